@@ -123,6 +123,7 @@ INVARIANT_CONDITION_FAILED_KYWD = 'INVARIANT_CONDITION_FAILED';
 PARENT_FAILED_KYWD = 'PARENT_FAILED';
 PARENT_EXITED_KYWD = 'PARENT_EXITED';
 EXITED_KYWD = 'EXITED';
+LIBRARY_EXPANSION_FAILED_KYWD = 'LIBRARY_EXPANSION_FAILED';
 
 // Boolean values
 TRUE_KYWD = 'true';
@@ -1108,6 +1109,7 @@ nodeFailureKywd :
   | PARENT_FAILED_KYWD
   | PARENT_EXITED_KYWD
   | EXITED_KYWD
+  | LIBRARY_EXPANSION_FAILED_KYWD
  ;
 
 nodeTimepointValue :
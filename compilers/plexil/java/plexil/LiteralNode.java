@@ -109,6 +109,7 @@ public class LiteralNode extends ExpressionNode
         case PlexilLexer.PARENT_FAILED_KYWD:
         case PlexilLexer.PARENT_EXITED_KYWD:
         case PlexilLexer.EXITED_KYWD:
+        case PlexilLexer.LIBRARY_EXPANSION_FAILED_KYWD:
             m_dataType = PlexilDataType.NODE_FAILURE_TYPE;
             break;
 
@@ -263,6 +263,7 @@ public class PlexilTreeAdaptor extends org.antlr.runtime.tree.CommonTreeAdaptor
         case PlexilLexer.PARENT_FAILED_KYWD:
         case PlexilLexer.PARENT_EXITED_KYWD:
         case PlexilLexer.EXITED_KYWD:
+        case PlexilLexer.LIBRARY_EXPANSION_FAILED_KYWD:
 
             return new LiteralNode(payload);
 
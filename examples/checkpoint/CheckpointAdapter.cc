@@ -140,6 +140,13 @@ void CheckpointAdapter::receiveCommandSuccess(Command* cmd) {
   }
 }
 
+void CheckpointAdapter::receiveCommandFailed(Command* cmd) {
+  if (cmd != NULL) {
+    getInterface().handleCommandAck(cmd, COMMAND_FAILED);
+    getInterface().notifyOfExternalEvent();
+  }
+}
+
 ///////////////////////////// Member functions //////////////////////////////////
 
 
@@ -289,6 +296,7 @@ void CheckpointAdapter::stop()
 {
   if(m_ok_on_exit) CheckpointSystem::getInstance()->setOK(true,0,NULL);
   if(m_flush_on_exit) CheckpointSystem::getInstance()->flush();
+  CheckpointSystem::getInstance()->stop();
   debugMsg("CheckpointAdapter", " stopped.");
 }
 
@@ -26,12 +26,14 @@
 
 #include "CheckpointSystem.hh"
 #include "Guard.hh"
+#include "JournalSaveManager.hh"
 #include "SimpleSaveManager.hh"
 #include "Publisher.hh"
 
 #include "Debug.hh"
 #include "StateCache.hh" // queryTime(), currentTime()
 
+#include <algorithm> // std::transform
 #include <iostream>
 #include <limits>
 
@@ -100,7 +102,18 @@ void CheckpointSystem::useTime(bool use_time) {
   m_use_time = use_time;
 }
 
+void CheckpointSystem::stop() {
+  m_manager->stop();
+}
+
 void CheckpointSystem::setSaveConfiguration(const pugi::xml_node* configXml){
+  // Select the save manager; defaults to SimpleSaveManager
+  string manager = configXml ? configXml->attribute("Manager").value() : "";
+  std::transform(manager.begin(), manager.end(), manager.begin(), ::tolower);
+  if(manager == "journal"){
+    debug("Using JournalSaveManager");
+    m_manager = std::make_unique<JournalSaveManager>();
+  }
   m_manager->setConfig(configXml);
 }
 
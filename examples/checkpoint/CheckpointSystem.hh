@@ -70,6 +70,7 @@ public:
 
   // Helper
   void start();
+  void stop();
   void setSaveConfiguration(const pugi::xml_node* configXml);
   void useTime(bool use_time);
 
@@ -0,0 +1,774 @@
+/* Copyright (c) 2006-2021, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "JournalSaveManager.hh"
+
+#include "Publisher.hh" // publishCommandSuccess(), publishCommandFailed()
+
+// PLEXIL includes
+#include "Debug.hh"
+#include "StateCache.hh" // queryTime()
+
+// POSIX includes
+#include <fcntl.h>
+#include <sys/stat.h> // mkdir
+#include <unistd.h>
+
+// C++ Standard Library includes
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits> // numeric_limits
+
+// C library includes
+#include <cerrno>
+#include <cstdio>  // rename()
+#include <cstring>
+
+using std::cerr;
+using std::endl;
+using std::map;
+using std::string;
+using std::vector;
+using namespace PLEXIL;
+
+#define debug(msg) debugMsg("JournalSaveManager"," "<<msg)
+
+//////////////////////////// File format ////////////////////////////
+
+//
+// Each file is a 12 byte header (magic number, generation) followed by
+// records of the form
+//   uint32 payload length, uint8 type, payload, uint32 checksum
+// The checksum covers the type and payload; a record which fails it, or
+// which runs past the end of the file, marks the end of valid data.
+// All integers are in host byte order.
+//
+
+namespace
+{
+  const char SNAPSHOT_MAGIC[] = "PLXCKPS1";
+  const char JOURNAL_MAGIC[] = "PLXCKPJ1";
+  const size_t MAGIC_LENGTH = 8;
+  const size_t HEADER_LENGTH = MAGIC_LENGTH + sizeof(uint32_t);
+
+  const char SNAPSHOT_FILE[] = "snapshot.bin";
+  const char JOURNAL_FILE[] = "journal.bin";
+
+  enum RecordType : uint8_t {
+    BOOT_RECORD = 1,       // boot time; starts a new boot
+    SAVE_RECORD,           // crash time of the newest boot
+    OK_RECORD,             // boot number relative to the newest boot, is_ok
+    CHECKPOINT_RECORD      // name, state, time, info; applies to the newest boot
+  };
+
+  //
+  // Encoding
+  //
+
+  void putU32(string &out, uint32_t n)
+  {
+    out.append(reinterpret_cast<char const *>(&n), sizeof(n));
+  }
+
+  void putBool(string &out, bool b)
+  {
+    out.push_back(b ? '\1' : '\0');
+  }
+
+  void putTime(string &out, Nullable<Real> const &time)
+  {
+    putBool(out, time.has_value());
+    Real r = time.has_value() ? time.value() : 0.0;
+    out.append(reinterpret_cast<char const *>(&r), sizeof(r));
+  }
+
+  void putString(string &out, string const &s)
+  {
+    putU32(out, s.size());
+    out.append(s);
+  }
+
+  // FNV-1a
+  uint32_t checksum(char const *data, size_t len)
+  {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; ++i) {
+      h ^= static_cast<uint8_t>(data[i]);
+      h *= 16777619u;
+    }
+    return h;
+  }
+
+  void putRecord(string &out, RecordType type, string const &payload)
+  {
+    putU32(out, payload.size());
+    size_t start = out.size();
+    out.push_back(static_cast<char>(type));
+    out.append(payload);
+    putU32(out, checksum(out.data() + start, out.size() - start));
+  }
+
+  string header(char const *magic, uint32_t generation)
+  {
+    string result(magic, MAGIC_LENGTH);
+    putU32(result, generation);
+    return result;
+  }
+
+  void putBoot(string &out, Nullable<Real> const &bootTime)
+  {
+    string payload;
+    putTime(payload, bootTime);
+    putRecord(out, BOOT_RECORD, payload);
+  }
+
+  void putSave(string &out, Nullable<Real> const &saveTime)
+  {
+    string payload;
+    putTime(payload, saveTime);
+    putRecord(out, SAVE_RECORD, payload);
+  }
+
+  void putOK(string &out, uint32_t bootNum, bool b)
+  {
+    string payload;
+    putU32(payload, bootNum);
+    putBool(payload, b);
+    putRecord(out, OK_RECORD, payload);
+  }
+
+  void putCheckpoint(string &out, string const &name, CheckpointData const &data)
+  {
+    string payload;
+    putString(payload, name);
+    putBool(payload, data.state);
+    putTime(payload, data.time);
+    putString(payload, data.info);
+    putRecord(out, CHECKPOINT_RECORD, payload);
+  }
+
+  //
+  // Decoding
+  //
+
+  class Cursor
+  {
+  public:
+    Cursor(char const *begin, char const *end) : m_ptr(begin), m_end(end) {}
+
+    bool getU32(uint32_t &n)
+    {
+      return getBytes(&n, sizeof(n));
+    }
+
+    bool getBool(bool &b)
+    {
+      char c;
+      if (!getBytes(&c, 1))
+        return false;
+      b = (c != '\0');
+      return true;
+    }
+
+    bool getTime(Nullable<Real> &time)
+    {
+      bool known;
+      Real r;
+      if (!getBool(known) || !getBytes(&r, sizeof(r)))
+        return false;
+      if (known)
+        time.set_value(r);
+      else
+        time.nullify();
+      return true;
+    }
+
+    bool getString(string &s)
+    {
+      uint32_t len;
+      if (!getU32(len) || len > (size_t) (m_end - m_ptr))
+        return false;
+      s.assign(m_ptr, len);
+      m_ptr += len;
+      return true;
+    }
+
+    bool atEnd() const
+    {
+      return m_ptr == m_end;
+    }
+
+  private:
+    bool getBytes(void *dest, size_t len)
+    {
+      if (len > (size_t) (m_end - m_ptr))
+        return false;
+      memcpy(dest, m_ptr, len);
+      m_ptr += len;
+      return true;
+    }
+
+    char const *m_ptr;
+    char const *m_end;
+  };
+
+  // Applies one record to the boot history (oldest boot first)
+  bool applyRecord(uint8_t type, Cursor &in, vector<BootData> &boots)
+  {
+    switch (type) {
+    case BOOT_RECORD: {
+      Nullable<Real> bootTime;
+      if (!in.getTime(bootTime))
+        return false;
+      BootData boot = {bootTime, Nullable<Real>(), false, map<const string, CheckpointData>()};
+      boots.push_back(boot);
+      return in.atEnd();
+    }
+
+    case SAVE_RECORD: {
+      Nullable<Real> saveTime;
+      if (!in.getTime(saveTime) || boots.empty())
+        return false;
+      boots.back().crash_time = saveTime;
+      return in.atEnd();
+    }
+
+    case OK_RECORD: {
+      uint32_t bootNum;
+      bool b;
+      if (!in.getU32(bootNum) || !in.getBool(b) || bootNum >= boots.size())
+        return false;
+      boots[boots.size() - 1 - bootNum].is_ok = b;
+      return in.atEnd();
+    }
+
+    case CHECKPOINT_RECORD: {
+      string name;
+      CheckpointData data;
+      if (!in.getString(name) || !in.getBool(data.state)
+          || !in.getTime(data.time) || !in.getString(data.info)
+          || boots.empty())
+        return false;
+      boots.back().checkpoints[name] = data;
+      return in.atEnd();
+    }
+
+    default:
+      return false;
+    }
+  }
+
+  bool readFile(string const &path, string &contents)
+  {
+    std::ifstream in(path.c_str(), std::ios::in | std::ios::binary);
+    if (!in)
+      return false;
+    contents.assign(std::istreambuf_iterator<char>(in),
+                    std::istreambuf_iterator<char>());
+    return !in.bad();
+  }
+
+  bool parseHeader(string const &contents, char const *magic, uint32_t &generation)
+  {
+    if (contents.size() < HEADER_LENGTH
+        || contents.compare(0, MAGIC_LENGTH, magic, MAGIC_LENGTH) != 0)
+      return false;
+    memcpy(&generation, contents.data() + MAGIC_LENGTH, sizeof(generation));
+    return true;
+  }
+
+  // Replays the records following the header.
+  // Returns the length of the valid prefix of the file.
+  size_t replayRecords(string const &contents, vector<BootData> &boots,
+                       size_t &nRecords)
+  {
+    char const *const base = contents.data();
+    size_t offset = HEADER_LENGTH;
+    while (offset < contents.size()) {
+      Cursor framing(base + offset, base + contents.size());
+      uint32_t len;
+      if (!framing.getU32(len)
+          || contents.size() - offset < sizeof(uint32_t) * 2 + 1 + (size_t) len)
+        break;
+      char const *body = base + offset + sizeof(uint32_t);
+      uint32_t sum;
+      memcpy(&sum, body + 1 + len, sizeof(sum));
+      if (sum != checksum(body, 1 + len))
+        break;
+      Cursor payload(body + 1, body + 1 + len);
+      if (!applyRecord(static_cast<uint8_t>(*body), payload, boots))
+        break;
+      offset += sizeof(uint32_t) * 2 + 1 + len;
+      ++nRecords;
+    }
+    return offset;
+  }
+
+  bool writeAll(int fd, char const *data, size_t len)
+  {
+    while (len) {
+      ssize_t n = write(fd, data, len);
+      if (n < 0) {
+        if (errno == EINTR)
+          continue;
+        return false;
+      }
+      data += n;
+      len -= n;
+    }
+    return true;
+  }
+
+  // Writes the file under a temporary name, then renames it into place
+  bool writeFileAtomically(string const &directory, string const &name,
+                           string const &contents)
+  {
+    string path = directory + "/" + name;
+    string partPath = path + ".part";
+    int fd = open(partPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+      cerr << "JournalSaveManager: Unable to create " << partPath << ": "
+           << strerror(errno) << endl;
+      return false;
+    }
+    bool ok = writeAll(fd, contents.data(), contents.size()) && fsync(fd) == 0;
+    close(fd);
+    if (!ok || rename(partPath.c_str(), path.c_str()) != 0) {
+      cerr << "JournalSaveManager: Writing " << path << " failed: "
+           << strerror(errno) << endl;
+      return false;
+    }
+    // Make the rename itself durable
+    int dirFd = open(directory.c_str(), O_RDONLY);
+    if (dirFd >= 0) {
+      fsync(dirFd);
+      close(dirFd);
+    }
+    return true;
+  }
+
+  bool ensureDirectory(string const &path)
+  {
+    struct stat st;
+    if (stat(path.c_str(), &st) == 0)
+      return S_ISDIR(st.st_mode);
+    size_t slash = path.find_last_of('/');
+    if (slash != string::npos && slash > 0 && !ensureDirectory(path.substr(0, slash)))
+      return false;
+    return mkdir(path.c_str(), S_IRWXU) == 0 || errno == EEXIST;
+  }
+}
+
+//////////////////////// Class Features ////////////////////////////
+
+JournalSaveManager::JournalSaveManager()
+  : m_file_directory("./saves"),
+    m_sync_interval(10),
+    m_compact_interval(1000),
+    m_have_read(false),
+    m_directory_set(false),
+    m_snapshot_offset(0),
+    m_journal_records(0),
+    m_journal_torn(false),
+    m_stop(false),
+    m_journal_fd(-1),
+    m_generation(0)
+{
+}
+
+JournalSaveManager::~JournalSaveManager()
+{
+  stopWriter();
+  // The adapter may be gone by now, so write out what remains
+  // without acknowledging any commands
+  {
+    std::lock_guard<std::mutex> guard(m_data_lock);
+    m_queued_commands.clear();
+  }
+  flushPending(false);
+  if (m_journal_fd >= 0)
+    close(m_journal_fd);
+}
+
+void JournalSaveManager::setData(vector<BootData> *data, int *num_total_boots)
+{
+  std::lock_guard<std::mutex> guard(m_data_lock);
+  m_data_vector = data;
+  m_num_total_boots = num_total_boots;
+}
+
+void JournalSaveManager::useTime(bool use_time)
+{
+  std::lock_guard<std::mutex> guard(m_data_lock);
+  m_use_time = use_time;
+}
+
+void JournalSaveManager::setConfig(const pugi::xml_node* configXml)
+{
+  std::lock_guard<std::mutex> guard(m_data_lock);
+  m_directory_set = true;
+  if (!configXml || !configXml->attribute("Directory")) {
+    cerr << "JournalSaveManager: No \"Directory\" attribute found in configuration, defaulting to ./saves" << endl;
+    m_file_directory = "./saves";
+  }
+  else
+    m_file_directory = configXml->attribute("Directory").value();
+  if (!configXml)
+    return;
+
+  pugi::xml_attribute attr = configXml->attribute("SyncInterval");
+  if (attr)
+    m_sync_interval = attr.as_uint(m_sync_interval);
+  attr = configXml->attribute("CompactInterval");
+  if (attr && attr.as_uint() > 0)
+    m_compact_interval = attr.as_uint();
+  debug("directory " << m_file_directory << ", sync interval " << m_sync_interval
+        << " ms, compact interval " << m_compact_interval << " records");
+}
+
+Nullable<Real> JournalSaveManager::saveTime() const
+{
+  Nullable<Real> time;
+  if (m_use_time) {
+    // Use currentTime not queryTime, because the TimeAdapter may have quit by now
+    time.set_value(StateCache::currentTime());
+    if (time.value() == std::numeric_limits<double>::min())
+      time.nullify();
+  }
+  return time;
+}
+
+void JournalSaveManager::enqueue(string const &record, Command *cmd)
+{
+  m_pending.append(record);
+  m_queued_commands.push_back(cmd);
+  m_save_time = saveTime();
+  if (++m_journal_records >= m_compact_interval || (m_journal_torn && !m_snapshot)) {
+    // Caller holds the CheckpointSystem write lock, so the data is consistent
+    // with the records queued so far.
+    // A journal which could not be cut back after a failed write is
+    // replaced by the snapshot.
+    debug("scheduling compaction");
+    m_snapshot.reset(new vector<BootData>(*m_data_vector));
+    m_snapshot->front().crash_time = m_save_time;
+    m_snapshot_offset = m_pending.size();
+    m_journal_records = 0;
+  }
+  m_data_cv.notify_one();
+}
+
+void JournalSaveManager::setOK(bool b, Integer boot_num, Command *cmd)
+{
+  string record;
+  putOK(record, (uint32_t) boot_num, b);
+  bool synchronous;
+  {
+    std::lock_guard<std::mutex> guard(m_data_lock);
+    enqueue(record, cmd);
+    synchronous = !m_writer.joinable();
+  }
+  if (synchronous)
+    flushPending(false);
+}
+
+void JournalSaveManager::setCheckpoint(const string& checkpoint_name, bool value,
+                                       string& info, Nullable<Real> time, Command *cmd)
+{
+  string record;
+  CheckpointData data = {value, time, info};
+  putCheckpoint(record, checkpoint_name, data);
+  bool synchronous;
+  {
+    std::lock_guard<std::mutex> guard(m_data_lock);
+    enqueue(record, cmd);
+    synchronous = !m_writer.joinable();
+  }
+  if (synchronous)
+    flushPending(false);
+}
+
+bool JournalSaveManager::writeOut()
+{
+  {
+    std::lock_guard<std::mutex> guard(m_data_lock);
+    m_save_time = saveTime();
+  }
+  return flushPending(true);
+}
+
+void JournalSaveManager::stop()
+{
+  stopWriter();
+  flushPending(false);
+}
+
+void JournalSaveManager::stopWriter()
+{
+  {
+    std::lock_guard<std::mutex> guard(m_data_lock);
+    m_stop = true;
+  }
+  m_data_cv.notify_one();
+  if (m_writer.joinable())
+    m_writer.join();
+}
+
+void JournalSaveManager::loadCrashes()
+{
+  std::lock_guard<std::mutex> file_guard(m_file_lock);
+  std::lock_guard<std::mutex> guard(m_data_lock);
+  if (m_have_read) {
+    cerr << "Aleady loaded crashes, this operation only supported once" << endl;
+    return;
+  }
+  m_have_read = true;
+  if (!m_directory_set) {
+    cerr << "SaveManager configuration never loaded, defaulting to directory = ./saves" << endl;
+    m_file_directory = "./saves";
+  }
+  if (!ensureDirectory(m_file_directory))
+    cerr << "JournalSaveManager: Unable to create directory " << m_file_directory << endl;
+
+  // Rebuild the history, oldest boot first
+  vector<BootData> boots;
+  string contents;
+  size_t nRecords = 0;
+  m_generation = 0;
+  if (readFile(m_file_directory + "/" + SNAPSHOT_FILE, contents)) {
+    if (parseHeader(contents, SNAPSHOT_MAGIC, m_generation))
+      replayRecords(contents, boots, nRecords);
+    else
+      cerr << "JournalSaveManager: Ignoring invalid snapshot in " << m_file_directory << endl;
+  }
+  debug("snapshot generation " << m_generation << ": " << boots.size() << " boot(s)");
+
+  bool journal_valid = false;
+  nRecords = 0;
+  string journalPath = m_file_directory + "/" + JOURNAL_FILE;
+  uint32_t journal_generation;
+  if (readFile(journalPath, contents)
+      && parseHeader(contents, JOURNAL_MAGIC, journal_generation)
+      && journal_generation == m_generation) {
+    journal_valid = true;
+    size_t valid = replayRecords(contents, boots, nRecords);
+    debug("replayed " << nRecords << " journal record(s)");
+    if (valid < contents.size()) {
+      debug("discarding " << contents.size() - valid << " byte(s) of incomplete journal");
+      if (truncate(journalPath.c_str(), valid) != 0)
+        journal_valid = false;
+    }
+  }
+
+  // Include current boot with current time, no checkpoints
+  Nullable<Real> time;
+  if (m_use_time) {
+    // Use queryTime here because this is likely the first time we are reading the time
+    time.set_value(StateCache::queryTime());
+    if (time.value() == std::numeric_limits<double>::min())
+      time.nullify();
+  }
+  BootData boot_d = {time, Nullable<Real>(), false, map<const string, CheckpointData>()};
+  boots.push_back(boot_d);
+
+  m_data_vector->assign(boots.rbegin(), boots.rend());
+  *m_num_total_boots = m_data_vector->size();
+
+  string bootRecord;
+  putBoot(bootRecord, time);
+  if (journal_valid && nRecords < m_compact_interval && openJournal(true)
+      && appendJournal(bootRecord)) {
+    m_journal_records = nRecords + 1;
+  }
+  else {
+    // Fold the journal into a new snapshot
+    vector<BootData> snapshot(*m_data_vector);
+    snapshot.front().crash_time = saveTime();
+    ++m_generation;
+    if (writeSnapshot(snapshot))
+      openJournal(false);
+    m_journal_records = 0;
+  }
+
+  m_stop = false;
+  m_writer = std::thread(&JournalSaveManager::writerLoop, this);
+}
+
+// Caller must hold m_file_lock
+bool JournalSaveManager::openJournal(bool append)
+{
+  if (m_journal_fd >= 0) {
+    close(m_journal_fd);
+    m_journal_fd = -1;
+  }
+  if (!append
+      && !writeFileAtomically(m_file_directory, JOURNAL_FILE,
+                              header(JOURNAL_MAGIC, m_generation)))
+    return false;
+  string path = m_file_directory + "/" + JOURNAL_FILE;
+  m_journal_fd = open(path.c_str(), O_WRONLY | O_APPEND);
+  if (m_journal_fd < 0) {
+    cerr << "JournalSaveManager: Unable to open " << path << ": " << strerror(errno) << endl;
+    return false;
+  }
+  return true;
+}
+
+// Appends the records to the journal and syncs it. On failure the
+// journal is cut back to its previous length, so that no part of the
+// records remains ahead of the next batch; if that fails too, the
+// journal is closed and must be replaced by a new snapshot.
+// Caller must hold m_file_lock
+bool JournalSaveManager::appendJournal(string const &records)
+{
+  off_t good = lseek(m_journal_fd, 0, SEEK_END);
+  if (good >= 0
+      && writeAll(m_journal_fd, records.data(), records.size())
+      && fsync(m_journal_fd) == 0)
+    return true;
+  cerr << "JournalSaveManager: Appending to journal failed: " << strerror(errno) << endl;
+  if (good >= 0 && ftruncate(m_journal_fd, good) == 0 && fsync(m_journal_fd) == 0) {
+    debug("journal truncated to " << good << " bytes");
+    return false;
+  }
+  cerr << "JournalSaveManager: Unable to truncate journal in " << m_file_directory
+       << ", it will be replaced at the next change" << endl;
+  close(m_journal_fd);
+  m_journal_fd = -1;
+  return false;
+}
+
+// Caller must hold m_file_lock
+bool JournalSaveManager::writeSnapshot(vector<BootData> const &boots)
+{
+  debug("writing snapshot generation " << m_generation << ", " << boots.size() << " boot(s)");
+  string contents = header(SNAPSHOT_MAGIC, m_generation);
+  for (vector<BootData>::const_reverse_iterator boot = boots.rbegin();
+       boot != boots.rend();
+       ++boot) {
+    putBoot(contents, boot->boot_time);
+    for (map<const string, CheckpointData>::const_iterator it = boot->checkpoints.begin();
+         it != boot->checkpoints.end();
+         ++it)
+      putCheckpoint(contents, it->first, it->second);
+    putOK(contents, 0, boot->is_ok);
+    putSave(contents, boot->crash_time);
+  }
+  return writeFileAtomically(m_file_directory, SNAPSHOT_FILE, contents);
+}
+
+bool JournalSaveManager::flushPending(bool force)
+{
+  std::lock_guard<std::mutex> file_guard(m_file_lock);
+
+  string records;
+  std::unique_ptr<vector<BootData> > snapshot;
+  size_t snapshot_offset;
+  vector<Command*> commands;
+  Nullable<Real> save_time;
+  bool torn;
+  {
+    std::lock_guard<std::mutex> guard(m_data_lock);
+    if (!m_have_read)
+      return false;
+    records.swap(m_pending);
+    snapshot.swap(m_snapshot);
+    snapshot_offset = m_snapshot_offset;
+    m_snapshot_offset = 0;
+    commands.swap(m_queued_commands);
+    save_time = m_save_time;
+    torn = m_journal_torn;
+  }
+  if (!force && records.empty() && !snapshot && commands.empty())
+    return true;
+
+  bool retval = true;
+  if (snapshot) {
+    // The snapshot supersedes the records queued before it
+    ++m_generation;
+    if (writeSnapshot(*snapshot)) {
+      retval = openJournal(false);
+      records.erase(0, snapshot_offset);
+      torn = false;
+    }
+    else
+      --m_generation; // keep appending to the current journal
+  }
+  if (retval && m_journal_fd < 0) {
+    if (torn)
+      retval = false; // wait for the snapshot
+    else {
+      // An earlier attempt to open the journal failed, so nothing has
+      // been appended to it since the last snapshot; start it afresh
+      debug("reopening journal");
+      retval = openJournal(false);
+    }
+  }
+  if (retval) {
+    putSave(records, save_time);
+    debug("appending " << records.size() << " bytes for " << commands.size() << " command(s)");
+    retval = appendJournal(records);
+    torn = (m_journal_fd < 0);
+  }
+  else
+    cerr << "JournalSaveManager: Journal in " << m_file_directory
+         << " is not open, changes not saved" << endl;
+
+  {
+    std::lock_guard<std::mutex> guard(m_data_lock);
+    m_journal_torn = torn;
+  }
+
+  // Report the outcome to all commands in the batch
+  debug("sending " << (retval ? "success" : "failure") << " to "
+        << commands.size() << " command(s)");
+  for (vector<Command*>::iterator it = commands.begin(); it != commands.end(); ++it)
+    if (*it) {
+      if (retval)
+        publishCommandSuccess(*it);
+      else
+        publishCommandFailed(*it);
+    }
+  return retval;
+}
+
+void JournalSaveManager::writerLoop()
+{
+  std::unique_lock<std::mutex> lock(m_data_lock);
+  while (!m_stop) {
+    m_data_cv.wait(lock, [this] { return m_stop || !m_pending.empty() || m_snapshot; });
+    if (m_stop)
+      break;
+    // Let changes made in the next interval join this batch
+    if (m_sync_interval)
+      m_data_cv.wait_for(lock, std::chrono::milliseconds(m_sync_interval),
+                         [this] { return m_stop; });
+    lock.unlock();
+    flushPending(false);
+    lock.lock();
+  }
+}
@@ -0,0 +1,131 @@
+/* Copyright (c) 2006-2021, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef _H_JournalSaveManager
+#define _H_JournalSaveManager
+
+#include "Nullable.hh"
+#include "SaveManager.hh"
+
+#include "ValueType.hh"
+
+#include "pugixml.hpp"
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//
+// A SaveManager which appends each change to a binary journal instead of
+// rewriting the whole history on every command.
+//
+// The save directory holds two files:
+//   snapshot.bin - the complete boot history as of the last compaction
+//   journal.bin  - records appended since that snapshot
+//
+// Both files begin with a magic number and a generation count. A journal is
+// only replayed on top of a snapshot of the same generation, so a crash at
+// any point during compaction leaves a consistent pair on disk.
+//
+// Records are appended by a writer thread which batches all changes made
+// within SyncInterval milliseconds into a single write and fdatasync();
+// COMMAND_SUCCESS is sent only after the batch is on disk. After
+// CompactInterval records the journal is folded into a new snapshot.
+//
+
+class JournalSaveManager : public SaveManager
+{
+public:
+
+  JournalSaveManager();
+  virtual ~JournalSaveManager();
+
+  virtual void setData(std::vector<BootData> *data, int *num_total_boots);
+
+  virtual void setConfig(const pugi::xml_node* configXml);
+
+  virtual void useTime(bool use_time);
+
+  virtual void loadCrashes();
+
+  // Writes all pending records synchronously
+  virtual bool writeOut();
+
+  virtual void stop();
+
+  // Enqueue a record and the command for the next batch
+  virtual void setOK(bool b, PLEXIL::Integer boot_num, PLEXIL::Command *cmd);
+  virtual void setCheckpoint(const std::string& checkpoint_name, bool value, std::string& info, Nullable<PLEXIL::Real> time, PLEXIL::Command *cmd);
+
+private:
+  // Disallow copy
+  JournalSaveManager & operator=(const JournalSaveManager&) = delete;
+  JournalSaveManager(const JournalSaveManager&) = delete;
+
+  // Caller must hold m_data_lock
+  void enqueue(std::string const &record, PLEXIL::Command *cmd);
+  Nullable<PLEXIL::Real> saveTime() const;
+
+  // Writes everything queued so far, then sends COMMAND_SUCCESS.
+  // If force is true, records the save time even when nothing is queued.
+  bool flushPending(bool force);
+  bool openJournal(bool append);
+  bool appendJournal(std::string const &records);
+  bool writeSnapshot(std::vector<BootData> const &boots);
+  void writerLoop();
+  void stopWriter();
+
+  std::string m_file_directory;
+  unsigned int m_sync_interval;  // milliseconds
+  size_t m_compact_interval;     // records
+
+  bool m_have_read;
+  bool m_directory_set;
+
+  // Guards everything below, except the file state
+  std::mutex m_data_lock;
+  std::condition_variable m_data_cv;
+  std::string m_pending;              // encoded records
+  size_t m_snapshot_offset;           // end of records covered by m_snapshot
+  std::unique_ptr<std::vector<BootData> > m_snapshot;
+  std::vector<PLEXIL::Command*> m_queued_commands;
+  Nullable<PLEXIL::Real> m_save_time; // time of the newest queued change
+  size_t m_journal_records;           // since the last snapshot
+  bool m_journal_torn;                // journal holds part of a failed batch
+  std::thread m_writer;
+  bool m_stop;
+
+  // Serializes file access between the writer thread and writeOut()
+  std::mutex m_file_lock;
+  int m_journal_fd;
+  uint32_t m_generation;
+};
+
+#endif
@@ -68,3 +68,7 @@ void publishCommandReceived (PLEXIL::Command* cmd){
 void publishCommandSuccess (PLEXIL::Command* cmd){
   instance->receiveCommandSuccess(cmd);
 }
+
+void publishCommandFailed (PLEXIL::Command* cmd){
+  instance->receiveCommandFailed(cmd);
+}
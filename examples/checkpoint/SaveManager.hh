@@ -58,6 +58,9 @@ public:
 			     Nullable<PLEXIL::Real> time,
 			     PLEXIL::Command *cmd) = 0;
 
+  // Called when the adapter stops, after any final flush
+  virtual void stop() {}
+
 protected:
   
   // Data, shared with CheckpointSystem
@@ -50,6 +50,7 @@ public:
                              const PLEXIL::Value& arg1, const PLEXIL::Value& arg2) = 0;
   virtual void receiveCommandReceived (PLEXIL::Command* cmd) = 0;
   virtual void receiveCommandSuccess (PLEXIL::Command* cmd) = 0;
+  virtual void receiveCommandFailed (PLEXIL::Command* cmd) = 0;
 };
 
 // A Subscriber registers for data with this function.
@@ -0,0 +1,166 @@
+/* Copyright (c) 2006-2021, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+//
+// Checks that a journal write which fails part way through does not
+// lose changes already acknowledged, nor those made after it.
+// The failure is injected with a file size limit.
+//
+
+#include "JournalSaveManager.hh"
+
+#include "Publisher.hh"
+
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+static std::set<PLEXIL::Command *> succeeded;
+static std::set<PLEXIL::Command *> failed;
+
+// Stand-ins for the adapter's replies
+void publishCommandSuccess(PLEXIL::Command *cmd)
+{
+  succeeded.insert(cmd);
+}
+
+void publishCommandFailed(PLEXIL::Command *cmd)
+{
+  failed.insert(cmd);
+}
+
+static PLEXIL::Command *fakeCommand(size_t n)
+{
+  return reinterpret_cast<PLEXIL::Command *>(n);
+}
+
+static bool check(bool condition, char const *what)
+{
+  if (!condition)
+    cout << "FAILED: " << what << endl;
+  return condition;
+}
+
+static off_t fileSize(string const &path)
+{
+  struct stat st;
+  return stat(path.c_str(), &st) == 0 ? st.st_size : -1;
+}
+
+static void setFileSizeLimit(rlim_t limit)
+{
+  struct rlimit lim;
+  getrlimit(RLIMIT_FSIZE, &lim);
+  lim.rlim_cur = limit;
+  setrlimit(RLIMIT_FSIZE, &lim);
+}
+
+static void configure(JournalSaveManager &mgr, string const &dir,
+                      vector<BootData> &data, int &nBoots)
+{
+  pugi::xml_document doc;
+  pugi::xml_node config = doc.append_child("SaveConfiguration");
+  config.append_attribute("Directory") = dir.c_str();
+  mgr.setConfig(&config);
+  mgr.setData(&data, &nBoots);
+  mgr.useTime(false);
+  mgr.loadCrashes();
+  // Write each change synchronously
+  mgr.stop();
+}
+
+static void setCheckpoint(JournalSaveManager &mgr, char const *name, size_t cmd)
+{
+  string info(name);
+  mgr.setCheckpoint(name, true, info, Nullable<PLEXIL::Real>(), fakeCommand(cmd));
+}
+
+int main()
+{
+  char dirTemplate[] = "/tmp/journal-test-XXXXXX";
+  if (!mkdtemp(dirTemplate)) {
+    cout << "Unable to create a directory" << endl;
+    return 1;
+  }
+  string dir(dirTemplate);
+  string journal = dir + "/journal.bin";
+  // Exceeding the limit must fail the write, not end the process
+  signal(SIGXFSZ, SIG_IGN);
+
+  bool success = true;
+  {
+    vector<BootData> data;
+    int nBoots = 0;
+    JournalSaveManager mgr;
+    configure(mgr, dir, data, nBoots);
+
+    setCheckpoint(mgr, "before", 1);
+    success = check(succeeded.count(fakeCommand(1)), "first change acknowledged") && success;
+
+    // Allow only part of the next record to be written
+    off_t good = fileSize(journal);
+    setFileSizeLimit(good + 5);
+    setCheckpoint(mgr, "lost", 2);
+    setFileSizeLimit(RLIM_INFINITY);
+    success = check(failed.count(fakeCommand(2)), "failed change reported") && success;
+    success = check(fileSize(journal) == good, "journal truncated after failure") && success;
+
+    setCheckpoint(mgr, "after", 3);
+    success = check(succeeded.count(fakeCommand(3)), "later change acknowledged") && success;
+  }
+
+  {
+    vector<BootData> data;
+    int nBoots = 0;
+    JournalSaveManager mgr;
+    configure(mgr, dir, data, nBoots);
+    success = check(nBoots == 2, "both boots replayed") && success;
+    if (nBoots == 2) {
+      BootData const &previous = data[1];
+      success = check(previous.checkpoints.count("before"), "first change replayed") && success;
+      success = check(previous.checkpoints.count("after"), "later change replayed") && success;
+      success = check(!previous.checkpoints.count("lost"), "failed change not replayed") && success;
+    }
+  }
+
+  unlink(journal.c_str());
+  unlink((dir + "/snapshot.bin").c_str());
+  rmdir(dir.c_str());
+  cout << "Journal test " << (success ? "succeeded" : "failed") << endl;
+  return success ? 0 : 1;
+}
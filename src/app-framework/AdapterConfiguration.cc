@@ -32,6 +32,7 @@
 #include "Debug.hh"
 #include "DynamicLoader.h"
 #include "ExecListenerHub.hh"
+#include "ExecMetrics.hh"
 #include "InterfaceAdapter.hh"
 #include "InterfaceError.hh"
 #include "InterfaceManager.hh"
@@ -40,6 +41,7 @@
 #include "ListenerFilters.hh"
 #include "LookupReceiver.hh"
 #include "MessageAdapter.hh"
+#include "MetricsAdapter.h"
 #include "NodeConnector.hh"
 #include "planLibrary.hh"
 #include "State.hh"
@@ -112,7 +114,10 @@ namespace PLEXIL {
     AdapterConfigurationImpl()
       : m_defaultCommandHandler(std::make_shared<CommandHandler>()),
         m_defaultLookupHandler(std::make_shared<LookupHandler>()),
-        m_plannerUpdateHandler()
+        m_plannerUpdateHandler(),
+        m_handlerGeneration(1),
+        m_priorityLanes(false),
+        m_coalesceLookups(false)
     {
       // Every application has access to the time adapter
       initTimeAdapter();
@@ -124,6 +129,9 @@ namespace PLEXIL {
       initUtilityAdapter();
       initLauncher();
 
+      // Every application has access to the metrics adapter
+      initMetricsAdapter();
+
       registerExecListenerFilters();
 
       //
@@ -277,6 +285,17 @@ namespace PLEXIL {
             delete path;
           }
         }
+        else if (strcmp(elementType, InterfaceSchema::INPUT_QUEUE_TAG) == 0) {
+          m_priorityLanes =
+            element.attribute(InterfaceSchema::PRIORITY_LANES_ATTR).as_bool();
+          m_coalesceLookups =
+            element.attribute(InterfaceSchema::COALESCE_LOOKUPS_ATTR).as_bool();
+          debugMsg("AdapterConfiguration:constructInterfaces",
+                   " input queue priority lanes "
+                   << (m_priorityLanes ? "enabled" : "disabled")
+                   << ", lookup coalescing "
+                   << (m_coalesceLookups ? "enabled" : "disabled"));
+        }
         else if (strcmp(elementType, InterfaceSchema::PLAN_PATH_TAG) == 0) {
           // Add to plan path
           const char* pathstring = element.child_value();
@@ -360,6 +379,7 @@ namespace PLEXIL {
                  " (vector) " << name << " -> " << handler);
         m_commandMap[name] = handler;
       }
+      handlersChanged();
     }
 
     virtual void registerCommandHandler(CommandHandlerPtr handler,
@@ -368,6 +388,7 @@ namespace PLEXIL {
       debugMsg("AdapterConfiguration:registerCommandHandler",
                " (string) " << cmdName << " -> " << handler);
       m_commandMap[cmdName] = handler;
+      handlersChanged();
     }
 
     virtual void registerCommandHandlerFunction(std::string const &stateName,
@@ -383,6 +404,7 @@ namespace PLEXIL {
     {
       debugMsg("AdapterConfiguration:setDefaultCommandHandler", ' ' << handler);
       m_defaultCommandHandler = CommandHandlerPtr(handler);
+      handlersChanged();
     }
 
     virtual void setDefaultCommandHandlerFunction(ExecuteCommandHandler execCmd,
@@ -405,6 +427,7 @@ namespace PLEXIL {
                  " (vector) " << name << " -> " << handler);
         m_lookupMap[name] = handler;
       }
+      handlersChanged();
     }
 
     virtual void registerLookupHandler(LookupHandlerPtr handler,
@@ -413,6 +436,7 @@ namespace PLEXIL {
       debugMsg("AdapterConfiguration:registerLookupHandler",
                " (string) for " << stateName << " -> " << handler);
       m_lookupMap[stateName] = handler;
+      handlersChanged();
     }
 
     virtual void registerLookupHandlerFunction(std::string const &stateName,
@@ -435,6 +459,7 @@ namespace PLEXIL {
     {
       debugMsg("AdapterConfiguration:registerLookupHandler", ' ' << handler);
       m_defaultLookupHandler = handler;
+      handlersChanged();
     }
 
     virtual void setDefaultLookupHandler(LookupNowHandler lookupNow,
@@ -488,7 +513,18 @@ namespace PLEXIL {
     {
       debugMsg("AdapterConfiguration:lookupNow", " of " << state);
       try {
-        getLookupHandler(state.name())->lookupNow(state, rcvr);
+        LookupHandler *handler = rcvr->getLookupHandler(m_handlerGeneration);
+        if (!handler) {
+          handler = getLookupHandler(state.name());
+          rcvr->setLookupHandler(handler, m_handlerGeneration);
+        }
+        if (execMetricsEnabled()) {
+          MetricsClock::time_point start = MetricsClock::now();
+          handler->lookupNow(state, rcvr);
+          recordLookup(state.name(), MetricsClock::now() - start);
+        }
+        else
+          handler->lookupNow(state, rcvr);
       }
       catch (InterfaceError const &e) {
         warn("lookupNow: Error performing lookup of " << state << ":\n"
@@ -527,13 +563,17 @@ namespace PLEXIL {
     //! @param The command to be executed.
     virtual void executeCommand(Command *cmd)
     {
+      if (execMetricsEnabled())
+        noteCommandSent(cmd);
       try {
-        getCommandHandler(cmd->getName())->executeCommand(cmd, m_manager);
+        getCachedCommandHandler(cmd)->executeCommand(cmd, m_manager);
       }
       catch (InterfaceError const &e) {
         // return error status quickly
         warn("executeCommand: Error executing command " << cmd->getName()
              << ":\n" << e.what());
+        if (execMetricsEnabled())
+          noteCommandAck(cmd);
         commandHandleReturn(cmd, COMMAND_INTERFACE_ERROR);
       }
     }
@@ -552,7 +592,7 @@ namespace PLEXIL {
     virtual void invokeAbort(Command *cmd)
     {
       try {
-        getCommandHandler(cmd->getName())->abortCommand(cmd, m_manager);
+        getCachedCommandHandler(cmd)->abortCommand(cmd, m_manager);
       }
       catch (InterfaceError const &e) {
         // return error status quickly
@@ -600,6 +640,25 @@ namespace PLEXIL {
       return m_defaultCommandHandler.get();
     }
 
+    // Use the handler cached on the command if it has one.
+    CommandHandler *getCachedCommandHandler(Command *cmd) const
+    {
+      CommandHandler *result = cmd->getCommandHandler(m_handlerGeneration);
+      if (!result) {
+        result = getCommandHandler(cmd->getName());
+        cmd->setCommandHandler(result, m_handlerGeneration);
+      }
+      return result;
+    }
+
+    // Any handler cached on a command or lookup receiver may have
+    // been replaced, and freed. Caches of the old generation miss.
+    void handlersChanged()
+    {
+      if (!++m_handlerGeneration)
+        m_handlerGeneration = 1; // 0 is that of an empty cache
+    }
+
     virtual LookupHandler *getLookupHandler(std::string const &stateName) const
     {
       LookupHandlerMap::const_iterator it = m_lookupMap.find(stateName);
@@ -688,9 +747,9 @@ namespace PLEXIL {
     {
       return 
 #ifdef PLEXIL_WITH_THREADS
-        new SerializedInputQueue();
+        new SerializedInputQueue(m_priorityLanes, m_coalesceLookups);
 #else
-        new SimpleInputQueue();
+        new SimpleInputQueue(m_priorityLanes, m_coalesceLookups);
 #endif
     }
 
@@ -899,6 +958,16 @@ namespace PLEXIL {
     //* Handler to use for Update nodes
     PlannerUpdateHandler m_plannerUpdateHandler;
 
+    //* Changed whenever a command or lookup handler is registered
+    unsigned int m_handlerGeneration;
+
+    //* True if command and update responses should go ahead of other
+    //* input queue entries
+    bool m_priorityLanes;
+
+    //* True if the input queue should coalesce superseded lookup values
+    bool m_coalesceLookups;
+
     //! Pointer to the InterfaceManager instance.
     //! @note InterfaceManager is owned by ExecApplication.
     InterfaceManager *m_manager;
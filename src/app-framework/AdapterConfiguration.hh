@@ -101,6 +101,10 @@ namespace PLEXIL
     //
     // Handler registration functions
     //
+    // The Dispatcher caches the handler it finds for a command or
+    // lookup. Registering or replacing any handler invalidates every
+    // cached handler.
+    //
 
     /**
      * @brief Register the given CommandHandler instance for all
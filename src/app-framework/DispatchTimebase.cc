@@ -167,6 +167,10 @@ namespace PLEXIL
         debugMsg("DispatchTimebase:setTimer", " tick mode, ignoring");
         return;
       }
+
+      // Merge with the pending wakeup, or defer by the slack window
+      if (!coalesceDeadline(d))
+        return;
       
       // Deadline based
       debugMsg("DispatchTimebase:setTimer",
@@ -30,9 +30,13 @@
 #include "Debug.hh"
 #include "Error.hh"
 #include "ExecListenerHub.hh"
+#include "ExecMetrics.hh"
+#include "ExecRecording.hh"
+#include "ExpressionStatistics.hh"
 #include "InterfaceAdapter.hh"
 #include "InterfaceManager.hh"
 #include "InputQueue.hh"
+#include "InterfaceSchema.hh"
 #include "PlexilExec.hh"
 #include "PlexilSchema.hh"
 #include "StateCache.hh"
@@ -193,8 +197,41 @@ namespace PLEXIL
     //
     using AdapterConfigurationPtr = std::unique_ptr<AdapterConfiguration>;
     using ExecListenerHubPtr  = std::unique_ptr<ExecListenerHub>;
+    using ExecRecorderPtr = std::unique_ptr<ExecRecorder>;
+    using ExecReplayerPtr = std::unique_ptr<ExecReplayer>;
     using InterfaceManagerPtr = std::unique_ptr<InterfaceManager>;
     using PlexilExecPtr = std::unique_ptr<PlexilExec>;
+    using StateCachePtr = std::unique_ptr<StateCache>;
+
+    //! Binds the application's exec, dispatcher, and state cache to
+    //! the calling thread for the lifetime of the object, and
+    //! restores the previous bindings when it goes out of scope.
+    class ContextBinding final
+    {
+    public:
+      ContextBinding(ExecApplicationImpl *app)
+        : m_exec(g_exec),
+          m_dispatcher(g_dispatcher),
+          m_stateCache(g_stateCache)
+      {
+        app->bindContext();
+      }
+
+      ~ContextBinding()
+      {
+        g_exec = m_exec;
+        g_dispatcher = m_dispatcher;
+        g_stateCache = m_stateCache;
+      }
+
+    private:
+      ContextBinding(ContextBinding const &) = delete;
+      ContextBinding &operator=(ContextBinding const &) = delete;
+
+      PlexilExec *m_exec;
+      Dispatcher *m_dispatcher;
+      StateCache *m_stateCache;
+    };
 
     //
     // Member variables
@@ -232,6 +269,16 @@ namespace PLEXIL
     unsigned int m_lastMark;
 #endif 
 
+    //! This application's external state cache.
+    //! Declared first so it outlives the plans which refer to it.
+    StateCachePtr m_stateCache;
+
+    //! Input recorder, if recording.
+    ExecRecorderPtr m_recorder;
+
+    //! Input replayer, if replaying.
+    ExecReplayerPtr m_replayer;
+
     //! Interfacing database and dispatcher
     AdapterConfigurationPtr m_configuration;
 
@@ -244,6 +291,10 @@ namespace PLEXIL
     //! Exec listener hub
     ExecListenerHubPtr m_listener;
 
+    //! The dispatcher used by the exec: the AdapterConfiguration, or
+    //! the recorder or replayer standing in for it.
+    Dispatcher *m_dispatcher;
+
     // Flag to determine whether exec should run conservatively
     bool m_runExecInBkgndOnly;
 
@@ -276,10 +327,14 @@ namespace PLEXIL
         m_allFinishedSem(),
         m_lastMark(0),
 #endif
+        m_stateCache(makeStateCache()),
+        m_recorder(),
+        m_replayer(),
         m_configuration(makeAdapterConfiguration()),
         m_manager(new InterfaceManager(this, m_configuration.get())),
         m_exec(makePlexilExec()),
         m_listener(new ExecListenerHub()),
+        m_dispatcher(m_configuration.get()),
         m_runExecInBkgndOnly(true),
         m_initialized(false),
         m_interfacesStarted(false),
@@ -289,11 +344,11 @@ namespace PLEXIL
     {
       // Set globals that other pieces rely on
       // Required by Exec core
-      g_dispatcher = static_cast<Dispatcher *>(m_configuration.get());
-      g_exec = m_exec.get();
+      // The worker thread makes the same bindings when it starts.
+      bindContext();
 
       // Link the Exec to the AdapterConfiguration
-      m_exec->setDispatcher(m_configuration.get());
+      m_exec->setDispatcher(m_dispatcher);
 
       // Link the Exec to the listener hub
       m_exec->setExecListener(m_listener.get());
@@ -302,8 +357,11 @@ namespace PLEXIL
     virtual ~ExecApplicationImpl()
     {
       // Reset global pointers to objects we own before they are deleted
-      g_dispatcher = nullptr;
-      g_exec = nullptr;
+      if (g_exec == m_exec.get()) {
+        g_dispatcher = nullptr;
+        g_exec = nullptr;
+        g_stateCache = nullptr;
+      }
     }
 
     //
@@ -330,6 +388,11 @@ namespace PLEXIL
       return m_exec.get();
     }
 
+    virtual StateCache *stateCache() override
+    {
+      return m_stateCache.get();
+    }
+
     //
     // General configuration
     //
@@ -355,6 +418,50 @@ namespace PLEXIL
       m_configuration->addLibraryPath(libdirs);
     }
 
+    //
+    // Record and replay
+    //
+
+    //! Record the inputs the Exec consumes to a file, for later replay.
+    //! @param filename Name of the recording file; it is overwritten.
+    //! @return true if successful, false otherwise.
+    virtual bool recordInputs(std::string const &filename) override
+    {
+      if (m_initialized || m_recorder || m_replayer) {
+        warn("Error: recordInputs() called after initialize(), recordInputs(), or replayInputs()");
+        return false;
+      }
+      m_recorder.reset(makeExecRecorder(filename, m_configuration.get()));
+      if (!m_recorder)
+        return false;
+      setDispatcher(m_recorder->dispatcher());
+      return true;
+    }
+
+    //! Feed the Exec the inputs from a recording instead of from the
+    //! interfaces.
+    //! @param filename Name of a file written by recordInputs().
+    //! @return true if successful, false otherwise.
+    virtual bool replayInputs(std::string const &filename) override
+    {
+      if (m_initialized || m_recorder || m_replayer) {
+        warn("Error: replayInputs() called after initialize(), recordInputs(), or replayInputs()");
+        return false;
+      }
+      m_replayer.reset(makeExecReplayer(filename));
+      if (!m_replayer)
+        return false;
+      setDispatcher(m_replayer->dispatcher());
+      return true;
+    }
+
+    //! Query whether replay of a recording failed.
+    //! @return true if replaying and the replay failed, false otherwise.
+    virtual bool replayFailed() const override
+    {
+      return m_replayer && m_replayer->failed();
+    }
+
     //
     // Initialization and startup
     //
@@ -383,7 +490,15 @@ namespace PLEXIL
       // *** NYI ***
 
       // Construct interfaces
-      if (!m_configuration->constructInterfaces(configXml, *m_manager, *m_listener)) {
+      if (m_replayer) {
+        // Replay supplies the inputs; only listeners are needed
+        if (!constructListeners(configXml)) {
+          debugMsg("ExecApplication:initialize",
+                   " construction of Exec listeners failed");
+          return false;
+        }
+      }
+      else if (!m_configuration->constructInterfaces(configXml, *m_manager, *m_listener)) {
         debugMsg("ExecApplication:initialize",
                  " construction of interfaces failed");
         return false;
@@ -409,6 +524,10 @@ namespace PLEXIL
                  " initialization of interface manager failed");
         return false;
       }
+      if (m_recorder)
+        m_manager->setInputQueue(m_recorder->wrapInputQueue(m_manager->releaseInputQueue()));
+      else if (m_replayer)
+        m_manager->setInputQueue(m_replayer->makeInputQueue());
 
       // Set the application state and return
       m_initialized = true;
@@ -460,10 +579,11 @@ namespace PLEXIL
 #ifdef PLEXIL_WITH_THREADS
         ThreadMutexGuard guard(m_execMutex);
 #endif
+        ContextBinding binding(this);
         debugMsg("ExecApplication:step", " Processing queue");
         m_manager->processQueue();
         debugMsg("ExecApplication:step", " Stepping exec");
-        m_exec->step(StateCache::queryTime());
+        stepExec();
         // Take care of any plans which have finished
         m_exec->deleteFinishedPlans();
         allFinished = m_exec->allPlansFinished();
@@ -497,12 +617,13 @@ namespace PLEXIL
 #ifdef PLEXIL_WITH_THREADS
         ThreadMutexGuard guard(m_execMutex);
 #endif
+        ContextBinding binding(this);
         debugMsg("ExecApplication:runExec", " Processing queue");
         m_manager->processQueue();
         do {
           do {
             debugMsg("ExecApplication:runExec", " Stepping exec");
-            m_exec->step(StateCache::queryTime());
+            stepExec();
           } while (m_exec->needsStep());
           debugMsg("ExecApplication:runExec", " Processing queue");
         } while (m_manager->processQueue());
@@ -730,6 +851,15 @@ namespace PLEXIL
       return m_exec->allPlansFinished();
     }
 
+    virtual void reportExpressionStatistics(std::ostream &s,
+                                            size_t topCount) override
+    {
+#ifdef PLEXIL_WITH_THREADS
+      ThreadMutexGuard guard(m_execMutex);
+#endif    
+      PLEXIL::reportExpressionStatistics(m_exec->getPlans(), s, topCount);
+    }
+
     /**
      * @brief Suspend the current thread until the application reaches APP_STOPPED state.
      * @note May be called by multiple threads
@@ -760,6 +890,7 @@ namespace PLEXIL
     virtual bool addLibrary(pugi::xml_document* libraryXml) override
     {
       // Delegate to InterfaceManager
+      ContextBinding binding(this);
       if (m_manager->handleAddLibrary(libraryXml)) {
         debugMsg("ExecApplication:addLibrary", " Library added");
         return true;
@@ -779,6 +910,7 @@ namespace PLEXIL
     {
       bool result = false;
       // Delegate to InterfaceManager
+      ContextBinding binding(this);
       try {
         result = m_manager->handleLoadLibrary(name);
       }
@@ -811,6 +943,7 @@ namespace PLEXIL
 #endif
 
       // Delegate to InterfaceManager
+      ContextBinding binding(this);
       try {
         m_manager->handleAddPlan(planXml->document_element());
         debugMsg("ExecApplication:addPlan", " successful");
@@ -838,6 +971,49 @@ namespace PLEXIL
     // Implementation methods
     //
 
+    //! Make this application's exec, dispatcher, and state cache
+    //! the ones used by the calling thread.
+    void bindContext()
+    {
+      g_dispatcher = m_dispatcher;
+      g_exec = m_exec.get();
+      g_stateCache = m_stateCache.get();
+    }
+
+    //! Step the exec once, timing the step if metrics are enabled.
+    //! @note Caller must hold m_execMutex.
+    void stepExec()
+    {
+      if (execMetricsEnabled()) {
+        MetricsClock::time_point start = MetricsClock::now();
+        m_exec->step(StateCache::queryTime());
+        recordMacroStep(MetricsClock::now() - start);
+      }
+      else
+        m_exec->step(StateCache::queryTime());
+    }
+
+    //! Use the given dispatcher in place of the AdapterConfiguration.
+    void setDispatcher(Dispatcher *dispatcher)
+    {
+      m_dispatcher = dispatcher;
+      m_exec->setDispatcher(dispatcher);
+      bindContext();
+    }
+
+    //! Construct the Exec listeners named in the configuration, and
+    //! nothing else.
+    bool constructListeners(pugi::xml_node const configXml)
+    {
+      for (pugi::xml_node element = configXml.child(InterfaceSchema::LISTENER_TAG);
+           element;
+           element = element.next_sibling(InterfaceSchema::LISTENER_TAG)) {
+        if (!m_listener->constructListener(element))
+          return false;
+      }
+      return true;
+    }
+
 #ifdef PLEXIL_WITH_THREADS
     /**
      * @brief Spawns the worker thread which runs the exec's top level loop.
@@ -856,6 +1032,9 @@ namespace PLEXIL
     {
       debugMsg("ExecApplication:worker", " started");
 
+      // Each application's worker thread runs its own exec
+      bindContext();
+
       // set up signal handling environment for this thread
       if (!initializeWorkerSignalHandling()) {
         warn("ExecApplication: Worker signal handling initialization failed.");
@@ -868,6 +1047,15 @@ namespace PLEXIL
         step();
         debugMsg("ExecApplication:worker", " Initial step complete");
 
+        if (m_replayer) {
+          // The recording stands in for external events
+          while (!m_stop && !m_replayer->finished())
+            runExec();
+          debugMsg("ExecApplication:worker", " Replay complete");
+          runExec(); // release anyone waiting on a queue mark
+          m_allFinishedSem.post();
+        }
+
         while (waitForExternalEvent()) {
           if (m_stop) {
             debugMsg("ExecApplication:worker", " Received stop request");
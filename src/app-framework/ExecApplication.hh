@@ -29,6 +29,7 @@
 
 #include "plexil-config.h"
 
+#include <iosfwd>
 #include <string>
 #include <vector>
 
@@ -47,9 +48,14 @@ namespace PLEXIL
   class ExecListenerHub;
   class InterfaceManager;
   class PlexilExec;
+  class StateCache;
 
   //! @class ExecApplication
   //! Provides the skeleton of a complete PLEXIL Executive application.
+  //! @note Each instance owns its own exec, state cache, input queue,
+  //!       and worker thread, so several instances may run
+  //!       independently in one process.  Global mutexes are shared
+  //!       by all instances and must not be contended across them.
   class ExecApplication
   {
   public:
@@ -74,6 +80,30 @@ namespace PLEXIL
     //! @param libdirs The vector of directory names.
     virtual void addLibraryPath(const std::vector<std::string>& libdirs) = 0;
 
+    //
+    // Record and replay
+    //
+
+    //! Record the inputs the Exec consumes to a file, for later replay.
+    //! @param filename Name of the recording file; it is overwritten.
+    //! @return true if successful, false otherwise.
+    //! @note Must be called before initialize().
+    virtual bool recordInputs(std::string const &filename) = 0;
+
+    //! Feed the Exec the inputs from a recording instead of from the
+    //! interfaces. Only the Exec listeners in the configuration are
+    //! constructed; adapters and handlers are not.
+    //! @param filename Name of a file written by recordInputs().
+    //! @return true if successful, false otherwise.
+    //! @note Must be called before initialize(). The plans added
+    //!       while recording must be added again.
+    virtual bool replayInputs(std::string const &filename) = 0;
+
+    //! Query whether replay of a recording failed.
+    //! @return true if replaying and the replay failed, false otherwise.
+    //! @see ExecReplayer::failed()
+    virtual bool replayFailed() const = 0;
+
     //
     // Initialization and startup
     //
@@ -158,6 +188,18 @@ namespace PLEXIL
     //!         plans have finished, false otherwise.
     virtual bool allPlansFinished() = 0;
 
+    //
+    // Run time statistics
+    //
+
+    //! Write a report on the expression listener graphs of the
+    //! loaded plans to the stream.
+    //! @param s The stream.
+    //! @param topCount The number of expressions to list in each ranking.
+    //! @see reportExpressionStatistics()
+    virtual void reportExpressionStatistics(std::ostream &s,
+                                            size_t topCount) = 0;
+
     //! Suspend the current thread until the application reaches
     //! APP_STOPPED state.
     //! @note Wait can be interrupted by signal handling; calling
@@ -203,6 +245,7 @@ namespace PLEXIL
     virtual InterfaceManager *manager() = 0;
     virtual ExecListenerHub *listenerHub() = 0;
     virtual PlexilExec *exec() = 0;
+    virtual StateCache *stateCache() = 0;
 
   protected:
 
@@ -93,6 +93,16 @@ namespace PLEXIL
       this->implementNotifyAssignment(dest, destName, value);
   }
 
+  /**
+   * @brief Notify that the Exec has completed a macro step.
+   * @param cycleNum The macro step number.
+   * @note Not subject to filtering.
+   */
+  void ExecListener::notifyOfStepComplete(unsigned int cycleNum) const
+  {
+    this->implementNotifyStepComplete(cycleNum);
+  }
+
   /**
    * @brief Construct the ExecListenerFilter specified by this listener's configuration XML.
    * @return True if successful, false otherwise.
@@ -251,4 +261,12 @@ namespace PLEXIL
   {
   }
 
+  /**
+   * @brief Notify that the Exec has completed a macro step.
+   * @param cycleNum The macro step number.
+   */
+  void ExecListener::implementNotifyStepComplete(unsigned int /* cycleNum */) const
+  {
+  }
+
 }
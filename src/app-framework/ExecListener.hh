@@ -81,6 +81,12 @@ namespace PLEXIL
                             std::string const &destName,
                             Value const &value) const;
 
+    //! Notify that the Exec has completed a macro step, and all
+    //! commands, updates and assignments issued in it have been
+    //! dispatched.
+    //! @param cycleNum The macro step number.
+    void notifyOfStepComplete(unsigned int cycleNum) const;
+
     //
     // API to application
     //
@@ -167,6 +173,10 @@ namespace PLEXIL
                                            std::string const & /* destName */,
                                            Value const & /* value */) const;
 
+    //! Notify that the Exec has completed a macro step.
+    //! @param cycleNum The macro step number.
+    //! @note The default method does nothing.
+    virtual void implementNotifyStepComplete(unsigned int /* cycleNum */) const;
 
     //
     // Shared API made available to derived classes
@@ -138,14 +138,8 @@ namespace PLEXIL
   void ExecListenerFactory::registerFactory(std::string const &name, ExecListenerFactory* factory)
   {
     assertTrue_1(factory);
-    // FIXME: Assert, or replace old factory?
-    if (factoryMap().find(name) != factoryMap().end()) {
-      warn("Attempted to register an exec listener factory for name \""
-           << name.c_str()
-           << "\" twice, ignoring.");
-      delete factory;
-      return;
-    }
+    // Called from the factory's constructor, so it cannot be refused
+    // here. The new factory replaces the old, as for AdapterFactory.
     factoryMap()[name] = ExecListenerFactoryPtr(factory);
     debugMsg("ExecListenerFactory:registerFactory",
              " Registered exec listener factory for name \"" << name.c_str() << "\"");
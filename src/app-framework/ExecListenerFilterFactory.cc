@@ -144,13 +144,9 @@ namespace PLEXIL
                                                   ExecListenerFilterFactory* factory)
   {
     assertTrue_1(factory);
-    if (factoryMap().find(name) != factoryMap().end()) {
-      warn("Attempted to register an exec listener filter factory for name \""
-           << name.c_str()
-           << "\" twice, ignoring.");
-      delete factory;
-      return;
-    }
+    // Called from the factory's constructor, so it cannot be refused
+    // here. Each AdapterConfiguration registers the standard filters
+    // again; the new factory replaces the old, as for AdapterFactory.
     factoryMap()[name] = ExecListenerFilterFactoryPtr(factory);
     debugMsg("ExecListenerFilterFactory:registerFactory",
              " Registered exec listener filter factory for name \"" << name.c_str() << "\"");
@@ -108,6 +108,7 @@ namespace PLEXIL
       listener->notifyOfTransitions(m_transitions);
       for (AssignmentRecord const &assign : m_assignments)
         listener->notifyOfAssignment(assign.dest, assign.destName, assign.value);
+      listener->notifyOfStepComplete(cycleNum);
     }
     m_transitions.clear();
     m_assignments.clear();
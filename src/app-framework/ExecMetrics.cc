@@ -0,0 +1,349 @@
+/* Copyright (c) 2006-2021, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "ExecMetrics.hh"
+
+#include "Command.hh"
+#include "Debug.hh"
+#include "Error.hh"
+#include "LatencyHistogram.hh"
+#include "lifecycle-utils.h"
+
+#include <atomic>
+#include <iomanip> // std::setprecision()
+#include <map>
+#include <memory>
+#include <ostream>
+#include <sstream>
+
+#ifdef PLEXIL_WITH_THREADS
+#include "LocalSocketServer.hh"
+
+#include <mutex>
+#endif
+
+namespace PLEXIL
+{
+
+  //
+  // Metrics storage
+  //
+
+  static std::atomic<bool> s_enabled(false);
+
+  using HistogramMap = std::map<std::string, std::unique_ptr<LatencyHistogram>>;
+
+  struct ExecMetricsData
+  {
+#ifdef PLEXIL_WITH_THREADS
+    std::mutex mutex;
+#endif
+    LatencyHistogram queueWait;
+    LatencyHistogram macroStep;
+    HistogramMap commands;
+    HistogramMap lookups;
+  };
+
+  // Deliberately never deleted, as recording may happen in other
+  // threads during program exit.
+  static ExecMetricsData &metrics()
+  {
+    static ExecMetricsData *sl_data = new ExecMetricsData();
+    return *sl_data;
+  }
+
+#ifdef PLEXIL_WITH_THREADS
+#define GUARD_METRICS(data) std::lock_guard<std::mutex> guard(data.mutex)
+#else
+#define GUARD_METRICS(data)
+#endif
+
+  // Caller must hold the mutex.
+  // Histograms are never deleted, so the result remains valid.
+  static LatencyHistogram *ensureHistogram(HistogramMap &map, std::string const &name)
+  {
+    std::unique_ptr<LatencyHistogram> &entry = map[name];
+    if (!entry)
+      entry.reset(new LatencyHistogram());
+    return entry.get();
+  }
+
+  static uint64_t toMicroseconds(MetricsClock::duration elapsed)
+  {
+    int64_t usec =
+      std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+    return usec > 0 ? (uint64_t) usec : 0;
+  }
+
+  void setExecMetricsEnabled(bool enable)
+  {
+    metrics(); // construct before any recording
+    s_enabled = enable;
+    debugMsg("ExecMetrics", (enable ? " enabled" : " disabled"));
+  }
+
+  bool execMetricsEnabled()
+  {
+    return s_enabled.load(std::memory_order_relaxed);
+  }
+
+  void resetExecMetrics()
+  {
+    ExecMetricsData &data = metrics();
+    GUARD_METRICS(data);
+    data.queueWait.reset();
+    data.macroStep.reset();
+    for (HistogramMap::value_type &entry : data.commands)
+      entry.second->reset();
+    for (HistogramMap::value_type &entry : data.lookups)
+      entry.second->reset();
+  }
+
+  void recordQueueWait(MetricsClock::time_point enqueued)
+  {
+    metrics().queueWait.record(toMicroseconds(MetricsClock::now() - enqueued));
+  }
+
+  void recordMacroStep(MetricsClock::duration elapsed)
+  {
+    metrics().macroStep.record(toMicroseconds(elapsed));
+  }
+
+  void recordLookup(std::string const &stateName, MetricsClock::duration elapsed)
+  {
+    ExecMetricsData &data = metrics();
+    LatencyHistogram *histogram;
+    {
+      GUARD_METRICS(data);
+      histogram = ensureHistogram(data.lookups, stateName);
+    }
+    histogram->record(toMicroseconds(elapsed));
+  }
+
+  // The send time is kept on the command, which clears it when
+  // activated, so nothing is left behind for commands which are
+  // aborted or never acknowledged.
+  void noteCommandSent(Command *cmd)
+  {
+    cmd->setSendTime(MetricsClock::now());
+  }
+
+  void noteCommandAck(Command *cmd)
+  {
+    MetricsClock::time_point now = MetricsClock::now();
+    MetricsClock::time_point sent = cmd->getSendTime();
+    if (sent == MetricsClock::time_point())
+      return;
+    cmd->setSendTime(MetricsClock::time_point());
+    ExecMetricsData &data = metrics();
+    LatencyHistogram *histogram;
+    {
+      GUARD_METRICS(data);
+      histogram = ensureHistogram(data.commands, cmd->getName());
+    }
+    histogram->record(toMicroseconds(now - sent));
+  }
+
+  //
+  // Prometheus text format
+  //
+
+  static double const QUANTILES[] = {0.5, 0.9, 0.99, 0.999, 1.0};
+
+  // Escape a label value per the exposition format.
+  static void writeLabelValue(std::ostream &s, std::string const &value)
+  {
+    s << '"';
+    for (char c : value) {
+      switch (c) {
+      case '\\':
+        s << "\\\\";
+        break;
+      case '"':
+        s << "\\\"";
+        break;
+      case '\n':
+        s << "\\n";
+        break;
+      default:
+        s << c;
+        break;
+      }
+    }
+    s << '"';
+  }
+
+  static void writeFamilyHeader(std::ostream &s, char const *name, char const *help)
+  {
+    s << "# HELP " << name << ' ' << help << '\n'
+      << "# TYPE " << name << " summary\n";
+  }
+
+  // Write one histogram as a summary, optionally labeled.
+  static void writeSummary(std::ostream &s,
+                           char const *name,
+                           LatencyHistogram const &histogram,
+                           char const *label = nullptr,
+                           std::string const &labelValue = std::string())
+  {
+    for (double q : QUANTILES) {
+      s << name << '{';
+      if (label) {
+        s << label << '=';
+        writeLabelValue(s, labelValue);
+        s << ',';
+      }
+      s << "quantile=\"" << q << "\"} "
+        << histogram.valueAtQuantile(q) * 1e-6 << '\n';
+    }
+    s << name << "_sum";
+    if (label) {
+      s << '{' << label << '=';
+      writeLabelValue(s, labelValue);
+      s << '}';
+    }
+    s << ' ' << histogram.sum() * 1e-6 << '\n';
+    s << name << "_count";
+    if (label) {
+      s << '{' << label << '=';
+      writeLabelValue(s, labelValue);
+      s << '}';
+    }
+    s << ' ' << histogram.count() << '\n';
+  }
+
+  void writeExecMetrics(std::ostream &s)
+  {
+    ExecMetricsData &data = metrics();
+    std::streamsize oldPrecision = s.precision(12);
+
+    writeFamilyHeader(s, "plexil_queue_wait_seconds",
+                      "Time from an input queue entry being queued to its processing.");
+    writeSummary(s, "plexil_queue_wait_seconds", data.queueWait);
+
+    writeFamilyHeader(s, "plexil_macro_step_seconds",
+                      "Duration of Exec macro steps.");
+    writeSummary(s, "plexil_macro_step_seconds", data.macroStep);
+
+    GUARD_METRICS(data);
+    if (!data.commands.empty()) {
+      writeFamilyHeader(s, "plexil_command_ack_seconds",
+                        "Time from a command being dispatched to its first handle value.");
+      for (HistogramMap::value_type const &entry : data.commands)
+        writeSummary(s, "plexil_command_ack_seconds", *entry.second,
+                     "command", entry.first);
+    }
+    if (!data.lookups.empty()) {
+      writeFamilyHeader(s, "plexil_lookup_seconds",
+                        "Duration of LookupNow calls on interface handlers.");
+      for (HistogramMap::value_type const &entry : data.lookups)
+        writeSummary(s, "plexil_lookup_seconds", *entry.second,
+                     "state", entry.first);
+    }
+
+    s.precision(oldPrecision);
+  }
+
+#ifdef PLEXIL_WITH_THREADS
+
+  //! Total time a client has to send its request, if any.
+  static constexpr std::chrono::milliseconds METRICS_CLIENT_TIMEOUT(200);
+
+  //! Longest request read from a client.
+  static constexpr size_t MAX_REQUEST_LENGTH = 8192;
+
+  // Read the client's request, if any, then reply with the metrics.
+  static void serveMetricsClient(LocalSocketClient &client)
+  {
+    std::string request;
+    while (request.find("\n\r\n") == std::string::npos
+           && request.find("\n\n") == std::string::npos
+           && request.size() <= MAX_REQUEST_LENGTH) {
+      LocalSocketClient::ReadStatus status = client.read(request);
+      if (status == LocalSocketClient::READ_STOP)
+        return;
+      if (status != LocalSocketClient::READ_OK)
+        break; // no request, or an incomplete one
+    }
+
+    std::ostringstream body;
+    writeExecMetrics(body);
+    std::string reply;
+    if (request.compare(0, 4, "GET ") == 0) {
+      std::ostringstream header;
+      header << "HTTP/1.0 200 OK\r\n"
+             << "Content-Type: text/plain; version=0.0.4\r\n"
+             << "Content-Length: " << body.str().size() << "\r\n"
+             << "Connection: close\r\n\r\n";
+      reply = header.str();
+    }
+    reply += body.str();
+    client.send(reply);
+  }
+
+  static std::unique_ptr<LocalSocketServer> s_listener;
+  static std::mutex s_listenerLock;
+
+  bool startMetricsListener(std::string const &path)
+  {
+    std::lock_guard<std::mutex> guard(s_listenerLock);
+    if (s_listener) {
+      warn("Metrics listener already running");
+      return false;
+    }
+    s_listener.reset(makeLocalSocketServer(path, "Metrics", METRICS_CLIENT_TIMEOUT,
+                                           &serveMetricsClient));
+    if (!s_listener)
+      return false;
+    static bool sl_finalizerAdded = false;
+    if (!sl_finalizerAdded) {
+      plexilAddFinalizer(&stopMetricsListener);
+      sl_finalizerAdded = true;
+    }
+    return true;
+  }
+
+  void stopMetricsListener()
+  {
+    std::lock_guard<std::mutex> guard(s_listenerLock);
+    s_listener.reset();
+  }
+
+#else
+
+  bool startMetricsListener(std::string const &path)
+  {
+    warn("Metrics socket " << path << " not supported without threads");
+    return false;
+  }
+
+  void stopMetricsListener()
+  {
+  }
+
+#endif // PLEXIL_WITH_THREADS
+
+} // namespace PLEXIL
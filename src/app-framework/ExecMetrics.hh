@@ -0,0 +1,118 @@
+/* Copyright (c) 2006-2021, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef PLEXIL_EXEC_METRICS_HH
+#define PLEXIL_EXEC_METRICS_HH
+
+#include "plexil-config.h"
+
+#include <chrono>
+#include <iosfwd>
+#include <string>
+
+//
+// Latency metrics for the Exec and its interfaces.
+//
+// When enabled, the following latencies are recorded in histograms:
+//   - queue wait: from an entry being put on the input queue to its
+//     processing by the Exec;
+//   - macro step: the duration of each PlexilExec::step() call;
+//   - command acknowledgement: from a command being dispatched to
+//     its first command handle value reaching the Exec, by command name;
+//   - lookup: the duration of each LookupNow call on a handler, by
+//     state name.
+//
+// The metrics are shared by all ExecApplication instances in the
+// process. They are written in the Prometheus text exposition format,
+// and may be served on a local socket; see the Metrics adapter.
+//
+
+namespace PLEXIL
+{
+  // Forward reference
+  class Command;
+
+  //! The clock used to measure latencies.
+  using MetricsClock = std::chrono::steady_clock;
+
+  //! Enable or disable collection of metrics.
+  //! @param enable True to enable collection, false to disable.
+  //! @note Collection is disabled by default.
+  extern void setExecMetricsEnabled(bool enable);
+
+  //! Query whether metrics are being collected.
+  //! @return True if enabled, false otherwise.
+  extern bool execMetricsEnabled();
+
+  //! Discard all recorded metrics.
+  extern void resetExecMetrics();
+
+  //! Record the time an input queue entry waited to be processed.
+  //! @param enqueued The time the entry was put on the queue.
+  extern void recordQueueWait(MetricsClock::time_point enqueued);
+
+  //! Record the duration of a macro step.
+  //! @param elapsed The duration.
+  extern void recordMacroStep(MetricsClock::duration elapsed);
+
+  //! Record the duration of a LookupNow call.
+  //! @param stateName The name of the state looked up.
+  //! @param elapsed The duration.
+  extern void recordLookup(std::string const &stateName,
+                           MetricsClock::duration elapsed);
+
+  //! Note that a command is being dispatched to its handler.
+  //! @param cmd The command.
+  //! @note The time is stored on the command, so this and
+  //!       noteCommandAck() must only be called in the Exec thread.
+  extern void noteCommandSent(Command *cmd);
+
+  //! Note that a command handle value for the command has reached the
+  //! Exec. Only the first after noteCommandSent() is recorded.
+  //! @param cmd The command.
+  extern void noteCommandAck(Command *cmd);
+
+  //! Write the metrics in the Prometheus text exposition format.
+  //! @param s The stream.
+  extern void writeExecMetrics(std::ostream &s);
+
+  //! Start a thread serving the metrics on a local (Unix domain)
+  //! stream socket at the given path. A client which sends an HTTP
+  //! request receives an HTTP response; any other client receives
+  //! the metrics text alone. Clients have 200 ms in all to send
+  //! their requests.
+  //! @param path The socket's path in the file system.
+  //! @return True if listening, false otherwise.
+  //! @note A socket left at the path by a listener which has exited
+  //!       is replaced. Fails if anything else is at the path.
+  extern bool startMetricsListener(std::string const &path);
+
+  //! Stop the metrics listener thread, if running, and remove its socket.
+  extern void stopMetricsListener();
+
+} // namespace PLEXIL
+
+#endif // PLEXIL_EXEC_METRICS_HH
@@ -0,0 +1,1376 @@
+/* Copyright (c) 2006-2021, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "ExecRecording.hh"
+
+#include "ArrayImpl.hh"
+#include "CommandImpl.hh"
+#include "commandUtils.hh"
+#include "Debug.hh"
+#include "Dispatcher.hh"
+#include "Error.hh"
+#include "InputQueue.hh"
+#include "LookupReceiver.hh"
+#include "Message.hh"
+#include "NodeImpl.hh"
+#include "QueueEntry.hh"
+#include "State.hh"
+#include "Update.hh"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <vector>
+
+#ifdef PLEXIL_WITH_THREADS
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#endif
+
+#if defined(HAVE_CSTRING)
+#include <cstring>
+#elif defined(HAVE_STRING_H)
+#include <string.h>
+#endif
+
+namespace PLEXIL
+{
+
+  //
+  // Recording file format
+  //
+  // The file begins with the 8 byte header RECORDING_HEADER.
+  // It is followed by a sequence of records, each consisting of a 1 byte
+  // tag, a 4 byte big-endian payload length, and the payload.
+  // Values are serialized as in Value::serialize(), except that an
+  // unknown value is written as the UNKNOWN_TYPE byte followed by its
+  // type. States are the serialized name, a 4 byte parameter count,
+  // and the parameter values.
+  //
+  // Commands, updates, and messages are referenced by the 4 byte
+  // ordinal of the executeCommand() call, executeUpdate() call, or
+  // message received record which introduced them. Plans are
+  // referenced by their node ID.
+  //
+
+  static char const RECORDING_HEADER[] = "PLXRPLY1";
+  static size_t const RECORDING_HEADER_LENGTH = 8;
+
+  // Queue polls and lookups
+  static char const QUEUE_EMPTY_RECORD = 'E';    // isEmpty() returned true
+  static char const BATCH_END_RECORD = 'B';      // get() returned nullptr
+  static char const LOOKUP_NOW_RECORD = 'N';     // state, flag byte, value
+
+  // Dispatcher calls, with any command handle or abort acknowledgement
+  // returned before the call completed (unknown if none)
+  static char const COMMAND_SENT_RECORD = 'C';   // value
+  static char const ABORT_SENT_RECORD = 'Z';     // value
+
+  // Queue entries
+  static char const LOOKUP_RECORD = 'L';         // state, value
+  static char const COMMAND_ACK_RECORD = 'K';    // command ordinal, value
+  static char const COMMAND_RETURN_RECORD = 'R'; // command ordinal, value
+  static char const COMMAND_ABORT_RECORD = 'A';  // command ordinal, value
+  static char const UPDATE_ACK_RECORD = 'U';     // update ordinal, value
+  static char const ADD_PLAN_RECORD = 'P';       // node ID
+  static char const RECEIVE_MSG_RECORD = 'M';    // state, sender, timestamp
+  static char const ACCEPT_MSG_RECORD = 'H';     // message ordinal, handle
+  static char const RELEASE_HANDLE_RECORD = 'X'; // handle
+  static char const MSG_QUEUE_EMPTY_RECORD = 'Q';
+  static char const MARK_RECORD = 'S';           // sequence
+
+  static uint32_t const NO_ORDINAL = 0xFFFFFFFF;
+
+  //
+  // Encoding helpers
+  //
+
+  static void appendLength(uint32_t len, std::vector<char> &buf)
+  {
+    buf.push_back((char) (0xFF & (len >> 24)));
+    buf.push_back((char) (0xFF & (len >> 16)));
+    buf.push_back((char) (0xFF & (len >> 8)));
+    buf.push_back((char) (0xFF & len));
+  }
+
+  static uint32_t getLength(char const *b)
+  {
+    return ((uint32_t) (unsigned char) b[0] << 24)
+      | ((uint32_t) (unsigned char) b[1] << 16)
+      | ((uint32_t) (unsigned char) b[2] << 8)
+      | (uint32_t) (unsigned char) b[3];
+  }
+
+  static void appendString(std::string const &str, std::vector<char> &buf)
+  {
+    size_t offset = buf.size();
+    buf.resize(offset + serialSize(str));
+    serialize(str, buf.data() + offset);
+  }
+
+  static void appendValue(Value const &val, std::vector<char> &buf)
+  {
+    if (!val.isKnown()) {
+      buf.push_back((char) UNKNOWN_TYPE);
+      buf.push_back((char) val.valueType());
+      return;
+    }
+    size_t offset = buf.size();
+    size_t n = serialSize(val);
+    checkError(n, "ExecRecorder: unable to serialize value " << val);
+    buf.resize(offset + n);
+    serialize(val, buf.data() + offset);
+  }
+
+  static void appendState(State const &state, std::vector<char> &buf)
+  {
+    appendString(state.name(), buf);
+    appendLength(state.parameterCount(), buf);
+    for (Value const &param : state.parameters())
+      appendValue(param, buf);
+  }
+
+  //! Decodes one record payload. Every accessor returns false once
+  //! the payload has been found to be malformed.
+  class RecordDecoder final
+  {
+  public:
+    RecordDecoder(std::vector<char> const &payload)
+      : m_ptr(payload.data()),
+        m_end(payload.data() + payload.size())
+    {
+    }
+
+    bool atEnd() const
+    {
+      return m_ptr == m_end;
+    }
+
+    bool getLength(uint32_t &len)
+    {
+      if (!m_ptr || m_end - m_ptr < 4)
+        return fail();
+      len = PLEXIL::getLength(m_ptr);
+      m_ptr += 4;
+      return true;
+    }
+
+    bool getFlag(bool &flag)
+    {
+      if (!m_ptr || m_ptr == m_end)
+        return fail();
+      flag = (*m_ptr++ != 0);
+      return true;
+    }
+
+    bool getString(std::string &str)
+    {
+      Value val;
+      if (!m_ptr || !check(val.deserialize(m_ptr, m_end))
+          || val.valueType() != STRING_TYPE)
+        return fail();
+      val.getValue(str);
+      return true;
+    }
+
+    bool getValue(Value &val)
+    {
+      if (!m_ptr || m_ptr == m_end)
+        return fail();
+      if ((ValueType) *m_ptr == UNKNOWN_TYPE) {
+        if (m_end - m_ptr < 2)
+          return fail();
+        ValueType typ = (ValueType) m_ptr[1];
+        if (typ != UNKNOWN_TYPE && !isUserType(typ) && !isInternalType(typ))
+          return fail();
+        val = Value(0, typ);
+        m_ptr += 2;
+        return true;
+      }
+      return check(val.deserialize(m_ptr, m_end));
+    }
+
+    bool getState(State &state)
+    {
+      std::string name;
+      uint32_t n;
+      if (!getString(name) || !getLength(n) || n > (size_t) (m_end - m_ptr))
+        return fail();
+      state = State(name, n);
+      Value param;
+      for (uint32_t i = 0; i < n; ++i) {
+        if (!getValue(param))
+          return false;
+        state.setParameter(i, param);
+      }
+      return true;
+    }
+
+  private:
+    bool check(char const *next)
+    {
+      if (!next || next > m_end)
+        return fail();
+      m_ptr = next;
+      return true;
+    }
+
+    bool fail()
+    {
+      m_ptr = nullptr;
+      return false;
+    }
+
+    char const *m_ptr;
+    char const *m_end;
+  };
+
+  //
+  // Recording
+  //
+
+  //! Records the value returned by a lookup, on its way to the
+  //! receiver supplied by the Exec.
+  class RecordingReceiver final : public LookupReceiver
+  {
+  public:
+    RecordingReceiver(LookupReceiver *rcvr)
+      : m_receiver(rcvr),
+        m_value(),
+        m_updated(false)
+    {
+    }
+
+    virtual ~RecordingReceiver() = default;
+
+    bool updated() const
+    {
+      return m_updated;
+    }
+
+    Value const &value() const
+    {
+      return m_value;
+    }
+
+    virtual void update(Value const &val)
+    {
+      record(val);
+      m_receiver->update(val);
+    }
+
+    virtual void setUnknown()
+    {
+      record(Value());
+      m_receiver->setUnknown();
+    }
+
+    virtual void update(Boolean val)
+    {
+      record(Value(val));
+      m_receiver->update(val);
+    }
+
+    virtual void update(Integer val)
+    {
+      record(Value(val));
+      m_receiver->update(val);
+    }
+
+    virtual void update(Real val)
+    {
+      record(Value(val));
+      m_receiver->update(val);
+    }
+
+    virtual void update(String const &val)
+    {
+      record(Value(val));
+      m_receiver->update(val);
+    }
+
+    virtual void update(char const *val)
+    {
+      record(Value(val));
+      m_receiver->update(val);
+    }
+
+    virtual void update(Boolean const ary[], size_t size)
+    {
+      record(Value(BooleanArray(std::vector<Boolean>(ary, ary + size))));
+      m_receiver->update(ary, size);
+    }
+
+    virtual void update(Integer const ary[], size_t size)
+    {
+      record(Value(IntegerArray(std::vector<Integer>(ary, ary + size))));
+      m_receiver->update(ary, size);
+    }
+
+    virtual void update(Real const ary[], size_t size)
+    {
+      record(Value(RealArray(std::vector<Real>(ary, ary + size))));
+      m_receiver->update(ary, size);
+    }
+
+    virtual void update(String const ary[], size_t size)
+    {
+      record(Value(StringArray(std::vector<String>(ary, ary + size))));
+      m_receiver->update(ary, size);
+    }
+
+    virtual LookupHandler *getLookupHandler(unsigned int generation) const
+    {
+      return m_receiver->getLookupHandler(generation);
+    }
+
+    virtual void setLookupHandler(LookupHandler *handler, unsigned int generation)
+    {
+      m_receiver->setLookupHandler(handler, generation);
+    }
+
+  private:
+    void record(Value &&val)
+    {
+      m_value = std::move(val);
+      m_updated = true;
+    }
+
+    void record(Value const &val)
+    {
+      m_value = val;
+      m_updated = true;
+    }
+
+    LookupReceiver *m_receiver;
+    Value m_value;
+    bool m_updated;
+  };
+
+  class ExecRecorderImpl;
+
+  //! Records each entry as the Exec takes it from the wrapped queue.
+  class RecordingInputQueue final : public InputQueue
+  {
+  public:
+    RecordingInputQueue(ExecRecorderImpl *recorder, InputQueue *queue)
+      : InputQueue(),
+        m_recorder(recorder),
+        m_queue(queue)
+    {
+    }
+
+    virtual ~RecordingInputQueue() = default;
+
+    virtual bool isEmpty() const;
+    virtual QueueEntry *get();
+
+    virtual void flush()
+    {
+      m_queue->flush();
+    }
+
+    virtual void release(QueueEntry *entry)
+    {
+      m_queue->release(entry);
+    }
+
+    virtual QueueEntry *allocate()
+    {
+      return m_queue->allocate();
+    }
+
+    virtual void put(QueueEntry *entry)
+    {
+      m_queue->put(entry);
+    }
+
+  private:
+    ExecRecorderImpl *m_recorder;
+    std::unique_ptr<InputQueue> m_queue;
+  };
+
+  class ExecRecorderImpl final :
+    public ExecRecorder,
+    public Dispatcher
+  {
+  public:
+    ExecRecorderImpl(Dispatcher *dispatcher)
+      : ExecRecorder(),
+        Dispatcher(),
+        m_stream(),
+#ifdef PLEXIL_WITH_THREADS
+        m_mutex(),
+#endif
+        m_dispatcher(dispatcher),
+        m_nextCommand(0),
+        m_nextUpdate(0),
+        m_nextMessage(0)
+    {
+    }
+
+    virtual ~ExecRecorderImpl() = default;
+
+    bool open(std::string const &filename)
+    {
+      m_stream.open(filename.c_str(),
+                    std::ios::out | std::ios::binary | std::ios::trunc);
+      if (!m_stream.is_open())
+        return false;
+      m_stream.write(RECORDING_HEADER, RECORDING_HEADER_LENGTH);
+      return m_stream.good();
+    }
+
+    //
+    // ExecRecorder API
+    //
+
+    virtual InputQueue *wrapInputQueue(InputQueue *queue)
+    {
+      return new RecordingInputQueue(this, queue);
+    }
+
+    virtual Dispatcher *dispatcher()
+    {
+      return this;
+    }
+
+    //
+    // Dispatcher API
+    //
+
+    virtual void lookupNow(State const &state, LookupReceiver *rcvr)
+    {
+      RecordingReceiver recorder(rcvr);
+      m_dispatcher->lookupNow(state, &recorder);
+      Lock lock(*this);
+      appendState(state, m_payload);
+      m_payload.push_back((char) recorder.updated());
+      if (recorder.updated())
+        appendValue(recorder.value(), m_payload);
+      write(LOOKUP_NOW_RECORD);
+    }
+
+    virtual void setThresholds(const State& state, Real hi, Real lo)
+    {
+      m_dispatcher->setThresholds(state, hi, lo);
+    }
+
+    virtual void setThresholds(const State& state, Integer hi, Integer lo)
+    {
+      m_dispatcher->setThresholds(state, hi, lo);
+    }
+
+    virtual void clearThresholds(const State& state)
+    {
+      m_dispatcher->clearThresholds(state);
+    }
+
+    virtual void executeCommand(Command *cmd)
+    {
+      {
+        Lock lock(*this);
+        m_commands[cmd] = m_nextCommand++;
+      }
+      CommandImpl *impl = dynamic_cast<CommandImpl *>(cmd);
+      assertTrue_1(impl);
+      CommandHandleValue before = impl->getCommandHandle();
+      m_dispatcher->executeCommand(cmd);
+      CommandHandleValue after = impl->getCommandHandle();
+
+      Lock lock(*this);
+      if (after != before)
+        appendValue(Value(after), m_payload);
+      else
+        appendValue(Value(0, COMMAND_HANDLE_TYPE), m_payload);
+      write(COMMAND_SENT_RECORD);
+    }
+
+    virtual void reportCommandArbitrationFailure(Command *cmd)
+    {
+      m_dispatcher->reportCommandArbitrationFailure(cmd);
+    }
+
+    virtual void invokeAbort(Command *cmd)
+    {
+      CommandImpl *impl = dynamic_cast<CommandImpl *>(cmd);
+      assertTrue_1(impl);
+      Boolean before = false;
+      bool wasKnown = impl->getAbortComplete()->getValue(before);
+      m_dispatcher->invokeAbort(cmd);
+      Boolean after = false;
+      bool isKnown = impl->getAbortComplete()->getValue(after);
+
+      Lock lock(*this);
+      if (isKnown && (!wasKnown || after != before))
+        appendValue(Value(after), m_payload);
+      else
+        appendValue(Value(0, BOOLEAN_TYPE), m_payload);
+      write(ABORT_SENT_RECORD);
+    }
+
+    virtual void executeUpdate(Update *upd)
+    {
+      {
+        Lock lock(*this);
+        m_updates[upd] = m_nextUpdate++;
+      }
+      m_dispatcher->executeUpdate(upd);
+    }
+
+    //
+    // Called by RecordingInputQueue
+    //
+
+    void recordEmpty()
+    {
+      Lock lock(*this);
+      write(QUEUE_EMPTY_RECORD);
+    }
+
+    void recordEntry(QueueEntry const *entry)
+    {
+      Lock lock(*this);
+      if (!entry) {
+        write(BATCH_END_RECORD);
+        return;
+      }
+
+      switch (entry->type) {
+      case Q_LOOKUP:
+        appendState(*entry->state, m_payload);
+        appendValue(entry->value, m_payload);
+        write(LOOKUP_RECORD);
+        break;
+
+      case Q_COMMAND_ACK:
+        appendLength(ordinal(m_commands, entry->command), m_payload);
+        appendValue(entry->value, m_payload);
+        write(COMMAND_ACK_RECORD);
+        break;
+
+      case Q_COMMAND_RETURN:
+        appendLength(ordinal(m_commands, entry->command), m_payload);
+        appendValue(entry->value, m_payload);
+        write(COMMAND_RETURN_RECORD);
+        break;
+
+      case Q_COMMAND_ABORT:
+        appendLength(ordinal(m_commands, entry->command), m_payload);
+        appendValue(entry->value, m_payload);
+        write(COMMAND_ABORT_RECORD);
+        break;
+
+      case Q_UPDATE_ACK:
+        appendLength(ordinal(m_updates, entry->update), m_payload);
+        appendValue(entry->value, m_payload);
+        write(UPDATE_ACK_RECORD);
+        break;
+
+      case Q_ADD_PLAN:
+        appendString(entry->plan->getNodeId(), m_payload);
+        write(ADD_PLAN_RECORD);
+        break;
+
+      case Q_RECEIVE_MSG:
+        m_messages[entry->message] = m_nextMessage++;
+        appendState(entry->message->message, m_payload);
+        appendString(entry->message->sender, m_payload);
+        appendValue(Value(entry->message->timestamp), m_payload);
+        write(RECEIVE_MSG_RECORD);
+        break;
+
+      case Q_ACCEPT_MSG:
+        appendLength(ordinal(m_messages, entry->message), m_payload);
+        appendValue(entry->value, m_payload);
+        write(ACCEPT_MSG_RECORD);
+        break;
+
+      case Q_RELEASE_MSG_HANDLE:
+        appendValue(entry->value, m_payload);
+        write(RELEASE_HANDLE_RECORD);
+        break;
+
+      case Q_MSG_QUEUE_EMPTY:
+        write(MSG_QUEUE_EMPTY_RECORD);
+        break;
+
+      case Q_MARK:
+        appendLength(entry->sequence, m_payload);
+        write(MARK_RECORD);
+        break;
+
+      default:
+        warn("ExecRecorder: not recording queue entry of invalid type "
+             << entry->type);
+        break;
+      }
+    }
+
+  private:
+
+    //! Serializes writers from all threads.
+    class Lock final
+    {
+    public:
+      Lock(ExecRecorderImpl &recorder)
+#ifdef PLEXIL_WITH_THREADS
+        : m_guard(recorder.m_mutex)
+#endif
+      {
+      }
+
+    private:
+#ifdef PLEXIL_WITH_THREADS
+      std::lock_guard<std::mutex> m_guard;
+#endif
+    };
+
+    template <typename T>
+    static uint32_t ordinal(std::map<T *, uint32_t> const &ordinals, T *item)
+    {
+      typename std::map<T *, uint32_t>::const_iterator it = ordinals.find(item);
+      if (it == ordinals.end())
+        return NO_ORDINAL;
+      return it->second;
+    }
+
+    // Write a record with the accumulated payload, and clear it.
+    // Caller must hold the lock.
+    void write(char tag)
+    {
+      char prefix[5];
+      prefix[0] = tag;
+      prefix[1] = (char) (0xFF & (m_payload.size() >> 24));
+      prefix[2] = (char) (0xFF & (m_payload.size() >> 16));
+      prefix[3] = (char) (0xFF & (m_payload.size() >> 8));
+      prefix[4] = (char) (0xFF & m_payload.size());
+      m_stream.write(prefix, sizeof(prefix));
+      m_stream.write(m_payload.data(), m_payload.size());
+      m_payload.clear();
+    }
+
+    std::ofstream m_stream;
+    std::vector<char> m_payload;
+#ifdef PLEXIL_WITH_THREADS
+    std::mutex m_mutex;
+#endif
+    std::map<Command *, uint32_t> m_commands;
+    std::map<Update *, uint32_t> m_updates;
+    std::map<Message *, uint32_t> m_messages;
+    Dispatcher *m_dispatcher;
+    uint32_t m_nextCommand;
+    uint32_t m_nextUpdate;
+    uint32_t m_nextMessage;
+  };
+
+  bool RecordingInputQueue::isEmpty() const
+  {
+    if (!m_queue->isEmpty())
+      return false;
+    m_recorder->recordEmpty();
+    return true;
+  }
+
+  QueueEntry *RecordingInputQueue::get()
+  {
+    QueueEntry *entry = m_queue->get();
+    m_recorder->recordEntry(entry);
+    return entry;
+  }
+
+  ExecRecorder *makeExecRecorder(std::string const &filename,
+                                 Dispatcher *dispatcher)
+  {
+    std::unique_ptr<ExecRecorderImpl> result(new ExecRecorderImpl(dispatcher));
+    if (!result->open(filename)) {
+      warn("ExecRecorder: unable to open " << filename << " for writing");
+      return nullptr;
+    }
+    return result.release();
+  }
+
+
+  //
+  // Replay
+  //
+
+  // How long to wait for the application to supply a plan the recording adds
+  static unsigned int const PLAN_WAIT_SECONDS = 10;
+
+  class ExecReplayerImpl;
+
+  //! Hands the recorded queue entries to the Exec.
+  class ReplayInputQueue final : public InputQueue
+  {
+  public:
+    ReplayInputQueue(ExecReplayerImpl *replayer)
+      : InputQueue(),
+        m_replayer(replayer)
+    {
+    }
+
+    virtual ~ReplayInputQueue() = default;
+
+    virtual bool isEmpty() const;
+    virtual QueueEntry *get();
+    virtual void flush();
+    virtual void release(QueueEntry *entry);
+    virtual QueueEntry *allocate();
+    virtual void put(QueueEntry *entry);
+
+  private:
+    ExecReplayerImpl *m_replayer;
+  };
+
+  class ExecReplayerImpl final :
+    public ExecReplayer,
+    public Dispatcher
+  {
+  public:
+    ExecReplayerImpl()
+      : ExecReplayer(),
+        Dispatcher(),
+        m_stream(),
+        m_filename(),
+        m_payload(),
+#ifdef PLEXIL_WITH_THREADS
+        m_mutex(),
+        m_planAdded(),
+#endif
+        m_liveMark(0),
+        m_replayedMark(0),
+        m_fileSize(0),
+        m_tag(0),
+        m_started(false),
+        m_finished(false),
+        m_failed(false)
+    {
+    }
+
+    virtual ~ExecReplayerImpl()
+    {
+      for (QueueEntry *entry : m_freeList)
+        delete entry;
+      for (QueueEntry *entry : m_plans) {
+        delete entry->plan;
+        delete entry;
+      }
+    }
+
+    bool open(std::string const &filename)
+    {
+      m_filename = filename;
+      m_stream.open(filename.c_str(), std::ios::in | std::ios::binary);
+      if (!m_stream.is_open())
+        return false;
+      m_stream.seekg(0, std::ios::end);
+      m_fileSize = m_stream.tellg();
+      m_stream.seekg(0);
+      char header[RECORDING_HEADER_LENGTH];
+      return m_stream.read(header, RECORDING_HEADER_LENGTH)
+        && !memcmp(header, RECORDING_HEADER, RECORDING_HEADER_LENGTH);
+    }
+
+    //
+    // ExecReplayer API
+    //
+
+    virtual InputQueue *makeInputQueue()
+    {
+      return new ReplayInputQueue(this);
+    }
+
+    virtual Dispatcher *dispatcher()
+    {
+      return this;
+    }
+
+    virtual bool finished() const
+    {
+      return m_finished;
+    }
+
+    virtual bool failed() const
+    {
+#ifdef PLEXIL_WITH_THREADS
+      std::lock_guard<std::mutex> guard(m_mutex);
+#endif
+      return m_failed;
+    }
+
+    //
+    // Dispatcher API
+    //
+
+    virtual void lookupNow(State const &state, LookupReceiver *rcvr)
+    {
+      if (!expect(LOOKUP_NOW_RECORD)) {
+        rcvr->setUnknown();
+        return;
+      }
+      RecordDecoder decoder(m_payload);
+      State recorded;
+      bool updated = false;
+      Value value;
+      if (!decoder.getState(recorded)
+          || !decoder.getFlag(updated)
+          || (updated && !decoder.getValue(value))
+          || !decoder.atEnd()) {
+        malformed();
+        rcvr->setUnknown();
+        return;
+      }
+      if (!(recorded == state)) {
+        warn("ExecReplayer: Exec diverged from recording " << m_filename
+             << ": looked up " << state << ", recording has " << recorded
+             << "; stopping replay");
+        fail();
+        rcvr->setUnknown();
+        return;
+      }
+      debugMsg("ExecReplayer:lookupNow",
+               ' ' << state << " = " << (updated ? value : Value("(no update)")));
+      if (!updated)
+        return;
+      if (value.isKnown())
+        rcvr->update(value);
+      else
+        rcvr->setUnknown();
+    }
+
+    virtual void setThresholds(const State& /* state */, Real /* hi */, Real /* lo */)
+    {
+    }
+
+    virtual void setThresholds(const State& /* state */, Integer /* hi */, Integer /* lo */)
+    {
+    }
+
+    virtual void clearThresholds(const State& /* state */)
+    {
+    }
+
+    virtual void executeCommand(Command *cmd)
+    {
+      debugMsg("ExecReplayer:executeCommand",
+               " #" << m_commands.size() << ' ' << cmd->getCommand());
+      m_commands.push_back(cmd);
+      Value handle;
+      CommandHandleValue handleValue = NO_COMMAND_HANDLE;
+      if (readDispatchRecord(COMMAND_SENT_RECORD, handle)
+          && handle.getValue(handleValue))
+        commandHandleReturn(cmd, handleValue);
+    }
+
+    virtual void reportCommandArbitrationFailure(Command *cmd)
+    {
+      commandHandleReturn(cmd, COMMAND_DENIED);
+    }
+
+    virtual void invokeAbort(Command *cmd)
+    {
+      Value ack;
+      Boolean ackValue = false;
+      if (readDispatchRecord(ABORT_SENT_RECORD, ack) && ack.getValue(ackValue))
+        commandAbortAcknowledge(cmd, ackValue);
+    }
+
+    virtual void executeUpdate(Update *upd)
+    {
+      debugMsg("ExecReplayer:executeUpdate", " #" << m_updates.size());
+      m_updates.push_back(upd);
+    }
+
+    //
+    // Called by ReplayInputQueue
+    //
+
+    bool pollEmpty()
+    {
+      if (!peek())
+        return !markPending();
+      if (m_tag != QUEUE_EMPTY_RECORD)
+        return false;
+      m_tag = 0;
+      return true;
+    }
+
+    QueueEntry *nextEntry()
+    {
+      if (m_finished)
+        return pendingMark();
+      while (peek()) {
+        char tag = m_tag;
+        m_tag = 0;
+        if (tag == BATCH_END_RECORD)
+          return nullptr;
+        if (tag == QUEUE_EMPTY_RECORD || tag == LOOKUP_NOW_RECORD
+            || tag == COMMAND_SENT_RECORD || tag == ABORT_SENT_RECORD) {
+          warn("ExecReplayer: Exec diverged from recording " << m_filename
+               << ": found record '" << tag << "' while reading the queue"
+               << "; stopping replay");
+          fail();
+          return nullptr;
+        }
+        QueueEntry *entry = decodeEntry(tag);
+        if (entry)
+          return entry;
+      }
+      return nullptr;
+    }
+
+    QueueEntry *allocate()
+    {
+#ifdef PLEXIL_WITH_THREADS
+      std::lock_guard<std::mutex> guard(m_mutex);
+#endif
+      if (m_freeList.empty())
+        return new QueueEntry;
+      QueueEntry *result = m_freeList.back();
+      m_freeList.pop_back();
+      return result;
+    }
+
+    void release(QueueEntry *entry)
+    {
+      assertTrue_1(entry);
+      entry->reset();
+#ifdef PLEXIL_WITH_THREADS
+      std::lock_guard<std::mutex> guard(m_mutex);
+#endif
+      m_freeList.push_back(entry);
+    }
+
+    // Plans are held until the recording adds them; once replay has
+    // finished, they are discarded and the replay fails.
+    // Marks are noted, so that anyone waiting on one is released when
+    // the replay finishes.
+    // Everything else came from the outside world, and is discarded.
+    void put(QueueEntry *entry)
+    {
+      assertTrue_1(entry);
+      if (entry->type == Q_MARK) {
+        {
+#ifdef PLEXIL_WITH_THREADS
+          std::lock_guard<std::mutex> guard(m_mutex);
+#endif
+          if (entry->sequence > m_liveMark)
+            m_liveMark = entry->sequence;
+        }
+        release(entry);
+        return;
+      }
+      if (entry->type != Q_ADD_PLAN) {
+        debugMsg("ExecReplayer:put", " discarding entry of type " << entry->type);
+        release(entry);
+        return;
+      }
+      {
+#ifdef PLEXIL_WITH_THREADS
+        std::lock_guard<std::mutex> guard(m_mutex);
+#endif
+        if (!m_finished) {
+          debugMsg("ExecReplayer:put", " holding plan " << entry->plan->getNodeId());
+          m_plans.push_back(entry);
+#ifdef PLEXIL_WITH_THREADS
+          m_planAdded.notify_all();
+#endif
+          return;
+        }
+        warn("ExecReplayer: replay of " << m_filename << " has finished; plan "
+             << entry->plan->getNodeId() << " is not added by it");
+        m_failed = true;
+      }
+      delete entry->plan;
+      release(entry);
+    }
+
+  private:
+
+    // Read the next record into m_tag and m_payload, unless one has
+    // already been read and not consumed.
+    bool peek()
+    {
+      if (m_finished)
+        return false;
+      if (m_tag)
+        return true;
+      char prefix[5];
+      if (!m_stream.read(prefix, sizeof(prefix))) {
+        if (m_stream.gcount()) {
+          warn("ExecReplayer: recording " << m_filename << " is truncated");
+          fail();
+        }
+        else if (!m_started) {
+          warn("ExecReplayer: recording " << m_filename
+               << " ends before the first Exec step");
+          fail();
+        }
+        else
+          finish();
+        return false;
+      }
+      // Don't allocate for a length the file can't hold
+      uint32_t len = getLength(prefix + 1);
+      if ((std::streamoff) len > m_fileSize - m_stream.tellg()) {
+        warn("ExecReplayer: record length " << len << " exceeds the size of recording "
+             << m_filename);
+        fail();
+        return false;
+      }
+      m_payload.resize(len);
+      if (!m_stream.read(m_payload.data(), m_payload.size())) {
+        warn("ExecReplayer: recording " << m_filename << " is truncated");
+        fail();
+        return false;
+      }
+      m_tag = prefix[0];
+      m_started = true;
+      return true;
+    }
+
+    // Consume the next record, which must have the given tag.
+    bool expect(char tag)
+    {
+      if (!peek())
+        return false;
+      if (m_tag != tag) {
+        warn("ExecReplayer: Exec diverged from recording " << m_filename
+             << ": expected record '" << tag << "', found '" << m_tag
+             << "'; stopping replay");
+        fail();
+        return false;
+      }
+      m_tag = 0;
+      return true;
+    }
+
+    // Once replay is finished, marks put by the application must be
+    // processed normally.
+    bool markPending()
+    {
+#ifdef PLEXIL_WITH_THREADS
+      std::lock_guard<std::mutex> guard(m_mutex);
+#endif
+      return m_liveMark > m_replayedMark;
+    }
+
+    QueueEntry *pendingMark()
+    {
+      if (!markPending())
+        return nullptr;
+      QueueEntry *entry = allocate();
+#ifdef PLEXIL_WITH_THREADS
+      std::lock_guard<std::mutex> guard(m_mutex);
+#endif
+      entry->initForMark(m_liveMark);
+      m_replayedMark = m_liveMark;
+      return entry;
+    }
+
+    // Consume the record for a dispatcher call, and get its value.
+    bool readDispatchRecord(char tag, Value &value)
+    {
+      if (!expect(tag))
+        return false;
+      RecordDecoder decoder(m_payload);
+      if (!decoder.getValue(value) || !decoder.atEnd()) {
+        malformed();
+        return false;
+      }
+      return true;
+    }
+
+    void malformed()
+    {
+      warn("ExecReplayer: invalid record in recording " << m_filename
+           << "; stopping replay");
+      fail();
+    }
+
+    // Stop replay because the recording is unusable or doesn't match
+    // what the Exec and the application are doing.
+    void fail()
+    {
+      {
+#ifdef PLEXIL_WITH_THREADS
+        std::lock_guard<std::mutex> guard(m_mutex);
+#endif
+        m_failed = true;
+      }
+      finish();
+    }
+
+    // Stop replay. Any plan the application supplied which the
+    // recording didn't add will never be run.
+    void finish()
+    {
+#ifdef PLEXIL_WITH_THREADS
+      std::lock_guard<std::mutex> guard(m_mutex);
+#endif
+      if (m_finished)
+        return;
+      debugMsg("ExecReplayer", " replay of " << m_filename << " finished");
+      m_finished = true;
+      for (QueueEntry const *entry : m_plans) {
+        warn("ExecReplayer: plan " << entry->plan->getNodeId()
+             << " is not added by recording " << m_filename);
+        m_failed = true;
+      }
+    }
+
+    template <typename T>
+    static auto byOrdinal(std::vector<T> const &items, uint32_t n)
+      -> decltype(&*items[n])
+    {
+      if (n >= items.size())
+        return nullptr;
+      return &*items[n];
+    }
+
+    // Construct the queue entry for the record just consumed.
+    // Returns nullptr if the record refers to something the Exec did not
+    // create in this run, or if replay has stopped.
+    QueueEntry *decodeEntry(char tag)
+    {
+      RecordDecoder decoder(m_payload);
+      QueueEntry *entry = nullptr;
+      uint32_t n = 0;
+      Value value;
+      bool ok = true;
+
+      switch (tag) {
+      case LOOKUP_RECORD: {
+        State state;
+        if ((ok = decoder.getState(state) && decoder.getValue(value))) {
+          entry = allocate();
+          entry->initForLookup(std::move(state), std::move(value));
+        }
+        break;
+      }
+
+      case COMMAND_ACK_RECORD:
+      case COMMAND_RETURN_RECORD:
+      case COMMAND_ABORT_RECORD: {
+        if (!(ok = decoder.getLength(n) && decoder.getValue(value)))
+          break;
+        Command *cmd = byOrdinal(m_commands, n);
+        if (!cmd) {
+          debugMsg("ExecReplayer", " skipping record '" << tag
+                   << "' for unknown command #" << n);
+          break;
+        }
+        entry = allocate();
+        if (tag == COMMAND_RETURN_RECORD)
+          entry->initForCommandReturn(cmd, std::move(value));
+        else {
+          entry->command = cmd;
+          entry->value = std::move(value);
+          entry->type = (tag == COMMAND_ACK_RECORD) ? Q_COMMAND_ACK : Q_COMMAND_ABORT;
+        }
+        break;
+      }
+
+      case UPDATE_ACK_RECORD: {
+        if (!(ok = decoder.getLength(n) && decoder.getValue(value)))
+          break;
+        Update *upd = byOrdinal(m_updates, n);
+        if (!upd) {
+          debugMsg("ExecReplayer", " skipping ack for unknown update #" << n);
+          break;
+        }
+        entry = allocate();
+        entry->update = upd;
+        entry->value = std::move(value);
+        entry->type = Q_UPDATE_ACK;
+        break;
+      }
+
+      case ADD_PLAN_RECORD: {
+        std::string nodeId;
+        if ((ok = decoder.getString(nodeId)) && !(entry = waitForPlan(nodeId))) {
+          warn("ExecReplayer: plan " << nodeId << " in recording " << m_filename
+               << " was not supplied; stopping replay");
+          fail();
+        }
+        break;
+      }
+
+      case RECEIVE_MSG_RECORD: {
+        State msg;
+        std::string sender;
+        Real timestamp = 0;
+        if (!(ok = decoder.getState(msg) && decoder.getString(sender)
+              && decoder.getValue(value) && value.getValue(timestamp)))
+          break;
+        m_messages.emplace_back(new Message(msg, sender, timestamp));
+        entry = allocate();
+        entry->initForReceiveMessage(m_messages.back().get());
+        break;
+      }
+
+      case ACCEPT_MSG_RECORD: {
+        if (!(ok = decoder.getLength(n) && decoder.getValue(value)))
+          break;
+        Message *msg = byOrdinal(m_messages, n);
+        if (!msg) {
+          debugMsg("ExecReplayer", " skipping accept for unknown message #" << n);
+          break;
+        }
+        entry = allocate();
+        entry->message = msg;
+        entry->value = std::move(value);
+        entry->type = Q_ACCEPT_MSG;
+        break;
+      }
+
+      case RELEASE_HANDLE_RECORD:
+        if ((ok = decoder.getValue(value))) {
+          entry = allocate();
+          entry->value = std::move(value);
+          entry->type = Q_RELEASE_MSG_HANDLE;
+        }
+        break;
+
+      case MSG_QUEUE_EMPTY_RECORD:
+        entry = allocate();
+        entry->initForMessageQueueEmpty();
+        break;
+
+      case MARK_RECORD:
+        if ((ok = decoder.getLength(n))) {
+          entry = allocate();
+          entry->initForMark(n);
+          m_replayedMark = n;
+        }
+        break;
+
+      default:
+        ok = false;
+        break;
+      }
+
+      if (!ok || !decoder.atEnd()) {
+        if (entry)
+          release(entry);
+        malformed();
+        return nullptr;
+      }
+      return entry;
+    }
+
+    // Get the held entry for the named plan, waiting for the
+    // application to add it if necessary.
+    QueueEntry *waitForPlan(std::string const &nodeId)
+    {
+      std::vector<QueueEntry *>::iterator it;
+      auto found =
+        [this, &it, &nodeId]() -> bool
+        {
+          it = std::find_if(m_plans.begin(), m_plans.end(),
+                            [&nodeId](QueueEntry const *e) -> bool
+                            { return e->plan->getNodeId() == nodeId; });
+          return it != m_plans.end();
+        };
+
+#ifdef PLEXIL_WITH_THREADS
+      std::unique_lock<std::mutex> lock(m_mutex);
+      if (!m_planAdded.wait_for(lock, std::chrono::seconds(PLAN_WAIT_SECONDS), found))
+        return nullptr;
+#else
+      if (!found())
+        return nullptr;
+#endif
+      QueueEntry *result = *it;
+      m_plans.erase(it);
+      return result;
+    }
+
+    std::ifstream m_stream;
+    std::string m_filename;
+    std::vector<char> m_payload;
+    std::vector<Command *> m_commands;
+    std::vector<Update *> m_updates;
+    std::vector<std::unique_ptr<Message>> m_messages;
+    std::vector<QueueEntry *> m_freeList;
+    std::vector<QueueEntry *> m_plans;
+#ifdef PLEXIL_WITH_THREADS
+    mutable std::mutex m_mutex;
+    std::condition_variable m_planAdded;
+#endif
+    unsigned int m_liveMark;     // highest mark put by the application
+    unsigned int m_replayedMark; // highest mark given to the Exec
+    std::streamoff m_fileSize;
+    char m_tag; // tag of the record in m_payload, 0 if consumed
+    bool m_started;  // at least one record has been read
+    bool m_finished;
+    bool m_failed;
+  };
+
+  bool ReplayInputQueue::isEmpty() const
+  {
+    return m_replayer->pollEmpty();
+  }
+
+  QueueEntry *ReplayInputQueue::get()
+  {
+    return m_replayer->nextEntry();
+  }
+
+  // Nothing is queued here; held plans are the application's to supply.
+  void ReplayInputQueue::flush()
+  {
+  }
+
+  void ReplayInputQueue::release(QueueEntry *entry)
+  {
+    m_replayer->release(entry);
+  }
+
+  QueueEntry *ReplayInputQueue::allocate()
+  {
+    return m_replayer->allocate();
+  }
+
+  void ReplayInputQueue::put(QueueEntry *entry)
+  {
+    m_replayer->put(entry);
+  }
+
+  ExecReplayer *makeExecReplayer(std::string const &filename)
+  {
+    std::unique_ptr<ExecReplayerImpl> result(new ExecReplayerImpl());
+    if (!result->open(filename)) {
+      warn("ExecReplayer: " << filename << " is not a readable Exec recording");
+      return nullptr;
+    }
+    return result.release();
+  }
+
+} // namespace PLEXIL
@@ -0,0 +1,113 @@
+/* Copyright (c) 2006-2021, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef PLEXIL_EXEC_RECORDING_HH
+#define PLEXIL_EXEC_RECORDING_HH
+
+#include <string>
+
+//
+// Record and replay of the inputs consumed by the Exec
+//
+
+// A recording captures, in the order the Exec consumed them, every
+// entry taken from the input queue and every result returned by an
+// immediate lookup (including the 'time' lookups used to step the
+// Exec), plus the boundaries of each pass through the queue.
+// Replaying the recording feeds the same inputs to the Exec in the
+// same order without any interface adapters, as fast as the Exec
+// can process them.
+
+namespace PLEXIL
+{
+
+  // Forward references
+  class Dispatcher;
+  class InputQueue;
+
+  //! @class ExecRecorder
+  //! Writes the inputs consumed by the Exec to a binary log file.
+  class ExecRecorder
+  {
+  public:
+    virtual ~ExecRecorder() = default;
+
+    //! Wrap an input queue so that the entries the Exec takes from it
+    //! are recorded.
+    //! @param queue The queue to wrap. The wrapper takes ownership.
+    //! @return The wrapper. The caller takes ownership.
+    virtual InputQueue *wrapInputQueue(InputQueue *queue) = 0;
+
+    //! Get the dispatcher the Exec should use while recording. It
+    //! records lookup results and forwards everything to the
+    //! dispatcher given to makeExecRecorder().
+    virtual Dispatcher *dispatcher() = 0;
+  };
+
+  //! Construct a recorder writing to the named file.
+  //! @param filename Name of the log file; it is overwritten.
+  //! @param dispatcher The dispatcher to wrap.
+  //! @return The new recorder, or nullptr if the file can't be opened.
+  ExecRecorder *makeExecRecorder(std::string const &filename,
+                                 Dispatcher *dispatcher);
+
+  //! @class ExecReplayer
+  //! Feeds the inputs captured by an ExecRecorder back to the Exec.
+  class ExecReplayer
+  {
+  public:
+    virtual ~ExecReplayer() = default;
+
+    //! Construct the input queue from which the Exec reads the recorded
+    //! inputs. Plans added to it are held until the recording adds
+    //! them; all other entries put to it are discarded.
+    //! @return The queue. The caller takes ownership.
+    virtual InputQueue *makeInputQueue() = 0;
+
+    //! Get the dispatcher the Exec should use while replaying. It
+    //! answers lookups from the recording and does not execute
+    //! commands or updates.
+    virtual Dispatcher *dispatcher() = 0;
+
+    //! Query whether the recording has been used up, or replay has
+    //! stopped because the Exec diverged from it.
+    virtual bool finished() const = 0;
+
+    //! Query whether replay failed: the recording was invalid or
+    //! ended before the first Exec step, the Exec diverged from it, or
+    //! the application supplied a plan the recording doesn't add.
+    virtual bool failed() const = 0;
+  };
+
+  //! Construct a replayer reading from the named file.
+  //! @param filename Name of a log file written by an ExecRecorder.
+  //! @return The new replayer, or nullptr if the file can't be opened
+  //!         or is not a recording.
+  ExecReplayer *makeExecReplayer(std::string const &filename);
+
+} // namespace PLEXIL
+
+#endif // PLEXIL_EXEC_RECORDING_HH
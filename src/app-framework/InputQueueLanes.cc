@@ -0,0 +1,181 @@
+/* Copyright (c) 2006-2026, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "InputQueueLanes.hh"
+
+#include "Debug.hh"
+#include "Error.hh"
+#include "State.hh"
+
+namespace PLEXIL
+{
+
+  InputQueueLanes::Lane InputQueueLanes::laneFor(QueueEntryType type) const
+  {
+    if (!m_priorityLanes)
+      return NORMAL_LANE;
+    switch (type) {
+    case Q_COMMAND_ACK:
+    case Q_COMMAND_RETURN: // must stay ordered with the acks
+    case Q_COMMAND_ABORT:
+    case Q_UPDATE_ACK:
+      return HIGH_LANE;
+
+    default:
+      return NORMAL_LANE;
+    }
+  }
+
+  bool InputQueueLanes::StatePtrLess::operator()(State const *a, State const *b) const
+  {
+    return *a < *b;
+  }
+
+  InputQueueLanes::InputQueueLanes()
+    : m_head(),
+      m_tail(),
+      m_pendingLookups(),
+      m_coalescedCount(0),
+      m_priorityLanes(false),
+      m_coalesceLookups(false),
+      m_tookHighPriority(false)
+  {
+  }
+
+  InputQueueLanes::~InputQueueLanes()
+  {
+    QueueEntry *temp = takeAll();
+    while (temp) {
+      QueueEntry *nxt = temp->next;
+      delete temp;
+      temp = nxt;
+    }
+  }
+
+  void InputQueueLanes::setPriorityLanes(bool enable)
+  {
+    assertTrue_2(isEmpty(),
+                 "InputQueueLanes::setPriorityLanes: queue is not empty");
+    m_priorityLanes = enable;
+  }
+
+  void InputQueueLanes::setCoalesceLookups(bool coalesce)
+  {
+    m_coalesceLookups = coalesce;
+    if (!coalesce)
+      m_pendingLookups.clear();
+  }
+
+  bool InputQueueLanes::isEmpty() const
+  {
+    for (size_t i = 0; i < LANE_COUNT; ++i)
+      if (m_head[i])
+        return false;
+    return true;
+  }
+
+  QueueEntry *InputQueueLanes::put(QueueEntry *entry)
+  {
+    assertTrue_1(entry);
+    if (m_coalesceLookups && entry->type == Q_LOOKUP) {
+      PendingLookupMap::iterator const it = m_pendingLookups.find(entry->state);
+      if (it != m_pendingLookups.end()) {
+        debugMsg("InputQueue:coalesce",
+                 ' ' << *entry->state << " = " << entry->value
+                 << " supersedes " << it->second->value);
+        it->second->value = std::move(entry->value);
+        ++m_coalescedCount;
+        return entry;
+      }
+      m_pendingLookups.emplace(entry->state, entry);
+    }
+
+    Lane const lane = laneFor(entry->type);
+    entry->next = nullptr;
+    if (m_tail[lane])
+      m_tail[lane]->next = entry;
+    else
+      m_head[lane] = entry;
+    m_tail[lane] = entry;
+    return nullptr;
+  }
+
+  QueueEntry *InputQueueLanes::get()
+  {
+    QueueEntry *result = m_head[HIGH_LANE];
+    if (result) {
+      m_tookHighPriority = true;
+      m_head[HIGH_LANE] = result->next;
+      if (!m_head[HIGH_LANE])
+        m_tail[HIGH_LANE] = nullptr;
+      result->next = nullptr;
+      return result;
+    }
+
+    if (m_tookHighPriority) {
+      // Let the Exec act on the responses before taking anything else
+      m_tookHighPriority = false;
+      if (m_head[NORMAL_LANE]) {
+        debugMsg("InputQueue:get", " ending batch after high priority entries");
+        return nullptr;
+      }
+    }
+
+    result = m_head[NORMAL_LANE];
+    if (!result)
+      return nullptr; // empty
+    m_head[NORMAL_LANE] = result->next;
+    if (!m_head[NORMAL_LANE])
+      m_tail[NORMAL_LANE] = nullptr;
+    result->next = nullptr;
+    if (result->type == Q_LOOKUP && m_coalesceLookups) {
+      PendingLookupMap::iterator const it = m_pendingLookups.find(result->state);
+      if (it != m_pendingLookups.end() && it->second == result)
+        m_pendingLookups.erase(it);
+    }
+    return result;
+  }
+
+  QueueEntry *InputQueueLanes::takeAll()
+  {
+    QueueEntry *result = nullptr;
+    QueueEntry *last = nullptr;
+    for (size_t i = 0; i < LANE_COUNT; ++i) {
+      if (!m_head[i])
+        continue;
+      if (last)
+        last->next = m_head[i];
+      else
+        result = m_head[i];
+      last = m_tail[i];
+      m_head[i] = m_tail[i] = nullptr;
+    }
+    m_pendingLookups.clear();
+    m_tookHighPriority = false;
+    return result;
+  }
+
+}
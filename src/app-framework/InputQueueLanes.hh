@@ -0,0 +1,135 @@
+/* Copyright (c) 2006-2026, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef PLEXIL_INPUT_QUEUE_LANES_HH
+#define PLEXIL_INPUT_QUEUE_LANES_HH
+
+#include "QueueEntry.hh"
+
+#include <map>
+
+namespace PLEXIL
+{
+
+  /**
+   * @class InputQueueLanes
+   * @brief The prioritized lanes behind the InputQueue implementations.
+   *
+   * By default every entry travels in one lane, in the order queued.
+   *
+   * Optionally, command acknowledgements, return values and abort
+   * acks, and update acks travel in a high priority lane, ahead of
+   * lookups, messages, plans, and marks.  A mark never overtakes
+   * anything queued before it.
+   *
+   * Optionally, a lookup value for a state which already has a value
+   * waiting in the queue replaces that value in place.
+   *
+   * @note Not thread safe; the owning queue serializes access.
+   */
+  class InputQueueLanes final
+  {
+  public:
+    enum Lane {
+      HIGH_LANE = 0,
+      NORMAL_LANE,
+
+      LANE_COUNT
+    };
+
+    //! The lane in which entries of this type travel.
+    Lane laneFor(QueueEntryType type) const;
+
+    InputQueueLanes();
+    ~InputQueueLanes();
+
+    //! Enable or disable the high priority lane.
+    //! @note Must only be called while the queue is empty.
+    void setPriorityLanes(bool enable);
+    bool priorityLanes() const
+    {
+      return m_priorityLanes;
+    }
+
+    //! Enable or disable coalescing of superseded lookup values.
+    void setCoalesceLookups(bool coalesce);
+    bool coalesceLookups() const
+    {
+      return m_coalesceLookups;
+    }
+
+    //! Number of lookup values coalesced since construction.
+    size_t coalescedCount() const
+    {
+      return m_coalescedCount;
+    }
+
+    bool isEmpty() const;
+
+    //! Append the entry to its lane.
+    //! @return nullptr if the entry was queued; the entry itself if
+    //!         its value was merged into a queued lookup, in which case
+    //!         the caller must recycle it.
+    QueueEntry *put(QueueEntry *entry);
+
+    //! Take the next entry, high priority lane first.
+    //! @return The entry; nullptr if the queue is empty.
+    //! @note Also returns nullptr once when the high priority lane has
+    //!       been drained and other entries are still waiting, so the
+    //!       caller ends its batch and steps the Exec before them.
+    QueueEntry *get();
+
+    //! Unlink every queued entry.
+    //! @return The entries, linked through their next pointers.
+    QueueEntry *takeAll();
+
+  private:
+
+    // Disallow copy, assign
+    InputQueueLanes(InputQueueLanes const &) = delete;
+    InputQueueLanes(InputQueueLanes &&) = delete;
+    InputQueueLanes &operator=(InputQueueLanes const &) = delete;
+    InputQueueLanes &operator=(InputQueueLanes &&) = delete;
+
+    struct StatePtrLess
+    {
+      bool operator()(State const *a, State const *b) const;
+    };
+
+    using PendingLookupMap = std::map<State const *, QueueEntry *, StatePtrLess>;
+
+    QueueEntry *m_head[LANE_COUNT];
+    QueueEntry *m_tail[LANE_COUNT];
+    PendingLookupMap m_pendingLookups;
+    size_t m_coalescedCount;
+    bool m_priorityLanes;
+    bool m_coalesceLookups;
+    bool m_tookHighPriority;
+  };
+
+}
+
+#endif // PLEXIL_INPUT_QUEUE_LANES_HH
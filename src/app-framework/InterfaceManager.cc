@@ -36,6 +36,7 @@
 #include "commandUtils.hh"
 #include "Debug.hh"
 #include "ExecApplication.hh"
+#include "ExecMetrics.hh"
 #include "ExecListenerHub.hh"
 #include "InputQueue.hh"
 #include "InterfaceAdapter.hh"
@@ -88,6 +89,23 @@ namespace PLEXIL
     return (bool) m_inputQueue;
   }
 
+  void InterfaceManager::setInputQueue(InputQueue *queue)
+  {
+    m_inputQueue.reset(queue);
+  }
+
+  InputQueue *InterfaceManager::releaseInputQueue()
+  {
+    return m_inputQueue.release();
+  }
+
+  void InterfaceManager::enqueue(QueueEntry *entry)
+  {
+    if (execMetricsEnabled())
+      entry->enqueued = MetricsClock::now();
+    m_inputQueue->put(entry);
+  }
+
   //
   // API to handlers
   //
@@ -110,7 +128,7 @@ namespace PLEXIL
     assertTrue_1(entry);
 
     entry->initForLookup(state, value);
-    m_inputQueue->put(entry);
+    enqueue(entry);
   }
 
   void
@@ -124,7 +142,7 @@ namespace PLEXIL
     assertTrue_1(entry);
 
     entry->initForLookup(state, value);
-    m_inputQueue->put(entry);
+    enqueue(entry);
   }
 
   void
@@ -138,7 +156,7 @@ namespace PLEXIL
     assertTrue_1(entry);
 
     entry->initForLookup(state, value);
-    m_inputQueue->put(entry);
+    enqueue(entry);
   }
 
   void
@@ -152,7 +170,7 @@ namespace PLEXIL
     assertTrue_1(entry);
 
     entry->initForLookup(state, value);
-    m_inputQueue->put(entry);
+    enqueue(entry);
   }
 
   //
@@ -183,7 +201,7 @@ namespace PLEXIL
     assertTrue_1(entry);
 
     entry->initForCommandAck(cmd, value);
-    m_inputQueue->put(entry);
+    enqueue(entry);
   }
 
   //! Receive a return value from a command.
@@ -205,7 +223,7 @@ namespace PLEXIL
     assertTrue_1(entry);
 
     entry->initForCommandReturn(cmd, value);
-    m_inputQueue->put(entry);
+    enqueue(entry);
   }
 
   void
@@ -223,8 +241,8 @@ namespace PLEXIL
     QueueEntry *entry = m_inputQueue->allocate();
     assertTrue_1(entry);
 
-    entry->initForCommandReturn(cmd, value);
-    m_inputQueue->put(entry);
+    entry->initForCommandReturn(cmd, std::move(value));
+    enqueue(entry);
   }
 
   //! Receive acknowledgement of a command abort.
@@ -247,7 +265,7 @@ namespace PLEXIL
     assertTrue_1(entry);
 
     entry->initForCommandAbort(cmd, ack);
-    m_inputQueue->put(entry);
+    enqueue(entry);
   }
 
   //
@@ -274,7 +292,7 @@ namespace PLEXIL
     assertTrue_1(entry);
 
     entry->initForUpdateAck(upd, ack);
-    m_inputQueue->put(entry);
+    enqueue(entry);
   }
 
   //
@@ -295,7 +313,7 @@ namespace PLEXIL
     assertTrue_1(entry);
 
     entry->initForReceiveMessage(message);
-    m_inputQueue->put(entry);
+    enqueue(entry);
   }
 
   //! Notify the executive that the message queue is empty.
@@ -305,7 +323,7 @@ namespace PLEXIL
     QueueEntry *entry = m_inputQueue->allocate();
     assertTrue_1(entry);
     entry->initForMessageQueueEmpty();
-    m_inputQueue->put(entry);
+    enqueue(entry);
   }
 
   //! Notify the executive that a message has been accepted.
@@ -326,7 +344,7 @@ namespace PLEXIL
     QueueEntry *entry = m_inputQueue->allocate();
     assertTrue_1(entry);
     entry->initForAcceptMessage(message, handle);
-    m_inputQueue->put(entry);
+    enqueue(entry);
   }
 
   //! Notify the executive that a message handle has been released.
@@ -342,7 +360,7 @@ namespace PLEXIL
     QueueEntry *entry = m_inputQueue->allocate();
     assertTrue_1(entry);
     entry->initForReleaseMessageHandle(handle);
-    m_inputQueue->put(entry);
+    enqueue(entry);
   }
 
   //! Receive a new plan and give it to the Exec.
@@ -360,7 +378,7 @@ namespace PLEXIL
     assertTrue_1(entry);
 
     entry->initForAddPlan(root);
-    m_inputQueue->put(entry);
+    enqueue(entry);
     m_application->listenerHub()->notifyOfAddPlan(planXml);
     debugMsg("InterfaceManager:handleAddPlan", " plan enqueued for loading");
   }
@@ -376,7 +394,7 @@ namespace PLEXIL
                "InterfaceManager::handleAddLibrary: Null plan document");
 
     // Hand off to librarian
-    Library const *l = loadLibraryDocument(doc);
+    LibraryPtr l = loadLibraryDocument(doc);
     if (l) {
       pugi::xml_node const node = l->doc->document_element().child(NODE_TAG);
       char const *name = node.child_value(NODEID_TAG);
@@ -433,7 +451,7 @@ namespace PLEXIL
 
     unsigned int sequence = ++m_markCount;
     entry->initForMark(sequence);
-    m_inputQueue->put(entry);
+    enqueue(entry);
     debugMsg("InterfaceManager:markQueue",
              " sequence # " << sequence);
     return sequence;
@@ -466,6 +484,9 @@ namespace PLEXIL
     bool needsStep = false;
     QueueEntry *entry;
     while ((entry = m_inputQueue->get())) {
+      if (entry->enqueued != MetricsClock::time_point())
+        recordQueueWait(entry->enqueued);
+
       switch (entry->type) {
       case Q_MARK:
         debugMsg("InterfaceManager:processQueue", " Received mark");
@@ -479,7 +500,7 @@ namespace PLEXIL
         debugMsg("InterfaceManager:processQueue",
                  " Received new value " << entry->value << " for " << *(entry->state));
 
-        StateCache::instance().lookupReturn(*(entry->state), entry->value);
+        m_application->stateCache()->lookupReturn(*(entry->state), entry->value);
         needsStep = true;
         break;
 
@@ -493,6 +514,8 @@ namespace PLEXIL
                    " received command handle value "
                    << commandHandleValueName((CommandHandleValue) handle)
                    << " for command " << entry->command->getCommand());
+          if (execMetricsEnabled())
+            noteCommandAck(entry->command);
           commandHandleReturn(entry->command, handle);
         }
         needsStep = true;
@@ -540,19 +563,19 @@ namespace PLEXIL
           assertTrue_1(pid);
           debugMsg("InterfaceManager:processQueue",
                    " adding plan " << entry->plan->getNodeId());
-          g_exec->addPlan(pid);
+          m_application->exec()->addPlan(pid);
         }
         entry->plan = nullptr;
         needsStep = true;
         break;
 
       case Q_RECEIVE_MSG:
-        StateCache::instance().messageReceived(entry->message);
+        m_application->stateCache()->messageReceived(entry->message);
         needsStep = true;
         break;
 
       case Q_MSG_QUEUE_EMPTY:
-        StateCache::instance().messageQueueEmpty();
+        m_application->stateCache()->messageQueueEmpty();
         needsStep = true;
         break;
         
@@ -561,7 +584,7 @@ namespace PLEXIL
           std::string handle;
           assertTrue_2(entry->value.getValue(handle),
                        "InterfaceManager::processQueue: message handle is unknown or wrong type");
-          StateCache::instance().assignMessageHandle(entry->message, handle);
+          m_application->stateCache()->assignMessageHandle(entry->message, handle);
         }
         entry->message = nullptr;
         needsStep = true;
@@ -572,7 +595,7 @@ namespace PLEXIL
           std::string handle;
           assertTrue_2(entry->value.getValue(handle),
                        "InterfaceManager::processQueue: message handle is unknown or wrong type");
-          StateCache::instance().releaseMessageHandle(handle);
+          m_application->stateCache()->releaseMessageHandle(handle);
         }
         needsStep = true;
         break;
@@ -589,7 +612,7 @@ namespace PLEXIL
     }
 
     debugMsg("InterfaceManager:processQueue",
-             " Queue empty, returning " << (needsStep ? "true" : "false"));
+             " Batch done, returning " << (needsStep ? "true" : "false"));
     return needsStep;
   }
 
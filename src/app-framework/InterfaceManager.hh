@@ -48,6 +48,8 @@ namespace PLEXIL
 
   class InputQueue;
 
+  struct QueueEntry;
+
   //! @class InterfaceManager
   //! A concrete derived class implementing the API of the
   //! AdapterExecInterface class.
@@ -77,6 +79,14 @@ namespace PLEXIL
     //! Initialize the interface manager.
     //! @return true if successful, false otherwise.
     virtual bool initialize();
+
+    //! Replace the input queue constructed by initialize().
+    //! @param queue The new queue. The interface manager takes ownership.
+    void setInputQueue(InputQueue *queue);
+
+    //! Give up ownership of the input queue.
+    //! @return The queue. The caller takes ownership.
+    InputQueue *releaseInputQueue();
     
     //! Read the input queue and give the received data to the Exec.
     //! @return True if the exec needs to be stepped as a result of
@@ -197,6 +207,10 @@ namespace PLEXIL
     InterfaceManager &operator=(InterfaceManager const &) = delete;
     InterfaceManager &operator=(InterfaceManager &&) = delete;
 
+    //! Put an initialized entry on the input queue.
+    //! @param entry The entry.
+    void enqueue(QueueEntry *entry);
+
     //
     // Private member variables
     //
@@ -184,6 +184,10 @@ namespace PLEXIL
         return;
       }
 
+      // Merge with the pending wakeup, or defer by the slack window
+      if (!coalesceDeadline(d))
+        return;
+
       debugMsg("ItimerTimebase:setTimer", 
                " deadline "
 	       << std::fixed << std::setprecision(6) << d);
@@ -43,6 +43,7 @@
 #include "State.hh"
 
 #include <algorithm> // std::find_if()
+#include <atomic>
 
 namespace PLEXIL
 {
@@ -152,7 +153,8 @@ namespace PLEXIL
 
   static unsigned int nextSerialNumber()
   {
-    static unsigned int sl_next = 0;
+    // May be shared by several exec instances
+    static std::atomic<unsigned int> sl_next(0);
     return ++sl_next;
   }
 
@@ -0,0 +1,97 @@
+/* Copyright (c) 2006-2021, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// This interface adapter enables collection of Exec latency metrics
+// (see ExecMetrics.hh) and optionally serves them, in the Prometheus
+// text format, on a local socket. It is accessed by including the
+// following entry in your interface configuration file:
+//    <Adapter AdapterType="Metrics" SocketPath="/tmp/plexil-metrics"/>
+// The SocketPath attribute is optional. With it, the metrics may be
+// read with e.g.
+//    curl --unix-socket /tmp/plexil-metrics http://localhost/metrics
+
+#include "AdapterFactory.hh"        // REGISTER_ADAPTER() macro
+#include "Debug.hh"
+#include "ExecMetrics.hh"
+#include "InterfaceAdapter.hh"
+
+#include "pugixml.hpp"
+
+namespace PLEXIL
+{
+
+  class MetricsAdapter final : public InterfaceAdapter
+  {
+  public:
+    MetricsAdapter(AdapterExecInterface& execInterface,
+                   AdapterConf *conf)
+      : InterfaceAdapter(execInterface, conf),
+        m_listening(false)
+    {}
+
+    virtual ~MetricsAdapter() = default;
+
+    virtual bool initialize(AdapterConfiguration * /* config */) override
+    {
+      setExecMetricsEnabled(true);
+      return true;
+    }
+
+    virtual bool start() override
+    {
+      char const *path = getXml().attribute(SOCKET_PATH_ATTR).value();
+      if (*path) {
+        m_listening = startMetricsListener(path);
+        if (!m_listening)
+          return false;
+      }
+      debugMsg("MetricsAdapter:start", " complete");
+      return true;
+    }
+
+    virtual void stop() override
+    {
+      if (m_listening) {
+        stopMetricsListener();
+        m_listening = false;
+      }
+      debugMsg("MetricsAdapter:stop", " complete");
+    }
+
+  private:
+
+    static constexpr char const *SOCKET_PATH_ATTR = "SocketPath";
+
+    bool m_listening;
+  };
+
+} // namespace PLEXIL
+
+extern "C"
+void initMetricsAdapter()
+{
+  REGISTER_ADAPTER(PLEXIL::MetricsAdapter, "Metrics");
+}
@@ -180,6 +180,10 @@ namespace PLEXIL
         return;
       }
 
+      // Merge with the pending wakeup, or defer by the slack window
+      if (!coalesceDeadline(d))
+        return;
+
       debugMsg("PosixTimebase:setTimer", 
                " deadline " << std::fixed << std::setprecision(6) << d);
 
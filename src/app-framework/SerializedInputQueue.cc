@@ -31,16 +31,17 @@
 
 namespace PLEXIL
 {
-  SerializedInputQueue::SerializedInputQueue()
+  SerializedInputQueue::SerializedInputQueue(bool priorityLanes, bool coalesceLookups)
     : InputQueue(),
-      m_queueGet(nullptr),
-      m_queuePut(nullptr),
+      m_lanes(),
       m_freeList(nullptr)
 #ifdef PLEXIL_WITH_THREADS
                       ,
       m_mutex(new std::mutex())
 #endif
   {
+    m_lanes.setPriorityLanes(priorityLanes);
+    m_lanes.setCoalesceLookups(coalesceLookups);
   }
 
   SerializedInputQueue::~SerializedInputQueue()
@@ -48,12 +49,7 @@ namespace PLEXIL
 #ifdef PLEXIL_WITH_THREADS
     std::lock_guard<std::mutex> const guard(*m_mutex);
 #endif
-    m_queuePut = nullptr;
-    while (m_queueGet) {
-      QueueEntry *temp = m_queueGet;
-      m_queueGet = temp->next;
-      delete temp;
-    }
+    // m_lanes deletes any entries still queued
     while (m_freeList) {
       QueueEntry *temp = m_freeList;
       m_freeList = temp->next;
@@ -66,7 +62,7 @@ namespace PLEXIL
 #ifdef PLEXIL_WITH_THREADS
     std::lock_guard<std::mutex> const guard(*m_mutex);
 #endif
-    return m_queueGet == nullptr;
+    return m_lanes.isEmpty();
   }
 
   QueueEntry *SerializedInputQueue::allocate()
@@ -88,9 +84,7 @@ namespace PLEXIL
 #ifdef PLEXIL_WITH_THREADS
     std::lock_guard<std::mutex> const guard(*m_mutex);
 #endif
-    entry->reset(); // ??
-    entry->next = m_freeList;
-    m_freeList = entry;
+    recycle(entry);
   }
 
   void SerializedInputQueue::put(QueueEntry *entry)
@@ -99,12 +93,9 @@ namespace PLEXIL
 #ifdef PLEXIL_WITH_THREADS
     std::lock_guard<std::mutex> const guard(*m_mutex);
 #endif
-    entry->next = nullptr;
-    if (m_queuePut)
-      m_queuePut->next = entry;
-    m_queuePut = entry;
-    if (!m_queueGet)
-      m_queueGet = entry;
+    QueueEntry *superseded = m_lanes.put(entry);
+    if (superseded)
+      recycle(superseded);
   }
 
   QueueEntry *SerializedInputQueue::get()
@@ -112,15 +103,7 @@ namespace PLEXIL
 #ifdef PLEXIL_WITH_THREADS
     std::lock_guard<std::mutex> const guard(*m_mutex);
 #endif
-    if (!m_queueGet)
-      return nullptr; // empty
-    QueueEntry *result = m_queueGet;
-    m_queueGet = result->next;
-    if (!m_queueGet) { // queue now empty
-      assertTrue_1(m_queuePut == result); // consistency check
-      m_queueGet = m_queuePut = nullptr;
-    }
-    return result;
+    return m_lanes.get();
   }
 
   void SerializedInputQueue::flush()
@@ -128,12 +111,20 @@ namespace PLEXIL
 #ifdef PLEXIL_WITH_THREADS
     std::lock_guard<std::mutex> const guard(*m_mutex);
 #endif
-    QueueEntry *temp;
-    while ((temp = m_queueGet)) {
-      m_queueGet = temp->next;
-      release(temp);
+    QueueEntry *temp = m_lanes.takeAll();
+    while (temp) {
+      QueueEntry *nxt = temp->next;
+      recycle(temp);
+      temp = nxt;
     }
-    m_queuePut = nullptr;
+  }
+
+  // Caller must hold the mutex.
+  void SerializedInputQueue::recycle(QueueEntry *entry)
+  {
+    entry->reset(); // ??
+    entry->next = m_freeList;
+    m_freeList = entry;
   }
 
 } // namespace PLEXIL
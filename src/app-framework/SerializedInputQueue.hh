@@ -30,6 +30,7 @@
 #include "plexil-config.h"
 
 #include "InputQueue.hh"
+#include "InputQueueLanes.hh"
 
 #include <memory>
 #include <mutex>
@@ -40,11 +41,12 @@ namespace PLEXIL
   /**
    * @class SerializedInputQueue
    * @brief A simple implementation of the InputQueue API.
+   * @see InputQueueLanes for the order in which entries are delivered.
    */
   class SerializedInputQueue : public InputQueue
   {
   public:
-    SerializedInputQueue();
+    SerializedInputQueue(bool priorityLanes = false, bool coalesceLookups = false);
     virtual ~SerializedInputQueue();
 
     // Serialized query
@@ -81,8 +83,9 @@ namespace PLEXIL
     SerializedInputQueue &operator=(SerializedInputQueue const &) = delete;
     SerializedInputQueue &operator=(SerializedInputQueue &&) = delete;
 
-    QueueEntry *m_queueGet;
-    QueueEntry *m_queuePut;
+    void recycle(QueueEntry *entry);
+
+    InputQueueLanes m_lanes;
     QueueEntry *m_freeList;
 #ifdef PLEXIL_WITH_THREADS
     std::unique_ptr<std::mutex> m_mutex;
@@ -31,22 +31,18 @@
 
 namespace PLEXIL
 {
-  SimpleInputQueue::SimpleInputQueue()
+  SimpleInputQueue::SimpleInputQueue(bool priorityLanes, bool coalesceLookups)
     : InputQueue(),
-      m_queueGet(nullptr),
-      m_queuePut(nullptr),
+      m_lanes(),
       m_freeList(nullptr)
   {
+    m_lanes.setPriorityLanes(priorityLanes);
+    m_lanes.setCoalesceLookups(coalesceLookups);
   }
 
   SimpleInputQueue::~SimpleInputQueue()
   {
-    m_queuePut = nullptr;
-    while (m_queueGet) {
-      QueueEntry *temp = m_queueGet;
-      m_queueGet = temp->next;
-      delete temp;
-    }
+    // m_lanes deletes any entries still queued
     while (m_freeList) {
       QueueEntry *temp = m_freeList;
       m_freeList = temp->next;
@@ -56,7 +52,7 @@ namespace PLEXIL
 
   bool SimpleInputQueue::isEmpty() const
   {
-    return m_queueGet == nullptr;
+    return m_lanes.isEmpty();
   }
 
   QueueEntry *SimpleInputQueue::allocate()
@@ -72,43 +68,37 @@ namespace PLEXIL
   void SimpleInputQueue::release(QueueEntry *entry)
   {
     assertTrue_1(entry);
-    entry->reset(); // ??
-    entry->next = m_freeList;
-    m_freeList = entry;
+    recycle(entry);
   }
 
   void SimpleInputQueue::put(QueueEntry *entry)
   {
     assertTrue_1(entry);
-    entry->next = nullptr;
-    if (m_queuePut)
-      m_queuePut->next = entry;
-    m_queuePut = entry;
-    if (!m_queueGet)
-      m_queueGet = entry;
+    QueueEntry *superseded = m_lanes.put(entry);
+    if (superseded)
+      recycle(superseded);
   }
 
   QueueEntry *SimpleInputQueue::get()
   {
-    if (!m_queueGet)
-      return nullptr; // empty
-    QueueEntry *result = m_queueGet;
-    m_queueGet = result->next;
-    if (!m_queueGet) { // queue now empty
-      assertTrue_1(m_queuePut == result); // consistency check
-      m_queueGet = m_queuePut = nullptr;
-    }
-    return result;
+    return m_lanes.get();
   }
 
   void SimpleInputQueue::flush()
   {
-    QueueEntry *temp;
-    while ((temp = m_queueGet)) {
-      m_queueGet = temp->next;
-      release(temp);
+    QueueEntry *temp = m_lanes.takeAll();
+    while (temp) {
+      QueueEntry *nxt = temp->next;
+      recycle(temp);
+      temp = nxt;
     }
-    m_queuePut = nullptr;
+  }
+
+  void SimpleInputQueue::recycle(QueueEntry *entry)
+  {
+    entry->reset(); // ??
+    entry->next = m_freeList;
+    m_freeList = entry;
   }
 
 } // namespace PLEXIL
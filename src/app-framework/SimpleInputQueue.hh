@@ -28,6 +28,7 @@
 #define PLEXIL_SIMPLE_INPUT_QUEUE_HH
 
 #include "InputQueue.hh"
+#include "InputQueueLanes.hh"
 
 namespace PLEXIL
 {
@@ -35,11 +36,12 @@ namespace PLEXIL
   /**
    * @class SimpleInputQueue
    * @brief A simple implementation of the InputQueue API.
+   * @see InputQueueLanes for the order in which entries are delivered.
    */
   class SimpleInputQueue : public InputQueue
   {
   public:
-    SimpleInputQueue();
+    SimpleInputQueue(bool priorityLanes = false, bool coalesceLookups = false);
     virtual ~SimpleInputQueue();
 
     // Simple query
@@ -75,8 +77,9 @@ namespace PLEXIL
     SimpleInputQueue &operator=(SimpleInputQueue const &) = delete;
     SimpleInputQueue &operator=(SimpleInputQueue &&) = delete;
 
-    QueueEntry *m_queueGet;
-    QueueEntry *m_queuePut;
+    void recycle(QueueEntry *entry);
+
+    InputQueueLanes m_lanes;
     QueueEntry *m_freeList;
   };
 
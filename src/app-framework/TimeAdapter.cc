@@ -157,7 +157,9 @@ namespace PLEXIL
     {
       try {
         m_timebase->stop(); 
-        debugMsg("TimeAdapter:stop", " complete");
+        debugMsg("TimeAdapter:stop",
+                 " complete, " << m_timebase->getMergedWakeupCount()
+                 << " deadlines merged");
       } catch (const InterfaceError &e) {
         std::cerr << "ERROR: Stopping timebase threw an exception:\n "
                   << e.what() << std::endl;
@@ -64,6 +64,9 @@ namespace PLEXIL
 
   Timebase::Timebase(WakeupFn f, void *arg)
     : m_nextWakeup(0),
+      m_requestedWakeup(0),
+      m_slack(0),
+      m_mergedWakeups(0),
       m_wakeupFn(f),
       m_wakeupArg(arg)
   {
@@ -89,6 +92,56 @@ namespace PLEXIL
     return 0;
   }
 
+  void Timebase::setSlack(uint32_t usec)
+  {
+    m_slack = usec / 1000000.0;
+  }
+
+  uint32_t Timebase::getSlack() const
+  {
+    return (uint32_t) (m_slack * 1000000.0 + 0.5);
+  }
+
+  size_t Timebase::getMergedWakeupCount() const
+  {
+    return m_mergedWakeups;
+  }
+
+  size_t Timebase::queryMergedWakeups()
+  {
+    if (s_instance)
+      return s_instance->getMergedWakeupCount();
+    return 0;
+  }
+
+  bool Timebase::coalesceDeadline(double &d)
+  {
+    // Re-arming for the pending wakeup, e.g. after an early timeout
+    if (!m_slack || d == m_nextWakeup)
+      return true;
+
+    // Is a wakeup pending, for a deadline within the slack window?
+    if (m_nextWakeup > getTime()
+        && d >= m_requestedWakeup - m_slack
+        && d <= m_requestedWakeup + m_slack) {
+      ++m_mergedWakeups;
+      if (d >= m_requestedWakeup) {
+        debugMsg("Timebase:coalesceDeadline",
+                 " deadline " << std::fixed << std::setprecision(6) << d
+                 << " merged into wakeup at " << m_nextWakeup);
+        return false;
+      }
+      // Move the wakeup earlier; it still serves the pending deadline
+      debugMsg("Timebase:coalesceDeadline",
+               " deadline " << std::fixed << std::setprecision(6) << d
+               << " moves wakeup earlier, merging deadline " << m_requestedWakeup);
+    }
+
+    m_requestedWakeup = d;
+    d += m_slack;
+    return true;
+  }
+
 } // namespace PLEXIL
 
 //
@@ -29,6 +29,9 @@
 
 #include "plexil-stdint.h" // uint32_t; also includes plexil-config.h
 
+#include <atomic>
+#include <cstddef> // size_t
+
 namespace PLEXIL
 {
 
@@ -58,6 +61,12 @@ namespace PLEXIL
   //! called exactly as specified, but should check the time at which
   //! the call is performed, and act accordingly.
 
+  //! In deadline mode, a Timebase may be given a *slack* window.
+  //! Each deadline wakeup is then deferred by up to the slack, and a
+  //! deadline requested within the slack window of a pending wakeup
+  //! is merged into that wakeup, so that nearby deadlines are served
+  //! by one wakeup (and one Exec cycle) instead of several.
+
   //! The wakeup function may be called from a signal handler, from an
   //! OS timer queue, or from a separate thread in the calling
   //! application. In deadline mode, the wakeup function can be
@@ -125,6 +134,24 @@ namespace PLEXIL
     //!       return 0.
     double getNextWakeup() const;
 
+    //! Set the slack window for deadline wakeups.
+    //! @param usec The slack, in microseconds.
+    //! @note A slack of 0, the default, disables merging of deadlines.
+    void setSlack(uint32_t usec);
+
+    //! Get the slack window for deadline wakeups.
+    //! @return The slack, in microseconds.
+    uint32_t getSlack() const;
+
+    //! Get the number of deadlines merged into another wakeup.
+    //! @return The count.
+    size_t getMergedWakeupCount() const;
+
+    //! Convenience function. Gets the merged wakeup count from an
+    //! existing timebase.
+    //! @return The count. Returns 0 if there is no existing timebase.
+    static size_t queryMergedWakeups();
+
   protected:
 
     //! Constructor.
@@ -133,9 +160,26 @@ namespace PLEXIL
     //! @note Constructor is only accessible to derived classes.
     Timebase(WakeupFn f, void *arg);
 
+    //! Apply the slack window to a requested deadline.
+    //! @param d The requested deadline; on return, the time for which
+    //!          to set the timer.
+    //! @return False if the deadline was merged into the pending
+    //!         wakeup, and the timer should not be set; true otherwise.
+    //! @note Derived classes call this from setTimer() in deadline mode.
+    bool coalesceDeadline(double &d);
+
     //! The time of the next scheduled deadline wakeup.
     double m_nextWakeup;
 
+    //! The earliest deadline served by the pending wakeup.
+    double m_requestedWakeup;
+
+    //! The slack window, in seconds.
+    double m_slack;
+
+    //! The number of deadlines merged into another wakeup.
+    std::atomic<size_t> m_mergedWakeups;
+
     //! Pointer to the wakeup function.
     WakeupFn m_wakeupFn;
 
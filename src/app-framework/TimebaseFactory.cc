@@ -63,7 +63,16 @@ namespace PLEXIL
       debugMsg("TimebaseFactory::makeTimebase",
                " got best factory \"" << factory->name() << '"');
     }
-    return factory->create(fn, arg);
+    Timebase *result = factory->create(fn, arg);
+    if (descriptor) {
+      // Slack window for deadline wakeups, in microseconds
+      uint32_t slack = descriptor.attribute(InterfaceSchema::SLACK_ATTR).as_uint();
+      if (slack) {
+        debugMsg("makeTimebase", " slack " << slack << " usec");
+        result->setSlack(slack);
+      }
+    }
+    return result;
   }
 
   TimebaseFactory const *TimebaseFactory::get(std::string const &name)
@@ -52,6 +52,9 @@ namespace PLEXIL
 
   //! User function to construct a Timebase instance.
   //! @param descriptor XML element describing the desired Timebase; may be empty.
+  //!                   Its optional Type attribute names the factory, and its
+  //!                   optional Slack attribute sets the slack window for
+  //!                   deadline wakeups, in microseconds.
   //! @param fn Pointer to the function to call on a timer timeout.
   //! @param arg Argument value passed to the timeout function.
   Timebase *makeTimebase(pugi::xml_node const descriptor,
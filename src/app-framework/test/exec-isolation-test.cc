@@ -0,0 +1,204 @@
+/* Copyright (c) 2006-2026, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+//
+// Module test for running more than one ExecApplication in a process.
+// Two applications run the same plan at the same time on their own
+// threads; each must see only its own Exec, dispatcher, and state
+// cache.
+//
+
+#include "ExecApplication.hh"
+
+#include "AdapterConfiguration.hh"
+#include "DebugMessage.hh"
+#include "Error.hh"
+#include "Expression.hh"
+#include "LookupReceiver.hh"
+#include "NodeImpl.hh"
+#include "PlexilExec.hh"
+#include "State.hh"
+#include "StateCache.hh"
+#include "lifecycle-utils.h"
+
+#include "pugixml.hpp"
+
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+using namespace PLEXIL;
+
+// Add adds LookupNow(Tag) to sum until it reaches the target. Hold
+// never starts, so the plan stays loaded once the Exec is quiescent.
+static std::string makePlan(char const *rootId, Integer target)
+{
+  std::string const limit =
+    "<IntegerValue>" + std::to_string(target) + "</IntegerValue>";
+  return
+    std::string("<PlexilPlan>"
+                "<Node NodeType=\"NodeList\"><NodeId>") + rootId + "</NodeId>"
+    "<VariableDeclarations><DeclareVariable><Name>sum</Name><Type>Integer</Type>"
+    "<InitialValue><IntegerValue>0</IntegerValue></InitialValue>"
+    "</DeclareVariable></VariableDeclarations>"
+    "<NodeBody><NodeList>"
+    "<Node NodeType=\"Assignment\"><NodeId>Add</NodeId>"
+    "<RepeatCondition><LT><IntegerVariable>sum</IntegerVariable>" + limit
+    + "</LT></RepeatCondition>"
+    "<PostCondition><EQNumeric><IntegerVariable>sum</IntegerVariable>" + limit
+    + "</EQNumeric></PostCondition>"
+    "<NodeBody><Assignment><IntegerVariable>sum</IntegerVariable>"
+    "<NumericRHS><ADD><IntegerVariable>sum</IntegerVariable>"
+    "<LookupNow><Name><StringValue>Tag</StringValue></Name></LookupNow>"
+    "</ADD></NumericRHS></Assignment></NodeBody></Node>"
+    "<Node NodeType=\"Empty\"><NodeId>Hold</NodeId>"
+    "<StartCondition><BooleanValue>false</BooleanValue></StartCondition></Node>"
+    "</NodeList></NodeBody></Node>"
+    "</PlexilPlan>";
+}
+
+static size_t const ITERATIONS = 100;
+
+// One application and what its lookup handler saw
+struct Instance
+{
+  Instance(char const *rootId, Integer tag)
+    : app(makeExecApplication()),
+      rootId(rootId),
+      tag(tag),
+      calls(0),
+      wrongContext(false)
+  {
+  }
+
+  std::unique_ptr<ExecApplication> app;
+  char const *rootId;
+  Integer tag;
+  std::atomic<size_t> calls;
+  std::atomic<bool> wrongContext;
+};
+
+static bool start(Instance &inst)
+{
+  pugi::xml_document emptyConfig;
+  assertTrue_1(inst.app->initialize(emptyConfig.document_element()));
+
+  // Called on the application's Exec thread
+  Instance *ip = &inst;
+  inst.app->configuration()->registerLookupHandlerFunction
+    ("Tag",
+     [ip](State const & /* state */, LookupReceiver *rcvr) -> void {
+       ++ip->calls;
+       if (g_exec != ip->app->exec()
+           || g_dispatcher != ip->app->configuration()
+           || &StateCache::instance() != ip->app->stateCache())
+         ip->wrongContext = true;
+       rcvr->update(ip->tag);
+     });
+
+  assertTrue_1(inst.app->startInterfaces());
+  assertTrue_1(inst.app->run());
+  return true;
+}
+
+static void runPlan(Instance *inst)
+{
+  pugi::xml_document *plan = new pugi::xml_document;
+  plan->load_string(makePlan(inst->rootId, inst->tag * (Integer) ITERATIONS).c_str());
+  if (!inst->app->addPlan(plan)) {
+    inst->wrongContext = true;
+    return;
+  }
+  inst->app->notifyAndWaitForCompletion();
+}
+
+static bool check(Instance &inst)
+{
+  std::cout << "  checking " << inst.rootId << std::endl;
+  assertTrue_1(!inst.wrongContext);
+  assertTrue_1(inst.calls >= ITERATIONS);
+
+  // Only this application's plan is in its Exec
+  std::list<NodePtr> const &plans = inst.app->exec()->getPlans();
+  assertTrue_1(plans.size() == 1);
+  assertTrue_1(plans.front()->getNodeId() == inst.rootId);
+
+  NodeImpl *root = dynamic_cast<NodeImpl *>(plans.front().get());
+  assertTrue_1(root);
+  Expression *sum = root->findVariable("sum");
+  assertTrue_1(sum);
+  Integer value = 0;
+  assertTrue_1(sum->getValue(value));
+  assertTrue_1(value == inst.tag * (Integer) ITERATIONS);
+
+  NodeImpl const *add = root->findChild("Add");
+  assertTrue_1(add);
+  assertTrue_1(add->getState() == FINISHED_STATE);
+  assertTrue_1(add->getOutcome() == SUCCESS_OUTCOME);
+  return true;
+}
+
+static bool testIsolation()
+{
+  std::cout << "testIsolation" << std::endl;
+  Instance a("RootA", 3);
+  Instance b("RootB", 7);
+
+  // Construct and initialize one at a time; the factory registries
+  // are shared by the whole process
+  assertTrue_1(start(a));
+  assertTrue_1(start(b));
+
+  std::thread ta(runPlan, &a);
+  std::thread tb(runPlan, &b);
+  ta.join();
+  tb.join();
+
+  bool success = check(a) && check(b);
+  a.app->stop();
+  b.app->stop();
+  return success;
+}
+
+int main()
+{
+  // Read Debug.cfg in current directory, if it exists
+  char debugConfig[] = "Debug.cfg";
+  std::ifstream config(debugConfig);
+  if (config.good()) {
+    PLEXIL::readDebugConfigStream(config);
+    std::cout << "Read debug configuration file " << debugConfig << std::endl;
+  }
+
+  bool success = testIsolation();
+
+  plexilRunFinalizers();
+  std::cout << "Exec isolation test " << (success ? "succeeded" : "failed") << std::endl;
+  return (success ? 0 : 1);
+}
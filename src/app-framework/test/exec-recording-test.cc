@@ -0,0 +1,387 @@
+/* Copyright (c) 2006-2026, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "ExecRecording.hh"
+
+#include "DebugMessage.hh"
+#include "Dispatcher.hh"
+#include "Error.hh"
+#include "InputQueue.hh"
+#include "LookupReceiver.hh"
+#include "NodeImpl.hh"
+#include "QueueEntry.hh"
+#include "SerializedInputQueue.hh"
+#include "State.hh"
+
+#include <cstdio> // std::remove()
+#include <fstream>
+#include <iostream>
+#include <memory>
+
+using namespace PLEXIL;
+
+static char const *const RECORDING_FILE = "exec-recording-test.bin";
+
+// Answers every lookup with the same value
+class TestDispatcher final : public Dispatcher
+{
+public:
+  TestDispatcher(Value const &val)
+    : Dispatcher(),
+      m_value(val)
+  {
+  }
+
+  virtual ~TestDispatcher() = default;
+
+  virtual void lookupNow(State const & /* state */, LookupReceiver *rcvr)
+  {
+    rcvr->update(m_value);
+  }
+
+  virtual void setThresholds(const State& /* state */, Real /* hi */, Real /* lo */)
+  {
+  }
+
+  virtual void setThresholds(const State& /* state */, Integer /* hi */, Integer /* lo */)
+  {
+  }
+
+  virtual void clearThresholds(const State& /* state */)
+  {
+  }
+
+  virtual void executeCommand(Command * /* cmd */)
+  {
+  }
+
+  virtual void reportCommandArbitrationFailure(Command * /* cmd */)
+  {
+  }
+
+  virtual void invokeAbort(Command * /* cmd */)
+  {
+  }
+
+  virtual void executeUpdate(Update * /* upd */)
+  {
+  }
+
+private:
+  Value m_value;
+};
+
+// Remembers the last value it was given
+class TestReceiver final : public LookupReceiver
+{
+public:
+  TestReceiver()
+    : LookupReceiver(),
+      value(),
+      updated(false)
+  {
+  }
+
+  virtual ~TestReceiver() = default;
+
+  virtual void update(Value const &val)
+  {
+    value = val;
+    updated = true;
+  }
+
+  virtual void setUnknown()
+  {
+    update(Value());
+  }
+
+  virtual void update(Boolean val)
+  {
+    update(Value(val));
+  }
+
+  virtual void update(Integer val)
+  {
+    update(Value(val));
+  }
+
+  virtual void update(Real val)
+  {
+    update(Value(val));
+  }
+
+  virtual void update(String const &val)
+  {
+    update(Value(val));
+  }
+
+  virtual void update(char const *val)
+  {
+    update(Value(val));
+  }
+
+  virtual void update(Boolean const /* ary */[], size_t /* size */)
+  {
+  }
+
+  virtual void update(Integer const /* ary */[], size_t /* size */)
+  {
+  }
+
+  virtual void update(Real const /* ary */[], size_t /* size */)
+  {
+  }
+
+  virtual void update(String const /* ary */[], size_t /* size */)
+  {
+  }
+
+  virtual LookupHandler *getLookupHandler(unsigned int /* generation */) const
+  {
+    return nullptr;
+  }
+
+  virtual void setLookupHandler(LookupHandler * /* handler */,
+                                unsigned int /* generation */)
+  {
+  }
+
+  Value value;
+  bool updated;
+};
+
+static void putLookup(InputQueue &q, char const *name, Integer val)
+{
+  QueueEntry *entry = q.allocate();
+  entry->initForLookup(State(name), Value(val));
+  q.put(entry);
+}
+
+// Take the next entry, check that it is a lookup with the expected
+// state and value, and recycle it
+static bool expectLookup(InputQueue &q, char const *name, Integer val)
+{
+  QueueEntry *entry = q.get();
+  if (!entry) {
+    std::cout << "  expected lookup of " << name << ", got batch end" << std::endl;
+    return false;
+  }
+  bool result = entry->type == Q_LOOKUP
+    && *entry->state == State(name)
+    && entry->value == Value(val);
+  if (!result)
+    std::cout << "  expected lookup of " << name << " = " << val
+              << ", got entry of type " << entry->type << std::endl;
+  q.release(entry);
+  return result;
+}
+
+// Record two passes of a simulated Exec through the queue: the first
+// finds the queue empty and looks up a state, the second takes two
+// lookup entries.
+static bool recordRun()
+{
+  TestDispatcher source(Value((Integer) 42));
+  std::unique_ptr<ExecRecorder> recorder(makeExecRecorder(RECORDING_FILE, &source));
+  assertTrue_1(recorder);
+  std::unique_ptr<InputQueue> q(recorder->wrapInputQueue(new SerializedInputQueue()));
+  Dispatcher *dispatcher = recorder->dispatcher();
+
+  TestReceiver rcvr;
+  assertTrue_1(q->isEmpty());
+  dispatcher->lookupNow(State("x"), &rcvr);
+  assertTrue_1(rcvr.updated);
+  assertTrue_1(rcvr.value == Value((Integer) 42));
+
+  putLookup(*q, "a", 1);
+  putLookup(*q, "a", 2);
+  assertTrue_1(!q->isEmpty());
+  assertTrue_1(expectLookup(*q, "a", 1));
+  assertTrue_1(expectLookup(*q, "a", 2));
+  assertTrue_1(!q->get());
+  return true;
+}
+
+static bool testRecordReplay()
+{
+  std::cout << "testRecordReplay" << std::endl;
+  assertTrue_1(recordRun());
+
+  std::unique_ptr<ExecReplayer> replayer(makeExecReplayer(RECORDING_FILE));
+  assertTrue_1(replayer);
+  std::unique_ptr<InputQueue> q(replayer->makeInputQueue());
+  Dispatcher *dispatcher = replayer->dispatcher();
+
+  // Entries put by the outside world are not what the Exec sees
+  putLookup(*q, "a", 99);
+
+  TestReceiver rcvr;
+  assertTrue_1(q->isEmpty());
+  dispatcher->lookupNow(State("x"), &rcvr);
+  assertTrue_1(rcvr.updated);
+  assertTrue_1(rcvr.value == Value((Integer) 42));
+
+  assertTrue_1(!q->isEmpty());
+  assertTrue_1(expectLookup(*q, "a", 1));
+  assertTrue_1(expectLookup(*q, "a", 2));
+  assertTrue_1(!q->get());
+  assertTrue_1(!replayer->finished());
+
+  // End of the recording
+  assertTrue_1(q->isEmpty());
+  assertTrue_1(replayer->finished());
+  assertTrue_1(!replayer->failed());
+  return true;
+}
+
+static bool testDivergence()
+{
+  std::cout << "testDivergence" << std::endl;
+  assertTrue_1(recordRun());
+
+  std::unique_ptr<ExecReplayer> replayer(makeExecReplayer(RECORDING_FILE));
+  assertTrue_1(replayer);
+  std::unique_ptr<InputQueue> q(replayer->makeInputQueue());
+
+  TestReceiver rcvr;
+  assertTrue_1(q->isEmpty());
+  replayer->dispatcher()->lookupNow(State("y"), &rcvr);
+  assertTrue_1(rcvr.updated);
+  assertTrue_1(!rcvr.value.isKnown());
+  assertTrue_1(replayer->finished());
+  assertTrue_1(replayer->failed());
+  return true;
+}
+
+static bool testEmptyRecording()
+{
+  std::cout << "testEmptyRecording" << std::endl;
+  {
+    TestDispatcher source(Value((Integer) 42));
+    std::unique_ptr<ExecRecorder> recorder(makeExecRecorder(RECORDING_FILE, &source));
+    assertTrue_1(recorder);
+  }
+
+  std::unique_ptr<ExecReplayer> replayer(makeExecReplayer(RECORDING_FILE));
+  assertTrue_1(replayer);
+  std::unique_ptr<InputQueue> q(replayer->makeInputQueue());
+  assertTrue_1(q->isEmpty());
+  assertTrue_1(!q->get());
+  assertTrue_1(replayer->finished());
+  assertTrue_1(replayer->failed());
+  return true;
+}
+
+static bool testUnrecordedPlan()
+{
+  std::cout << "testUnrecordedPlan" << std::endl;
+  assertTrue_1(recordRun());
+
+  // A plan supplied while replaying, which the recording never adds
+  {
+    std::unique_ptr<ExecReplayer> replayer(makeExecReplayer(RECORDING_FILE));
+    assertTrue_1(replayer);
+    std::unique_ptr<InputQueue> q(replayer->makeInputQueue());
+    QueueEntry *entry = q->allocate();
+    entry->initForAddPlan(new NodeImpl("unrecorded"));
+    q->put(entry);
+
+    TestReceiver rcvr;
+    assertTrue_1(q->isEmpty());
+    replayer->dispatcher()->lookupNow(State("x"), &rcvr);
+    assertTrue_1(expectLookup(*q, "a", 1));
+    assertTrue_1(expectLookup(*q, "a", 2));
+    assertTrue_1(!q->get());
+    assertTrue_1(q->isEmpty());
+    assertTrue_1(replayer->finished());
+    assertTrue_1(replayer->failed());
+  }
+
+  // A plan supplied after the recording has been used up
+  {
+    std::unique_ptr<ExecReplayer> replayer(makeExecReplayer(RECORDING_FILE));
+    assertTrue_1(replayer);
+    std::unique_ptr<InputQueue> q(replayer->makeInputQueue());
+    TestReceiver rcvr;
+    assertTrue_1(q->isEmpty());
+    replayer->dispatcher()->lookupNow(State("x"), &rcvr);
+    assertTrue_1(expectLookup(*q, "a", 1));
+    assertTrue_1(expectLookup(*q, "a", 2));
+    assertTrue_1(!q->get());
+    assertTrue_1(q->isEmpty());
+    assertTrue_1(replayer->finished());
+    assertTrue_1(!replayer->failed());
+
+    QueueEntry *entry = q->allocate();
+    entry->initForAddPlan(new NodeImpl("late"));
+    q->put(entry);
+    assertTrue_1(replayer->failed());
+  }
+  return true;
+}
+
+static bool testOversizedRecord()
+{
+  std::cout << "testOversizedRecord" << std::endl;
+  assertTrue_1(recordRun());
+
+  // Overwrite the length of the first record
+  {
+    std::fstream f(RECORDING_FILE, std::ios::in | std::ios::out | std::ios::binary);
+    assertTrue_1(f.is_open());
+    f.seekp(9);
+    f.write("\xff\xff\xff\xf0", 4);
+  }
+
+  std::unique_ptr<ExecReplayer> replayer(makeExecReplayer(RECORDING_FILE));
+  assertTrue_1(replayer);
+  std::unique_ptr<InputQueue> q(replayer->makeInputQueue());
+  assertTrue_1(q->isEmpty());
+  assertTrue_1(replayer->finished());
+  assertTrue_1(replayer->failed());
+  return true;
+}
+
+int main()
+{
+  // Read Debug.cfg in current directory, if it exists
+  char debugConfig[] = "Debug.cfg";
+  std::ifstream config(debugConfig);
+  if (config.good()) {
+    PLEXIL::readDebugConfigStream(config);
+    std::cout << "Read debug configuration file " << debugConfig << std::endl;
+  }
+
+  bool success = testRecordReplay()
+    && testDivergence()
+    && testEmptyRecording()
+    && testUnrecordedPlan()
+    && testOversizedRecord();
+
+  std::remove(RECORDING_FILE);
+  std::cout << "Exec recording test " << (success ? "succeeded" : "failed") << std::endl;
+  return (success ? 0 : 1);
+}
@@ -0,0 +1,166 @@
+/* Copyright (c) 2006-2026, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "ExecApplication.hh"
+
+#include "DebugMessage.hh"
+#include "Error.hh"
+#include "Notifier.hh"
+#include "lifecycle-utils.h"
+
+#include "pugixml.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+
+using namespace PLEXIL;
+
+// SetX assigns x, then IncrX increments it. Hold never starts, so the
+// plan stays loaded for the report once the Exec is quiescent.
+static char const *const PLAN =
+  "<PlexilPlan>"
+  "<Node NodeType=\"NodeList\"><NodeId>Root</NodeId>"
+  "<VariableDeclarations><DeclareVariable><Name>x</Name><Type>Integer</Type>"
+  "<InitialValue><IntegerValue>0</IntegerValue></InitialValue>"
+  "</DeclareVariable></VariableDeclarations>"
+  "<NodeBody><NodeList>"
+  "<Node NodeType=\"Assignment\"><NodeId>SetX</NodeId>"
+  "<NodeBody><Assignment><IntegerVariable>x</IntegerVariable>"
+  "<NumericRHS><IntegerValue>1</IntegerValue></NumericRHS>"
+  "</Assignment></NodeBody></Node>"
+  "<Node NodeType=\"Assignment\"><NodeId>IncrX</NodeId>"
+  "<StartCondition><EQNumeric><IntegerVariable>x</IntegerVariable>"
+  "<IntegerValue>1</IntegerValue></EQNumeric></StartCondition>"
+  "<NodeBody><Assignment><IntegerVariable>x</IntegerVariable>"
+  "<NumericRHS><ADD><IntegerVariable>x</IntegerVariable><IntegerValue>1</IntegerValue></ADD></NumericRHS>"
+  "</Assignment></NodeBody></Node>"
+  "<Node NodeType=\"Empty\"><NodeId>Hold</NodeId>"
+  "<StartCondition><EQNumeric><IntegerVariable>x</IntegerVariable>"
+  "<IntegerValue>3</IntegerValue></EQNumeric></StartCondition></Node>"
+  "</NodeList></NodeBody></Node>"
+  "</PlexilPlan>";
+
+static bool contains(std::string const &report, std::string const &text)
+{
+  if (report.find(text) != std::string::npos)
+    return true;
+  std::cout << "  report does not contain \"" << text << "\":\n" << report;
+  return false;
+}
+
+static bool testCounting(ExecApplication &app)
+{
+  std::cout << "testCounting" << std::endl;
+  Notifier::resetNotificationCounts();
+  Notifier::setNotificationCounting(true);
+
+  pugi::xml_document *plan = new pugi::xml_document;
+  assertTrue_1(plan->load_string(PLAN));
+  assertTrue_1(app.addPlan(plan));
+  app.notifyAndWaitForCompletion();
+  assertTrue_1(!app.allPlansFinished());
+
+  size_t total = Notifier::getNotificationCount();
+  size_t steps = 0, maxPerStep = 0;
+  Notifier::getMacroStepCounts(steps, maxPerStep);
+  assertTrue_1(total > 0);
+  assertTrue_1(steps > 0);
+  assertTrue_1(maxPerStep > 0 && maxPerStep <= total);
+  assertTrue_1(Notifier::getRecentMacroStepCounts().size() == steps);
+
+  std::ostringstream s;
+  app.reportExpressionStatistics(s, 20);
+  std::string report = s.str();
+  std::ostringstream summary;
+  summary << "Notification counting on: " << total << " notifications in "
+          << steps << " macro steps, maximum " << maxPerStep << " in one step\n";
+  assertTrue_1(contains(report, summary.str()));
+  assertTrue_1(contains(report, "Plan Root: "));
+  assertTrue_1(contains(report, " Listener count distribution:\n"));
+  assertTrue_1(contains(report, " changes published\n"));
+  // Initial value, assignment, increment
+  assertTrue_1(contains(report, "  3 (Variable Integer x "));
+  assertTrue_1(contains(report, " (Node IncrX)\n"));
+  return true;
+}
+
+static bool testCountingOff(ExecApplication &app)
+{
+  std::cout << "testCountingOff" << std::endl;
+
+  // Counts are kept when counting stops
+  size_t total = Notifier::getNotificationCount();
+  Notifier::setNotificationCounting(false);
+  std::ostringstream s1;
+  app.reportExpressionStatistics(s1, 20);
+  std::ostringstream summary;
+  summary << "Notification counting off: " << total << " notifications";
+  assertTrue_1(contains(s1.str(), summary.str()));
+  assertTrue_1(contains(s1.str(), " changes published\n"));
+
+  // ... and forgotten when reset
+  Notifier::resetNotificationCounts();
+  assertTrue_1(Notifier::getNotificationCount() == 0);
+  std::ostringstream s2;
+  app.reportExpressionStatistics(s2, 20);
+  std::string report = s2.str();
+  std::string const off("Notification counting off\n");
+  assertTrue_1(report.compare(0, off.size(), off) == 0);
+  assertTrue_1(contains(report, "Plan Root: "));
+  assertTrue_1(report.find("changes published") == std::string::npos);
+  return true;
+}
+
+int main()
+{
+  // Read Debug.cfg in current directory, if it exists
+  char debugConfig[] = "Debug.cfg";
+  std::ifstream config(debugConfig);
+  if (config.good()) {
+    PLEXIL::readDebugConfigStream(config);
+    std::cout << "Read debug configuration file " << debugConfig << std::endl;
+  }
+
+  bool success = false;
+  {
+    std::unique_ptr<ExecApplication> app(makeExecApplication());
+    pugi::xml_document emptyConfig;
+    assertTrue_1(app->initialize(emptyConfig.document_element()));
+    assertTrue_1(app->startInterfaces());
+    assertTrue_1(app->run());
+
+    success = testCounting(*app)
+      && testCountingOff(*app);
+
+    app->stop();
+  }
+
+  plexilRunFinalizers();
+  std::cout << "Expression statistics test " << (success ? "succeeded" : "failed") << std::endl;
+  return (success ? 0 : 1);
+}
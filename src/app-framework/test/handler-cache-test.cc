@@ -0,0 +1,356 @@
+/* Copyright (c) 2006-2026, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+//
+// Module test for the handlers cached by AdapterConfiguration on
+// commands and lookup receivers.
+//
+
+#include "AdapterConfiguration.hh"
+
+#include "Command.hh"
+#include "CommandHandler.hh"
+#include "CommandImpl.hh"
+#include "Constant.hh"
+#include "DebugMessage.hh"
+#include "Error.hh"
+#include "LookupHandler.hh"
+#include "LookupReceiver.hh"
+#include "StateCacheEntry.hh"
+
+#include <fstream>
+#include <iostream>
+#include <memory>
+
+using namespace PLEXIL;
+
+class CountingCommandHandler final : public CommandHandler
+{
+public:
+  CountingCommandHandler()
+    : CommandHandler(),
+      executed(0),
+      aborted(0)
+  {
+  }
+
+  virtual ~CountingCommandHandler() = default;
+
+  virtual void executeCommand(Command * /* cmd */, AdapterExecInterface * /* intf */)
+  {
+    ++executed;
+  }
+
+  virtual void abortCommand(Command * /* cmd */, AdapterExecInterface * /* intf */)
+  {
+    ++aborted;
+  }
+
+  unsigned int executed;
+  unsigned int aborted;
+};
+
+class CountingLookupHandler final : public LookupHandler
+{
+public:
+  CountingLookupHandler()
+    : LookupHandler(),
+      lookups(0)
+  {
+  }
+
+  virtual ~CountingLookupHandler() = default;
+
+  virtual void lookupNow(State const & /* state */, LookupReceiver * /* rcvr */)
+  {
+    ++lookups;
+  }
+
+  unsigned int lookups;
+};
+
+// Caches like CommandImpl, and counts the handlers it is given
+class TestCommand final : public Command
+{
+public:
+  TestCommand(char const *name)
+    : Command(),
+      state(name),
+      args(),
+      handler(nullptr),
+      generation(0),
+      cached(0)
+  {
+  }
+
+  virtual ~TestCommand() = default;
+
+  virtual State const &getCommand() const
+  {
+    return state;
+  }
+
+  virtual std::string const &getName() const
+  {
+    return state.name();
+  }
+
+  virtual std::vector<Value> const &getArgValues() const
+  {
+    return args;
+  }
+
+  virtual bool isReturnExpected() const
+  {
+    return false;
+  }
+
+  virtual CommandHandler *getCommandHandler(unsigned int gen) const
+  {
+    return gen == generation ? handler : nullptr;
+  }
+
+  virtual void setCommandHandler(CommandHandler *h, unsigned int gen)
+  {
+    handler = h;
+    generation = gen;
+    ++cached;
+  }
+
+  virtual std::chrono::steady_clock::time_point getSendTime() const
+  {
+    return std::chrono::steady_clock::time_point();
+  }
+
+  virtual void setSendTime(std::chrono::steady_clock::time_point /* t */)
+  {
+  }
+
+  State state;
+  std::vector<Value> args;
+  CommandHandler *handler;
+  unsigned int generation;
+  unsigned int cached; // count of handlers found in the registry
+};
+
+// Caches like StateCacheEntry, and counts the handlers it is given
+class TestReceiver final : public LookupReceiver
+{
+public:
+  TestReceiver()
+    : LookupReceiver(),
+      handler(nullptr),
+      generation(0),
+      cached(0)
+  {
+  }
+
+  virtual ~TestReceiver() = default;
+
+  virtual void update(Value const & /* val */) {}
+  virtual void setUnknown() {}
+  virtual void update(Boolean /* val */) {}
+  virtual void update(Integer /* val */) {}
+  virtual void update(Real /* val */) {}
+  virtual void update(String const & /* val */) {}
+  virtual void update(char const * /* val */) {}
+  virtual void update(Boolean const /* ary */[], size_t /* size */) {}
+  virtual void update(Integer const /* ary */[], size_t /* size */) {}
+  virtual void update(Real const /* ary */[], size_t /* size */) {}
+  virtual void update(String const /* ary */[], size_t /* size */) {}
+
+  virtual LookupHandler *getLookupHandler(unsigned int gen) const
+  {
+    return gen == generation ? handler : nullptr;
+  }
+
+  virtual void setLookupHandler(LookupHandler *h, unsigned int gen)
+  {
+    handler = h;
+    generation = gen;
+    ++cached;
+  }
+
+  LookupHandler *handler;
+  unsigned int generation;
+  unsigned int cached; // count of handlers found in the registry
+};
+
+static bool testCommandCache(AdapterConfiguration *config)
+{
+  std::cout << "testCommandCache" << std::endl;
+  std::shared_ptr<CountingCommandHandler> first = std::make_shared<CountingCommandHandler>();
+  config->registerCommandHandler(first, "move");
+
+  // The first dispatch finds the handler; later ones use the cache
+  TestCommand cmd("move");
+  config->executeCommand(&cmd);
+  assertTrue_1(first->executed == 1);
+  assertTrue_1(cmd.cached == 1);
+  config->executeCommand(&cmd);
+  config->invokeAbort(&cmd);
+  assertTrue_1(first->executed == 2);
+  assertTrue_1(first->aborted == 1);
+  assertTrue_1(cmd.cached == 1);
+
+  // Replacing the handler for the command
+  std::shared_ptr<CountingCommandHandler> second = std::make_shared<CountingCommandHandler>();
+  config->registerCommandHandler(second, "move");
+  first.reset(); // now freed, so must not be called
+  config->executeCommand(&cmd);
+  assertTrue_1(second->executed == 1);
+  assertTrue_1(cmd.cached == 2);
+  config->executeCommand(&cmd);
+  assertTrue_1(second->executed == 2);
+  assertTrue_1(cmd.cached == 2);
+
+  // Registering a handler for another command
+  std::shared_ptr<CountingCommandHandler> other = std::make_shared<CountingCommandHandler>();
+  config->registerCommandHandler(other, std::vector<std::string>{"stop", "turn"});
+  config->executeCommand(&cmd);
+  assertTrue_1(second->executed == 3);
+  assertTrue_1(other->executed == 0);
+  assertTrue_1(cmd.cached == 3);
+
+  // Replacing the default handler, which an unregistered command uses
+  TestCommand unregistered("wait");
+  std::shared_ptr<CountingCommandHandler> dflt = std::make_shared<CountingCommandHandler>();
+  config->setDefaultCommandHandler(dflt);
+  config->executeCommand(&unregistered);
+  assertTrue_1(dflt->executed == 1);
+  std::shared_ptr<CountingCommandHandler> newDflt = std::make_shared<CountingCommandHandler>();
+  config->setDefaultCommandHandler(newDflt);
+  dflt.reset();
+  config->executeCommand(&unregistered);
+  assertTrue_1(newDflt->executed == 1);
+  assertTrue_1(unregistered.cached == 2);
+
+  // Registering a handler for the command that used the default
+  unsigned int waits = 0;
+  config->registerCommandHandlerFunction("wait",
+                                         [&waits](Command *, AdapterExecInterface *) -> void
+                                         { ++waits; });
+  config->executeCommand(&unregistered);
+  assertTrue_1(waits == 1);
+  assertTrue_1(newDflt->executed == 1);
+  return true;
+}
+
+static bool testLookupCache(AdapterConfiguration *config)
+{
+  std::cout << "testLookupCache" << std::endl;
+  std::shared_ptr<CountingLookupHandler> first = std::make_shared<CountingLookupHandler>();
+  config->registerLookupHandler(first, "position");
+
+  TestReceiver rcvr;
+  State const position("position");
+  config->lookupNow(position, &rcvr);
+  config->lookupNow(position, &rcvr);
+  assertTrue_1(first->lookups == 2);
+  assertTrue_1(rcvr.cached == 1);
+
+  // Replacing the handler for the state
+  std::shared_ptr<CountingLookupHandler> second = std::make_shared<CountingLookupHandler>();
+  config->registerLookupHandler(second, std::vector<std::string>{"position"});
+  first.reset();
+  config->lookupNow(position, &rcvr);
+  config->lookupNow(position, &rcvr);
+  assertTrue_1(second->lookups == 2);
+  assertTrue_1(rcvr.cached == 2);
+
+  // Replacing the default handler, which an unregistered state uses
+  TestReceiver unregistered;
+  State const speed("speed");
+  std::shared_ptr<CountingLookupHandler> dflt = std::make_shared<CountingLookupHandler>();
+  config->setDefaultLookupHandler(dflt);
+  config->lookupNow(speed, &unregistered);
+  assertTrue_1(dflt->lookups == 1);
+  std::shared_ptr<CountingLookupHandler> newDflt = std::make_shared<CountingLookupHandler>();
+  config->setDefaultLookupHandler(newDflt);
+  dflt.reset();
+  config->lookupNow(speed, &unregistered);
+  assertTrue_1(newDflt->lookups == 1);
+
+  // Registering a handler for the state that used the default
+  unsigned int speeds = 0;
+  config->registerLookupHandlerFunction("speed",
+                                        [&speeds](State const &, LookupReceiver *) -> void
+                                        { ++speeds; });
+  config->lookupNow(speed, &unregistered);
+  assertTrue_1(speeds == 1);
+  assertTrue_1(newDflt->lookups == 1);
+  assertTrue_1(unregistered.cached == 3);
+  return true;
+}
+
+// The caches in the Exec's own command and lookup receiver classes
+static bool testCacheGenerations()
+{
+  std::cout << "testCacheGenerations" << std::endl;
+  CountingCommandHandler cmdHandler;
+  CountingLookupHandler lookupHandler;
+
+  CommandImpl cmd("testCacheGenerations");
+  cmd.setNameExpr(new StringConstant("move"), true);
+  cmd.activate();
+  assertTrue_1(!cmd.getCommandHandler(0));
+  cmd.setCommandHandler(&cmdHandler, 1);
+  assertTrue_1(cmd.getCommandHandler(1) == &cmdHandler);
+  assertTrue_1(!cmd.getCommandHandler(2));
+  cmd.setCommandHandler(&cmdHandler, 2);
+  assertTrue_1(cmd.getCommandHandler(2) == &cmdHandler);
+  assertTrue_1(!cmd.getCommandHandler(1));
+  cmd.deactivate(nullptr);
+
+  std::unique_ptr<StateCacheEntry> entry(makeStateCacheEntry());
+  assertTrue_1(!entry->getLookupHandler(0));
+  entry->setLookupHandler(&lookupHandler, 1);
+  assertTrue_1(entry->getLookupHandler(1) == &lookupHandler);
+  assertTrue_1(!entry->getLookupHandler(2));
+  entry->setLookupHandler(&lookupHandler, 2);
+  assertTrue_1(entry->getLookupHandler(2) == &lookupHandler);
+  assertTrue_1(!entry->getLookupHandler(1));
+  return true;
+}
+
+int main()
+{
+  // Read Debug.cfg in current directory, if it exists
+  char debugConfig[] = "Debug.cfg";
+  std::ifstream config(debugConfig);
+  if (config.good()) {
+    PLEXIL::readDebugConfigStream(config);
+    std::cout << "Read debug configuration file " << debugConfig << std::endl;
+  }
+
+  std::unique_ptr<AdapterConfiguration> adapterConfig(makeAdapterConfiguration());
+  bool success = testCommandCache(adapterConfig.get())
+    && testLookupCache(adapterConfig.get())
+    && testCacheGenerations();
+
+  std::cout << "Handler cache test " << (success ? "succeeded" : "failed") << std::endl;
+  return (success ? 0 : 1);
+}
@@ -0,0 +1,242 @@
+/* Copyright (c) 2006-2026, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "SerializedInputQueue.hh"
+
+#include "DebugMessage.hh"
+#include "Error.hh"
+#include "QueueEntry.hh"
+#include "State.hh"
+
+#include <fstream>
+#include <iostream>
+
+using namespace PLEXIL;
+
+// Entries are never acted upon here, so any distinct address will do
+static int s_commands[2];
+static Command *const s_cmd0 = reinterpret_cast<Command *>(&s_commands[0]);
+static Command *const s_cmd1 = reinterpret_cast<Command *>(&s_commands[1]);
+
+static void putLookup(InputQueue &q, char const *name, Integer val)
+{
+  QueueEntry *entry = q.allocate();
+  entry->initForLookup(State(name), Value(val));
+  q.put(entry);
+}
+
+static void putAck(InputQueue &q, Command *cmd, CommandHandleValue val)
+{
+  QueueEntry *entry = q.allocate();
+  entry->initForCommandAck(cmd, val);
+  q.put(entry);
+}
+
+static void putReturn(InputQueue &q, Command *cmd, Integer val)
+{
+  QueueEntry *entry = q.allocate();
+  entry->initForCommandReturn(cmd, Value(val));
+  q.put(entry);
+}
+
+static void putMark(InputQueue &q, unsigned int seq)
+{
+  QueueEntry *entry = q.allocate();
+  entry->initForMark(seq);
+  q.put(entry);
+}
+
+// Take the next entry, check its type, and recycle it
+static bool expectEntry(InputQueue &q, QueueEntryType type, QueueEntry *copy = nullptr)
+{
+  QueueEntry *entry = q.get();
+  if (!entry) {
+    std::cout << "  expected entry of type " << type << ", got batch end" << std::endl;
+    return false;
+  }
+  if (entry->type != type) {
+    std::cout << "  expected entry of type " << type << ", got " << entry->type << std::endl;
+    q.release(entry);
+    return false;
+  }
+  if (copy) {
+    copy->command = entry->command;
+    copy->value = entry->value;
+  }
+  q.release(entry);
+  return true;
+}
+
+static bool testFifo()
+{
+  std::cout << "testFifo" << std::endl;
+  SerializedInputQueue q;
+  assertTrue_1(q.isEmpty());
+  assertTrue_1(!q.get());
+
+  QueueEntry copy;
+  putLookup(q, "a", 1);
+  putMark(q, 1);
+  putLookup(q, "a", 2);
+  assertTrue_1(!q.isEmpty());
+  assertTrue_1(expectEntry(q, Q_LOOKUP, &copy));
+  assertTrue_1(copy.value == Value((Integer) 1));
+  assertTrue_1(expectEntry(q, Q_MARK));
+  assertTrue_1(expectEntry(q, Q_LOOKUP, &copy));
+  assertTrue_1(copy.value == Value((Integer) 2));
+  assertTrue_1(!q.get());
+  assertTrue_1(q.isEmpty());
+
+  // Without priority lanes, responses keep their place
+  putLookup(q, "a", 3);
+  putAck(q, s_cmd0, COMMAND_SUCCESS);
+  putLookup(q, "a", 4);
+  assertTrue_1(expectEntry(q, Q_LOOKUP, &copy));
+  assertTrue_1(copy.value == Value((Integer) 3));
+  assertTrue_1(expectEntry(q, Q_COMMAND_ACK));
+  assertTrue_1(expectEntry(q, Q_LOOKUP, &copy));
+  assertTrue_1(copy.value == Value((Integer) 4));
+  assertTrue_1(!q.get());
+  assertTrue_1(q.isEmpty());
+  return true;
+}
+
+static bool testPriority()
+{
+  std::cout << "testPriority" << std::endl;
+  SerializedInputQueue q(true);
+  QueueEntry copy;
+
+  // Telemetry, then a mark, then command responses
+  for (Integer i = 0; i < 100; ++i)
+    putLookup(q, "telemetry", i);
+  putMark(q, 1);
+  putReturn(q, s_cmd0, 42);
+  putAck(q, s_cmd0, COMMAND_SUCCESS);
+  putAck(q, s_cmd1, COMMAND_SENT_TO_SYSTEM);
+
+  // Responses come first, in the order sent
+  assertTrue_1(expectEntry(q, Q_COMMAND_RETURN, &copy));
+  assertTrue_1(copy.command == s_cmd0);
+  assertTrue_1(expectEntry(q, Q_COMMAND_ACK, &copy));
+  assertTrue_1(copy.command == s_cmd0);
+  assertTrue_1(expectEntry(q, Q_COMMAND_ACK, &copy));
+  assertTrue_1(copy.command == s_cmd1);
+
+  // Then the batch ends so the Exec can step
+  assertTrue_1(!q.get());
+  assertTrue_1(!q.isEmpty());
+
+  // Then the telemetry, followed by the mark
+  for (Integer i = 0; i < 100; ++i) {
+    assertTrue_1(expectEntry(q, Q_LOOKUP, &copy));
+    assertTrue_1(copy.value == Value(i));
+  }
+  // A late response still goes ahead of the mark
+  putAck(q, s_cmd1, COMMAND_SUCCESS);
+  assertTrue_1(expectEntry(q, Q_COMMAND_ACK));
+  assertTrue_1(!q.get());
+  assertTrue_1(expectEntry(q, Q_MARK));
+  assertTrue_1(!q.get());
+  assertTrue_1(q.isEmpty());
+
+  // Responses alone do not end a batch early
+  putAck(q, s_cmd0, COMMAND_SUCCESS);
+  assertTrue_1(expectEntry(q, Q_COMMAND_ACK));
+  assertTrue_1(!q.get());
+  assertTrue_1(q.isEmpty());
+  return true;
+}
+
+static bool testCoalescing()
+{
+  std::cout << "testCoalescing" << std::endl;
+  QueueEntry copy;
+
+  {
+    // Off by default
+    SerializedInputQueue q;
+    putLookup(q, "a", 1);
+    putLookup(q, "a", 2);
+    assertTrue_1(expectEntry(q, Q_LOOKUP));
+    assertTrue_1(expectEntry(q, Q_LOOKUP));
+    assertTrue_1(q.isEmpty());
+  }
+
+  SerializedInputQueue q(false, true);
+  putLookup(q, "a", 1);
+  putLookup(q, "b", 10);
+  putLookup(q, "a", 2);
+  putMark(q, 1);
+  putLookup(q, "a", 3);
+  putLookup(q, "b", 11);
+
+  // The latest value for each state, in the place of the first
+  assertTrue_1(expectEntry(q, Q_LOOKUP, &copy));
+  assertTrue_1(copy.value == Value((Integer) 3));
+  assertTrue_1(expectEntry(q, Q_LOOKUP, &copy));
+  assertTrue_1(copy.value == Value((Integer) 11));
+  assertTrue_1(expectEntry(q, Q_MARK));
+  assertTrue_1(!q.get());
+  assertTrue_1(q.isEmpty());
+
+  // A value arriving after its state was taken is queued anew
+  putLookup(q, "a", 4);
+  assertTrue_1(expectEntry(q, Q_LOOKUP, &copy));
+  putLookup(q, "a", 5);
+  putLookup(q, "a", 6);
+  assertTrue_1(expectEntry(q, Q_LOOKUP, &copy));
+  assertTrue_1(copy.value == Value((Integer) 6));
+  assertTrue_1(!q.get());
+
+  // Flush forgets the pending values
+  putLookup(q, "a", 7);
+  q.flush();
+  assertTrue_1(q.isEmpty());
+  putLookup(q, "a", 8);
+  assertTrue_1(expectEntry(q, Q_LOOKUP, &copy));
+  assertTrue_1(copy.value == Value((Integer) 8));
+  assertTrue_1(q.isEmpty());
+  return true;
+}
+
+int main()
+{
+  // Read Debug.cfg in current directory, if it exists
+  char debugConfig[] = "Debug.cfg";
+  std::ifstream config(debugConfig);
+  if (config.good()) {
+    PLEXIL::readDebugConfigStream(config);
+    std::cout << "Read debug configuration file " << debugConfig << std::endl;
+  }
+
+  bool success = testFifo()
+    && testPriority()
+    && testCoalescing();
+
+  std::cout << "Input queue test " << (success ? "succeeded" : "failed") << std::endl;
+  return (success ? 0 : 1);
+}
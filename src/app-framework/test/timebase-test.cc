@@ -157,6 +157,68 @@ static bool testTimebaseDeadlines(std::string const &name)
   return false;
 }
 
+static bool testTimebaseSlack(std::string const &name)
+{
+  std::cout << "testTimebaseSlack: Testing " << name << std::endl;
+  try {
+    ThreadSemaphore testSem;
+    std::unique_ptr<Timebase> tb(TimebaseFactory::get(name)->create(wakeup, (void *)  &testSem));
+    assertTrue_1(tb->getSlack() == 0);
+    assertTrue_1(tb->getMergedWakeupCount() == 0);
+
+    tb->setSlack(USEC_PER_SEC / 5);
+    assertTrue_1(tb->getSlack() == USEC_PER_SEC / 5);
+
+    // First deadline is deferred by the slack
+    tb->start();
+    double startTime = tb->getTime();
+    tb->setTimer(startTime + 1.0);
+    assertTrue_1(eq_within_epsilon(tb->getNextWakeup(), startTime + 1.2));
+    assertTrue_1(tb->getMergedWakeupCount() == 0);
+
+    // Later deadline within the slack is merged
+    tb->setTimer(startTime + 1.1);
+    assertTrue_1(eq_within_epsilon(tb->getNextWakeup(), startTime + 1.2));
+    assertTrue_1(tb->getMergedWakeupCount() == 1);
+    assertTrue_1(Timebase::queryMergedWakeups() == 1);
+
+    // Earlier deadline within the slack moves the wakeup earlier
+    tb->setTimer(startTime + 0.9);
+    assertTrue_1(eq_within_epsilon(tb->getNextWakeup(), startTime + 1.1));
+    assertTrue_1(tb->getMergedWakeupCount() == 2);
+
+    // Deadline outside the slack replaces the wakeup
+    tb->setTimer(startTime + 0.5);
+    assertTrue_1(eq_within_epsilon(tb->getNextWakeup(), startTime + 0.7));
+    assertTrue_1(tb->getMergedWakeupCount() == 2);
+
+    // Wait for wakeup 
+    testSem.wait();
+    double actualTime = tb->getTime();
+    std::cout << "\nWakeup scheduled for "
+              << std::fixed << std::setprecision(6) << startTime + 0.7
+              << ", received at " << actualTime << std::endl;
+    // Should be strictly >=, but macOS can wake up early
+    assertTrue_1(geq_within_epsilon(actualTime, startTime + 0.7));
+
+    // No pending wakeup, so nothing to merge with
+    tb->setTimer(actualTime + 0.1);
+    assertTrue_1(eq_within_epsilon(tb->getNextWakeup(), actualTime + 0.3));
+    assertTrue_1(tb->getMergedWakeupCount() == 2);
+    testSem.wait();
+
+    tb->stop();
+
+    std::cout << "testTimebaseSlack: " << name << " passed\n" << std::endl;
+    return true;
+  } catch (Error const &e) {
+    std::cerr << "*** Test error: " << e.what() << std::endl;
+  }
+
+  std::cout << "\ntestTimebaseSlack: " << name << " failed\n" << std::endl;
+  return false;
+}
+
 static bool testTimebaseTick(std::string const &name)
 {
   std::cout << "testTimebaseTick: Testing " << name << std::endl;
@@ -240,6 +302,11 @@ int main(int argc, char *argv[])
     success = success && testTimebaseDeadlines(name);
   }
 
+  std::cout << "Testing deadline slack" << std::endl;
+  for (std::string const &name : timebaseNames) {
+    success = success && testTimebaseSlack(name);
+  }
+
   std::cout << "Testing tick timers" << std::endl;
   for (std::string const &name : timebaseNames) {
     success = success && testTimebaseTick(name);
@@ -27,6 +27,14 @@
 //
 // Agenda implementation
 //
+// A hierarchical timer wheel, after Varghese & Lauck. Level 0 holds
+// one slot per tick for the next WHEEL_SIZE ticks; each higher level
+// holds one slot per WHEEL_SIZE ticks of the level below. As time
+// advances, the slots of the higher levels are cascaded down into the
+// lower ones. Scheduling a response is constant time regardless of how
+// many are pending, and all the responses due in a tick are released
+// in one batch.
+//
 
 #include "Agenda.hh"
 
@@ -34,12 +42,46 @@
 
 #include "timeval-utils.hh"
 
-#include <deque>
+#include <algorithm>
 #include <memory>
 #include <mutex>
 
-typedef std::pair<timeval, std::unique_ptr<ResponseMessage> > AgendaEntry;
-typedef std::deque<AgendaEntry> AgendaQueue;
+#include "plexil-stdint.h"
+
+namespace
+{
+  constexpr unsigned int WHEEL_BITS = 8;
+  constexpr size_t WHEEL_SIZE = 1 << WHEEL_BITS;
+  constexpr uint64_t WHEEL_MASK = WHEEL_SIZE - 1;
+  constexpr unsigned int WHEEL_LEVELS = 4;
+
+  struct AgendaEntry
+  {
+    timeval time;    // relative to the agenda's base time
+    uint64_t tick;   // time in ticks
+    uint64_t seq;    // order of scheduling, to break ties
+    std::unique_ptr<ResponseMessage> msg;
+  };
+
+  typedef std::vector<AgendaEntry> AgendaSlot;
+
+  bool entryBefore(AgendaEntry const &a, AgendaEntry const &b)
+  {
+    if (a.time < b.time)
+      return true;
+    if (b.time < a.time)
+      return false;
+    return a.seq < b.seq;
+  }
+
+  uint64_t timevalToTick(timeval const &tym)
+  {
+    int64_t usec = (int64_t) tym.tv_sec * 1000000 + tym.tv_usec;
+    if (usec < 0)
+      return 0;
+    return (uint64_t) usec / AGENDA_TICK_USEC;
+  }
+}
 
 class AgendaImpl : public Agenda
 {
@@ -50,12 +92,32 @@ private:
   // Member variables
   //
 
-  AgendaQueue m_queue;
+  AgendaSlot m_wheel[WHEEL_LEVELS][WHEEL_SIZE];
+  // Earliest entry in each slot of the levels above 0
+  timeval m_slotMin[WHEEL_LEVELS][WHEEL_SIZE];
+  // Entries too far in the future for the wheel
+  AgendaSlot m_overflow;
+  size_t m_levelCount[WHEEL_LEVELS];
+  timeval m_base;
+  uint64_t m_current; // the tick of the level 0 slot now being served
+  uint64_t m_seq;
+  size_t m_size;
+  mutable timeval m_next; // absolute time of earliest entry
+  mutable bool m_nextValid;
   std::unique_ptr<std::mutex> m_mutex;
 
   AgendaImpl()
-    : m_mutex(new std::mutex())
+    : m_overflow(),
+      m_base({0, 0}),
+      m_current(0),
+      m_seq(0),
+      m_size(0),
+      m_next({0, 0}),
+      m_nextValid(true),
+      m_mutex(new std::mutex())
   {
+    for (unsigned int l = 0; l < WHEEL_LEVELS; ++l)
+      m_levelCount[l] = 0;
   }
 
 public:
@@ -64,30 +126,31 @@ public:
   {
     std::lock_guard<std::mutex> g(*m_mutex);
     // Delete all the ResponseMessage instances
-    m_queue.clear();
+    for (unsigned int l = 0; l < WHEEL_LEVELS; ++l)
+      for (size_t i = 0; i < WHEEL_SIZE; ++i)
+        m_wheel[l][i].clear();
+    m_overflow.clear();
   }
 
   virtual size_t size() const
   {
     std::lock_guard<std::mutex> g(*m_mutex);
-    return m_queue.size();
+    return m_size;
   }
 
   virtual bool empty() const
   {
     std::lock_guard<std::mutex> g(*m_mutex);
-    return m_queue.empty();
+    return !m_size;
   }
 
-  // Adds its parameter to every ResponseMessage in the queue.
+  // Responses scheduled before the start time are relative to it;
+  // moving the base time moves them all at once.
   virtual void setSimulatorStartTime(timeval const &tym)
   {
     std::lock_guard<std::mutex> g(*m_mutex);
-    // If queue was sorted on entry, it'll remain sorted at exit.
-    for (AgendaQueue::iterator it = m_queue.begin();
-         it != m_queue.end();
-         it++)
-      it->first = it->first + tym;
+    m_base = m_base + tym;
+    m_nextValid = false;
   }
     
   // Only valid when not empty.
@@ -95,30 +158,202 @@ public:
   {
     static struct timeval sl_zero = {0, 0};
     std::lock_guard<std::mutex> g(*m_mutex);
-    if (m_queue.empty())
+    if (!m_size)
       return sl_zero;
-    return m_queue.front().first;
+    if (!m_nextValid) {
+      m_next = m_base + earliestTime();
+      m_nextValid = true;
+    }
+    return m_next;
   }
 
   virtual ResponseMessage *popResponse()
   {
     std::lock_guard<std::mutex> g(*m_mutex);
-    if (m_queue.empty())
+    if (!m_size)
       return nullptr;
 
-    ResponseMessage *msg = m_queue.front().second.release();
-    m_queue.pop_front();
+    // Bring the earliest entry into the current level 0 slot
+    AgendaSlot due;
+    advanceTo(timevalToTick(earliestTime()), due); // nothing can be due before it
+    AgendaSlot &slot = m_wheel[0][m_current & WHEEL_MASK];
+    AgendaSlot::iterator it = std::min_element(slot.begin(), slot.end(), entryBefore);
+    ResponseMessage *msg = it->msg.release();
+    slot.erase(it);
+    --m_levelCount[0];
+    --m_size;
+    m_nextValid = false;
     return msg;
   }
+
+  virtual size_t popResponses(timeval const &now,
+                              std::vector<ScheduledResponse> &result)
+  {
+    std::lock_guard<std::mutex> g(*m_mutex);
+    if (!m_size)
+      return 0;
+
+    timeval relNow = now - m_base;
+    AgendaSlot due;
+    advanceTo(timevalToTick(relNow), due);
+
+    // Take whatever in the current slot is due
+    AgendaSlot &slot = m_wheel[0][m_current & WHEEL_MASK];
+    AgendaSlot::iterator keep = slot.begin();
+    for (AgendaSlot::iterator it = slot.begin(); it != slot.end(); ++it) {
+      if (relNow < it->time) {
+        if (keep != it)
+          *keep = std::move(*it);
+        ++keep;
+      }
+      else
+        due.push_back(std::move(*it));
+    }
+    slot.erase(keep, slot.end());
+
+    if (due.empty())
+      return 0;
+    m_levelCount[0] -= due.size();
+    m_size -= due.size();
+    m_nextValid = false;
+
+    std::sort(due.begin(), due.end(), entryBefore);
+    result.reserve(result.size() + due.size());
+    for (AgendaEntry &entry : due)
+      result.emplace_back(m_base + entry.time, entry.msg.release());
+    return due.size();
+  }
   
-  // Insert into list in earliest-first order.
   virtual void scheduleResponse(timeval tym, ResponseMessage *msg)
   {
     std::lock_guard<std::mutex> g(*m_mutex);
-    AgendaQueue::iterator it = m_queue.begin();
-    while (it != m_queue.end() && it->first < tym)
-      ++it;
-    m_queue.emplace(it, AgendaEntry(tym, msg));
+    timeval rel = tym - m_base;
+    if (m_nextValid && (!m_size || tym < m_next))
+      m_next = tym;
+    insert(AgendaEntry({rel, timevalToTick(rel), m_seq++,
+                        std::unique_ptr<ResponseMessage>(msg)}));
+    ++m_size;
+  }
+
+private:
+
+  //
+  // Internal helpers; caller must hold the mutex.
+  //
+
+  void insert(AgendaEntry &&entry)
+  {
+    // Overdue entries go in the current slot
+    uint64_t tick = std::max(entry.tick, m_current);
+    uint64_t delta = tick - m_current;
+    for (unsigned int l = 0; l < WHEEL_LEVELS; ++l) {
+      if (delta < ((uint64_t) 1 << (WHEEL_BITS * (l + 1)))) {
+        size_t idx = (tick >> (WHEEL_BITS * l)) & WHEEL_MASK;
+        AgendaSlot &slot = m_wheel[l][idx];
+        if (l && (slot.empty() || entry.time < m_slotMin[l][idx]))
+          m_slotMin[l][idx] = entry.time;
+        slot.push_back(std::move(entry));
+        ++m_levelCount[l];
+        return;
+      }
+    }
+    m_overflow.push_back(std::move(entry));
+  }
+
+  // Redistribute the current slot of the given level to the levels below.
+  void cascade(unsigned int level)
+  {
+    AgendaSlot entries;
+    entries.swap(m_wheel[level][(m_current >> (WHEEL_BITS * level)) & WHEEL_MASK]);
+    m_levelCount[level] -= entries.size();
+    for (AgendaEntry &entry : entries)
+      insert(std::move(entry));
+  }
+
+  // Move on to the next tick.
+  void advanceTick()
+  {
+    ++m_current;
+    for (unsigned int l = 1; l < WHEEL_LEVELS; ++l) {
+      if (m_current & (((uint64_t) 1 << (WHEEL_BITS * l)) - 1))
+        return;
+      cascade(l);
+    }
+    // Wrapped the whole wheel
+    if (!m_overflow.empty()) {
+      AgendaSlot entries;
+      entries.swap(m_overflow);
+      for (AgendaEntry &entry : entries)
+        insert(std::move(entry));
+    }
+  }
+
+  // Advance the wheel to the given tick, moving every entry in the
+  // level 0 slots passed over to the due vector.
+  void advanceTo(uint64_t target, AgendaSlot &due)
+  {
+    while (m_current < target) {
+      AgendaSlot &slot = m_wheel[0][m_current & WHEEL_MASK];
+      if (!slot.empty()) {
+        for (AgendaEntry &entry : slot)
+          due.push_back(std::move(entry));
+        slot.clear();
+      }
+      if (m_size == due.size()) {
+        // Nothing left on the wheel
+        m_current = target;
+        return;
+      }
+      if (m_levelCount[0] == due.size()) {
+        // Levels 0 through l - 1 are empty, so nothing can cascade
+        // until the end of the current slot of level l; skip to it
+        unsigned int l = 1;
+        while (l < WHEEL_LEVELS && !m_levelCount[l])
+          ++l;
+        uint64_t lastTick = m_current | (((uint64_t) 1 << (WHEEL_BITS * l)) - 1);
+        if (target <= lastTick) {
+          m_current = target;
+          return;
+        }
+        m_current = lastTick;
+      }
+      advanceTick();
+    }
+  }
+
+  // Relative time of the earliest entry. Agenda must not be empty.
+  timeval earliestTime() const
+  {
+    bool found = false;
+    timeval result = {0, 0};
+
+    // Level 0 slots are in tick order starting from the current one
+    for (size_t i = 0; i < WHEEL_SIZE; ++i) {
+      AgendaSlot const &slot = m_wheel[0][(m_current + i) & WHEEL_MASK];
+      if (!slot.empty()) {
+        result = std::min_element(slot.begin(), slot.end(), entryBefore)->time;
+        found = true;
+        break;
+      }
+    }
+    for (unsigned int l = 1; l < WHEEL_LEVELS; ++l) {
+      if (!m_levelCount[l])
+        continue;
+      for (size_t i = 0; i < WHEEL_SIZE; ++i) {
+        if (!m_wheel[l][i].empty()
+            && (!found || m_slotMin[l][i] < result)) {
+          result = m_slotMin[l][i];
+          found = true;
+        }
+      }
+    }
+    for (AgendaEntry const &entry : m_overflow) {
+      if (!found || entry.time < result) {
+        result = entry.time;
+        found = true;
+      }
+    }
+    return result;
   }
   
 };
@@ -41,12 +41,24 @@
 #include <stddef.h>
 #endif 
 
+#include <utility> // std::pair
+#include <vector>
+
 /**
  * @class Agenda The schedule of simulator responses to send.
+ * @note The implementation is a hierarchical timer wheel with
+ *       AGENDA_TICK_USEC resolution. Responses due in the same tick
+ *       are released together by popResponses().
  */
 
+//! Resolution of the agenda, in microseconds.
+constexpr long AGENDA_TICK_USEC = 1000;
+
 struct ResponseMessage;
 
+//! A response removed from the agenda, with the time it was scheduled for.
+typedef std::pair<timeval, ResponseMessage *> ScheduledResponse;
+
 class Agenda
 {
 public:
@@ -55,6 +67,17 @@ public:
   virtual void setSimulatorStartTime(timeval const &tym) = 0;
   virtual timeval const &nextResponseTime() const = 0;
   virtual ResponseMessage *popResponse() = 0;
+
+  /**
+   * @brief Remove every response scheduled at or before the given time.
+   * @param now The current time.
+   * @param result Vector to which the responses are appended, earliest first.
+   * @return The number of responses appended.
+   * @note The caller is responsible for the returned responses.
+   */
+  virtual size_t popResponses(timeval const &now,
+                              std::vector<ScheduledResponse> &result) = 0;
+
   virtual void scheduleResponse(timeval tym, ResponseMessage *msg) = 0;
 
   virtual ~Agenda() = default;
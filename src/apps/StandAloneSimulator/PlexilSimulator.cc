@@ -49,6 +49,7 @@ static void usage(std::ostream &stream = std::cout)
          << "  -t <telemetry script file>\n"
          << "  -central <host>:<port>         (default is localhost:1381)\n"
          << "  -d <debug config file>         (default is SimDebug.cfg)\n"
+         << "  -high-rate                     Run on a fixed tick and report latency statistics\n"
          << std::endl;
 }
 
@@ -60,6 +61,7 @@ int main(int argc, char** argv)
   std::string telemetryScriptName("");
   std::string centralhost("localhost:1381");
   std::string debugConfig("SimDebug.cfg");
+  bool highRate = false;
 
   //
   // Parse command arguments
@@ -78,6 +80,8 @@ int main(int argc, char** argv)
         centralhost = argv[++i];
       else if (strcmp(argv[i], "-n") == 0)
         agentName = argv[++i];
+      else if (strcmp(argv[i], "-high-rate") == 0)
+        highRate = true;
       else if (strcmp(argv[i], "-t") == 0) {
         telemetryScriptName = argv[++i];
         std::cout << "WARNING: The '-t' option is deprecated.\n\
@@ -156,6 +160,7 @@ at the top of the script."
 
   // Simulator instance is responsible for deleting map, agenda
   std::unique_ptr<Simulator> mySimulator(makeSimulator(plexilRelay.get(), mgrMap, agenda));
+  mySimulator->setHighRate(highRate);
 
   // Run until interrupted
   mySimulator->simulatorTopLevel();
@@ -38,11 +38,14 @@
 
 #include "Debug.hh"
 #include "Error.hh"
+#include "LatencyHistogram.hh"
 #include "timeval-utils.hh"
 
 #include <iomanip>
+#include <iostream>
 #include <memory>
 #include <thread>
+#include <vector>
 
 #if defined(HAVE_CERRNO)
 #include <cerrno>
@@ -50,8 +53,26 @@
 #include <errno.h>
 #endif
 
+using PLEXIL::LatencyHistogram;
 using PLEXIL::Value;
 
+//! Print a one-line summary of the response latencies.
+static void reportLatencies(std::ostream &str, LatencyHistogram const &latencies)
+{
+  uint64_t count = latencies.count();
+  if (!count) {
+    str << "no samples";
+    return;
+  }
+  str << count << " samples, latency usec: min " << latencies.min()
+      << " mean " << latencies.sum() / count
+      << " p50 " << latencies.valueAtQuantile(0.5)
+      << " p90 " << latencies.valueAtQuantile(0.9)
+      << " p99 " << latencies.valueAtQuantile(0.99)
+      << " p99.9 " << latencies.valueAtQuantile(0.999)
+      << " max " << latencies.max();
+}
+
 class SimulatorImpl : public Simulator
 {
 private:
@@ -69,8 +90,10 @@ private:
   std::unique_ptr<Agenda> m_Agenda;
   std::unique_ptr<ResponseManagerMap> m_CmdToRespMgr;
   std::thread m_SimulatorThread;
+  LatencyHistogram m_Latencies;
   bool m_Started;
   bool m_Stop;
+  bool m_HighRate;
 
 public:
 
@@ -81,8 +104,10 @@ public:
       m_Agenda(agenda),
       m_CmdToRespMgr(map),
       m_SimulatorThread(),
+      m_Latencies(),
       m_Started(false),
-      m_Stop(false)
+      m_Stop(false),
+      m_HighRate(false)
   {
     m_CommRelay->registerSimulator(this);
   }
@@ -118,6 +143,13 @@ public:
     debugMsg("Simulator:stop", " succeeded");
   }
 
+  virtual void setHighRate(bool highRate)
+  {
+    assertTrue_2(!m_Started,
+                 "StandAloneSimulator::setHighRate: simulator already running");
+    m_HighRate = highRate;
+  }
+
   // *** BEWARE ***
   // This can be called directly from main() or run as a thread;
   // see examples/robosim/RoboSimSimulator/RoboSimSimulator.cc
@@ -140,6 +172,11 @@ public:
 
     // Schedule initial telemetry responses
     m_Agenda->setSimulatorStartTime(now);
+
+    if (m_HighRate) {
+      highRateTopLevel();
+      return;
+    }
   
     //
     // Set the timer for the first event, if any
@@ -201,7 +238,7 @@ public:
     debugMsg("Simulator:scheduleResponseForCommand",
              " for : " << command);
     bool valid = constructNextResponse(command, uniqueId, time, MSG_COMMAND);
-    if (valid)
+    if (valid && !m_HighRate) // high rate loop will pick it up at the next tick
       scheduleNextResponse(time);
     else
       debugMsg("Simulator:scheduleResponseForCommand",
@@ -318,28 +355,7 @@ private:
     //
     // Send every message with a scheduled time earlier than now.
     //
-    while (!m_Agenda->empty()) {
-      timeval const &responseTime = m_Agenda->nextResponseTime();
-      debugMsg("Simulator:handleWakeUp", " next response at "
-               << responseTime.tv_sec << '.' << responseTime.tv_usec);
-      if (responseTime > now)
-        break;
-    
-      ResponseMessage *resp = m_Agenda->popResponse();
-      checkError(resp,
-                 "Simulator:handleWakeup: Agenda::popResponse returned null");
-      if (resp->getMessageType() == MSG_TELEMETRY) {
-        // Store the value for subsequent LookupNow requests
-        m_LookupNowValueMap[resp->getName()] = resp->getValue();
-      }
-      debugMsg("Simulator:handleWakeUp", " sending response "
-               << resp->getName() << " value " << resp->getValue()
-               << " scheduled for "
-               << responseTime.tv_sec << '.' << responseTime.tv_usec);
-
-      m_CommRelay->sendResponse(resp); // comm relay will delete resp
-      debugMsg("Simulator:handleWakeUp", " Sent response");
-    }
+    dispatchResponses(now);
 
     debugMsg("Simulator:handleWakeUp", " done sending responses for now");
 
@@ -357,6 +373,98 @@ private:
     debugMsg("Simulator:handleWakeUp", " completed");
   }
 
+  /**
+   * @brief Send every response due at or before the given time, in one batch.
+   * @param now The current time.
+   */
+  void dispatchResponses(timeval const &now)
+  {
+    std::vector<ScheduledResponse> dueResponses;
+    if (!m_Agenda->popResponses(now, dueResponses))
+      return;
+
+    debugMsg("Simulator:dispatchResponses",
+             " sending " << dueResponses.size() << " responses");
+    for (ScheduledResponse const &due : dueResponses) {
+      ResponseMessage *resp = due.second;
+      if (resp->getMessageType() == MSG_TELEMETRY) {
+        // Store the value for subsequent LookupNow requests
+        m_LookupNowValueMap[resp->getName()] = resp->getValue();
+      }
+      debugMsg("Simulator:dispatchResponses", " sending response "
+               << resp->getName() << " value " << resp->getValue()
+               << " scheduled for "
+               << due.first.tv_sec << '.' << due.first.tv_usec);
+
+      m_CommRelay->sendResponse(resp); // comm relay will delete resp
+      if (m_HighRate) {
+        timeval sent;
+        gettimeofday(&sent, nullptr);
+        timeval latency = sent - due.first;
+        int64_t usec = (int64_t) latency.tv_sec * 1000000 + latency.tv_usec;
+        m_Latencies.record(usec < 0 ? 0 : (uint64_t) usec);
+      }
+    }
+  }
+
+  /**
+   * @brief Top level loop for high-rate mode.
+   * @note Wakes at least once per agenda tick, sends everything due,
+   *       and never arms an interval timer.
+   */
+  void highRateTopLevel()
+  {
+    timeval const tick = {0, AGENDA_TICK_USEC};
+    timeval start;
+    gettimeofday(&start, nullptr);
+    m_Latencies.reset();
+
+    while (!m_Stop) {
+      timeval now;
+      gettimeofday(&now, nullptr);
+      timeval wakeup = now + tick;
+      if (!m_Agenda->empty()) {
+        timeval next = m_Agenda->nextResponseTime();
+        if (next < wakeup)
+          wakeup = next;
+      }
+
+      int waitResult = m_TimingService.waitUntil(wakeup);
+      if (waitResult != 0) {
+        // received some other signal
+        debugMsg("Simulator:highRateTopLevel",
+                 " timing service received signal " << waitResult << ", exiting");
+        break;
+      }
+
+      gettimeofday(&now, nullptr);
+      dispatchResponses(now);
+    }
+
+    timeval end;
+    gettimeofday(&end, nullptr);
+    double elapsed = timevalToDouble(end - start);
+    std::cout << "Simulator: sent " << m_Latencies.count() << " responses in "
+              << std::setiosflags(std::ios_base::fixed) << std::setprecision(3)
+              << elapsed << " seconds";
+    if (elapsed > 0)
+      std::cout << " (" << std::setprecision(0)
+                << m_Latencies.count() / elapsed << " per second)";
+    std::cout << "\nSimulator: ";
+    reportLatencies(std::cout, m_Latencies);
+    std::cout << std::endl;
+
+    //
+    // Clean up
+    //
+    m_TimingService.restoreSignalHandling();
+
+    m_Stop = false;
+    m_Started = false;
+
+    debugMsg("Simulator:highRateTopLevel", " cleaning up");
+  }
+
 };
 
 Simulator *makeSimulator(CommRelayBase* commRelay, ResponseManagerMap *map, Agenda *agenda)
@@ -50,6 +50,15 @@ public:
    */
   virtual void stop() = 0;
 
+  /**
+   * @brief Select high-rate mode.
+   * @param highRate If true, the top level loop runs on a fixed
+   *        AGENDA_TICK_USEC tick instead of arming a timer for each
+   *        response, and reports dispatch latency statistics on exit.
+   * @note Call before start() or simulatorTopLevel().
+   */
+  virtual void setHighRate(bool highRate) = 0;
+
   /**
    * @brief The simulator top level loop.  
    * @note Call only after reading all scripts.
@@ -61,11 +61,20 @@ TimingService::~TimingService()
 	restoreSignalHandling();
 }
 
+//! Last non-timer signal caught by the handler below, or 0.
+static volatile sig_atomic_t s_caughtSignal = 0;
+
 /**
- * @brief Dummy signal handler function for signals we process.
- * @note This should never be called!
+ * @brief Signal handler function for signals we process.
+ * @note Only called when the signal is delivered to a thread which
+ *       has not blocked it, e.g. one spawned before the mask was set.
+ *       Records the signal so that waitUntil() can report it.
  */
-void dummySignalHandler(int /* signo */) {}
+void dummySignalHandler(int signo)
+{
+  if (signo != SIGALRM)
+	s_caughtSignal = signo;
+}
 
 /**
  * @brief Set the process's signal mask and signal actions for timer use.
@@ -267,3 +276,45 @@ int TimingService::wait()
   debugMsg("TimingService:wait", " received non-timer signal " << theSignal);
   return theSignal;
 }
+
+int TimingService::waitUntil(const timeval& time)
+{
+  assertTrueMsg(m_nBlockedSignals != 0,
+				"TimingService::waitUntil: Fatal error: signal handling has not been initialized");
+
+#ifdef HAVE_SIGTIMEDWAIT
+  timeval now;
+  gettimeofday(&now, nullptr);
+  timeval delay = time - now;
+  timespec timeout = {0, 0};
+  if (delay.tv_sec > 0 || (delay.tv_sec == 0 && delay.tv_usec > 0)) {
+	timeout.tv_sec = delay.tv_sec;
+	timeout.tv_nsec = delay.tv_usec * 1000;
+  }
+
+  // With a zero timeout, simply polls for pending signals
+  int theSignal = sigtimedwait(&m_sigset, nullptr, &timeout);
+  if (theSignal < 0) {
+	assertTrueMsg(errno == EAGAIN || errno == EINTR,
+				  "TimingService::waitUntil: Fatal error: sigtimedwait failed, errno = " << errno);
+	// Check for a signal caught by another thread
+	theSignal = s_caughtSignal;
+	if (theSignal != 0) {
+	  s_caughtSignal = 0;
+	  debugMsg("TimingService:waitUntil", " signal " << theSignal << " caught by another thread");
+	}
+	return theSignal;
+  }
+  if (theSignal == SIGALRM) {
+	debugMsg("TimingService:waitUntil", " received timer wakeup");
+	return 0;
+  }
+
+  debugMsg("TimingService:waitUntil", " received non-timer signal " << theSignal);
+  return theSignal;
+#else
+  if (!setTimer(time))
+	return 0; // already past
+  return wait();
+#endif
+}
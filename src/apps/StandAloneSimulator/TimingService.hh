@@ -97,6 +97,15 @@ public:
    */
   int wait();
 
+  /**
+   * @brief Wait until the given absolute time, or until a signal arrives.
+   * @param time Const reference to a timeval with the requested wakeup time.
+   * @return 0 if the time was reached, the signal number otherwise.
+   * @note Uses sigtimedwait() where available, so no interval timer
+   *       (and no SIGALRM) is involved.
+   */
+  int waitUntil(const timeval& time);
+
 private:  
 
   // Deliberately not implemented
@@ -0,0 +1,234 @@
+/* Copyright (c) 2006-2026, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+//
+// Module test for the simulator Agenda.
+// Compares the timer wheel against a simple ordered reference, with
+// response times on either side of each wheel level boundary.
+//
+
+#include "Agenda.hh"
+
+#include "ResponseMessage.hh"
+
+#include "Error.hh"
+
+#include "plexil-stdint.h"
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <set>
+#include <tuple>
+#include <vector>
+
+// Must agree with Agenda.cc
+static constexpr unsigned int WHEEL_BITS = 8;
+static constexpr unsigned int WHEEL_LEVELS = 4;
+
+// Reference entry: time in microseconds, order of scheduling, message id
+typedef std::tuple<int64_t, uint64_t, size_t> RefEntry;
+typedef std::set<RefEntry> Reference;
+
+static timeval usecToTimeval(int64_t usec)
+{
+  return timeval({(time_t) (usec / 1000000), (suseconds_t) (usec % 1000000)});
+}
+
+static int64_t timevalToUsec(timeval const &tym)
+{
+  return (int64_t) tym.tv_sec * 1000000 + tym.tv_usec;
+}
+
+// Length of a level's slot span, in microseconds
+static int64_t levelSpanUsec(unsigned int level)
+{
+  return ((int64_t) 1 << (WHEEL_BITS * level)) * AGENDA_TICK_USEC;
+}
+
+static void schedule(Agenda &agenda, Reference &ref, uint64_t &seq, int64_t usec)
+{
+  size_t id = seq;
+  agenda.scheduleResponse(usecToTimeval(usec),
+                          new ResponseMessage("test", PLEXIL::Value(), MSG_TELEMETRY,
+                                              reinterpret_cast<void *>(id)));
+  ref.insert(RefEntry(usec, seq++, id));
+}
+
+// Check the next response time and size against the reference.
+static bool checkNext(Agenda const &agenda, Reference const &ref)
+{
+  if (agenda.size() != ref.size()) {
+    std::cout << "  size " << agenda.size() << ", expected " << ref.size() << std::endl;
+    return false;
+  }
+  if (ref.empty())
+    return agenda.empty();
+  int64_t next = timevalToUsec(agenda.nextResponseTime());
+  if (next != std::get<0>(*ref.begin())) {
+    std::cout << "  next response time " << next
+              << ", expected " << std::get<0>(*ref.begin()) << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// Pop one response and check it against the reference.
+static bool checkPop(Agenda &agenda, Reference &ref)
+{
+  if (!checkNext(agenda, ref))
+    return false;
+  std::unique_ptr<ResponseMessage> msg(agenda.popResponse());
+  assertTrue_1(msg);
+  size_t id = reinterpret_cast<size_t>(msg->getId());
+  if (id != std::get<2>(*ref.begin())) {
+    std::cout << "  popped response " << id
+              << ", expected " << std::get<2>(*ref.begin())
+              << " at " << std::get<0>(*ref.begin()) << std::endl;
+    return false;
+  }
+  ref.erase(ref.begin());
+  return true;
+}
+
+// Pop everything due by the given time and check it against the reference.
+static bool checkPopResponses(Agenda &agenda, Reference &ref, int64_t now)
+{
+  std::vector<ScheduledResponse> due;
+  size_t n = agenda.popResponses(usecToTimeval(now), due);
+  assertTrue_1(n == due.size());
+  for (ScheduledResponse &resp : due) {
+    std::unique_ptr<ResponseMessage> msg(resp.second);
+    if (ref.empty() || std::get<0>(*ref.begin()) > now) {
+      std::cout << "  popResponses(" << now << ") returned an extra response" << std::endl;
+      return false;
+    }
+    size_t id = reinterpret_cast<size_t>(msg->getId());
+    if (id != std::get<2>(*ref.begin())
+        || timevalToUsec(resp.first) != std::get<0>(*ref.begin())) {
+      std::cout << "  popResponses(" << now << ") returned " << id
+                << " at " << timevalToUsec(resp.first)
+                << ", expected " << std::get<2>(*ref.begin())
+                << " at " << std::get<0>(*ref.begin()) << std::endl;
+      return false;
+    }
+    ref.erase(ref.begin());
+  }
+  if (!ref.empty() && std::get<0>(*ref.begin()) <= now) {
+    std::cout << "  popResponses(" << now << ") missed response "
+              << std::get<2>(*ref.begin()) << " at " << std::get<0>(*ref.begin())
+              << std::endl;
+    return false;
+  }
+  return checkNext(agenda, ref);
+}
+
+// Responses just before, at, and after each level boundary, in
+// scrambled order, including ties and times within one tick.
+static bool testLevelBoundaries()
+{
+  std::cout << "testLevelBoundaries" << std::endl;
+  std::unique_ptr<Agenda> agenda(makeAgenda());
+  Reference ref;
+  uint64_t seq = 0;
+
+  std::vector<int64_t> times;
+  for (unsigned int l = 1; l <= WHEEL_LEVELS; ++l) {
+    int64_t boundary = levelSpanUsec(l);
+    for (int64_t delta : {-AGENDA_TICK_USEC, (int64_t) -1, (int64_t) 0,
+                          (int64_t) 1, AGENDA_TICK_USEC / 2, AGENDA_TICK_USEC})
+      times.push_back(boundary + delta);
+  }
+  times.push_back(0);
+  times.push_back(AGENDA_TICK_USEC - 1);
+
+  std::mt19937 gen(1);
+  std::shuffle(times.begin(), times.end(), gen);
+  for (int64_t t : times) {
+    schedule(*agenda, ref, seq, t);
+    schedule(*agenda, ref, seq, t); // tie, released in order scheduled
+  }
+  while (!ref.empty())
+    if (!checkPop(*agenda, ref))
+      return false;
+  assertTrue_1(agenda->empty());
+  return true;
+}
+
+// Random mix of scheduling and removal, with times spread over every
+// level of the wheel and beyond it.
+static bool testRandomized(unsigned int seed)
+{
+  std::cout << "testRandomized, seed " << seed << std::endl;
+  std::unique_ptr<Agenda> agenda(makeAgenda());
+  Reference ref;
+  uint64_t seq = 0;
+  int64_t now = 0;
+
+  std::mt19937_64 gen(seed);
+  std::uniform_int_distribution<unsigned int> levelDist(0, WHEEL_LEVELS);
+  std::uniform_int_distribution<unsigned int> opDist(0, 9);
+
+  for (unsigned int i = 0; i < 20000; ++i) {
+    // Pick a distance of up to one span of a random level
+    int64_t span = levelSpanUsec(levelDist(gen) + 1);
+    int64_t delta = std::uniform_int_distribution<int64_t>(0, span)(gen);
+
+    unsigned int op = opDist(gen);
+    if (op < 6) {
+      // Mostly in the future, sometimes overdue
+      int64_t t = (op == 0) ? now - delta / 2 : now + delta;
+      schedule(*agenda, ref, seq, t < 0 ? 0 : t);
+    }
+    else if (op < 8) {
+      if (!ref.empty() && !checkPop(*agenda, ref))
+        return false;
+    }
+    else {
+      // Advance the clock, sometimes only a little
+      now += (op == 8) ? delta / 64 : delta;
+      if (!checkPopResponses(*agenda, ref, now))
+        return false;
+    }
+  }
+
+  while (!ref.empty())
+    if (!checkPop(*agenda, ref))
+      return false;
+  assertTrue_1(agenda->empty());
+  return true;
+}
+
+int main()
+{
+  bool success = testLevelBoundaries();
+  for (unsigned int seed = 1; success && seed <= 5; ++seed)
+    success = testRandomized(seed);
+
+  std::cout << "Agenda test " << (success ? "succeeded" : "failed") << std::endl;
+  return (success ? 0 : 1);
+}
@@ -0,0 +1,817 @@
+/* Copyright (c) 2006-2020, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "ScriptReader.hh"
+
+#include "Debug.hh"
+#include "Error.hh"
+#include "ParserException.hh"
+#include "pugixml.hpp"
+#include "stricmp.h"
+
+#include <algorithm> // std::count()
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+
+#if defined(HAVE_CSTRING)
+#include <cstring>
+#elif defined(HAVE_STRING_H)
+#include <string.h>
+#endif
+
+namespace PLEXIL
+{
+
+  //
+  // Script parsing utilities
+  //
+
+  // Forward declarations
+  static Value parseOneValue(const std::string& type,
+                             const std::string& valStr);
+  static Value parseParam(pugi::xml_node const param);
+  static void parseParams(pugi::xml_node const root,
+                          std::vector<Value>& dest);
+
+  static State parseStateInternal(pugi::xml_node const elt)
+  {
+    checkError(!elt.attribute("name").empty(),
+               "No name attribute in " << elt.name() << " element.");
+    State result(elt.attribute("name").value());
+    std::vector<Value> parms;
+    parseParams(elt, parms);
+    size_t n = parms.size();
+    if (n) {
+      result.setParameterCount(n);
+      for (size_t i = 0; i < n; ++i)
+        result.setParameter(i, parms[i]);
+    }
+    return result;
+  }
+
+  static State parseState(pugi::xml_node const elt)
+  {
+    checkError(strcmp(elt.name(), "State") == 0,
+               "Expected <State> element. Found '" << elt.name() << "'");
+    return parseStateInternal(elt);
+  }
+
+  // Parses all command-like elements: Command, CommandAck, CommandAbort.
+  static State parseCommand(pugi::xml_node const cmd)
+  {
+    checkError(strcmp(cmd.name(), "Command") == 0 ||
+               strcmp(cmd.name(), "CommandAck") == 0 ||
+               strcmp(cmd.name(), "CommandAbort") == 0,
+               "Expected <Command> element.  Found '" << cmd.name() << "'");
+    return parseStateInternal(cmd);
+  }
+
+  static Value parseResult(pugi::xml_node const cmd)
+  {
+    pugi::xml_node resXml = cmd.child("Result");
+    checkError(!resXml.empty(), "No Result child in <" << cmd.name() << "> element.");
+    checkError(!resXml.first_child().empty(), "Empty Result child in <" << cmd.name() << "> element.");
+    checkError(!cmd.attribute("type").empty(),
+               "No type attribute in <" << cmd.name() << "> element.");
+    std::string type(cmd.attribute("type").value());
+
+    // read in the initiial values and parameters
+    if (type.rfind("array") == std::string::npos) {
+      // Not an array
+      return parseOneValue(type, resXml.child_value());
+    }
+    else {
+      std::vector<Value> values;
+      while (!resXml.empty()) {
+        values.push_back(parseOneValue(type, resXml.child_value()));
+        resXml = resXml.next_sibling();
+      }
+      return Value(values);
+    }
+  }
+
+  static void parseParams(pugi::xml_node const root, 
+                          std::vector<Value>& dest)
+  {
+    size_t n = std::distance(root.begin(), root.end());
+    if (!n)
+      return; // no parameters
+
+    dest.reserve(n);
+    pugi::xml_node param = root.child("Param");
+    while (!param.empty()) {
+      dest.push_back(parseParam(param));
+      param = param.next_sibling("Param");
+    }
+  }
+
+  static Value parseParam(pugi::xml_node const param)
+  {
+    checkError(!param.first_child().empty()
+               || strcmp(param.attribute("type").value(), "string") == 0,
+               "Empty Param child in <" << param.parent().name() << "> element.");
+    std::string type(param.attribute("type").value());
+    std::string val(param.child_value());
+    if (val == "UNKNOWN") {
+      // Create a typed unknown
+      ValueType t = UNKNOWN_TYPE;
+      if (type == "int")
+        t = INTEGER_TYPE;
+      else if (type == "real")
+        t = REAL_TYPE;
+      else if (type == "bool")
+        t = BOOLEAN_TYPE;
+      else if (type == "string")
+        t = STRING_TYPE;
+      return Value(0, t);
+    }
+    else if (type == "int") {
+      Integer value;
+      std::istringstream str(val);
+      str >> value;
+      return Value(value);
+    }
+    else if (type == "real") {
+      Real value;
+      std::istringstream str(val);
+      str >> value;
+      return Value(value);
+    }
+    else if (type == "bool") {
+      bool value;
+      std::istringstream str(val);
+      str >> value;
+      return Value(value);
+    }
+    // string case
+    else if (param.first_child().empty()) {
+      return Value("");
+    }
+    else {
+      return Value(param.child_value());
+    }
+  }
+
+  static Value parseStateValue(pugi::xml_node const stateXml)
+  {
+    // read in values
+    std::string type(stateXml.attribute("type").value());
+    checkError(!type.empty(),
+               "No type attribute in <" << stateXml.name() << "> element");
+
+    pugi::xml_node valXml = stateXml.child("Value");
+    checkError(valXml,
+               "No <Value> element in <"  << stateXml.name() << "> element");
+    if (type.rfind("array") == std::string::npos) {
+      // Not an array
+      return parseOneValue(type, valXml.child_value());
+    }
+    else {
+      std::vector<Value> values;
+      while (!valXml.empty()) {
+        values.push_back(parseOneValue(type, valXml.child_value()));
+        valXml = valXml.next_sibling();
+      }
+      return Value(values);
+    }
+  }
+
+  // parse in value
+  static Value parseOneValue(const std::string& type, 
+                             const std::string& valStr)
+  {
+    // Unknown
+    if (0 == stricmp(valStr.c_str(), "Plexil_Unknown")) return Value();
+
+    // string or string-array
+    else if (type.find("string") == 0) {
+      return Value(valStr);
+    }
+    // int, int-array
+    else if (type.find("int") == 0) {
+      Integer value;
+      std::istringstream ss(valStr);
+      ss >> value;
+      return Value(value);
+    }
+    // real, real-array
+    else if (type.find("real") == 0) {
+      Real value;
+      std::istringstream ss(valStr);
+      ss >> value;
+      return Value(value);
+    }
+    // bool or bool-array
+    else if (type.find("bool") == 0) {
+      if (0 == stricmp(valStr.c_str(), "true"))
+        return Value(true);
+      else if (0 == stricmp(valStr.c_str(), "false"))
+        return Value(false);
+      else {
+        bool value;
+        std::istringstream ss(valStr);
+        ss >> value;
+        return Value(value);
+      }
+    }
+    else {
+      reportParserException("Unknown type attribute \"" << type << "\"");
+      return Value();
+    }
+  }
+
+  // Append the event described by one script element.
+  // Returns false if the element is not an event.
+  static bool parseEvent(pugi::xml_node const elt,
+                         std::vector<ScriptEvent> &events)
+  {
+    ScriptEvent event;
+    if (strcmp(elt.name(), "State") == 0) {
+      event.type = ScriptEvent::STATE_EVENT;
+      event.state = parseState(elt);
+      event.value = parseStateValue(elt);
+    }
+    else if (strcmp(elt.name(), "Command") == 0) {
+      event.type = ScriptEvent::COMMAND_EVENT;
+      event.state = parseCommand(elt);
+      event.value = parseResult(elt);
+    }
+    else if (strcmp(elt.name(), "CommandAck") == 0) {
+      event.type = ScriptEvent::COMMAND_ACK_EVENT;
+      event.state = parseCommand(elt);
+      event.value = parseResult(elt);
+    }
+    else if (strcmp(elt.name(), "CommandAbort") == 0) {
+      event.type = ScriptEvent::COMMAND_ABORT_EVENT;
+      event.state = parseCommand(elt);
+      event.value = parseResult(elt);
+    }
+    else if (strcmp(elt.name(), "UpdateAck") == 0) {
+      event.type = ScriptEvent::UPDATE_ACK_EVENT;
+      event.name = elt.attribute("name").value();
+    }
+    else if (strcmp(elt.name(), "SendPlan") == 0) {
+      event.type = ScriptEvent::SEND_PLAN_EVENT;
+      event.name = elt.attribute("file").value();
+      checkError(!event.name.empty(),
+                 "SendPlan element has no file attribute");
+    }
+    else
+      return false;
+    events.push_back(std::move(event));
+    return true;
+  }
+
+  //
+  // XmlScriptReader
+  //
+  // Scans the PLEXILScript document for the top-level elements of the
+  // Script, and parses each one on its own with pugixml just before it
+  // is needed. Requires InitialState, if present, to precede Script.
+  //
+
+  class XmlScriptReader final : public ScriptReader
+  {
+  public:
+    XmlScriptReader(std::string const &filename)
+      : m_stream(filename.c_str(), std::ios::in | std::ios::binary),
+        m_buf(m_stream.rdbuf()),
+        m_filename(filename),
+        m_done(false)
+    {
+    }
+
+    virtual ~XmlScriptReader() = default;
+
+    virtual void readInitialState(std::vector<ScriptEvent> &events)
+    {
+      std::string tag;
+      TagType type = nextTag(tag, nullptr);
+      checkParserException(type == START_TAG || type == EMPTY_TAG,
+                           "File " << m_filename << " is not a valid PLEXIL simulator script");
+      checkParserException(tagName(tag) == "PLEXILScript",
+                           "File " << m_filename << " is not a valid PLEXIL simulator script");
+      checkParserException(type == START_TAG,
+                           "No Script element in Plexilscript.");
+
+      // Read children of PLEXILScript up to the Script element
+      std::string text;
+      while (true) {
+        type = nextTag(tag, nullptr);
+        checkParserException(type == START_TAG || type == EMPTY_TAG,
+                             "No Script element in Plexilscript.");
+        std::string name = tagName(tag);
+        if (name == "Script") {
+          m_done = (type == EMPTY_TAG);
+          return;
+        }
+        if (name != "InitialState") {
+          captureElement(tag, type, text); // ignore it
+          continue;
+        }
+
+        captureElement(tag, type, text);
+        pugi::xml_document doc;
+        parseFragment(text, doc);
+        for (pugi::xml_node state = doc.document_element().first_child();
+             state;
+             state = state.next_sibling()) {
+          // Deal with <InitialState>  </InitialState>
+          if (state.type() != pugi::node_element)
+            continue;
+          ScriptEvent event;
+          event.type = ScriptEvent::STATE_EVENT;
+          event.state = parseState(state);
+          event.value = parseStateValue(state);
+          events.push_back(std::move(event));
+        }
+      }
+    }
+
+    virtual bool readStep(std::vector<ScriptEvent> &events)
+    {
+      if (m_done)
+        return false;
+      std::string tag;
+      TagType type = nextTag(tag, nullptr);
+      if (type != START_TAG && type != EMPTY_TAG) {
+        // End of Script element, or truncated file
+        m_done = true;
+        return false;
+      }
+
+      captureElement(tag, type, m_text);
+      parseFragment(m_text, m_doc);
+      pugi::xml_node elt = m_doc.document_element();
+      if (strcmp(elt.name(), "Simultaneous") == 0) {
+        for (pugi::xml_node item = elt.first_child(); item; item = item.next_sibling()) {
+          // ignore text element (e.g. from <Script> </Script>)
+          if (item.type() != pugi::node_element)
+            continue;
+          if (!parseEvent(item, events)) {
+            reportParserException("Unknown script element '" << item.name()
+                                  << "' inside <Simultaneous>");
+          }
+        }
+      }
+      else if (strcmp(elt.name(), "Delay") == 0)
+        ; // No-op
+      else if (!parseEvent(elt, events)) {
+        reportParserException("Unknown script element '" << elt.name() << "'");
+      }
+      return true;
+    }
+
+  private:
+
+    enum TagType {
+      NO_TAG = 0,  // end of file
+      START_TAG,
+      END_TAG,
+      EMPTY_TAG
+    };
+
+    // Read through the next start, end, or empty-element tag, returning
+    // it in tag. Text, comments, CDATA, and processing instructions are
+    // skipped. Everything consumed is appended to capture if not null.
+    TagType nextTag(std::string &tag, std::string *capture)
+    {
+      int c;
+      while ((c = m_buf->sbumpc()) != std::char_traits<char>::eof()) {
+        if (c != '<') {
+          if (capture)
+            capture->push_back((char) c);
+          continue;
+        }
+        tag.assign(1, '<');
+        int next = m_buf->sgetc();
+        if (next == '!' || next == '?') {
+          readMarkup(tag);
+          if (capture)
+            capture->append(tag);
+          continue;
+        }
+
+        // Element tag; watch for '>' in quoted attribute values
+        char quote = 0;
+        while ((c = m_buf->sbumpc()) != std::char_traits<char>::eof()) {
+          tag.push_back((char) c);
+          if (quote) {
+            if (c == quote)
+              quote = 0;
+          }
+          else if (c == '"' || c == '\'')
+            quote = (char) c;
+          else if (c == '>')
+            break;
+        }
+        checkParserException(c == '>',
+                             "Unexpected end of file in script " << m_filename);
+        if (capture)
+          capture->append(tag);
+        if (tag[1] == '/')
+          return END_TAG;
+        if (tag[tag.size() - 2] == '/')
+          return EMPTY_TAG;
+        return START_TAG;
+      }
+      return NO_TAG;
+    }
+
+    // Read a comment, CDATA section, processing instruction, or DOCTYPE
+    // whose leading '<' is already in markup.
+    void readMarkup(std::string &markup)
+    {
+      int c;
+      while ((c = m_buf->sbumpc()) != std::char_traits<char>::eof()) {
+        markup.push_back((char) c);
+        size_t len = markup.size();
+        if (markup.compare(0, 4, "<!--") == 0) {
+          if (len >= 7 && markup.compare(len - 3, 3, "-->") == 0)
+            return;
+        }
+        else if (markup.compare(0, 9, "<![CDATA[") == 0) {
+          if (len >= 12 && markup.compare(len - 3, 3, "]]>") == 0)
+            return;
+        }
+        else if (markup[1] == '?') {
+          if (len >= 4 && markup.compare(len - 2, 2, "?>") == 0)
+            return;
+        }
+        else if (c == '>'
+                 && std::count(markup.begin(), markup.end(), '[')
+                 == std::count(markup.begin(), markup.end(), ']'))
+          return; // DOCTYPE, possibly with an internal subset
+      }
+      reportParserException("Unexpected end of file in script " << m_filename);
+    }
+
+    // Capture the whole element whose start tag was just read.
+    void captureElement(std::string const &startTag, TagType type,
+                        std::string &text)
+    {
+      text = startTag;
+      if (type == EMPTY_TAG)
+        return;
+      std::string tag;
+      size_t depth = 1;
+      while (depth) {
+        switch (nextTag(tag, &text)) {
+        case START_TAG:
+          ++depth;
+          break;
+
+        case END_TAG:
+          --depth;
+          break;
+
+        case EMPTY_TAG:
+          break;
+
+        default:
+          reportParserException("Unexpected end of file in script " << m_filename);
+        }
+      }
+    }
+
+    // Parses text in place; text is not usable afterward.
+    void parseFragment(std::string &text, pugi::xml_document &doc)
+    {
+      pugi::xml_parse_result result =
+        doc.load_buffer_inplace(&text[0], text.size(),
+                                pugi::parse_default | pugi::parse_ws_pcdata_single);
+      checkParserException(result.status == pugi::status_ok,
+                           "Error parsing script " << m_filename << ": "
+                           << result.description());
+    }
+
+    static std::string tagName(std::string const &tag)
+    {
+      size_t start = (tag[1] == '/') ? 2 : 1;
+      size_t end = tag.find_first_of(" \t\r\n/>", start);
+      return tag.substr(start, end - start);
+    }
+
+    std::ifstream m_stream;
+    std::streambuf *m_buf;
+    std::string m_filename;
+    std::string m_text;         // reused for each element
+    pugi::xml_document m_doc;   // reused for each element
+    bool m_done;
+  };
+
+  //
+  // Binary script format
+  //
+  // An 8 byte header, followed by records of the form
+  //   1 byte tag, 4 byte big-endian payload length, payload
+  // Event records use the ScriptEvent::Type values as tags. Their payload
+  // is the state name, parameter count, parameters, and value, or the name
+  // for UpdateAck and SendPlan. Strings and known values use the PLEXIL
+  // serial representation; an unknown value is UNKNOWN_TYPE followed by
+  // its type, so that typed unknown parameters survive.
+  // A SIMULTANEOUS_RECORD payload is the 4 byte big-endian count of the
+  // event records which follow it.
+  // Each event, simultaneous, or delay record is one exec step.
+  //
+
+  static char const BINARY_SCRIPT_HEADER[] = "PLXSCRB1";
+  static size_t const BINARY_SCRIPT_HEADER_LENGTH = 8;
+
+  static char const INITIAL_STATE_RECORD = 'I';
+  static char const SIMULTANEOUS_RECORD = 'M';
+  static char const DELAY_RECORD = 'D';
+
+  static void putLength(uint32_t len, char *b)
+  {
+    b[0] = (char) (0xFF & (len >> 24));
+    b[1] = (char) (0xFF & (len >> 16));
+    b[2] = (char) (0xFF & (len >> 8));
+    b[3] = (char) (0xFF & len);
+  }
+
+  static uint32_t getLength(char const *b)
+  {
+    return ((uint32_t) (unsigned char) b[0] << 24)
+      | ((uint32_t) (unsigned char) b[1] << 16)
+      | ((uint32_t) (unsigned char) b[2] << 8)
+      | (uint32_t) (unsigned char) b[3];
+  }
+
+  static void appendValue(Value const &val, std::vector<char> &buf)
+  {
+    size_t offset = buf.size();
+    if (!val.isKnown()) {
+      buf.push_back((char) UNKNOWN_TYPE);
+      buf.push_back((char) val.valueType());
+      return;
+    }
+    size_t n = serialSize(val);
+    checkError(n, "writeBinaryScript: unable to serialize value " << val);
+    buf.resize(offset + n);
+    serialize(val, buf.data() + offset);
+  }
+
+  // Read a value written by appendValue(), reading nothing at or after end.
+  // Returns null if the value is invalid or extends past end.
+  static char const *readValue(Value &val, char const *b, char const *end)
+  {
+    if (b < end && (ValueType) *b == UNKNOWN_TYPE) {
+      if (end - b < 2)
+        return nullptr;
+      ValueType typ = (ValueType) b[1];
+      if (typ != UNKNOWN_TYPE && !isUserType(typ) && !isInternalType(typ))
+        return nullptr;
+      val = Value(0, typ);
+      return b + 2;
+    }
+    return val.deserialize(b, end);
+  }
+
+  // Read a serialized string, reading nothing at or after end.
+  // Returns null if the string is invalid or extends past end.
+  static char const *readString(std::string &str, char const *b, char const *end)
+  {
+    Value val;
+    b = val.deserialize(b, end);
+    if (!b || val.valueType() != STRING_TYPE)
+      return nullptr;
+    val.getValue(str);
+    return b;
+  }
+
+  static void writeRecord(std::ostream &out, char tag, std::vector<char> const &payload)
+  {
+    char prefix[5];
+    prefix[0] = tag;
+    putLength(payload.size(), prefix + 1);
+    out.write(prefix, sizeof(prefix));
+    out.write(payload.data(), payload.size());
+  }
+
+  static void writeEvent(std::ostream &out, char tag, ScriptEvent const &event,
+                         std::vector<char> &buf)
+  {
+    switch (event.type) {
+    case ScriptEvent::UPDATE_ACK_EVENT:
+    case ScriptEvent::SEND_PLAN_EVENT:
+      buf.resize(serialSize(event.name));
+      serialize(event.name, buf.data());
+      break;
+
+    default: {
+      buf.resize(serialSize(event.state.name()) + 4);
+      putLength(event.state.parameterCount(),
+                serialize(event.state.name(), buf.data()));
+      for (Value const &param : event.state.parameters())
+        appendValue(param, buf);
+      appendValue(event.value, buf);
+      break;
+    }
+    }
+    writeRecord(out, tag, buf);
+  }
+
+  void writeBinaryScript(ScriptReader &reader, std::ostream &out)
+  {
+    out.write(BINARY_SCRIPT_HEADER, BINARY_SCRIPT_HEADER_LENGTH);
+    std::vector<ScriptEvent> events;
+    std::vector<char> buf;
+    reader.readInitialState(events);
+    for (ScriptEvent const &event : events)
+      writeEvent(out, INITIAL_STATE_RECORD, event, buf);
+    events.clear();
+    while (reader.readStep(events)) {
+      if (events.empty()) {
+        buf.clear();
+        writeRecord(out, DELAY_RECORD, buf);
+      }
+      else if (events.size() == 1)
+        writeEvent(out, events.front().type, events.front(), buf);
+      else {
+        buf.resize(4);
+        putLength(events.size(), buf.data());
+        writeRecord(out, SIMULTANEOUS_RECORD, buf);
+        for (ScriptEvent const &event : events)
+          writeEvent(out, event.type, event, buf);
+      }
+      events.clear();
+    }
+  }
+
+  class BinaryScriptReader final : public ScriptReader
+  {
+  public:
+    BinaryScriptReader(std::string const &filename)
+      : m_stream(filename.c_str(), std::ios::in | std::ios::binary),
+        m_filename(filename),
+        m_fileSize(0),
+        m_tag(0)
+    {
+      m_stream.seekg(0, std::ios::end);
+      m_fileSize = m_stream.tellg();
+      m_stream.seekg(BINARY_SCRIPT_HEADER_LENGTH); // header checked by caller
+    }
+
+    virtual ~BinaryScriptReader() = default;
+
+    virtual void readInitialState(std::vector<ScriptEvent> &events)
+    {
+      while (readRecord() && m_tag == INITIAL_STATE_RECORD) {
+        events.emplace_back();
+        decodeEvent(ScriptEvent::STATE_EVENT, events.back());
+        m_tag = 0;
+      }
+    }
+
+    virtual bool readStep(std::vector<ScriptEvent> &events)
+    {
+      if (!readRecord())
+        return false;
+      char tag = m_tag;
+      m_tag = 0;
+      switch (tag) {
+      case DELAY_RECORD:
+        return true;
+
+      case SIMULTANEOUS_RECORD: {
+        checkParserException(m_payload.size() == 4,
+                             "Invalid simultaneous record in script " << m_filename);
+        uint32_t n = getLength(m_payload.data());
+        for (uint32_t i = 0; i < n; ++i) {
+          checkParserException(readRecord(),
+                               "Unexpected end of file in script " << m_filename);
+          events.emplace_back();
+          decodeEvent(m_tag, events.back());
+          m_tag = 0;
+        }
+        return true;
+      }
+
+      default:
+        events.emplace_back();
+        decodeEvent(tag, events.back());
+        return true;
+      }
+    }
+
+  private:
+
+    // Read the next record into m_tag and m_payload, unless one has
+    // already been read and not consumed.
+    bool readRecord()
+    {
+      if (m_tag)
+        return true;
+      char prefix[5];
+      if (!m_stream.read(prefix, sizeof(prefix))) {
+        checkParserException(!m_stream.gcount(),
+                             "Unexpected end of file in script " << m_filename);
+        return false;
+      }
+      // Don't allocate for a length the file can't hold
+      uint32_t len = getLength(prefix + 1);
+      checkParserException((std::streamoff) len <= m_fileSize - m_stream.tellg(),
+                           "Record length " << len << " exceeds the size of script "
+                           << m_filename);
+      m_payload.resize(len);
+      checkParserException(m_stream.read(m_payload.data(), m_payload.size()),
+                           "Unexpected end of file in script " << m_filename);
+      m_tag = prefix[0];
+      return true;
+    }
+
+    void decodeEvent(char tag, ScriptEvent &event)
+    {
+      char const *b = m_payload.data();
+      char const *end = b + m_payload.size();
+      switch (tag) {
+      case ScriptEvent::UPDATE_ACK_EVENT:
+      case ScriptEvent::SEND_PLAN_EVENT:
+        b = readString(event.name, b, end);
+        break;
+
+      case ScriptEvent::STATE_EVENT:
+      case ScriptEvent::COMMAND_EVENT:
+      case ScriptEvent::COMMAND_ACK_EVENT:
+      case ScriptEvent::COMMAND_ABORT_EVENT: {
+        std::string name;
+        b = readString(name, b, end);
+        checkParserException(b && end - b >= 4,
+                             "Invalid record in script " << m_filename);
+        uint32_t n = getLength(b);
+        b += 4;
+        checkParserException(n < (size_t) (end - b), // at least 1 byte each
+                             "Invalid record in script " << m_filename);
+        event.state = State(name, n);
+        Value val;
+        for (uint32_t i = 0; b && b < end && i < n; ++i) {
+          b = readValue(val, b, end);
+          event.state.setParameter(i, val);
+        }
+        if (b && b < end)
+          b = readValue(event.value, b, end);
+        else
+          b = nullptr;
+        break;
+      }
+
+      default:
+        reportParserException("Unknown record type '" << tag
+                              << "' in script " << m_filename);
+      }
+      checkParserException(b == end,
+                           "Invalid record in script " << m_filename);
+      event.type = (ScriptEvent::Type) tag;
+    }
+
+    std::ifstream m_stream;
+    std::string m_filename;
+    std::vector<char> m_payload;
+    std::streamoff m_fileSize;
+    char m_tag; // tag of the record in m_payload, 0 if consumed
+  };
+
+  ScriptReader *makeScriptReader(std::string const &filename)
+  {
+    bool binary;
+    {
+      std::ifstream probe(filename.c_str(), std::ios::in | std::ios::binary);
+      if (!probe.is_open())
+        return nullptr;
+      char header[BINARY_SCRIPT_HEADER_LENGTH];
+      binary = probe.read(header, BINARY_SCRIPT_HEADER_LENGTH)
+        && !memcmp(header, BINARY_SCRIPT_HEADER, BINARY_SCRIPT_HEADER_LENGTH);
+    }
+    debugMsg("ScriptReader",
+             " reading " << (binary ? "binary" : "XML") << " script " << filename);
+    if (binary)
+      return new BinaryScriptReader(filename);
+    return new XmlScriptReader(filename);
+  }
+
+}
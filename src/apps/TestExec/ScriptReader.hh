@@ -0,0 +1,95 @@
+/* Copyright (c) 2006-2021, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef PLEXIL_SCRIPT_READER_HH
+#define PLEXIL_SCRIPT_READER_HH
+
+#include "State.hh"
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace PLEXIL
+{
+
+  //! @struct ScriptEvent
+  //! One simulated external event from a TestExec script.
+  struct ScriptEvent
+  {
+    //! Event types. The values are the record tags of the binary format.
+    enum Type : char {
+      STATE_EVENT = 'S',
+      COMMAND_EVENT = 'C',
+      COMMAND_ACK_EVENT = 'K',
+      COMMAND_ABORT_EVENT = 'A',
+      UPDATE_ACK_EVENT = 'U',
+      SEND_PLAN_EVENT = 'P'
+    };
+
+    Type type;
+    State state;      //!< The state or command
+    Value value;      //!< State value, command result, ack, or abort ack
+    std::string name; //!< Node name for UpdateAck, file name for SendPlan
+  };
+
+  //! @class ScriptReader
+  //! Abstract interface to a source of script events.
+  //! Implementations read the script incrementally, so that memory use
+  //! does not grow with the length of the script.
+  class ScriptReader
+  {
+  public:
+    virtual ~ScriptReader() = default;
+
+    //! Read the events of the initial state.
+    //! Must be called once, before the first call to readStep().
+    //! @param events Vector to which the events are appended.
+    virtual void readInitialState(std::vector<ScriptEvent> &events) = 0;
+
+    //! Read the events to be processed before the next exec step.
+    //! May append no events, e.g. for a Delay.
+    //! @param events Vector to which the events are appended.
+    //! @return false at end of script, true otherwise.
+    virtual bool readStep(std::vector<ScriptEvent> &events) = 0;
+  };
+
+  //! Construct a reader for the named script file.
+  //! Binary scripts are recognized by their header; anything else is
+  //! read as a PLEXILScript XML document.
+  //! @param filename The file name.
+  //! @return Pointer to the reader; nullptr if the file could not be opened.
+  //! @note Reports a ParserException if the file is not a valid script.
+  extern ScriptReader *makeScriptReader(std::string const &filename);
+
+  //! Copy a script to the output stream in the binary format.
+  //! @param reader The reader.  readInitialState() must not have been called.
+  //! @param out The output stream.
+  extern void writeBinaryScript(ScriptReader &reader, std::ostream &out);
+
+}
+
+#endif // PLEXIL_SCRIPT_READER_HH
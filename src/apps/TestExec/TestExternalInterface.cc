@@ -36,35 +36,21 @@
 #include "NodeConstants.hh"
 #include "ParserException.hh"
 #include "PlexilExec.hh"
+#include "ScriptReader.hh"
 #include "StateCache.hh"
 #include "Update.hh"
 #include "parsePlan.hh"
 #include "plan-utils.hh"
 #include "pugixml.hpp"
-#include "stricmp.h"
 
-#include <limits>
 #include <sstream>
 
-#ifdef STDC_HEADERS
-#include <cstring>
-#endif
-
 namespace PLEXIL
 {
 
   // Forward declarations for local functions
   static std::string getText(const State& c);
   static std::string getText(const State& c, const Value& v);
-  static State parseCommand(pugi::xml_node const cmd);
-  static Value parseOneValue(const std::string& type,
-                             const std::string& valStr);
-  static Value parseParam(pugi::xml_node const param);
-  static void parseParams(pugi::xml_node const root,
-                          std::vector<Value>& dest);
-  static Value parseResult(pugi::xml_node const valXml);
-  static State parseState(pugi::xml_node const elt);
-  static Value parseStateValue(pugi::xml_node const stateXml);
 
   TestExternalInterface::TestExternalInterface()
     : Dispatcher()
@@ -73,72 +59,30 @@ namespace PLEXIL
     m_states.insert(std::pair<State, Value>(State::timeState(), Value(0.0)));
   }
 
-  void TestExternalInterface::run(pugi::xml_node const input)
+  void TestExternalInterface::run(ScriptReader &script)
   {
     checkError(g_exec, "Attempted to run a script without an executive.");
 
-    handleInitialState(input); // steps exec once
-    
-    pugi::xml_node script = input.child("Script");
-    checkError(!script.empty(), "No Script element in Plexilscript.");
-    pugi::xml_node scriptElement = script.first_child();
-    while (!scriptElement.empty()) {
-      // ignore text element (e.g. from <Script> </Script>)
-      if (scriptElement.type() == pugi::node_pcdata) {
-        // debugMsg("Test:verboseTestOutput", " Ignoring XML PCDATA");
-      }
-
-      // state
-      else if (strcmp(scriptElement.name(), "State") == 0) {
-        handleState(scriptElement);
-      }
-
-      // command
-      else if (strcmp(scriptElement.name(), "Command") == 0) {
-        handleCommand(scriptElement);
-      }
-
-      // command ack
-      else if (strcmp(scriptElement.name(), "CommandAck") == 0) {
-        handleCommandAck(scriptElement);
-      }
-         
-      // command abort
-      else if (strcmp(scriptElement.name(), "CommandAbort") == 0) {
-        handleCommandAbort(scriptElement);
-      }
-
-      // update ack
-      else if (strcmp(scriptElement.name(), "UpdateAck") == 0) {
-        handleUpdateAck(scriptElement);
+    // Events are only held for one step at a time
+    std::vector<ScriptEvent> events;
+    script.readInitialState(events);
+    handleInitialState(events); // steps exec once
+    events.clear();
+
+    while (script.readStep(events)) {
+      if (events.size() > 1) {
+        debugMsg("Test:testOutput", "Processing simultaneous event(s)");
+        for (ScriptEvent const &event : events)
+          handleEvent(event);
+        debugMsg("Test:testOutput", "End simultaneous event(s)");
       }
+      else if (!events.empty())
+        handleEvent(events.front());
+      events.clear();
 
-      // send plan
-      else if (strcmp(scriptElement.name(), "SendPlan") == 0) {
-        handleSendPlan(scriptElement);
-      }
-
-      // simultaneous
-      else if (strcmp(scriptElement.name(), "Simultaneous") == 0) {
-        handleSimultaneous(scriptElement);
-      }
-
-      // delay
-      else if (strcmp(scriptElement.name(), "Delay") == 0) {
-        ; // No-op
-      }
-
-      // report unknown script element
-      else {
-        reportParserException("Unknown script element '" << scriptElement.name() << "'");
-        return;
-      }
-         
       // step the exec forward
       if (true /* g_exec->processQueue() */ ) // *** FIXME ***
         g_exec->step(StateCache::currentTime());
-
-      scriptElement = scriptElement.next_sibling();
     }
     // Script is complete
     // Continue stepping the Exec til quiescent
@@ -147,80 +91,94 @@ namespace PLEXIL
     }
   }
 
-  void TestExternalInterface::handleInitialState(pugi::xml_node const input)
+  void TestExternalInterface::handleInitialState(std::vector<ScriptEvent> const &events)
   {
-    pugi::xml_node initialState = input.child("InitialState");
-    if (initialState) {
-      pugi::xml_node state = initialState.first_child();
-      // Deal with <InitialState>  </InitialState>
-      if (state.type() != pugi::node_pcdata) {
-        while (state) {
-          State st = parseState(state);
-          Value value = parseStateValue(state);
-          debugMsg("Test:testOutput",
-                   "Creating initial state " << st << " = " << value);
-          m_states[st] = value;
-          StateCache::instance().lookupReturn(st, value);
-          state = state.next_sibling();
-        }
-      }
+    for (ScriptEvent const &event : events) {
+      debugMsg("Test:testOutput",
+               "Creating initial state " << event.state << " = " << event.value);
+      m_states[event.state] = event.value;
+      StateCache::instance().lookupReturn(event.state, event.value);
     }
     g_exec->step(StateCache::currentTime());
   }
 
-  void TestExternalInterface::handleState(pugi::xml_node const elt)
+  void TestExternalInterface::handleEvent(ScriptEvent const &event)
+  {
+    switch (event.type) {
+    case ScriptEvent::STATE_EVENT:
+      handleState(event);
+      break;
+
+    case ScriptEvent::COMMAND_EVENT:
+      handleCommand(event);
+      break;
+
+    case ScriptEvent::COMMAND_ACK_EVENT:
+      handleCommandAck(event);
+      break;
+
+    case ScriptEvent::COMMAND_ABORT_EVENT:
+      handleCommandAbort(event);
+      break;
+
+    case ScriptEvent::UPDATE_ACK_EVENT:
+      handleUpdateAck(event);
+      break;
+
+    case ScriptEvent::SEND_PLAN_EVENT:
+      handleSendPlan(event);
+      break;
+    }
+  }
+
+  void TestExternalInterface::handleState(ScriptEvent const &event)
   {
-    State st = parseState(elt);
-    Value value = parseStateValue(elt);
     debugMsg("Test:testOutput",
-             "Processing event: " << st << " = " << value);
-    m_states[st] = value;
-    StateCache::instance().lookupReturn(st, value);
+             "Processing event: " << event.state << " = " << event.value);
+    m_states[event.state] = event.value;
+    StateCache::instance().lookupReturn(event.state, event.value);
   }
 
-  void TestExternalInterface::handleCommand(pugi::xml_node const elt)
+  void TestExternalInterface::handleCommand(ScriptEvent const &event)
   {
-    State command = parseCommand(elt);
-    Value value = parseResult(elt);
+    State const &command = event.state;
     debugMsg("Test:testOutput",
-             "Sending command result " << getText(command, value));
+             "Sending command result " << getText(command, event.value));
     StateCommandMap::iterator it = 
       m_executingCommands.find(command);
     checkError(it != m_executingCommands.end(),
                "No currently executing command " << getText(command));
-    commandReturn(it->second, value);
+    commandReturn(it->second, event.value);
     m_executingCommands.erase(it);
   }
 
-  void TestExternalInterface::handleCommandAck(pugi::xml_node const elt)
+  void TestExternalInterface::handleCommandAck(ScriptEvent const &event)
   {
-    State command = parseCommand(elt);
+    State const &command = event.state;
     // Ack should be string value
-    Value value = parseResult(elt);
     CommandHandleValue handle = NO_COMMAND_HANDLE;
     std::string const *str = nullptr;
-    if (value.getValuePointer(str))
+    if (event.value.getValuePointer(str))
       handle = parseCommandHandleValue(*str);
     debugMsg("Test:testOutput",
-             "Sending command ACK " << getText(command, value));
+             "Sending command ACK " << getText(command, event.value));
     StateCommandMap::iterator it = m_commandAcks.find(command);
     assertTrueMsg(it != m_commandAcks.end(), 
                   "No command waiting for acknowledgement " << getText(command));
     commandHandleReturn(it->second, handle);
   }
 
-  void TestExternalInterface::handleCommandAbort(pugi::xml_node const elt)
+  void TestExternalInterface::handleCommandAbort(ScriptEvent const &event)
   {
-    State command = parseCommand(elt);
-    Value value = parseResult(elt);
-    assertTrueMsg(value.valueType() == BOOLEAN_TYPE,
+    State const &command = event.state;
+    assertTrueMsg(event.value.valueType() == BOOLEAN_TYPE,
                   "CommmandAbort value must be Boolean");
     Boolean ack;
-    assertTrueMsg(value.getValue(ack),
+    assertTrueMsg(event.value.getValue(ack),
                   "CommmandAbort value must not be unknown");
     
     debugMsg("Test:testOutput",
-             "Sending abort ACK " << getText(command, value));
+             "Sending abort ACK " << getText(command, event.value));
     StateCommandMap::iterator it = 
       m_abortingCommands.find(command);
     assertTrueMsg(it != m_abortingCommands.end(), 
@@ -231,9 +189,9 @@ namespace PLEXIL
     m_abortingCommands.erase(it);
   }
 
-  void TestExternalInterface::handleUpdateAck(pugi::xml_node const elt)
+  void TestExternalInterface::handleUpdateAck(ScriptEvent const &event)
   {
-    std::string name(elt.attribute("name").value());
+    std::string const &name = event.name;
     debugMsg("Test:testOutput", "Sending update ACK " << name);
     std::map<std::string, Update*>::iterator it = m_waitingUpdates.find(name);
     checkError(it != m_waitingUpdates.end(),
@@ -242,20 +200,18 @@ namespace PLEXIL
     m_waitingUpdates.erase(it);
   }
 
-  void TestExternalInterface::handleSendPlan(pugi::xml_node const elt)
+  void TestExternalInterface::handleSendPlan(ScriptEvent const &event)
   {
-    const char* filename = elt.attribute("file").value();
-    checkError(strlen(filename) > 0,
-               "SendPlan element has no file attribute");
+    char const *filename = event.name.c_str();
 
     pugi::xml_document* doc = new pugi::xml_document();
     pugi::xml_parse_result parseResult = doc->load_file(filename);
     assertTrueMsg(parseResult.status == pugi::status_ok, 
-                  "Error parsing plan file " << elt.attribute("file").value()
+                  "Error parsing plan file " << filename
                   << ": " << parseResult.description());
 
     debugMsg("Test:testOutput",
-             "Sending plan from file " << elt.attribute("file").value());
+             "Sending plan from file " << filename);
     NodeImpl *root = nullptr;
     try {
       root = parsePlan(doc->document_element().child("PlexilPlan"));
@@ -267,237 +223,6 @@ namespace PLEXIL
       g_exec->addPlan(root);
   }
 
-  void TestExternalInterface::handleSimultaneous(pugi::xml_node const elt)
-  {
-    debugMsg("Test:testOutput", "Processing simultaneous event(s)");
-    pugi::xml_node item = elt.first_child();
-    while (!item.empty()) {
-      // ignore text element (e.g. from <Script> </Script>)
-      if (item.type() == pugi::node_pcdata) {
-        //debugMsg("Test:verboseTestOutput", " Ignoring XML PCDATA");
-      }
-      // state
-      else if (strcmp(item.name(), "State") == 0) {
-        handleState(item);
-      }
-      // command
-      else if (strcmp(item.name(), "Command") == 0) {
-        handleCommand(item);
-      }
-      // command ack
-      else if (strcmp(item.name(), "CommandAck") == 0) {
-        handleCommandAck(item);
-      }
-      // command abort
-      else if (strcmp(item.name(), "CommandAbort") == 0) {
-        handleCommandAbort(item);
-      }
-      // update ack
-      else if (strcmp(item.name(), "UpdateAck") == 0) {
-        handleUpdateAck(item);
-      }
-      // report unknown script element
-      else {
-        reportParserException("Unknown script element '" << item.name()
-                              << "' inside <Simultaneous>");
-        return;
-      }
-      item = item.next_sibling();
-    }
-    debugMsg("Test:testOutput", "End simultaneous event(s)");
-  }
-
-  //
-  // Script parsing utilities
-  //
-
-  static State parseStateInternal(pugi::xml_node const elt)
-  {
-    checkError(!elt.attribute("name").empty(),
-               "No name attribute in " << elt.name() << " element.");
-    State result(elt.attribute("name").value());
-    std::vector<Value> parms;
-    parseParams(elt, parms);
-    size_t n = parms.size();
-    if (n) {
-      result.setParameterCount(n);
-      for (size_t i = 0; i < n; ++i)
-        result.setParameter(i, parms[i]);
-    }
-    return result;
-  }
-
-  static State parseState(pugi::xml_node const elt)
-  {
-    checkError(strcmp(elt.name(), "State") == 0,
-               "Expected <State> element. Found '" << elt.name() << "'");
-    return parseStateInternal(elt);
-  }
-
-  // Parses all command-like elements: Command, CommandAck, CommandAbort.
-  static State parseCommand(pugi::xml_node const cmd)
-  {
-    checkError(strcmp(cmd.name(), "Command") == 0 ||
-               strcmp(cmd.name(), "CommandAck") == 0 ||
-               strcmp(cmd.name(), "CommandAbort") == 0,
-               "Expected <Command> element.  Found '" << cmd.name() << "'");
-    return parseStateInternal(cmd);
-  }
-
-  static Value parseResult(pugi::xml_node const cmd)
-  {
-    pugi::xml_node resXml = cmd.child("Result");
-    checkError(!resXml.empty(), "No Result child in <" << cmd.name() << "> element.");
-    checkError(!resXml.first_child().empty(), "Empty Result child in <" << cmd.name() << "> element.");
-    checkError(!cmd.attribute("type").empty(),
-               "No type attribute in <" << cmd.name() << "> element.");
-    std::string type(cmd.attribute("type").value());
-
-    // read in the initiial values and parameters
-    if (type.rfind("array") == std::string::npos) {
-      // Not an array
-      return parseOneValue(type, resXml.child_value());
-    }
-    else {
-      std::vector<Value> values;
-      while (!resXml.empty()) {
-        values.push_back(parseOneValue(type, resXml.child_value()));
-        resXml = resXml.next_sibling();
-      }
-      return Value(values);
-    }
-  }
-
-  static void parseParams(pugi::xml_node const root, 
-                          std::vector<Value>& dest)
-  {
-    size_t n = std::distance(root.begin(), root.end());
-    if (!n)
-      return; // no parameters
-
-    dest.reserve(n);
-    pugi::xml_node param = root.child("Param");
-    while (!param.empty()) {
-      dest.push_back(parseParam(param));
-      param = param.next_sibling("Param");
-    }
-  }
-
-  static Value parseParam(pugi::xml_node const param)
-  {
-    checkError(!param.first_child().empty()
-               || strcmp(param.attribute("type").value(), "string") == 0,
-               "Empty Param child in <" << param.parent().name() << "> element.");
-    std::string type(param.attribute("type").value());
-    std::string val(param.child_value());
-    if (val == "UNKNOWN") {
-      // Create a typed unknown
-      ValueType t = UNKNOWN_TYPE;
-      if (type == "int")
-        t = INTEGER_TYPE;
-      else if (type == "real")
-        t = REAL_TYPE;
-      else if (type == "bool")
-        t = BOOLEAN_TYPE;
-      else if (type == "string")
-        t = STRING_TYPE;
-      return Value(0, t);
-    }
-    else if (type == "int") {
-      Integer value;
-      std::istringstream str(val);
-      str >> value;
-      return Value(value);
-    }
-    else if (type == "real") {
-      Real value;
-      std::istringstream str(val);
-      str >> value;
-      return Value(value);
-    }
-    else if (type == "bool") {
-      bool value;
-      std::istringstream str(val);
-      str >> value;
-      return Value(value);
-    }
-    // string case
-    else if (param.first_child().empty()) {
-      return Value("");
-    }
-    else {
-      return Value(param.child_value());
-    }
-  }
-
-  static Value parseStateValue(pugi::xml_node const stateXml)
-  {
-    // read in values
-    std::string type(stateXml.attribute("type").value());
-    checkError(!type.empty(),
-               "No type attribute in <" << stateXml.name() << "> element");
-
-    pugi::xml_node valXml = stateXml.child("Value");
-    checkError(valXml,
-               "No <Value> element in <"  << stateXml.name() << "> element");
-    if (type.rfind("array") == std::string::npos) {
-      // Not an array
-      return parseOneValue(type, valXml.child_value());
-    }
-    else {
-      std::vector<Value> values;
-      while (!valXml.empty()) {
-        values.push_back(parseOneValue(type, valXml.child_value()));
-        valXml = valXml.next_sibling();
-      }
-      return Value(values);
-    }
-  }
-
-  // parse in value
-  static Value parseOneValue(const std::string& type, 
-                             const std::string& valStr)
-  {
-    // Unknown
-    if (0 == stricmp(valStr.c_str(), "Plexil_Unknown")) return Value();
-
-    // string or string-array
-    else if (type.find("string") == 0) {
-      return Value(valStr);
-    }
-    // int, int-array
-    else if (type.find("int") == 0) {
-      Integer value;
-      std::istringstream ss(valStr);
-      ss >> value;
-      return Value(value);
-    }
-    // real, real-array
-    else if (type.find("real") == 0) {
-      Real value;
-      std::istringstream ss(valStr);
-      ss >> value;
-      return Value(value);
-    }
-    // bool or bool-array
-    else if (type.find("bool") == 0) {
-      if (0 == stricmp(valStr.c_str(), "true"))
-        return Value(true);
-      else if (0 == stricmp(valStr.c_str(), "false"))
-        return Value(false);
-      else {
-        bool value;
-        std::istringstream ss(valStr);
-        ss >> value;
-        return Value(value);
-      }
-    }
-    else {
-      reportParserException("Unknown type attribute \"" << type << "\"");
-      return Value();
-    }
-  }
-
   void TestExternalInterface::lookupNow(State const &state,
                                         LookupReceiver *rcvr)
   {
@@ -33,15 +33,13 @@
 #include <iostream>
 #include <map>
 #include <set>
-
-// Forward reference
-namespace pugi
-{
-  class xml_node;
-}
+#include <vector>
 
 namespace PLEXIL 
 {
+  // Forward references
+  class ScriptReader;
+  struct ScriptEvent;
 
   class TestExternalInterface final :
     public Dispatcher
@@ -50,7 +48,7 @@ namespace PLEXIL
     TestExternalInterface();
     virtual ~TestExternalInterface() = default;
 
-    void run(pugi::xml_node const input);
+    void run(ScriptReader &script);
 
     //
     // Dispatcher API
@@ -76,14 +74,14 @@ namespace PLEXIL
     typedef std::map<State, Command *> StateCommandMap;
     typedef std::map<State, Value>        StateMap;
 
-    void handleInitialState(pugi::xml_node const input);
-    void handleState(pugi::xml_node const elt);
-    void handleCommand(pugi::xml_node const elt);
-    void handleCommandAck(pugi::xml_node const elt);
-    void handleCommandAbort(pugi::xml_node const elt);
-    void handleUpdateAck(pugi::xml_node const elt);
-    void handleSendPlan(pugi::xml_node const elt);
-    void handleSimultaneous(pugi::xml_node const elt);
+    void handleInitialState(std::vector<ScriptEvent> const &events);
+    void handleEvent(ScriptEvent const &event);
+    void handleState(ScriptEvent const &event);
+    void handleCommand(ScriptEvent const &event);
+    void handleCommandAck(ScriptEvent const &event);
+    void handleCommandAbort(ScriptEvent const &event);
+    void handleUpdateAck(ScriptEvent const &event);
+    void handleSendPlan(ScriptEvent const &event);
 
     std::map<std::string, Update *> m_waitingUpdates;
     StateCommandMap m_executingCommands; //map from state to the command objects
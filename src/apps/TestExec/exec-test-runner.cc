@@ -37,6 +37,7 @@
 #include "PlexilExec.hh"
 #include "PlexilSchema.hh"
 #include "ResourceArbiterInterface.hh"
+#include "ScriptReader.hh"
 #include "TestExternalInterface.hh"
 
 #ifdef HAVE_DEBUG_LISTENER
@@ -48,6 +49,7 @@
 #endif
 
 #include <fstream>
+#include <memory>
 #include <string>
 
 #if defined(HAVE_CSTRING)
@@ -78,6 +80,7 @@ int run(int argc, char** argv)
   string planName("error");
   string debugConfig("Debug.cfg");
   string resourceFile("resource.data");
+  string binaryScriptName;
   vector<string> libraryNames;
   vector<string> libraryPaths;
   string
@@ -87,7 +90,9 @@ int run(int argc, char** argv)
                         [-d <debug_config_file>] (default ./Debug.cfg)\n\
                         [+d]                     (disable debug messages)\n\
                         [-r <resource_file>]     (default ./resource.data)\n\
-                        [+r]                     (don't read resource data)\n");
+                        [+r]                     (don't read resource data)\n\
+       exec-test-runner -s <script> -w <binary-script-file>\n\
+                        (convert script to binary format and exit)\n");
 
 #ifdef HAVE_LUV_LISTENER
   string luvHost = LUV_DEFAULT_HOSTNAME;
@@ -132,6 +137,14 @@ int run(int argc, char** argv)
       }
       scriptName = argv[i];
     }
+    else if (strcmp(argv[i], "-w") == 0) {
+      if (argc == (++i)) {
+        warn("Missing argument to the " << argv[i-1] << " option.\n"
+             << usage);
+        return 2;
+      }
+      binaryScriptName = argv[i];
+    }
     else if (strcmp(argv[i], "-l") == 0) {
       if (argc == (++i)) {
         warn("Missing argument to the " << argv[i-1] << " option.\n"
@@ -254,6 +267,35 @@ int run(int argc, char** argv)
     warn("No -s option found.\n" << usage);
     return 2;
   }
+
+  // Convert the script and exit
+  if (!binaryScriptName.empty()) {
+    try {
+      std::unique_ptr<ScriptReader> script(makeScriptReader(scriptName));
+      if (!script) {
+        warn("Error: script file " << scriptName << " not found or not readable");
+        return 1;
+      }
+      std::ofstream out(binaryScriptName.c_str(),
+                        std::ios::out | std::ios::binary | std::ios::trunc);
+      if (!out) {
+        warn("Error: unable to open " << binaryScriptName << " for writing");
+        return 1;
+      }
+      writeBinaryScript(*script, out);
+      if (!out.flush()) {
+        warn("Error writing " << binaryScriptName);
+        return 1;
+      }
+    }
+    catch (ParserException const &e) {
+      warn("Error converting script " << scriptName << ":\n"
+           << e.what());
+      return 1;
+    }
+    return 0;
+  }
+
   if (planName == "error") {
     warn("No -p option found.\n" << usage);
     return 2;
@@ -330,7 +372,7 @@ int run(int argc, char** argv)
     if (fname.rfind(".plx") == std::string::npos)
       fname += ".plx";
     
-    Library const *l;
+    LibraryPtr l;
     try {
       l = loadLibraryNode(fname.c_str());
       if (!l) {
@@ -411,17 +453,10 @@ int run(int argc, char** argv)
 
   // load script
   {
-    pugi::xml_document *scriptDoc;
-    try {
-      scriptDoc = loadXmlFile(scriptName);
-      if (!scriptDoc)
-        warn("Error: script file " << scriptName << " not found or not readable");
-    }
-    catch (ParserException const &e) {
-      warn("Error parsing script " << scriptName << ":\n"
-           << e.what());
-    }
-    if (!scriptDoc) {
+    std::unique_ptr<ScriptReader> script(makeScriptReader(scriptName));
+    if (!script) {
+      warn("Error: script file " << scriptName << " not found or not readable");
+
       // Clean up
       delete g_exec;
       g_exec = nullptr;
@@ -431,12 +466,14 @@ int run(int argc, char** argv)
     }
 
     // execute plan
+    // Script is read incrementally as the plan executes
     clock_t time = clock();
-    pugi::xml_node scriptElement = scriptDoc->document_element();
-    if (scriptElement.empty()
-        || !testTag("PLEXILScript", scriptElement)) {
-      warn("File " << scriptName << " is not a valid PLEXIL simulator script");
-      delete scriptDoc;
+    try {
+      intf.run(*script);
+    }
+    catch (ParserException const &e) {
+      warn("Error parsing script " << scriptName << ":\n"
+           << e.what());
 
       // Clean up
       delete g_exec;
@@ -445,9 +482,7 @@ int run(int argc, char** argv)
 
       return 1;
     }
-    intf.run(scriptElement);
     debugMsg("Time", "Time spent in execution: " << clock() - time);
-    delete scriptDoc;
   }
 
   // clean up
@@ -0,0 +1,306 @@
+/* Copyright (c) 2006-2026, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+//
+// Module test for the TestExec script readers.
+// Converts an XML script to the binary format, replays both, and
+// checks that corrupt binary scripts are rejected with a
+// ParserException rather than misread.
+//
+
+#include "ScriptReader.hh"
+
+#include "DebugMessage.hh"
+#include "Error.hh"
+#include "ParserException.hh"
+
+#include <cstdio> // std::remove()
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <vector>
+
+using namespace PLEXIL;
+
+static char const *const XML_FILE = "script-reader-test.psx";
+static char const *const BINARY_FILE = "script-reader-test.bin";
+static char const *const CORRUPT_FILE = "script-reader-test-corrupt.bin";
+
+// Length of the binary script header
+static size_t const HEADER_LENGTH = 8;
+
+static char const *const SCRIPT =
+  "<PLEXILScript>\n"
+  "  <InitialState>\n"
+  "    <State name=\"time\" type=\"real\"><Value>0</Value></State>\n"
+  "    <State name=\"pos\" type=\"int\"><Param type=\"string\">x</Param>"
+  "<Value>3</Value></State>\n"
+  "  </InitialState>\n"
+  "  <Script>\n"
+  "    <CommandAck name=\"move_to\" type=\"bool\">"
+  "<Param type=\"real\">0.5</Param><Param type=\"int\">UNKNOWN</Param>"
+  "<Result>1</Result></CommandAck>\n"
+  "    <Command name=\"move_to\" type=\"int\">"
+  "<Param type=\"real\">0.5</Param><Param type=\"int\">UNKNOWN</Param>"
+  "<Result>0</Result></Command>\n"
+  "    <Delay/>\n"
+  "    <Simultaneous>\n"
+  "      <State name=\"time\" type=\"real\"><Value>31.5</Value></State>\n"
+  "      <State name=\"names\" type=\"string-array\">"
+  "<Value>a</Value><Value>bc</Value></State>\n"
+  "      <UpdateAck name=\"Update1\"/>\n"
+  "    </Simultaneous>\n"
+  "    <CommandAbort name=\"does_nothing\" type=\"bool\"><Result>1</Result></CommandAbort>\n"
+  "    <Command name=\"sense\" type=\"string\"><Param type=\"bool\">1</Param>"
+  "<Result>ok</Result></Command>\n"
+  "    <SendPlan file=\"plan.plx\"/>\n"
+  "  </Script>\n"
+  "</PLEXILScript>\n";
+
+// The initial state, followed by one entry per step
+typedef std::vector<std::vector<ScriptEvent> > EventLog;
+
+static EventLog readAll(std::string const &filename)
+{
+  std::unique_ptr<ScriptReader> reader(makeScriptReader(filename));
+  checkError(reader, "Unable to open script " << filename);
+  EventLog result(1);
+  reader->readInitialState(result.front());
+  std::vector<ScriptEvent> step;
+  while (reader->readStep(step)) {
+    result.push_back(step);
+    step.clear();
+  }
+  return result;
+}
+
+static bool sameEvent(ScriptEvent const &a, ScriptEvent const &b)
+{
+  return a.type == b.type
+    && a.state == b.state
+    && a.value.valueType() == b.value.valueType()
+    && a.value == b.value
+    && a.name == b.name;
+}
+
+static bool sameEvents(EventLog const &a, EventLog const &b)
+{
+  if (a.size() != b.size()) {
+    std::cout << "  step counts differ: " << a.size() << " vs. " << b.size() << std::endl;
+    return false;
+  }
+  for (size_t i = 0; i < a.size(); ++i) {
+    if (a[i].size() != b[i].size()) {
+      std::cout << "  step " << i << " event counts differ" << std::endl;
+      return false;
+    }
+    for (size_t j = 0; j < a[i].size(); ++j) {
+      if (!sameEvent(a[i][j], b[i][j])) {
+        std::cout << "  step " << i << " event " << j << " differs: "
+                  << a[i][j].state << " = " << a[i][j].value << " vs. "
+                  << b[i][j].state << " = " << b[i][j].value << std::endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+static std::string readFile(char const *filename)
+{
+  std::ifstream in(filename, std::ios::in | std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(in),
+                     std::istreambuf_iterator<char>());
+}
+
+static void writeFile(char const *filename, std::string const &contents)
+{
+  std::ofstream out(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+  out.write(contents.data(), contents.size());
+}
+
+static bool convert(char const *from, char const *to)
+{
+  std::unique_ptr<ScriptReader> reader(makeScriptReader(from));
+  assertTrue_1(reader);
+  std::ofstream out(to, std::ios::out | std::ios::binary | std::ios::trunc);
+  writeBinaryScript(*reader, out);
+  return out.good();
+}
+
+// Offsets of the start of each record, and of the end of the file
+static std::set<size_t> recordBoundaries(std::string const &bin)
+{
+  std::set<size_t> result;
+  size_t offset = HEADER_LENGTH;
+  while (offset + 5 <= bin.size()) {
+    result.insert(offset);
+    size_t len = ((size_t) (unsigned char) bin[offset + 1] << 24)
+      | ((size_t) (unsigned char) bin[offset + 2] << 16)
+      | ((size_t) (unsigned char) bin[offset + 3] << 8)
+      | (size_t) (unsigned char) bin[offset + 4];
+    offset += 5 + len;
+  }
+  result.insert(offset);
+  return result;
+}
+
+// Returns true if reading the script throws a ParserException
+static bool rejected(std::string const &contents)
+{
+  writeFile(CORRUPT_FILE, contents);
+  try {
+    readAll(CORRUPT_FILE);
+  }
+  catch (ParserException const & /* exc */) {
+    return true;
+  }
+  return false;
+}
+
+static bool testRoundTrip()
+{
+  std::cout << "testRoundTrip" << std::endl;
+  writeFile(XML_FILE, SCRIPT);
+  EventLog xmlEvents = readAll(XML_FILE);
+  assertTrue_1(xmlEvents.front().size() == 2);
+  assertTrue_1(xmlEvents.size() == 8);
+  assertTrue_1(xmlEvents[3].empty());     // Delay
+  assertTrue_1(xmlEvents[4].size() == 3); // Simultaneous
+
+  assertTrue_1(convert(XML_FILE, BINARY_FILE));
+  std::string bin = readFile(BINARY_FILE);
+  assertTrue_1(bin.size() > HEADER_LENGTH);
+  assertTrue_1(bin.compare(0, HEADER_LENGTH, "PLXSCRB1") == 0);
+  assertTrue_1(sameEvents(xmlEvents, readAll(BINARY_FILE)));
+
+  // Converting the binary script again gives the same bytes
+  assertTrue_1(convert(BINARY_FILE, CORRUPT_FILE));
+  assertTrue_1(readFile(CORRUPT_FILE) == bin);
+  return true;
+}
+
+static bool testTruncated()
+{
+  std::cout << "testTruncated" << std::endl;
+  std::string bin = readFile(BINARY_FILE);
+  std::set<size_t> boundaries = recordBoundaries(bin);
+  assertTrue_1(*boundaries.rbegin() == bin.size());
+
+  // A script cut inside a record is always rejected. One cut between
+  // records is a shorter script, unless it splits a Simultaneous group.
+  for (size_t len = HEADER_LENGTH + 1; len < bin.size(); ++len) {
+    if (boundaries.count(len))
+      continue;
+    if (!rejected(bin.substr(0, len))) {
+      std::cout << "  script truncated to " << len << " bytes was not rejected" << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool testOversized()
+{
+  std::cout << "testOversized" << std::endl;
+  std::string bin = readFile(BINARY_FILE);
+
+  // Record length larger than the file
+  std::string bad(bin);
+  bad.replace(HEADER_LENGTH + 1, 4, "\xff\xff\xff\xf0", 4);
+  assertTrue_1(rejected(bad));
+
+  // Record length one byte past the end of the file
+  std::set<size_t> boundaries = recordBoundaries(bin);
+  size_t last = *std::next(boundaries.rbegin());
+  bad = bin;
+  bad[last + 4] = (char) (bad[last + 4] + 1);
+  assertTrue_1(rejected(bad));
+
+  // Parameter count larger than the record.  The first record is the
+  // "time" initial state: name, parameter count, value.
+  size_t count = HEADER_LENGTH + 5 + serialSize(std::string("time"));
+  assertTrue_1(bin.compare(count, 4, std::string(4, '\0')) == 0);
+  bad = bin;
+  bad.replace(count, 4, "\x7f\xff\xff\xff", 4);
+  assertTrue_1(rejected(bad));
+
+  // Record longer than its contents
+  bad = bin;
+  bad[HEADER_LENGTH + 4] = (char) (bad[HEADER_LENGTH + 4] + 1);
+  bad.insert(*std::next(boundaries.begin()), 1, '\0');
+  assertTrue_1(rejected(bad));
+  return true;
+}
+
+static bool testUnknownTag()
+{
+  std::cout << "testUnknownTag" << std::endl;
+  std::string bin = readFile(BINARY_FILE);
+  std::set<size_t> boundaries = recordBoundaries(bin);
+  boundaries.erase(bin.size());
+  for (size_t offset : boundaries) {
+    std::string bad(bin);
+    bad[offset] = 'Z';
+    if (!rejected(bad)) {
+      std::cout << "  unknown tag at offset " << offset << " was not rejected" << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+int main()
+{
+  // Read Debug.cfg in current directory, if it exists
+  char debugConfig[] = "Debug.cfg";
+  std::ifstream config(debugConfig);
+  if (config.good()) {
+    PLEXIL::readDebugConfigStream(config);
+    std::cout << "Read debug configuration file " << debugConfig << std::endl;
+  }
+
+  bool success = false;
+  try {
+    success = testRoundTrip()
+      && testTruncated()
+      && testOversized()
+      && testUnknownTag();
+  }
+  catch (std::exception const &exc) {
+    std::cout << "Unexpected exception: " << exc.what() << std::endl;
+    success = false;
+  }
+
+  std::remove(XML_FILE);
+  std::remove(BINARY_FILE);
+  std::remove(CORRUPT_FILE);
+  std::cout << "Script reader test " << (success ? "succeeded" : "failed") << std::endl;
+  return (success ? 0 : 1);
+}
@@ -100,6 +100,9 @@ namespace PLEXIL
     
   protected:
 
+    // Devirtualized transitions, see NodeImpl::transitionAs()
+    friend class NodeImpl;
+
     // Specific behaviors for derived classes
     virtual void specializedHandleExecution(PlexilExec *exec) override;
     virtual void specializedDeactivateExecutable(PlexilExec *exec) override;
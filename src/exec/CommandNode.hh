@@ -82,6 +82,9 @@ namespace PLEXIL
 
   protected:
 
+    // Devirtualized transitions, see NodeImpl::transitionAs()
+    friend class NodeImpl;
+
     // Specific behaviors for derived classes
     virtual void specializedCreateConditionWrappers() override;
     virtual void specializedHandleExecution(PlexilExec *exec) override;
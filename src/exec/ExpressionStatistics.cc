@@ -0,0 +1,235 @@
+/* Copyright (c) 2006-2021, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "ExpressionStatistics.hh"
+
+#include "Assignable.hh"
+#include "Assignment.hh"
+#include "AssignmentNode.hh"
+#include "CommandImpl.hh"
+#include "CommandNode.hh"
+#include "Notifier.hh"
+#include "Update.hh"
+#include "UpdateNode.hh"
+
+#include <algorithm> // std::partial_sort()
+#include <map>
+#include <ostream>
+#include <unordered_set>
+#include <vector>
+
+namespace PLEXIL
+{
+
+  //! Collects the distinct expressions reachable from a plan.
+  class ExpressionCollector final
+  {
+  public:
+    ExpressionCollector() = default;
+    ~ExpressionCollector() = default;
+
+    std::vector<Notifier const *> const &notifiers() const
+    {
+      return m_notifiers;
+    }
+
+    size_t expressionCount() const
+    {
+      return m_seen.size();
+    }
+
+    void addNode(NodeImpl *node)
+    {
+      NodeImpl const *constNode = node;
+      for (size_t i = 0; i < NodeImpl::conditionIndexMax; ++i)
+        addExpression(const_cast<Expression *>(constNode->getCondition(i)));
+      addExpression(node->getStateVariable());
+      addExpression(node->getOutcomeVariable());
+      addExpression(node->getFailureTypeVariable());
+      std::vector<ExpressionPtr> const *vars = node->getLocalVariables();
+      if (vars)
+        for (ExpressionPtr const &var : *vars)
+          addExpression(var.get());
+
+      switch (node->getType()) {
+      case NodeType_Assignment: {
+        Assignment *assign = static_cast<AssignmentNode *>(node)->getAssignment();
+        if (assign) {
+          addExpression(assign->getDest());
+          addExpression(assign->getAck());
+          addExpression(assign->getAbortComplete());
+        }
+        break;
+      }
+
+      case NodeType_Command: {
+        CommandImpl *cmd = static_cast<CommandNode *>(node)->getCommand();
+        if (cmd) {
+          addExpression(cmd->getDest());
+          addExpression(cmd->getAck());
+          addExpression(cmd->getAbortComplete());
+          addExpression(cmd->getCommandHandleKnownFn());
+        }
+        break;
+      }
+
+      case NodeType_Update: {
+        Update *upd = static_cast<UpdateNode *>(node)->getUpdate();
+        if (upd)
+          addExpression(upd->getAck());
+        break;
+      }
+
+      default:
+        break;
+      }
+
+      for (NodeImplPtr const &kid : node->getChildren())
+        addNode(kid.get());
+    }
+
+  private:
+    void addExpression(Listenable *exp)
+    {
+      if (!exp || !m_seen.insert(exp).second)
+        return;
+      Notifier const *notifier = dynamic_cast<Notifier const *>(exp);
+      if (notifier)
+        m_notifiers.push_back(notifier);
+      exp->doSubexprs([this](Listenable *sub) { this->addExpression(sub); });
+    }
+
+    std::unordered_set<Listenable const *> m_seen;
+    std::vector<Notifier const *> m_notifiers;
+  };
+
+  static void printExpression(std::ostream &s, Notifier const *notifier)
+  {
+    Expression const *exp = dynamic_cast<Expression const *>(notifier);
+    if (exp) {
+      s << *exp;
+      return;
+    }
+    // Nodes notify their state, outcome, and failure type variables' listeners
+    NodeImpl const *node = dynamic_cast<NodeImpl const *>(notifier);
+    if (node)
+      s << "(Node " << node->getNodeId() << ')';
+    else
+      s << "(Notifier " << notifier << ')';
+  }
+
+  // Print the top entries of the notifiers, ranked by the given key.
+  template <typename KeyFn>
+  static void reportTop(std::ostream &s,
+                        std::vector<Notifier const *> notifiers,
+                        size_t topCount,
+                        char const *what,
+                        KeyFn key)
+  {
+    size_t n = std::min(topCount, notifiers.size());
+    std::partial_sort(notifiers.begin(), notifiers.begin() + n, notifiers.end(),
+                      [&key](Notifier const *a, Notifier const *b) -> bool
+                      { return key(a) > key(b); });
+    s << " Most " << what << ":\n";
+    for (size_t i = 0; i < n && key(notifiers[i]); ++i) {
+      s << "  " << key(notifiers[i]) << ' ';
+      printExpression(s, notifiers[i]);
+      s << '\n';
+    }
+  }
+
+  static void reportPlan(NodeImpl *root, std::ostream &s, size_t topCount,
+                         bool counting)
+  {
+    ExpressionCollector collector;
+    collector.addNode(root);
+    std::vector<Notifier const *> const &notifiers = collector.notifiers();
+
+    std::map<size_t, size_t> fanOut;
+    size_t listeners = 0;
+    size_t memory = 0;
+    size_t publishes = 0;
+    for (Notifier const *notifier : notifiers) {
+      size_t count = notifier->getListenerCount();
+      ++fanOut[count];
+      listeners += count;
+      memory += notifier->getListenerMemory();
+      if (counting)
+        publishes += notifier->getPublishCount();
+    }
+
+    s << "Plan " << root->getNodeId() << ": "
+      << collector.expressionCount() << " expressions, "
+      << notifiers.size() << " with listener lists, "
+      << listeners << " listeners, "
+      << memory << " bytes of listener lists\n";
+    s << " Listener count distribution:\n";
+    for (std::pair<size_t const, size_t> const &entry : fanOut)
+      s << "  " << entry.first << " listener" << (entry.first == 1 ? "" : "s")
+        << ": " << entry.second << " expression" << (entry.second == 1 ? "" : "s")
+        << '\n';
+
+    reportTop(s, notifiers, topCount, "listeners",
+              [](Notifier const *n) -> size_t { return n->getListenerCount(); });
+    if (counting) {
+      s << " " << publishes << " changes published\n";
+      reportTop(s, notifiers, topCount, "changes published",
+                [](Notifier const *n) -> size_t { return n->getPublishCount(); });
+    }
+  }
+
+  void reportExpressionStatistics(std::list<NodePtr> const &plans,
+                                  std::ostream &s,
+                                  size_t topCount)
+  {
+    bool counting = Notifier::isNotificationCounting();
+    size_t steps = 0, maxPerStep = 0;
+    Notifier::getMacroStepCounts(steps, maxPerStep);
+    if (counting || steps) {
+      size_t total = Notifier::getNotificationCount();
+      s << "Notification counting " << (counting ? "on" : "off") << ": "
+        << total << " notifications in " << steps << " macro steps, maximum "
+        << maxPerStep << " in one step\n";
+      std::vector<size_t> recent = Notifier::getRecentMacroStepCounts();
+      if (!recent.empty()) {
+        s << " Most recent steps:";
+        for (size_t n : recent)
+          s << ' ' << n;
+        s << '\n';
+      }
+      counting = true; // report the counts gathered
+    }
+    else
+      s << "Notification counting off\n";
+
+    for (NodePtr const &plan : plans) {
+      NodeImpl *root = dynamic_cast<NodeImpl *>(plan.get());
+      if (root)
+        reportPlan(root, s, topCount, counting);
+    }
+  }
+
+} // namespace PLEXIL
@@ -0,0 +1,62 @@
+/* Copyright (c) 2006-2021, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef PLEXIL_EXPRESSION_STATISTICS_HH
+#define PLEXIL_EXPRESSION_STATISTICS_HH
+
+#include <cstddef>
+#include <iosfwd>
+#include <list>
+#include <memory>
+
+//
+// Run time statistics on the expression listener graphs of loaded plans
+//
+
+namespace PLEXIL
+{
+  // Forward reference
+  class Node;
+
+  using NodePtr = std::unique_ptr<Node>;
+
+  //! Write a report on the expressions of each plan: the distribution
+  //! of listener counts (fan-out), the memory held by listener lists,
+  //! the expressions with the most listeners, and, if change
+  //! notifications have been counted, the expressions which published
+  //! the most changes and the notifications per macro step.
+  //! @param plans The plans to report on.
+  //! @param s The stream to write to.
+  //! @param topCount The number of expressions to list in each ranking.
+  //! @note Caller must ensure the plans do not change during the call.
+  //! @see Notifier::setNotificationCounting()
+  void reportExpressionStatistics(std::list<NodePtr> const &plans,
+                                  std::ostream &s,
+                                  size_t topCount = 10);
+
+} // namespace PLEXIL
+
+#endif // PLEXIL_EXPRESSION_STATISTICS_HH
@@ -46,6 +46,7 @@ namespace PLEXIL
     static constexpr char const *DEFAULT_COMMAND_ADAPTER_TAG = "DefaultCommandAdapter";
     static constexpr char const *DEFAULT_LOOKUP_ADAPTER_TAG = "DefaultLookupAdapter";
     static constexpr char const *FILTER_TAG = "Filter";
+    static constexpr char const *INPUT_QUEUE_TAG = "InputQueue";
     static constexpr char const *INTERFACES_TAG = "Interfaces";
     static constexpr char const *INTERFACE_LIBRARY_TAG = "InterfaceLibrary";
     static constexpr char const *LIBRARY_NODE_PATH_TAG = "LibraryNodePath";
@@ -64,12 +65,15 @@ namespace PLEXIL
     //
 
     static constexpr char const *ADAPTER_TYPE_ATTR = "AdapterType";
+    static constexpr char const *COALESCE_LOOKUPS_ATTR = "CoalesceLookups";
     static constexpr char const *DEFAULT_HANDLER_ATTR = "DefaultHandler";
     static constexpr char const *FILTER_TYPE_ATTR = "FilterType";
     static constexpr char const *HANDLER_TYPE_ATTR = "HandlerType";
     static constexpr char const *LIB_PATH_ATTR = "LibPath";
     static constexpr char const *LISTENER_TYPE_ATTR = "ListenerType";
     static constexpr char const *NAME_ATTR = "Name";
+    static constexpr char const *PRIORITY_LANES_ATTR = "PriorityLanes";
+    static constexpr char const *SLACK_ATTR = "Slack";
     static constexpr char const *TICK_INTERVAL_ATTR = "TickInterval";
     static constexpr char const *TYPE_ATTR = "Type";
     
@@ -28,14 +28,18 @@
 
 #include "Debug.hh"
 #include "Error.hh"
+#include "Mutex.hh"
 #include "NodeVariableMap.hh"
+#include "PlexilExec.hh"
 
 namespace PLEXIL
 {
 
   LibraryCallNode::LibraryCallNode(char const *nodeId, NodeImpl *parent)
     : ListNode(nodeId, parent),
-      m_aliasMap()
+      m_aliasMap(),
+      m_expander(),
+      m_releaseWhenReset(false)
   {
   }
 
@@ -47,7 +51,9 @@ namespace PLEXIL
                                    NodeState state,
                                    NodeImpl *parent)
     : ListNode(type, name, state, parent),
-      m_aliasMap()
+      m_aliasMap(),
+      m_expander(),
+      m_releaseWhenReset(false)
   {
     checkError(type == LIBRARYNODECALL,
                "Invalid node type " << type << " for a LibraryCallNode");
@@ -73,6 +79,7 @@ namespace PLEXIL
     ListNode::cleanUpNodeBody();
 
     delete m_aliasMap.release();
+    delete m_expander.release();
   }
 
   void LibraryCallNode::allocateAliasMap(size_t n)
@@ -107,4 +114,91 @@ namespace PLEXIL
     return m_aliasMap.get();
   }
 
+  void LibraryCallNode::setExpander(LibraryCallExpander *exp, bool releaseWhenReset)
+  {
+    m_expander.reset(exp);
+    m_releaseWhenReset = releaseWhenReset;
+  }
+
+  void LibraryCallNode::setState(PlexilExec *exec, NodeState newValue, double tym)
+  {
+    ListNode::setState(exec, newValue, tym);
+    if (newValue == INACTIVE_STATE && m_releaseWhenReset && !m_children.empty())
+      releaseBody(exec);
+  }
+
+  // Expansion is part of the transition rather than of getDestState(),
+  // so that condition checks have no side effects and may run on any thread.
+  void LibraryCallNode::prepareTransition()
+  {
+    if (m_state != WAITING_STATE || m_nextState != EXECUTING_STATE
+        || !m_expander || !m_children.empty() || expandBody())
+      return;
+
+    debugMsg("Node:transition",
+             ' ' << m_nodeId << ' ' << this
+             << " WAITING -> ITERATION_ENDED. Library call expansion failed.");
+    m_nextState = ITERATION_ENDED_STATE;
+    m_nextOutcome = FAILURE_OUTCOME;
+    m_nextFailureType = LIBRARY_EXPANSION_FAILED;
+    // Give back the mutexes acquired in order to execute
+    if (m_usingMutexes)
+      for (Mutex *m : *m_usingMutexes)
+        m->release(this);
+  }
+
+  // Construct the called node, and connect it to the conditions
+  // which would have listened to it had it been constructed with the plan.
+  // Called when this node is about to transition from WAITING to EXECUTING,
+  // before the ancestor conditions are activated, so the new child sees
+  // the same condition state it would have seen as an INACTIVE child all along.
+  bool LibraryCallNode::expandBody()
+  {
+    debugMsg("LibraryCallNode:expand", ' ' << m_nodeId);
+    if (!m_expander->expand(this)) {
+      debugMsg("LibraryCallNode:expand", ' ' << m_nodeId << " failed");
+      cleanUpChildConditions();
+      clearChildren();
+      return false;
+    }
+    for (NodeImplPtr &child : m_children) {
+      child->addListener(&m_actionCompleteFn);
+      if (m_conditions[endIdx] == &m_allFinishedFn)
+        child->addListener(&m_allFinishedFn);
+    }
+    return true;
+  }
+
+  static bool isQueued(NodeImpl const *node)
+  {
+    if (node->getQueueStatus() != QUEUE_NONE)
+      return true;
+    for (NodeImplPtr const &child : node->getChildren())
+      if (isQueued(child.get()))
+        return true;
+    return false;
+  }
+
+  // Delete the called node. It is reconstructed if this node executes again.
+  // The exec deletes it once the listeners have seen this step's transitions.
+  void LibraryCallNode::releaseBody(PlexilExec *exec)
+  {
+    // Can't delete a node the exec still holds in one of its queues;
+    // try again at the next reset.
+    for (NodeImplPtr const &child : m_children)
+      if (isQueued(child.get()))
+        return;
+
+    debugMsg("LibraryCallNode:release", ' ' << m_nodeId);
+    for (NodeImplPtr &child : m_children) {
+      child->removeListener(&m_actionCompleteFn);
+      child->removeListener(&m_allFinishedFn);
+    }
+    cleanUpChildConditions();
+    if (exec)
+      for (NodeImplPtr &child : m_children)
+        exec->releaseNode(child.release());
+    clearChildren();
+  }
+
 }
@@ -31,6 +31,21 @@
 
 namespace PLEXIL
 {
+  class LibraryCallNode;
+
+  //! Constructs the called node of a LibraryCallNode on demand.
+  //! Supplied by the plan parser when library expansion is deferred.
+  class LibraryCallExpander
+  {
+  public:
+    virtual ~LibraryCallExpander() = default;
+
+    //! Construct and finalize the called node, and add it as the caller's child.
+    //! @param caller The LibraryCallNode.
+    //! @return True if successful, false if the called node could not
+    //!         be constructed.  The caller discards any partial result.
+    virtual bool expand(LibraryCallNode *caller) = 0;
+  };
 
   class LibraryCallNode : public ListNode
   {
@@ -75,8 +90,39 @@ namespace PLEXIL
 
     void allocateAliasMap(size_t n);
 
+    //! Defer construction of the called node until this node first
+    //! begins executing.
+    //! @param exp The expander; this node takes ownership.
+    //! @param releaseWhenReset If true, delete the called node again
+    //!        when this node is reset to INACTIVE.
+    void setExpander(LibraryCallExpander *exp, bool releaseWhenReset);
+
+    //! Has the called node been constructed?
+    bool isExpanded() const
+    {
+      return !m_children.empty();
+    }
+
+    virtual void setState(PlexilExec *exec, NodeState newValue, double tym) override;
+
+  protected:
+
+    // Devirtualized transitions, see NodeImpl::transitionAs()
+    friend class NodeImpl;
+
+    //! Expands the called node as the node leaves WAITING for EXECUTING.
+    //! If expansion fails, the node goes to ITERATION_ENDED with
+    //! failure type LIBRARY_EXPANSION_FAILED instead.
+    void prepareTransition();
+
   private:
+
+    bool expandBody();
+    void releaseBody(PlexilExec *exec);
+
     NodeVariableMapPtr m_aliasMap;
+    std::unique_ptr<LibraryCallExpander> m_expander;
+    bool m_releaseWhenReset;
   };
 
 }
@@ -32,6 +32,8 @@
 #include "Function.hh"
 #include "NodeOperatorImpl.hh"
 
+#include <algorithm> // std::fill
+
 namespace PLEXIL
 {
 
@@ -50,17 +52,9 @@ namespace PLEXIL
 
     bool operator()(Boolean &result, NodeImpl const *node) const
     {
-      std::vector<NodeImplPtr> const &kids = node->getChildren();
-      size_t total = kids.size();
-      for (size_t i = 0; i < total; ++i) {
-        if (kids[i]->getState() != FINISHED_STATE) {
-          result = false;
-          debugMsg("AllFinished", "result = false");
-          return true;
-        }
-      }
-      debugMsg("AllFinished", "result = true");
-      result = true;
+      ListNode const *list = static_cast<ListNode const *>(node);
+      result = list->getChildCount(FINISHED_STATE) == list->getChildren().size();
+      debugMsg("AllFinished", "result = " << (result ? "true" : "false"));
       return true; // always known
     }
 
@@ -96,22 +90,10 @@ namespace PLEXIL
 
     bool operator()(Boolean &result, NodeImpl const *node) const
     {
-      std::vector<NodeImplPtr> const &kids = node->getChildren();
-      size_t total = kids.size();
-      for (size_t i = 0; i < total; ++i) {
-        switch (kids[i]->getState()) {
-        case WAITING_STATE:
-        case FINISHED_STATE:
-          break;
-
-        default:
-          result = false;
-          debugMsg("AllWaitingOrFinished", " result = false");
-          return true;
-        }
-      }
-      result = true;
-      debugMsg("AllWaitingOrFinished", " result = true");
+      ListNode const *list = static_cast<ListNode const *>(node);
+      result = list->getChildCount(WAITING_STATE) + list->getChildCount(FINISHED_STATE)
+        == list->getChildren().size();
+      debugMsg("AllWaitingOrFinished", " result = " << (result ? "true" : "false"));
       return true; // always known
     }
 
@@ -140,7 +122,8 @@ namespace PLEXIL
   ListNode::ListNode(char const *nodeId, NodeImpl *parent)
     : NodeImpl(nodeId, parent),
       m_actionCompleteFn(AllWaitingOrFinished::instance(), this),
-      m_allFinishedFn(AllFinished::instance(), this)
+      m_allFinishedFn(AllFinished::instance(), this),
+      m_childStateCounts()
   {
   }
 
@@ -154,7 +137,8 @@ namespace PLEXIL
                      NodeImpl *parent)
     : NodeImpl(type, name, state, parent),
       m_actionCompleteFn(AllWaitingOrFinished::instance(), this),
-      m_allFinishedFn(AllFinished::instance(), this)
+      m_allFinishedFn(AllFinished::instance(), this),
+      m_childStateCounts()
   {
     checkError(type == LIST || type == LIBRARYNODECALL,
                "Invalid node type " << type << " for a ListNode");
@@ -339,11 +323,16 @@ namespace PLEXIL
 
     debugMsg("ListNode:cleanUpNodeBody", " for " << m_nodeId);
 
-    // Delete children
+    clearChildren();
+    m_cleanedBody = true;
+  }
+
+  void ListNode::clearChildren()
+  {
     for (NodeImplPtr &child : m_children)
       delete (Node*) child.release();
     m_children.clear();
-    m_cleanedBody = true;
+    std::fill(m_childStateCounts, m_childStateCounts + NODE_STATE_MAX, 0);
   }
 
   void ListNode::cleanUpChildConditions()
@@ -379,6 +368,13 @@ namespace PLEXIL
   void ListNode::addChild(NodeImpl *node)
   {
     m_children.emplace_back(NodeImplPtr(node));
+    ++m_childStateCounts[node->getState()];
+  }
+
+  void ListNode::childStateChanged(NodeState oldState, NodeState newState)
+  {
+    --m_childStateCounts[oldState];
+    ++m_childStateCounts[newState];
   }
 
   //! Sets the state variable to the new state.
@@ -95,6 +95,16 @@ namespace PLEXIL
     // For initialization and parsing.
     virtual NodeVariableMap const *getChildVariableMap() const override;
 
+    /**
+     * @brief Get the number of children currently in the given state.
+     * @param state The state.
+     * @return The count.
+     */
+    size_t getChildCount(NodeState state) const
+    {
+      return m_childStateCounts[state];
+    }
+
     //! Sets the state variable to the new state.
     //! @param exec The PlexilExec instance.
     //! @param newValue The new node state.
@@ -105,9 +115,15 @@ namespace PLEXIL
 
   protected:
 
+    // Devirtualized transitions, see NodeImpl::transitionAs()
+    friend class NodeImpl;
+
     virtual void specializedCreateConditionWrappers() override;
     virtual void specializedActivate() override;
 
+    virtual void childStateChanged(NodeState oldState, NodeState newState) override;
+    void clearChildren(); // deletes the children
+
     virtual void cleanUpConditions() override;
     void cleanUpChildConditions(); // only used by ListNode
     virtual void cleanUpNodeBody() override;
@@ -128,6 +144,10 @@ namespace PLEXIL
     NodeFunction m_allFinishedFn;
     // Shared with derived class LibraryCallNode
     std::vector<NodeImplPtr> m_children; /*<! Vector of child nodes. */
+
+  private:
+
+    size_t m_childStateCounts[NODE_STATE_MAX]; /*<! Number of children in each state. */
   };
 
 }
@@ -24,6 +24,8 @@
 * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include "plexil-config.h"
+
 #include "Mutex.hh"
 
 #include "Debug.hh"
@@ -34,6 +36,10 @@
 #include <map>
 #include <memory> // std::unique_ptr
 
+#ifdef PLEXIL_WITH_THREADS
+#include <mutex>
+#endif
+
 namespace PLEXIL
 {
 
@@ -72,10 +78,19 @@ namespace PLEXIL
 
   static MutexMap s_globalMutexes;
 
+#ifdef PLEXIL_WITH_THREADS
+  //! Plans may be parsed concurrently by several exec instances.
+  static std::recursive_mutex s_globalMutexesLock;
+  using GlobalMutexGuard = std::lock_guard<std::recursive_mutex>;
+#endif
+
   Mutex *getGlobalMutex(char const *name)
   {
     assertTrue_2(name && *name,
                  "getGlobalMutex: null or empty name");
+#ifdef PLEXIL_WITH_THREADS
+    GlobalMutexGuard guard(s_globalMutexesLock);
+#endif
     MutexMap::const_iterator it = s_globalMutexes.find(name);
     if (it != s_globalMutexes.end())
       return it->second.get();
@@ -94,6 +109,9 @@ namespace PLEXIL
 
   Mutex *ensureGlobalMutex(char const *name)
   {
+#ifdef PLEXIL_WITH_THREADS
+    GlobalMutexGuard guard(s_globalMutexesLock);
+#endif
     Mutex *result = getGlobalMutex(name);
     if (result) {
       debugMsg("Mutex:ensureGlobalMutex", " returning existing mutex " << name);
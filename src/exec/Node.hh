@@ -113,6 +113,12 @@ namespace PLEXIL {
      */
     virtual bool getDestState() = 0;
 
+    //! May getDestState() be called off the Exec thread, concurrently
+    //! with other nodes?  True unless evaluating the node's conditions
+    //! writes to an expression's result cache.
+    //! @note Call only from the Exec thread.
+    virtual bool isParallelEvaluable() = 0;
+
     /**
      * @brief Gets the previously calculated destination state of this node.
      * @return The destination state.
@@ -214,6 +220,20 @@ namespace PLEXIL {
 
   std::ostream& operator<<(std::ostream &stream, Node const &node);
 
+  /**
+   * @brief Commit the pending state transitions of a group of nodes.
+   * @param exec The PlexilExec instance.
+   * @param nodes Pointer to the first of the nodes.
+   * @param count The number of nodes.
+   * @param time The time of the transition.
+   * @note All the nodes must be of the same node type, and should
+   *       share the same current and next states.  Equivalent to
+   *       calling transition() on each in order, but avoids
+   *       dispatching on the node type for each one.
+   */
+  extern void transitionNodeGroup(PlexilExec *exec, Node *const *nodes,
+                                  size_t count, double time);
+
 }
 
 #endif
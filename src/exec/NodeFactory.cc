@@ -107,11 +107,9 @@ namespace PLEXIL
 		 && (nodeType < NodeType_error),
 		 "getNodeFactory: Invalid node type value");
 
-    static bool s_inited = false;
-    if (!s_inited) {
-      initializeNodeFactories();
-      s_inited = true;
-    }
+    // Function-local static initialization is thread safe
+    static bool const s_inited = (initializeNodeFactories(), true);
+    (void) s_inited;
     assertTrueMsg(s_nodeFactories[nodeType],
                   "Internal error: no node factory for valid node type" << nodeType);
     return s_nodeFactories[nodeType];
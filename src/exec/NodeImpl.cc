@@ -26,8 +26,12 @@
 
 #include "NodeImpl.hh"
 
+#include "AssignmentNode.hh"
+#include "CommandNode.hh"
 #include "Debug.hh"
 #include "Error.hh"
+#include "LibraryCallNode.hh"
+#include "ListNode.hh"
 #include "Mutex.hh"
 #include "NodeConstants.hh"
 #include "NodeTimepointValue.hh"
@@ -35,6 +39,7 @@
 #include "PlanError.hh"
 #include "PlexilExec.hh"
 #include "StateCache.hh" // currentTime()
+#include "UpdateNode.hh"
 #include "UserVariable.hh"
 
 #include <algorithm> // std::sort
@@ -53,6 +58,7 @@
 
 #include <iomanip>   // std::setprecision
 #include <sstream>
+#include <unordered_set>
 
 namespace PLEXIL
 {
@@ -162,6 +168,7 @@ namespace PLEXIL
       m_state(INACTIVE_STATE),
       m_outcome(NO_OUTCOME),
       m_failureType(NO_FAILURE),
+      m_parallelEvaluable(PARALLEL_UNKNOWN),
       m_nextState(NO_NODE_STATE),
       m_nextOutcome(NO_OUTCOME),
       m_nextFailureType(NO_FAILURE),
@@ -198,6 +205,7 @@ namespace PLEXIL
       m_state(state),
       m_outcome(NO_OUTCOME),
       m_failureType(NO_FAILURE),
+      m_parallelEvaluable(PARALLEL_UNKNOWN),
       m_nextState(NO_NODE_STATE),
       m_nextOutcome(NO_OUTCOME),
       m_nextFailureType(NO_FAILURE),
@@ -625,6 +633,9 @@ namespace PLEXIL
     case QUEUE_PENDING_CHECK:     // already a candidate, silently ignore
       return;
 
+    case QUEUE_PENDING_TRY_CHECK: // already a candidate, silently ignore
+      return;
+
     case QUEUE_TRANSITION_CHECK:  // already a candidate, silently ignore
       return;
 
@@ -745,6 +756,44 @@ namespace PLEXIL
     }
   }
 
+  // True if evaluating the expression, or any it depends upon,
+  // writes to a result cache.
+  static bool writesCache(Listenable *exp, std::unordered_set<Listenable *> &seen)
+  {
+    if (!exp || !seen.insert(exp).second)
+      return false;
+    Expression const *e = dynamic_cast<Expression const *>(exp);
+    if (e && e->cachesValue())
+      return true;
+    bool result = false;
+    exp->doSubexprs([&result, &seen](Listenable *sub)
+                    {
+                      if (!result)
+                        result = writesCache(sub, seen);
+                    });
+    return result;
+  }
+
+  // The condition expressions never change once the node is
+  // constructed, so the answer is computed once.
+  bool NodeImpl::isParallelEvaluable()
+  {
+    if (m_parallelEvaluable == PARALLEL_UNKNOWN) {
+      std::unordered_set<Listenable *> seen;
+      m_parallelEvaluable = PARALLEL_SAFE;
+      for (size_t i = 0; i < conditionIndexMax; ++i) {
+        if (writesCache(getCondition(i), seen)) {
+          debugMsg("NodeImpl:isParallelEvaluable",
+                   ' ' << m_nodeId << ' ' << getConditionName(i)
+                   << " condition writes a result cache");
+          m_parallelEvaluable = PARALLEL_UNSAFE;
+          break;
+        }
+      }
+    }
+    return m_parallelEvaluable == PARALLEL_SAFE;
+  }
+
   /**
    * @brief Gets the destination state of this node, were it to transition, based on the values of various conditions.
    * @return True if the new destination state is different from the last check, false otherwise.
@@ -792,40 +841,34 @@ namespace PLEXIL
   //
 
   void NodeImpl::transition(PlexilExec *exec, double time) 
+  {
+    Node *self = this;
+    transitionNodeGroup(exec, &self, 1, time);
+  }
+
+  //
+  // Transition implementation
+  //
+  // N is the exact class of the node, so the calls to the specialized
+  // transition methods can be resolved at compile time.
+  //
+
+  template <class N>
+  void NodeImpl::transitionAs(PlexilExec *exec, double time)
   {
     // Fail silently
     if (m_nextState == m_state)
       return;
 
+    N *self = static_cast<N *>(this);
+    self->N::prepareTransition();
+
     debugMsg("Node:transition", " Transitioning " << m_nodeId << ' ' << this
              << " from " << nodeStateName(m_state)
              << " to " << nodeStateName(m_nextState)
              << " at " << std::setprecision(15) << time);
-    
-    transitionFrom(exec);
-    transitionTo(exec, time);
-
-    // Clear pending-transition variables
-    m_nextState = NO_NODE_STATE;
-    m_nextOutcome = NO_OUTCOME;
-    m_nextFailureType = NO_FAILURE;
-
-    condDebugMsg(m_state == FINISHED_STATE || m_state == ITERATION_ENDED_STATE,
-                 "Node:outcome",
-                 " Outcome of " << m_nodeId << ' ' << this <<
-                 " is " << outcomeName((NodeOutcome) m_outcome));
-    condDebugMsg(m_outcome == FAILURE_OUTCOME
-                 && (m_state == FINISHED_STATE || m_state == ITERATION_ENDED_STATE),
-                 "Node:failure",
-                 " Failure type of " << m_nodeId << ' ' << this <<
-                 " is " << failureTypeName((FailureType) m_failureType));
-
-    this->publishChange();
-  }
 
-  // Common method 
-  void NodeImpl::transitionFrom(PlexilExec *exec)
-  {
+    // Transition out of the current state
     switch (m_state) {
     case INACTIVE_STATE:
       transitionFromInactive();
@@ -836,11 +879,11 @@ namespace PLEXIL
       break;
 
     case EXECUTING_STATE:
-      transitionFromExecuting(exec);
+      self->N::transitionFromExecuting(exec);
       break;
 
     case FINISHING_STATE:
-      transitionFromFinishing(exec);
+      self->N::transitionFromFinishing(exec);
       break;
 
     case FINISHED_STATE:
@@ -848,7 +891,7 @@ namespace PLEXIL
       break;
 
     case FAILING_STATE:
-      transitionFromFailing(exec);
+      self->N::transitionFromFailing(exec);
       break;
 
     case ITERATION_ENDED_STATE:
@@ -858,11 +901,8 @@ namespace PLEXIL
     default:
       errorMsg("NodeImpl::transitionFrom: Invalid node state " << m_state);
     }
-  }
 
-  // Common method 
-  void NodeImpl::transitionTo(PlexilExec *exec, double time)
-  {
+    // Transition into the next state
     switch (m_nextState) {
     case INACTIVE_STATE:
       transitionToInactive();
@@ -873,23 +913,23 @@ namespace PLEXIL
       break;
 
     case EXECUTING_STATE:
-      transitionToExecuting();
+      self->N::transitionToExecuting();
       break;
 
     case FINISHING_STATE:
-      transitionToFinishing();
+      self->N::transitionToFinishing();
       break;
 
     case FINISHED_STATE:
-      transitionToFinished();
+      self->N::transitionToFinished();
       break;
 
     case FAILING_STATE:
-      transitionToFailing(exec);
+      self->N::transitionToFailing(exec);
       break;
 
     case ITERATION_ENDED_STATE:
-      transitionToIterationEnded();
+      self->N::transitionToIterationEnded();
       break;
 
     default:
@@ -904,6 +944,68 @@ namespace PLEXIL
     }
     if (m_nextState == EXECUTING_STATE)
       execute(exec);
+
+    // Clear pending-transition variables
+    m_nextState = NO_NODE_STATE;
+    m_nextOutcome = NO_OUTCOME;
+    m_nextFailureType = NO_FAILURE;
+
+    condDebugMsg(m_state == FINISHED_STATE || m_state == ITERATION_ENDED_STATE,
+                 "Node:outcome",
+                 " Outcome of " << m_nodeId << ' ' << this <<
+                 " is " << outcomeName((NodeOutcome) m_outcome));
+    condDebugMsg(m_outcome == FAILURE_OUTCOME
+                 && (m_state == FINISHED_STATE || m_state == ITERATION_ENDED_STATE),
+                 "Node:failure",
+                 " Failure type of " << m_nodeId << ' ' << this <<
+                 " is " << failureTypeName((FailureType) m_failureType));
+
+    this->publishChange();
+  }
+
+  template <class N>
+  void NodeImpl::transitionGroupAs(PlexilExec *exec, Node *const *nodes,
+                                   size_t count, double time)
+  {
+    for (size_t i = 0; i < count; ++i)
+      static_cast<N *>(nodes[i])->template transitionAs<N>(exec, time);
+  }
+
+  void transitionNodeGroup(PlexilExec *exec, Node *const *nodes,
+                           size_t count, double time)
+  {
+    if (!count)
+      return;
+
+    // NodeFactory guarantees the node type identifies the exact class
+    switch (nodes[0]->getType()) {
+    case NodeType_Assignment:
+      NodeImpl::transitionGroupAs<AssignmentNode>(exec, nodes, count, time);
+      break;
+
+    case NodeType_Command:
+      NodeImpl::transitionGroupAs<CommandNode>(exec, nodes, count, time);
+      break;
+
+    case NodeType_NodeList:
+      NodeImpl::transitionGroupAs<ListNode>(exec, nodes, count, time);
+      break;
+
+    case NodeType_LibraryNodeCall:
+      NodeImpl::transitionGroupAs<LibraryCallNode>(exec, nodes, count, time);
+      break;
+
+    case NodeType_Update:
+      NodeImpl::transitionGroupAs<UpdateNode>(exec, nodes, count, time);
+      break;
+
+    case NodeType_Empty:
+      NodeImpl::transitionGroupAs<NodeImpl>(exec, nodes, count, time);
+      break;
+
+    default:
+      errorMsg("transitionNodeGroup: Invalid node type " << nodes[0]->getType());
+    }
   }
 
   //
@@ -1528,13 +1630,15 @@ namespace PLEXIL
   }
 
   // Some transition handlers call this twice.
-  // Called from NodeImpl::transitionTo(), ListNodeImpl::setState() (wrapper method)
+  // Called from NodeImpl::transitionAs(), ListNodeImpl::setState() (wrapper method)
   void NodeImpl::setState(PlexilExec *exec, NodeState newValue, double tym)
   {
     if (newValue == m_state)
       return;
     assertTrue_1(exec);
     logTransition(tym, newValue);
+    if (m_parent)
+      m_parent->childStateChanged(m_state, newValue);
     m_state = newValue;
     if (m_state == FINISHED_STATE && !m_parent)
       // Mark this node as ready to be deleted -
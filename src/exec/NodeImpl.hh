@@ -196,6 +196,8 @@ namespace PLEXIL
      */
     virtual bool getDestState() override;
 
+    virtual bool isParallelEvaluable() override;
+
     /**
      * @brief Gets the previously calculated destination state of this node.
      * @return The destination state.
@@ -463,6 +465,12 @@ namespace PLEXIL
     // Only used by Node, ListNode, LibraryCallNode.
     virtual NodeVariableMap const *getChildVariableMap() const;
 
+    //! Notify this node that one of its children is changing state.
+    //! @param oldState The child's current state.
+    //! @param newState The child's new state.
+    //! @note The default method does nothing. ListNode overrides it.
+    virtual void childStateChanged(NodeState /* oldState */, NodeState /* newState */) {}
+
     // *** Seems to be called only from NodeImpl constructor?
     void commonInit();
 
@@ -533,6 +541,13 @@ namespace PLEXIL
     virtual bool getDestStateFromFailing();
     bool getDestStateFromIterationEnded();
 
+    // Called on the Exec thread immediately before a transition.
+    // A node type may revise m_nextState, m_nextOutcome and
+    // m_nextFailureType here, e.g. if it cannot begin executing.
+    void prepareTransition()
+    {
+    }
+
     //
     // Transition out of the named current state.
     void transitionFromInactive();
@@ -564,13 +579,19 @@ namespace PLEXIL
     // Common state
     //
 
+    enum ParallelEvaluable : uint8_t {
+      PARALLEL_UNKNOWN = 0,
+      PARALLEL_SAFE,
+      PARALLEL_UNSAFE
+    };
+
     Node        *m_next;                /*!< For LinkedQueue<Node> */
     QueueStatus  m_queueStatus;         /*!< Which exec queue the node is in, if any. */
     NodeState    m_state;               /*!< The current state of the node. */
     NodeOutcome  m_outcome;             /*!< The current outcome. */
     FailureType  m_failureType;         /*!< The current failure. */
 
-    bool         m_pad; // to ensure 8 byte alignment
+    uint8_t      m_parallelEvaluable;   /*!< Result of isParallelEvaluable(); PARALLEL_UNKNOWN until first call. */
     NodeState    m_nextState;           /*!< The state returned by getDestState() the last time checkConditions() was called. */
     NodeOutcome  m_nextOutcome;         /*!< The pending outcome. */
     FailureType  m_nextFailureType;     /*!< The pending failure. */
@@ -608,10 +629,21 @@ namespace PLEXIL
 
     // These should only be called from transition().
     void setNodeOutcome(NodeOutcome o);
-    void transitionFrom(PlexilExec *exec);
-    void transitionTo(PlexilExec *exec, double tym);
     void logTransition(double time, NodeState newState);
 
+    // Transition implementation for a node whose exact class is N.
+    // Calls to the specialized transition methods are resolved
+    // statically.
+    template <class N>
+    void transitionAs(PlexilExec *exec, double time);
+
+    template <class N>
+    static void transitionGroupAs(PlexilExec *exec, Node *const *nodes,
+                                  size_t count, double time);
+
+    friend void transitionNodeGroup(PlexilExec *exec, Node *const *nodes,
+                                    size_t count, double time);
+
     //
     // Internal versions
     //
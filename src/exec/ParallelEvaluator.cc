@@ -0,0 +1,232 @@
+/* Copyright (c) 2006-2021, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "plexil-config.h"
+
+#include "ParallelEvaluator.hh"
+
+#include "Dispatcher.hh"
+#include "Node.hh"
+#include "PlexilExec.hh"
+#include "StateCache.hh"
+
+#ifdef PLEXIL_WITH_THREADS
+#include <algorithm> // std::min()
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#endif
+
+namespace PLEXIL
+{
+
+#ifdef PLEXIL_WITH_THREADS
+
+  //! Smallest number of nodes handed to a thread at one time.
+  static size_t const MIN_CHUNK_SIZE = 16;
+
+  class ParallelEvaluatorImpl final : public ParallelEvaluator
+  {
+  private:
+    using Lock = std::unique_lock<std::mutex>;
+
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_startCv;   //!< Signals workers that a batch is ready.
+    std::condition_variable m_doneCv;    //!< Signals the caller that workers are done.
+    std::atomic<size_t> m_next;          //!< Index of the next unclaimed node.
+    std::exception_ptr m_error;          //!< First exception thrown by an evaluation.
+
+    // Description of the current batch; written under m_mutex
+    Node * const *m_nodes;
+    char *m_results;
+    size_t m_size;
+    size_t m_chunk;
+
+    // The caller's exec context, bound in each worker for the batch
+    PlexilExec *m_exec;
+    Dispatcher *m_dispatcher;
+    StateCache *m_stateCache;
+
+    size_t m_active;                     //!< Workers still working on this batch.
+    unsigned int m_generation;           //!< Incremented for each batch.
+    bool m_shutdown;
+
+  public:
+    ParallelEvaluatorImpl(size_t nThreads)
+      : ParallelEvaluator(),
+        m_workers(),
+        m_mutex(),
+        m_startCv(),
+        m_doneCv(),
+        m_next(0),
+        m_error(),
+        m_nodes(nullptr),
+        m_results(nullptr),
+        m_size(0),
+        m_chunk(MIN_CHUNK_SIZE),
+        m_exec(nullptr),
+        m_dispatcher(nullptr),
+        m_stateCache(nullptr),
+        m_active(0),
+        m_generation(0),
+        m_shutdown(false)
+    {
+      // The calling thread does its share, so spawn one fewer
+      m_workers.reserve(nThreads - 1);
+      for (size_t i = 1; i < nThreads; ++i)
+        m_workers.emplace_back([this]() -> void {this->worker();});
+    }
+
+    virtual ~ParallelEvaluatorImpl()
+    {
+      {
+        Lock lock(m_mutex);
+        m_shutdown = true;
+      }
+      m_startCv.notify_all();
+      for (std::thread &t : m_workers)
+        t.join();
+    }
+
+    virtual size_t concurrency() const override
+    {
+      return m_workers.size() + 1;
+    }
+
+    virtual void evaluate(std::vector<Node *> const &nodes,
+                          std::vector<char> &results) override
+    {
+      results.resize(nodes.size());
+      if (nodes.empty())
+        return;
+
+      {
+        Lock lock(m_mutex);
+        m_nodes = nodes.data();
+        m_results = results.data();
+        m_size = nodes.size();
+        // Several chunks per thread to even out the load
+        m_chunk = std::max(MIN_CHUNK_SIZE, m_size / (4 * concurrency()));
+        m_next = 0;
+        m_error = nullptr;
+        m_exec = g_exec;
+        m_dispatcher = g_dispatcher;
+        m_stateCache = g_stateCache;
+        m_active = m_workers.size();
+        ++m_generation;
+      }
+      m_startCv.notify_all();
+
+      work();
+
+      std::exception_ptr error;
+      {
+        Lock lock(m_mutex);
+        m_doneCv.wait(lock, [this]() -> bool {return !m_active;});
+        m_nodes = nullptr;
+        m_results = nullptr;
+        error = m_error;
+        m_error = nullptr;
+      }
+      if (error)
+        std::rethrow_exception(error);
+    }
+
+  private:
+
+    void worker()
+    {
+      unsigned int seen = 0;
+      while (true) {
+        {
+          Lock lock(m_mutex);
+          m_startCv.wait(lock,
+                         [this, seen]() -> bool
+                         {return m_shutdown || m_generation != seen;});
+          if (m_shutdown)
+            return;
+          seen = m_generation;
+          g_exec = m_exec;
+          g_dispatcher = m_dispatcher;
+          g_stateCache = m_stateCache;
+        }
+
+        work();
+
+        {
+          Lock lock(m_mutex);
+          if (!--m_active)
+            m_doneCv.notify_one();
+        }
+      }
+    }
+
+    // Claim and evaluate chunks until the batch is exhausted.
+    void work()
+    {
+      size_t const size = m_size;
+      size_t const chunk = m_chunk;
+      while (true) {
+        size_t begin = m_next.fetch_add(chunk);
+        if (begin >= size)
+          return;
+        size_t end = std::min(begin + chunk, size);
+        try {
+          for (size_t i = begin; i < end; ++i)
+            m_results[i] = m_nodes[i]->getDestState();
+        }
+        catch (...) {
+          Lock lock(m_mutex);
+          if (!m_error)
+            m_error = std::current_exception();
+          m_next = size; // abandon the rest of the batch
+          return;
+        }
+      }
+    }
+
+  };
+
+  ParallelEvaluator *makeParallelEvaluator(size_t nThreads)
+  {
+    if (nThreads < 2)
+      return nullptr;
+    return new ParallelEvaluatorImpl(nThreads);
+  }
+
+#else // !PLEXIL_WITH_THREADS
+
+  ParallelEvaluator *makeParallelEvaluator(size_t /* nThreads */)
+  {
+    return nullptr;
+  }
+
+#endif // PLEXIL_WITH_THREADS
+
+} // namespace PLEXIL
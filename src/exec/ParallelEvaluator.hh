@@ -0,0 +1,81 @@
+/* Copyright (c) 2006-2021, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef PLEXIL_PARALLEL_EVALUATOR_HH
+#define PLEXIL_PARALLEL_EVALUATOR_HH
+
+#include <cstddef>
+#include <vector>
+
+namespace PLEXIL
+{
+  // Forward reference
+  class Node;
+
+  //! @class ParallelEvaluator
+  //! Evaluates Node::getDestState() for a batch of candidate nodes
+  //! on a pool of worker threads.
+  //! @note getDestState() writes the node's own next-state fields.
+  //!       It only reads condition values if Node::isParallelEvaluable()
+  //!       is true, so such candidates can be evaluated concurrently
+  //!       within one micro step.
+  class ParallelEvaluator
+  {
+  public:
+    virtual ~ParallelEvaluator() = default;
+
+    //! Get the number of threads, including the caller's, which share the work.
+    virtual size_t concurrency() const = 0;
+
+    //! Call getDestState() on every node in the batch.
+    //! @param nodes The nodes to evaluate. Each must be parallel evaluable.
+    //! @param results On return, results[i] holds the value returned
+    //!        by nodes[i]->getDestState().
+    //! @note Blocks until every node has been evaluated.  If an
+    //!       evaluation throws, the first exception caught is
+    //!       rethrown in the caller's thread.
+    virtual void evaluate(std::vector<Node *> const &nodes,
+                          std::vector<char> &results) = 0;
+
+  protected:
+    ParallelEvaluator() = default;
+
+  private:
+    ParallelEvaluator(ParallelEvaluator const &) = delete;
+    ParallelEvaluator(ParallelEvaluator &&) = delete;
+    ParallelEvaluator &operator=(ParallelEvaluator const &) = delete;
+    ParallelEvaluator &operator=(ParallelEvaluator &&) = delete;
+  };
+
+  //! Construct a ParallelEvaluator.
+  //! @param nThreads Total number of threads to use, including the caller's.
+  //! @return Pointer to the new evaluator; null if nThreads < 2 or
+  //!         the exec was built without thread support.
+  extern ParallelEvaluator *makeParallelEvaluator(size_t nThreads);
+
+} // namespace PLEXIL
+
+#endif // PLEXIL_PARALLEL_EVALUATOR_HH
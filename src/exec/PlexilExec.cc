@@ -37,18 +37,23 @@
 #include "Mutex.hh"
 #include "Node.hh"
 #include "NodeConstants.hh"
+#include "Notifier.hh"
+#include "ParallelEvaluator.hh"
 #include "ResourceArbiterInterface.hh"
 #include "StateCache.hh"
 #include "Update.hh"
 #include "Variable.hh"
 
-#include <algorithm> // std::remove_if()
+#include <algorithm> // std::remove_if(), std::stable_sort()
 
 namespace PLEXIL 
 {
 
-  // Initialization of global variable
-  PlexilExec *g_exec = nullptr;
+  // Initialization of per-thread global variable
+  thread_local PlexilExec *g_exec = nullptr;
+
+  //! Smallest candidate queue worth evaluating in parallel.
+  static size_t const PARALLEL_EVALUATION_THRESHOLD = 64;
 
   //
   // Local classes
@@ -77,6 +82,7 @@ namespace PLEXIL
     LinkedQueue<Node> m_candidateQueue;    /*<! Nodes whose conditions have changed and may be eligible to transition. */
     LinkedQueue<Node> m_stateChangeQueue;  /*<! Nodes awaiting state transition.*/
     LinkedQueue<Node> m_finishedRootNodes; /*<! Root nodes which are no longer eligible to execute. */
+    std::vector<NodePtr> m_releasedNodes;  /*<! Nodes removed from running plans, awaiting deletion. */
     PriorityQueue<Node, PriorityCompare> m_pendingQueue; /*<! Nodes waiting to acquire a mutex or assign a variable. */ 
     LinkedQueue<Assignment> m_assignmentsToExecute;
     LinkedQueue<Assignment> m_assignmentsToRetract;
@@ -88,10 +94,17 @@ namespace PLEXIL
 
     std::list<NodePtr> m_plan; /*<! The root of the plan.*/
     std::vector<NodeTransition> m_transitionsToPublish;
+    std::vector<Node *> m_candidateBatch;  /*<! Candidates drained for parallel evaluation. */
+    std::vector<char> m_candidateResults;  /*<! Results of their getDestState() calls. */
+    std::vector<Node *> m_parallelBatch;   /*<! The candidates safe to evaluate off this thread. */
+    std::vector<char> m_parallelResults;   /*<! Results from the worker pool. */
+    std::vector<Node *> m_transitionBatch; /*<! State change queue, grouped for transition. */
     std::unique_ptr<ResourceArbiterInterface> m_arbiter;
+    std::unique_ptr<ParallelEvaluator> m_evaluator; /*<! Null unless parallel evaluation is enabled. */
     Dispatcher *m_dispatcher;
     ExecListenerBase *m_listener;
     bool m_finishedRootNodesDeleted; /*<! True if at least one finished plan has been deleted */
+    bool m_transitionBatching; /*<! True if transitions are grouped by node type and states */
 
   public:
 
@@ -104,16 +117,25 @@ namespace PLEXIL
         m_candidateQueue(),
         m_stateChangeQueue(),
         m_finishedRootNodes(),
+        m_releasedNodes(),
         m_pendingQueue(),
         m_assignmentsToExecute(),
         m_assignmentsToRetract(),
         m_commandsToExecute(),
         m_commandsToAbort(),
         m_plan(),
+        m_transitionsToPublish(),
+        m_candidateBatch(),
+        m_candidateResults(),
+        m_parallelBatch(),
+        m_parallelResults(),
+        m_transitionBatch(),
         m_arbiter(makeResourceArbiter()),
+        m_evaluator(),
         m_dispatcher(),
         m_listener(),
-        m_finishedRootNodesDeleted(false)
+        m_finishedRootNodesDeleted(false),
+        m_transitionBatching(false)
     {}
 
     virtual ~PlexilExecImpl() 
@@ -121,6 +143,7 @@ namespace PLEXIL
       m_candidateQueue.clear();
       m_stateChangeQueue.clear();
       m_finishedRootNodes.clear();
+      m_releasedNodes.clear();
       m_pendingQueue.clear();
       m_assignmentsToExecute.clear();
       m_assignmentsToRetract.clear();
@@ -133,6 +156,23 @@ namespace PLEXIL
       return m_arbiter.get();
     }
 
+    virtual bool setConditionEvaluationThreads(size_t nThreads) override
+    {
+      if (nThreads < 2) {
+        m_evaluator.reset();
+        return true;
+      }
+      m_evaluator.reset(makeParallelEvaluator(nThreads));
+      debugMsg("PlexilExec:setConditionEvaluationThreads",
+               ' ' << (m_evaluator ? m_evaluator->concurrency() : 1) << " threads");
+      return (bool) m_evaluator;
+    }
+
+    virtual void setTransitionBatching(bool batch) override
+    {
+      m_transitionBatching = batch;
+    }
+
     virtual void setDispatcher(Dispatcher *intf) override
     {
       m_dispatcher = intf;
@@ -197,8 +237,17 @@ namespace PLEXIL
       addFinishedRootNode(node);
     }
 
+    virtual void releaseNode(Node *node) override
+    {
+      debugMsg("PlexilExec:releaseNode",
+               ' ' << node->getNodeId() << ' ' << node);
+      m_releasedNodes.emplace_back(node);
+    }
+
     virtual void deleteFinishedPlans() override
     {
+      // Released nodes may belong to finished plans, so delete them first
+      m_releasedNodes.clear();
       while (!m_finishedRootNodes.empty()) {
         Node *node = m_finishedRootNodes.front();
         m_finishedRootNodes.pop();
@@ -226,6 +275,9 @@ namespace PLEXIL
       // Queue had better be empty when we get here!
       checkError(m_stateChangeQueue.empty(), "State change queue not empty at entry");
 
+      // Listeners have seen the previous step, so released nodes can go
+      m_releasedNodes.clear();
+
 #ifndef NO_DEBUG_MESSAGE_SUPPORT 
       // Only used in debugMsg calls
       unsigned int stepCount = 0;
@@ -245,61 +297,41 @@ namespace PLEXIL
 
       // BEGIN QUIESCENCE LOOP
       do {
-        debugStmt("PlexilExec:step",
-                  {
-                    getDebugOutputStream() << "[PlexilExec:step]["
-                                           << cycleNum << ":" << stepCount << "]";
-                    printConditionCheckQueue();
-                  });
-        condDebugStmt(!m_pendingQueue.empty(),
-                      "PlexilExec:step",
-                      {
-                        getDebugOutputStream() << "[PlexilExec:step]["
-                                               << cycleNum << ":" << stepCount << "]";
-                        printPendingQueue();
-                      });
+        debugMsg("PlexilExec:step",
+                 '[' << cycleNum << ":" << stepCount << "] Check queue: "
+                 << nodeIdList(m_candidateQueue.front()));
+        condDebugMsg(!m_pendingQueue.empty(),
+                     "PlexilExec:step",
+                     '[' << cycleNum << ":" << stepCount << "] Pending queue: "
+                     << nodeIdList(m_pendingQueue.front()));
 
         // Evaluate conditions of nodes reporting a change
-        while (!m_candidateQueue.empty()) {
-          Node *candidate = getCandidateNode();
-          bool canTransition = candidate->getDestState(); // sets node's next state
-          if (canTransition) {
-            debugMsg("PlexilExec:step",
-                     " Node " << candidate->getNodeId() << ' ' << candidate
-                     << " can transition from "
-                     << nodeStateName(candidate->getState())
-                     << " to " << nodeStateName(candidate->getNextState()));
-            if (!resourceCheckRequired(candidate)) {
-              // The node is eligible to transition now
-              addStateChangeNode(candidate);
-            }
-            else {
-              // Possibility of conflict - set it aside to evaluate as a batch
-              addPendingNode(candidate);
-            }
+        if (m_evaluator
+            && m_candidateQueue.size() >= PARALLEL_EVALUATION_THRESHOLD) {
+          evaluateCandidatesInParallel();
+        }
+        else {
+          while (!m_candidateQueue.empty()) {
+            Node *candidate = getCandidateNode();
+            if (candidate->getDestState()) // sets node's next state
+              addEligibleNode(candidate);
           }
         }
 
         // See if any on the pending queue are eligible
         if (!m_pendingQueue.empty()) {
-          debugStmt("PlexilExec:step",
-                    {
-                      getDebugOutputStream() << "[PlexilExec:step]["
-                                             << cycleNum << ":" << stepCount << "]";
-                      printPendingQueue();
-                    });
+          debugMsg("PlexilExec:step",
+                   '[' << cycleNum << ":" << stepCount << "] Pending queue: "
+                   << nodeIdList(m_pendingQueue.front()));
           resolveResourceConflicts();
         }
 
         if (m_stateChangeQueue.empty())
           break; // nothing to do, exit quiescence loop
 
-        debugStmt("PlexilExec:step",
-                  {
-                    getDebugOutputStream() << "[PlexilExec:step]["
-                                           << cycleNum << ":" << stepCount << "]";
-                    printStateChangeQueue();
-                  });
+        debugMsg("PlexilExec:step",
+                 '[' << cycleNum << ":" << stepCount << "] State change queue: "
+                 << nodeIdList(m_stateChangeQueue.front()));
 
 #ifndef NO_DEBUG_MESSAGE_SUPPORT 
         // Only used in debug messages
@@ -312,6 +344,8 @@ namespace PLEXIL
 
         // Transition the nodes
         // Transition may put node on m_candidateQueue or m_finishedRootNodes
+        if (m_transitionBatching)
+          transitionInGroups(startTime);
         while (!m_stateChangeQueue.empty()) {
           Node *node = getStateChangeNode();
           NodeState oldState = node->getState(); // for listener
@@ -355,6 +389,7 @@ namespace PLEXIL
       StateCache::instance().incrementCycleCount();
       performAssignments();
       executeOutboundQueue();
+      Notifier::noteMacroStep();
       if (m_listener)
         m_listener->stepComplete(cycleNum);
 
@@ -436,6 +471,117 @@ namespace PLEXIL
     // At each step, each node in the pending queue is checked.
     // 
 
+    // Sort key for grouping the state change queue.
+    static uint32_t transitionGroupKey(Node const *node)
+    {
+      return (((uint32_t) node->getType()) << 16)
+        | (((uint32_t) node->getState()) << 8)
+        | (uint32_t) node->getNextState();
+    }
+
+    // Transition the state change queue in groups of nodes sharing the
+    // same node type, current state, and next state, in order of
+    // first appearance within each group.
+    void transitionInGroups(double startTime)
+    {
+      m_transitionBatch.clear();
+      while (Node *node = getStateChangeNode())
+        m_transitionBatch.push_back(node);
+      std::stable_sort(m_transitionBatch.begin(), m_transitionBatch.end(),
+                       [] (Node const *a, Node const *b) -> bool
+                       { return transitionGroupKey(a) < transitionGroupKey(b); });
+
+      size_t const n = m_transitionBatch.size();
+      size_t first = 0;
+      while (first < n) {
+        Node *leader = m_transitionBatch[first];
+        uint32_t key = transitionGroupKey(leader);
+        size_t last = first + 1;
+        while (last < n && transitionGroupKey(m_transitionBatch[last]) == key)
+          ++last;
+
+        NodeState oldState = leader->getState(); // for listener
+        debugMsg("PlexilExec:step",
+                 " Transitioning " << last - first << ' '
+                 << nodeTypeString(leader->getType())
+                 << " nodes from " << nodeStateName(oldState)
+                 << " to " << nodeStateName(leader->getNextState()));
+        transitionNodeGroup(this, &m_transitionBatch[first], last - first, startTime);
+        if (m_listener)
+          for (size_t i = first; i < last; ++i)
+            m_transitionsToPublish.emplace_back(NodeTransition(m_transitionBatch[i],
+                                                               oldState,
+                                                               m_transitionBatch[i]->getState()));
+        first = last;
+      }
+      m_transitionBatch.clear();
+    }
+
+    // Queue a node whose getDestState() returned true.
+    void addEligibleNode(Node *candidate)
+    {
+      debugMsg("PlexilExec:step",
+               " Node " << candidate->getNodeId() << ' ' << candidate
+               << " can transition from "
+               << nodeStateName(candidate->getState())
+               << " to " << nodeStateName(candidate->getNextState()));
+      if (!resourceCheckRequired(candidate)) {
+        // The node is eligible to transition now
+        addStateChangeNode(candidate);
+      }
+      else {
+        // Possibility of conflict - set it aside to evaluate as a batch
+        addPendingNode(candidate);
+      }
+    }
+
+    // Drain the candidate queue and evaluate the destination states.
+    // Nodes whose conditions write an expression's result cache are
+    // evaluated here first; the rest touch no shared state and go to
+    // the worker pool. Eligible nodes are then queued in candidate
+    // queue order, exactly as serial evaluation would have done.
+    void evaluateCandidatesInParallel()
+    {
+      static char const IN_PARALLEL_BATCH = 2;
+
+      m_candidateBatch.clear();
+      m_parallelBatch.clear();
+      while (Node *candidate = getCandidateNode())
+        m_candidateBatch.push_back(candidate);
+      m_candidateResults.resize(m_candidateBatch.size());
+      for (size_t i = 0; i < m_candidateBatch.size(); ++i) {
+        Node *candidate = m_candidateBatch[i];
+        if (candidate->isParallelEvaluable()) {
+          m_parallelBatch.push_back(candidate);
+          m_candidateResults[i] = IN_PARALLEL_BATCH;
+        }
+        else
+          m_candidateResults[i] = candidate->getDestState();
+      }
+
+      if (m_parallelBatch.size() >= PARALLEL_EVALUATION_THRESHOLD) {
+        debugMsg("PlexilExec:step",
+                 " evaluating " << m_parallelBatch.size() << " of "
+                 << m_candidateBatch.size() << " candidates on "
+                 << m_evaluator->concurrency() << " threads");
+        m_evaluator->evaluate(m_parallelBatch, m_parallelResults);
+      }
+      else {
+        m_parallelResults.resize(m_parallelBatch.size());
+        for (size_t i = 0; i < m_parallelBatch.size(); ++i)
+          m_parallelResults[i] = m_parallelBatch[i]->getDestState();
+      }
+
+      size_t j = 0;
+      for (size_t i = 0; i < m_candidateBatch.size(); ++i) {
+        bool eligible = (m_candidateResults[i] == IN_PARALLEL_BATCH)
+          ? m_parallelResults[j++]
+          : m_candidateResults[i];
+        if (eligible)
+          addEligibleNode(m_candidateBatch[i]);
+      }
+    }
+
     // We know that the node is eligible to transition.
     // Is it a potential participant in a resource conflict?
     // Returns false if no chance of conflict,
@@ -765,47 +911,16 @@ namespace PLEXIL
       return retval.str();
     }
 
-    void printConditionCheckQueue() const
+    // Node IDs of a queue, starting from its front, for debug messages.
+    // TODO: add mutex, variable info for the pending queue
+    static std::string nodeIdList(Node const *node)
     {
-#ifndef NO_DEBUG_MESSAGE_SUPPORT
-      std::ostream &s = getDebugOutputStream();
-      s << " Check queue: ";
-      Node *node = m_candidateQueue.front();
-      while (node) {
-        s << node->getNodeId() << " ";
-        node = node->next();
-      }
-      s << std::endl;
-#endif
-    }
-
-    // TODO: add mutex, variable info
-    void printPendingQueue() const
-    {
-#ifndef NO_DEBUG_MESSAGE_SUPPORT
-      std::ostream &s = getDebugOutputStream();
-      s << " Pending queue: ";
-      Node *node = m_pendingQueue.front();
-      while (node) {
-        s << node->getNodeId() << " ";
-        node = node->next();
-      }
-      s << std::endl;
-#endif
-    }
-
-    void printStateChangeQueue() const
-    {
-#ifndef NO_DEBUG_MESSAGE_SUPPORT
-      std::ostream &s = getDebugOutputStream();
-      s << " State change queue: ";
-      Node *node = m_stateChangeQueue.front();
+      std::ostringstream retval;
       while (node) {
-        s << node->getNodeId() << " ";
+        retval << node->getNodeId() << ' ';
         node = node->next();
       }
-      s << std::endl;
-#endif
+      return retval.str();
     }
 
   };
@@ -27,6 +27,7 @@
 #ifndef PLEXIL_EXEC_HH
 #define PLEXIL_EXEC_HH
 
+#include <cstddef>
 #include <list>
 #include <memory>
 
@@ -104,6 +105,13 @@ namespace PLEXIL
      */
     virtual void markRootNodeFinished(Node *node) = 0;
 
+    /**
+     * @brief Take ownership of a node removed from a running plan.
+     *        It is deleted after the listeners have been notified of
+     *        the current step, at the next step or with the finished plans.
+     */
+    virtual void releaseNode(Node *node) = 0;
+
     //
     // API to application
     //
@@ -124,6 +132,30 @@ namespace PLEXIL
     //! Get the command resource arbiter.
     virtual ResourceArbiterInterface *getArbiter() = 0;
 
+    /**
+     * @brief Select how many threads evaluate the conditions of
+     *        candidate nodes in each micro step.
+     * @param nThreads Number of threads, including the exec's own.
+     *        0 or 1 selects serial evaluation, which is the default.
+     * @return True if the request was honored, false if parallel
+     *         evaluation is not available in this build.
+     * @note The order of the resulting transitions is the same as
+     *       with serial evaluation.
+     */
+    virtual bool setConditionEvaluationThreads(size_t nThreads) = 0;
+
+    /**
+     * @brief Select whether the state change queue is transitioned
+     *        in groups of nodes with the same node type, current
+     *        state, and next state.
+     * @param batch True to group transitions, false to transition
+     *        in queue order, which is the default.
+     * @note Grouping changes the order in which the nodes of one
+     *       micro step transition, and thus the order in which their
+     *       commands, assignments, and updates are queued.
+     */
+    virtual void setTransitionBatching(bool batch) = 0;
+
     /**
      * @brief Begins a single "macro step" i.e. the entire quiescence cycle.
      */
@@ -170,8 +202,10 @@ namespace PLEXIL
     PlexilExec &operator=(PlexilExec &&) = delete;
   };
 
-  // Global pointer to the exec instance
-  extern PlexilExec *g_exec;
+  //! Pointer to the exec instance in use by the calling thread.
+  //! @note Each thread may be bound to a different exec instance,
+  //!       which allows several independent execs in one process.
+  extern thread_local PlexilExec *g_exec;
 
   /**
    * @brief Construct a PlexilExec instance.
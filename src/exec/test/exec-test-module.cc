@@ -26,6 +26,8 @@
 
 #include "Assignable.hh"
 #include "Debug.hh"
+#include "LibraryCallNode.hh"
+#include "ListNode.hh"
 #include "NodeImpl.hh"
 #include "NodeFactory.hh"
 #include "PlexilExec.hh"
@@ -34,6 +36,10 @@
 
 #include <ostream>
 
+#ifdef PLEXIL_WITH_THREADS
+#include <thread>
+#endif
+
 using namespace PLEXIL;
 
 // For Boolean variable/condition tests
@@ -57,6 +63,7 @@ public:
   virtual void enqueueAbortCommand(CommandImpl * /* cmd */) override {}
   virtual void enqueueUpdate(Update * /* upd */) override {}
   virtual void markRootNodeFinished(Node * /* node */) override {}
+  virtual void releaseNode(Node *node) override { delete node; }
   virtual bool addPlan(Node * /* root */) override { return false; }
   virtual void step(double /* startTime */) override {}
   virtual bool needsStep() const override {return false;}
@@ -64,6 +71,8 @@ public:
   virtual void setExecListener(ExecListenerBase * /* l */) override {}
   virtual ExecListenerBase *getExecListener() override { return nullptr; }
   virtual ResourceArbiterInterface *getArbiter() override { return nullptr; }
+  virtual bool setConditionEvaluationThreads(size_t /* nThreads */) override { return false; }
+  virtual void setTransitionBatching(bool /* batch */) override {}
   virtual void deleteFinishedPlans() override {}
   virtual bool allPlansFinished() const override { return true; }
   virtual std::list<NodePtr> const &getPlans() const override { return g_dummyPlanList; }
@@ -376,6 +385,250 @@ static bool waitingTransTest()
   return true;
 }
 
+class TestExpander : public LibraryCallExpander
+{
+public:
+  TestExpander(bool succeed)
+    : m_succeed(succeed)
+  {
+  }
+
+  virtual bool expand(LibraryCallNode *caller) override
+  {
+    // The partial result of a failed expansion should be discarded
+    caller->addChild(NodeFactory::createNode(EMPTY,
+                                             std::string("callee"),
+                                             INACTIVE_STATE,
+                                             caller));
+    return m_succeed;
+  }
+
+private:
+  bool m_succeed;
+};
+
+static bool libraryCallExpansionTest()
+{
+  TransitionExecConnector con;
+  g_exec = &con;
+  NodeImpl *parent =
+    NodeFactory::createNode(LIST, std::string("testParent"), EXECUTING_STATE, nullptr);
+  Value const falseValue(false);
+  Value const trueValue(true);
+
+  for (int succeed = 0; succeed < 2; ++succeed) {
+    LibraryCallNode *node =
+      dynamic_cast<LibraryCallNode *>(NodeFactory::createNode(LIBRARYNODECALL,
+                                                              std::string("libraryCallExpansionTest"),
+                                                              WAITING_STATE,
+                                                              parent));
+    assertTrue_1(node);
+    node->setExpander(new TestExpander(succeed != 0), true);
+    node->getAncestorExitCondition()->asAssignable()->setValue(falseValue);
+    node->getExitCondition()->asAssignable()->setValue(falseValue);
+    node->getAncestorInvariantCondition()->asAssignable()->setValue(trueValue);
+    node->getAncestorEndCondition()->asAssignable()->setValue(falseValue);
+    node->getSkipCondition()->asAssignable()->setValue(falseValue);
+    node->getStartCondition()->asAssignable()->setValue(trueValue);
+    node->getPreCondition()->asAssignable()->setValue(trueValue);
+
+    // Checking the conditions has no side effects, so the parallel
+    // step may check them on a worker thread
+    assertTrue_1(node->isParallelEvaluable());
+#ifdef PLEXIL_WITH_THREADS
+    bool changed = false;
+    std::thread worker([node, &changed]() -> void { changed = node->getDestState(); });
+    worker.join();
+    assertTrue_1(changed);
+#else
+    assertTrue_1(node->getDestState());
+#endif
+    assertTrue_1(node->getNextState() == EXECUTING_STATE);
+    assertTrue_1(!node->isExpanded());
+
+    // The called node is constructed by the transition
+    node->transition(&con);
+    if (succeed) {
+      assertTrue_1(node->getState() == EXECUTING_STATE);
+      assertTrue_1(node->isExpanded());
+      assertTrue_1(node->getChildren().size() == 1);
+      // Reset releases the called node, once no queue holds it.
+      // This connector never takes the candidates it is given.
+      node->getChildren().front()->setQueueStatus(QUEUE_NONE);
+      node->setState(&con, INACTIVE_STATE, 0.0);
+      assertTrue_1(!node->isExpanded());
+    }
+    else {
+      assertTrue_1(!node->isExpanded());
+      assertTrue_1(node->getState() == ITERATION_ENDED_STATE);
+      assertTrue_1(node->getOutcome() == FAILURE_OUTCOME);
+      assertTrue_1(node->getFailureType() == LIBRARY_EXPANSION_FAILED);
+    }
+    delete (Node*) node;
+  }
+  delete (Node*) parent;
+  g_exec = nullptr;
+  return true;
+}
+
+// Exposes deletion of the children, as on cleanup of the plan
+class ChildCountListNode final : public ListNode
+{
+public:
+  ChildCountListNode()
+    : ListNode(LIST, std::string("listChildCountTest"), EXECUTING_STATE, nullptr)
+  {
+  }
+
+  using ListNode::clearChildren;
+};
+
+// Compare the node's running counts with a count of its children
+static bool childCountsMatch(ListNode const *list)
+{
+  size_t counts[NODE_STATE_MAX] = {};
+  for (NodeImplPtr const &child : list->getChildren())
+    ++counts[child->getState()];
+  for (size_t s = NO_NODE_STATE; s < NODE_STATE_MAX; ++s) {
+    if (list->getChildCount((NodeState) s) != counts[s]) {
+      debugMsg("UnitTest:listChildCountTest",
+               ' ' << list->getNodeId() << " counts "
+               << list->getChildCount((NodeState) s) << " children "
+               << nodeStateName((NodeState) s) << ", has " << counts[s]);
+      return false;
+    }
+  }
+  return true;
+}
+
+static NodeImpl *addCountedChild(ListNode *list, char const *name)
+{
+  NodeImpl *child =
+    NodeFactory::createNode(EMPTY, std::string(name), INACTIVE_STATE, list);
+  list->addChild(child);
+  return child;
+}
+
+// Conditions which let the child run straight through, once the
+// test sets its start, skip or end condition
+static void setRunConditions(NodeImpl *child)
+{
+  Value const falseValue(false);
+  Value const trueValue(true);
+  child->getAncestorExitCondition()->asAssignable()->setValue(falseValue);
+  child->getAncestorInvariantCondition()->asAssignable()->setValue(trueValue);
+  child->getAncestorEndCondition()->asAssignable()->setValue(falseValue);
+  child->getExitCondition()->asAssignable()->setValue(falseValue);
+  child->getInvariantCondition()->asAssignable()->setValue(trueValue);
+  child->getPreCondition()->asAssignable()->setValue(trueValue);
+  child->getPostCondition()->asAssignable()->setValue(trueValue);
+  child->getRepeatCondition()->asAssignable()->setValue(falseValue);
+}
+
+static bool transitionChild(NodeImpl *child, PlexilExec *exec, NodeState expected)
+{
+  setRunConditions(child);
+  assertTrue_1(child->getDestState());
+  assertTrue_1(child->getNextState() == expected);
+  child->transition(exec);
+  assertTrue_1(child->getState() == expected);
+  return childCountsMatch(dynamic_cast<ListNode const *>(child->getParent()));
+}
+
+static bool listChildCountTest()
+{
+  TransitionExecConnector con;
+  g_exec = &con;
+  Value const trueValue(true);
+
+  ChildCountListNode *list = new ChildCountListNode();
+  assertTrue_1(childCountsMatch(list));
+  assertTrue_1(list->getChildCount(INACTIVE_STATE) == 0);
+
+  NodeImpl *first = addCountedChild(list, "first");
+  NodeImpl *second = addCountedChild(list, "second");
+  NodeImpl *third = addCountedChild(list, "third");
+  assertTrue_1(childCountsMatch(list));
+  assertTrue_1(list->getChildCount(INACTIVE_STATE) == 3);
+
+  // Through one iteration
+  assertTrue_1(transitionChild(first, &con, WAITING_STATE));
+  assertTrue_1(transitionChild(second, &con, WAITING_STATE));
+  assertTrue_1(transitionChild(third, &con, WAITING_STATE));
+  assertTrue_1(list->getChildCount(WAITING_STATE) == 3);
+  first->getStartCondition()->asAssignable()->setValue(trueValue);
+  assertTrue_1(transitionChild(first, &con, EXECUTING_STATE));
+  first->getEndCondition()->asAssignable()->setValue(trueValue);
+  assertTrue_1(transitionChild(first, &con, ITERATION_ENDED_STATE));
+  assertTrue_1(transitionChild(first, &con, FINISHED_STATE));
+  second->getSkipCondition()->asAssignable()->setValue(trueValue);
+  assertTrue_1(transitionChild(second, &con, FINISHED_STATE));
+  assertTrue_1(list->getChildCount(FINISHED_STATE) == 2);
+  assertTrue_1(list->getChildCount(WAITING_STATE) == 1);
+
+  // Every state change, whatever its cause
+  for (size_t s = INACTIVE_STATE; s < NODE_STATE_MAX; ++s) {
+    third->setState(&con, (NodeState) s, 0.0);
+    assertTrue_1(childCountsMatch(list));
+  }
+  third->setState(&con, FINISHED_STATE, 0.0);
+  assertTrue_1(list->getChildCount(FINISHED_STATE) == 3);
+
+  // Reset of the children for the next iteration
+  list->setState(&con, WAITING_STATE, 0.0);
+  assertTrue_1(transitionChild(first, &con, INACTIVE_STATE));
+  assertTrue_1(transitionChild(second, &con, INACTIVE_STATE));
+  assertTrue_1(transitionChild(third, &con, INACTIVE_STATE));
+  assertTrue_1(list->getChildCount(INACTIVE_STATE) == 3);
+
+  // Deleting the children
+  list->clearChildren();
+  assertTrue_1(list->getChildren().empty());
+  assertTrue_1(childCountsMatch(list));
+  assertTrue_1(list->getChildCount(INACTIVE_STATE) == 0);
+  addCountedChild(list, "fourth");
+  assertTrue_1(childCountsMatch(list));
+  assertTrue_1(list->getChildCount(INACTIVE_STATE) == 1);
+
+  // Release and re-expansion of a library call's body
+  LibraryCallNode *call =
+    dynamic_cast<LibraryCallNode *>(NodeFactory::createNode(LIBRARYNODECALL,
+                                                            std::string("call"),
+                                                            WAITING_STATE,
+                                                            list));
+  assertTrue_1(call);
+  list->addChild(call);
+  call->setExpander(new TestExpander(true), true);
+  list->setState(&con, EXECUTING_STATE, 0.0);
+  assertTrue_1(childCountsMatch(list));
+  Value const falseValue(false);
+  for (int i = 0; i < 2; ++i) {
+    call->getSkipCondition()->asAssignable()->setValue(falseValue);
+    call->getStartCondition()->asAssignable()->setValue(trueValue);
+    assertTrue_1(transitionChild(call, &con, EXECUTING_STATE));
+    assertTrue_1(call->isExpanded());
+    assertTrue_1(childCountsMatch(call));
+    assertTrue_1(call->getChildCount(INACTIVE_STATE) == 1);
+    NodeImpl *callee = call->getChildren().front().get();
+    callee->setState(&con, WAITING_STATE, 0.0);
+    assertTrue_1(childCountsMatch(call));
+    assertTrue_1(call->getChildCount(WAITING_STATE) == 1);
+
+    // This connector never takes the candidates it is given
+    callee->setQueueStatus(QUEUE_NONE);
+    call->setState(&con, INACTIVE_STATE, 0.0);
+    assertTrue_1(!call->isExpanded());
+    assertTrue_1(childCountsMatch(call));
+    assertTrue_1(call->getChildCount(WAITING_STATE) == 0);
+    assertTrue_1(childCountsMatch(list));
+    assertTrue_1(transitionChild(call, &con, WAITING_STATE));
+  }
+
+  delete (Node*) list;
+  g_exec = nullptr;
+  return true;
+}
+
 static bool iterationEndedDestTest()
 {
   TransitionExecConnector con;
@@ -1752,6 +2005,8 @@ bool stateTransitionTests()
   runTest(inactiveTransTest);
   runTest(waitingDestTest);
   runTest(waitingTransTest);
+  runTest(libraryCallExpansionTest);
+  runTest(listChildCountTest);
   runTest(iterationEndedDestTest);
   runTest(iterationEndedTransTest);
   runTest(finishedDestTest);
@@ -91,6 +91,12 @@ namespace PLEXIL
   
 #undef DEFINE_CACHED_FUNC_DEFAULT_GET_VALUE_PTR_METHOD
 
+    // getValuePointer() writes m_valueCache
+    virtual bool cachesValue() const
+    {
+      return true;
+    }
+
   protected:
 
     // Only available to derived classes
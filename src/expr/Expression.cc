@@ -61,6 +61,12 @@ namespace PLEXIL
     return false;
   }
 
+  // Default method.
+  bool Expression::cachesValue() const
+  {
+    return false;
+  }
+
   // Default method.
   Expression *Expression::getBaseExpression()
   {
@@ -105,6 +105,14 @@ namespace PLEXIL
      */
     virtual bool isConstant() const;
 
+    /**
+     * @brief Query whether evaluating this expression writes to a result cache.
+     * @return True if it does, false otherwise.
+     * @note The default method returns false.
+     * @note Such an expression is only safe to evaluate on the Exec thread.
+     */
+    virtual bool cachesValue() const;
+
     /**
      * @brief Get the real expression for which this may be an alias or reference.
      * @return Pointer to the base expression.
@@ -97,6 +97,7 @@ namespace PLEXIL
   DEFINE_EXPRESSION_CONSTANT(FailureTypeConstant, PARENT_FAILED_CONSTANT, PARENT_FAILED);
   DEFINE_EXPRESSION_CONSTANT(FailureTypeConstant, EXITED_CONSTANT, EXITED);
   DEFINE_EXPRESSION_CONSTANT(FailureTypeConstant, PARENT_EXITED_CONSTANT, PARENT_EXITED);
+  DEFINE_EXPRESSION_CONSTANT(FailureTypeConstant, LIBRARY_EXPANSION_FAILED_CONSTANT, LIBRARY_EXPANSION_FAILED);
 
   //
   // CommandHandleConstant
@@ -102,6 +102,7 @@ namespace PLEXIL
   extern Expression *PARENT_FAILED_CONSTANT();
   extern Expression *EXITED_CONSTANT();
   extern Expression *PARENT_EXITED_CONSTANT();
+  extern Expression *LIBRARY_EXPANSION_FAILED_CONSTANT();
   
   class CommandHandleConstant : public Constant<CommandHandleValue>
   {
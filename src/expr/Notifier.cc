@@ -29,6 +29,13 @@
 #include "Error.hh"
 
 #include <algorithm> // for std::find()
+#include <atomic>
+#include <deque>
+#include <unordered_map>
+
+#ifdef PLEXIL_WITH_THREADS
+#include <mutex>
+#endif
 
 #ifdef LISTENER_DEBUG
 #include "Debug.hh"
@@ -44,6 +51,138 @@ namespace PLEXIL
   Notifier *Notifier::s_instanceList = nullptr;
 #endif
 
+  //
+  // Change notification statistics
+  //
+
+  // Number of recent macro steps whose counts are kept
+  static size_t const RECENT_STEP_LIMIT = 100;
+
+  // Tested on every publishChange() call
+  static std::atomic<bool> s_counting(false);
+
+  // True if any expression may have a publish count
+  static std::atomic<bool> s_haveCounts(false);
+
+  //! Counts gathered while counting is on.
+  //! Counts are kept out of the expressions themselves, so that they
+  //! cost no memory unless in use.
+  struct NotificationCounts final
+  {
+#ifdef PLEXIL_WITH_THREADS
+    std::mutex mutex;
+#endif
+    std::unordered_map<Notifier const *, size_t> publishes;
+    std::deque<size_t> recentSteps;
+    size_t notifications = 0;
+    size_t notificationsAtLastStep = 0;
+    size_t steps = 0;
+    size_t maxPerStep = 0;
+  };
+
+  // Constructed on first use; never deleted, so that expressions
+  // destroyed during static destruction can still consult it
+  static NotificationCounts &counts()
+  {
+    static NotificationCounts *sl_counts = new NotificationCounts();
+    return *sl_counts;
+  }
+
+#ifdef PLEXIL_WITH_THREADS
+  using CountsGuard = std::lock_guard<std::mutex>;
+#define GUARD_COUNTS(c) CountsGuard guard((c).mutex)
+#else
+#define GUARD_COUNTS(c)
+#endif
+
+  static void countPublish(Notifier const *notifier, size_t nListeners)
+  {
+    NotificationCounts &c = counts();
+    GUARD_COUNTS(c);
+    ++c.publishes[notifier];
+    c.notifications += nListeners;
+    s_haveCounts = true;
+  }
+
+  static void forgetPublishes(Notifier const *notifier)
+  {
+    NotificationCounts &c = counts();
+    GUARD_COUNTS(c);
+    c.publishes.erase(notifier);
+  }
+
+  void Notifier::setNotificationCounting(bool enable)
+  {
+    s_counting = enable;
+  }
+
+  bool Notifier::isNotificationCounting()
+  {
+    return s_counting;
+  }
+
+  void Notifier::resetNotificationCounts()
+  {
+    NotificationCounts &c = counts();
+    GUARD_COUNTS(c);
+    c.publishes.clear();
+    c.recentSteps.clear();
+    c.notifications = c.notificationsAtLastStep = 0;
+    c.steps = c.maxPerStep = 0;
+    s_haveCounts = false;
+  }
+
+  void Notifier::noteMacroStep()
+  {
+    if (!s_counting.load(std::memory_order_relaxed))
+      return;
+    NotificationCounts &c = counts();
+    GUARD_COUNTS(c);
+    size_t n = c.notifications - c.notificationsAtLastStep;
+    c.notificationsAtLastStep = c.notifications;
+    ++c.steps;
+    if (n > c.maxPerStep)
+      c.maxPerStep = n;
+    if (c.recentSteps.size() == RECENT_STEP_LIMIT)
+      c.recentSteps.pop_front();
+    c.recentSteps.push_back(n);
+  }
+
+  size_t Notifier::getPublishCount() const
+  {
+    if (!s_haveCounts)
+      return 0;
+    NotificationCounts &c = counts();
+    GUARD_COUNTS(c);
+    std::unordered_map<Notifier const *, size_t>::const_iterator it =
+      c.publishes.find(this);
+    if (it == c.publishes.end())
+      return 0;
+    return it->second;
+  }
+
+  size_t Notifier::getNotificationCount()
+  {
+    NotificationCounts &c = counts();
+    GUARD_COUNTS(c);
+    return c.notifications;
+  }
+
+  void Notifier::getMacroStepCounts(size_t &steps, size_t &maxPerStep)
+  {
+    NotificationCounts &c = counts();
+    GUARD_COUNTS(c);
+    steps = c.steps;
+    maxPerStep = c.maxPerStep;
+  }
+
+  std::vector<size_t> Notifier::getRecentMacroStepCounts()
+  {
+    NotificationCounts &c = counts();
+    GUARD_COUNTS(c);
+    return std::vector<size_t>(c.recentSteps.begin(), c.recentSteps.end());
+  }
+
   Notifier::Notifier()
     : Listenable(),
       m_activeCount(0),
@@ -75,6 +214,9 @@ namespace PLEXIL
     assertTrue_2(m_outgoingListeners.empty(),
                  "Error: Expression still has outgoing listeners.");
 
+    if (s_haveCounts.load(std::memory_order_relaxed))
+      forgetPublishes(this);
+
 #ifdef RECORD_EXPRESSION_STATS
     // Delete this from instance list
     if (m_prev)
@@ -180,11 +322,24 @@ namespace PLEXIL
  
   void Notifier::publishChange()
   {
-    if (isActive())
-      for (std::vector<ExpressionListener *>::iterator it = m_outgoingListeners.begin();
-           it != m_outgoingListeners.end();
-           ++it)
-        (*it)->notifyChanged();
+    if (!isActive())
+      return;
+    if (s_counting.load(std::memory_order_relaxed))
+      countPublish(this, m_outgoingListeners.size());
+    for (std::vector<ExpressionListener *>::iterator it = m_outgoingListeners.begin();
+         it != m_outgoingListeners.end();
+         ++it)
+      (*it)->notifyChanged();
+  }
+
+  size_t Notifier::getListenerCount() const
+  {
+    return m_outgoingListeners.size();
+  }
+
+  size_t Notifier::getListenerMemory() const
+  {
+    return m_outgoingListeners.capacity() * sizeof(ExpressionListener *);
   }
 
 #ifdef RECORD_EXPRESSION_STATS
@@ -197,11 +352,6 @@ namespace PLEXIL
   {
     return s_instanceList;
   }
-
-  size_t Notifier::getListenerCount() const
-  {
-    return m_outgoingListeners.size();
-  }
 #endif
 
 }
@@ -85,10 +85,76 @@ namespace PLEXIL
      */
     virtual void publishChange();
 
+    /**
+     * @brief Get the number of listeners to this expression.
+     */
+    size_t getListenerCount() const;
+
+    /**
+     * @brief Get the memory allocated to this expression's listener list.
+     * @return The size in bytes.
+     */
+    size_t getListenerMemory() const;
+
+    //
+    // Change notification statistics
+    //
+    // Counting is off by default. When off, it costs one test per
+    // call to publishChange().
+    //
+
+    /**
+     * @brief Start or stop counting change notifications.
+     * @param enable True to start, false to stop.
+     * @note Counts gathered so far are kept when counting stops.
+     */
+    static void setNotificationCounting(bool enable);
+
+    /**
+     * @brief Query whether change notifications are being counted.
+     */
+    static bool isNotificationCounting();
+
+    /**
+     * @brief Discard all counts gathered so far.
+     */
+    static void resetNotificationCounts();
+
+    /**
+     * @brief Mark the end of a macro step. Records the number of
+     *        listener notifications since the previous mark.
+     */
+    static void noteMacroStep();
+
+    /**
+     * @brief Get the number of changes this expression has published
+     *        while counting.
+     */
+    size_t getPublishCount() const;
+
+    /**
+     * @brief Get the total number of listener notifications delivered
+     *        while counting.
+     */
+    static size_t getNotificationCount();
+
+    /**
+     * @brief Get the number of macro steps marked while counting, and
+     *        the largest number of notifications in any one of them.
+     * @param steps Reference to the step count.
+     * @param maxPerStep Reference to the maximum notifications per step.
+     */
+    static void getMacroStepCounts(size_t &steps, size_t &maxPerStep);
+
+    /**
+     * @brief Get the notification counts of the most recent macro steps,
+     *        oldest first.
+     */
+    static std::vector<size_t> getRecentMacroStepCounts();
+
 #ifdef RECORD_EXPRESSION_STATS
     static Notifier const *getInstanceList();
     Notifier const *next() const;
-    size_t Notifier::getListenerCount() const
 #endif
 
   protected:
@@ -42,6 +42,8 @@ static bool testStringLength()
   Integer result;
 
   strlen->activate(); // will also activate var
+  assertTrue_1(!strlen->cachesValue());
+  assertTrue_1(!var.cachesValue());
 
   // unknown
   assertTrue_1(!strlen->getValue(result));
@@ -72,6 +74,7 @@ static bool testStringConcat()
     Function *fooConc = makeCachedFunction(StringConcat::instance(),
                                            &foo, false);
     fooConc->activate();
+    assertTrue_1(fooConc->cachesValue());
     assertTrue_1(fooConc->getValue(result));
     assertTrue_1(foo.getValue(result2));
     assertTrue_1(result == result2);
@@ -215,6 +215,10 @@ namespace PLEXIL
       if (xml) {
         taskName = xml.attribute("TaskName").value();
         serverName = xml.attribute("Server").value();
+        // Packed format may be turned off for interoperability testing
+        m_ipcFacade.setPackedFormat(xml.attribute("PackedMessages").as_bool(true));
+        // Shared memory for peers on this host is optional
+        m_ipcFacade.setSharedMemory(xml.attribute("SharedMemory").as_bool());
       }
 
       // Use defaults if necessary
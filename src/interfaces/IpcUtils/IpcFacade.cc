@@ -30,8 +30,10 @@
 #include "CommandHandle.hh"
 #include "Debug.hh"
 #include "Error.hh"
+#include "SharedMemoryRing.hh"
 
 #include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <map>
 #include <thread>
@@ -48,6 +50,10 @@
 #include <string.h>
 #endif
 
+#if defined(HAVE_UNISTD_H)
+#include <unistd.h> // gethostname()
+#endif
+
 namespace PLEXIL 
 {
   // forward reference
@@ -56,6 +62,37 @@ namespace PLEXIL
   static void ipcMessageHandler(MSG_INSTANCE /* rawMsg */,
                                 void * unmarshalledMsg,
                                 void * this_as_void_ptr);
+  static void ipcHandlerChangeHandler(const char *msgName,
+                                      int numHandlers,
+                                      void *this_as_void_ptr);
+  static void ipcDisconnectHandler(const char *moduleName,
+                                   void *this_as_void_ptr);
+
+  //! Size of the shared memory ring created by each IpcFacade.
+  static constexpr size_t SHARED_MEMORY_RING_CAPACITY = 1 << 20;
+
+  //! Fixed part of a packed message as stored in a shared memory
+  //! ring. Followed by the NUL-terminated sender UID, requester UID
+  //! and name strings, then the serialized values.
+  struct PackedRecordHeader
+  {
+    uint16_t leaderType;
+    uint16_t count;
+    uint32_t serial;
+    uint32_t requestSerial;
+    uint32_t senderLength;    // including NUL
+    uint32_t requesterLength; // including NUL
+    uint32_t nameLength;      // including NUL
+    uint32_t dataSize;
+  };
+
+  //! Stand-in for a value message when a packed sequence is delivered
+  //! to listeners. Never sent.
+  struct PlexilValueRefMsg
+  {
+    struct PlexilMsgBase header;
+    Value const *value;
+  };
 
   /**
    * Returns a constant character string pointer for the formatted message type,
@@ -153,6 +190,10 @@ namespace PLEXIL
       return STRING_PAIR_MSG;
       break;
 
+    case PlexilMsgType_PackedValues:
+      return PACKED_VALUES_MSG;
+      break;
+
     default:
       return nullptr;
       break;
@@ -387,6 +428,12 @@ namespace PLEXIL
 
     debugMsg("getPlexilMsgValue", " message type = " << msg->msgType);
     switch ((PlexilMsgType) msg->msgType) {
+    case PlexilMsgType_ValueRef: {
+      PlexilValueRefMsg const *ref = reinterpret_cast<PlexilValueRefMsg const *>(msg);
+      debugMsg("getPlexilMsgValue", " received packed value " << *ref->value);
+      return *ref->value;
+    }
+
     case PlexilMsgType_CommandHandleValue: {
       PlexilCommandHandleValueMsg const *param = reinterpret_cast<const struct PlexilCommandHandleValueMsg*> (msg);
       debugMsg("getPlexilMsgValue",
@@ -488,10 +535,18 @@ namespace PLEXIL
   IpcFacade::IpcFacade() :
     m_myUID(generateUID()),
     m_listenersMutex(),
+    m_packedPeers(),
+    m_ringFallbackPeers(),
+    m_packedPeersMutex(),
+    m_ringDelivered(0),
+    m_leaderHandlers(0),
     m_nextSerial(1),
     m_isInitialized(false),
     m_isStarted(false),
-    m_stopDispatchThread(false)
+    m_stopDispatchThread(false),
+    m_stopRingThread(false),
+    m_packedEnabled(true),
+    m_sharedMemoryEnabled(false)
   {
     debugMsg("IpcFacade", " constructor");
   }
@@ -585,6 +640,36 @@ namespace PLEXIL
                ' ' << m_myUID << " subscribing to messages");
       subscribeToMsgs();
 
+      if (m_packedEnabled && m_sharedMemoryEnabled) {
+#ifdef PLEXIL_IPC_SHARED_MEMORY
+        m_ring.reset(makeSharedMemoryRing(m_myUID, SHARED_MEMORY_RING_CAPACITY));
+        char hostname[256];
+        if (m_ring && !gethostname(hostname, sizeof(hostname))) {
+          hostname[sizeof(hostname) - 1] = '\0';
+          m_endpoint = std::string(hostname) + ' ' + m_ring->name();
+          m_ringDelivered = 0;
+          m_stopRingThread = false;
+          m_ringThread = std::thread([this]() { this->ringDispatch(); });
+        }
+        else {
+          warn("IpcFacade " << m_myUID << ": unable to create shared memory ring");
+          m_ring.reset();
+        }
+#else
+        warn("IpcFacade: shared memory is not supported on this platform");
+#endif
+      }
+
+      if (m_packedEnabled) {
+        // Track which peers accept the packed format
+        IPC_subscribeHandlerChange(STRING_VALUE_MSG, ipcHandlerChangeHandler, this);
+        IPC_subscribeDisconnect(ipcDisconnectHandler, this);
+        m_leaderHandlers = IPC_numHandlers(STRING_VALUE_MSG);
+        debugMsg("IpcFacade:start",
+                 ' ' << m_myUID << ' ' << m_leaderHandlers << " subscribers");
+        announcePackedFormat("");
+      }
+
       // Spawn message thread AFTER all subscribes complete
       // Running thread in parallel with subscriptions resulted in deadlocks
       debugMsg("IpcFacade:start", ' ' << m_myUID << " spawning IPC dispatch thread");
@@ -610,11 +695,28 @@ namespace PLEXIL
     m_stopDispatchThread = true;
     m_thread.join();
 
+    if (m_ring) {
+      debugMsg("IpcFacade:stop", ' ' << m_myUID << " cancelling shared memory thread");
+      m_stopRingThread = true;
+      m_ring->close();
+      m_ringThread.join();
+    }
+
     debugMsg("IpcFacade:stop", ' ' << m_myUID << " unsubscribing all");
     unsubscribeAllListeners();
 
     debugMsg("IpcFacade:stop", ' ' << m_myUID << " unsubscribing from messages");
     unsubscribeFromMsgs();
+    if (m_packedEnabled) {
+      IPC_unsubscribeHandlerChange(STRING_VALUE_MSG, ipcHandlerChangeHandler);
+      IPC_unsubscribeDisconnect(ipcDisconnectHandler);
+      std::lock_guard<std::mutex> guard(m_packedPeersMutex);
+      m_packedPeers.clear();
+      m_localPeers.clear();
+      m_ringFallbackPeers.clear();
+    }
+    m_ring.reset();
+    m_endpoint.clear();
     m_isStarted = false;
 
     // Disconnect from central
@@ -625,6 +727,18 @@ namespace PLEXIL
     debugMsg("IpcFacade:stop", ' ' << m_myUID << " complete");
   }
 
+  void IpcFacade::setPackedFormat(bool enable)
+  {
+    assertTrue_2(!m_isStarted, "setPackedFormat called after started");
+    m_packedEnabled = enable;
+  }
+
+  void IpcFacade::setSharedMemory(bool enable)
+  {
+    assertTrue_2(!m_isStarted, "setSharedMemory called after started");
+    m_sharedMemoryEnabled = enable;
+  }
+
   void IpcFacade::subscribeAll(IpcMessageListener* listener)
   {
     debugMsg("IpcFacade:subscribeAll", " locking listeners mutex");
@@ -686,6 +800,12 @@ namespace PLEXIL
                     "IpcFacade " << m_myUID << ": Subscribing to " << *name
                     << " messages failed; IPC_errno = " << IPC_errno);
     }      
+    if (m_packedEnabled) {
+      status = subscribeDataCentral(PACKED_VALUES_MSG, ipcMessageHandler);
+      assertTrueMsg(status == IPC_OK,
+                    "IpcFacade " << m_myUID << ": Subscribing to " << PACKED_VALUES_MSG
+                    << " messages failed; IPC_errno = " << IPC_errno);
+    }
     return status;
   }
 
@@ -711,6 +831,12 @@ namespace PLEXIL
                     "IpcFacade " << m_myUID << ": Unsubscribing from " << *name
                     << " messages failed; IPC_errno = " << IPC_errno);
     }      
+    if (m_packedEnabled) {
+      status = unsubscribeCentral(PACKED_VALUES_MSG, ipcMessageHandler);
+      assertTrueMsg(status == IPC_OK,
+                    "IpcFacade " << m_myUID << ": Unsubscribing from " << PACKED_VALUES_MSG
+                    << " messages failed; IPC_errno = " << IPC_errno);
+    }
     return status;
   }
 
@@ -742,18 +868,25 @@ namespace PLEXIL
   {
     assertTrue_2(m_isStarted, "publishCommand called before started");
     uint32_t serial = getSerialNumber();
-    struct PlexilStringValueMsg cmdPacket =
-      { { PlexilMsgType_Command,
-          (uint16_t) argsToDeliver.size(),
-          serial,
-          m_myUID.c_str() },
-        command.c_str() };
-
-    IPC_RETURN_TYPE result =
-      IPC_publishData(formatMsgName(STRING_VALUE_MSG, dest), (void *) &cmdPacket);
-
-    if (result == IPC_OK) {
-      result = sendParameters(argsToDeliver, serial);
+    IPC_RETURN_TYPE result;
+    if (usePackedFormat(dest)) {
+      result = publishPacked(PlexilMsgType_Command, serial, command, 0, "",
+                             argsToDeliver.data(), argsToDeliver.size(), dest);
+    }
+    else {
+      struct PlexilStringValueMsg cmdPacket =
+        { { PlexilMsgType_Command,
+            (uint16_t) argsToDeliver.size(),
+            serial,
+            m_myUID.c_str() },
+          command.c_str() };
+
+      result =
+        IPC_publishData(formatMsgName(STRING_VALUE_MSG, dest), (void *) &cmdPacket);
+
+      if (result == IPC_OK) {
+        result = sendParameters(argsToDeliver, serial);
+      }
     }
 
     setError(result);
@@ -776,22 +909,29 @@ namespace PLEXIL
                                     std::string const &dest,
                                     std::vector<Value> const &argsToDeliver)
   {
-    // Construct the messages
-    // Leader
     uint32_t serial = getSerialNumber();
-    struct PlexilStringValueMsg leader =
-      { { PlexilMsgType_LookupNow,
-          (uint16_t) argsToDeliver.size(),
-          serial,
-          m_myUID.c_str() },
-        lookup.c_str() };
-
-    IPC_RETURN_TYPE result =
-      IPC_publishData(formatMsgName(STRING_VALUE_MSG, dest), (void *) &leader);
-
-    if (result == IPC_OK && !argsToDeliver.empty())
-      // Send trailers, if any 
-      result = sendParameters(argsToDeliver, serial);
+    IPC_RETURN_TYPE result;
+    if (usePackedFormat(dest)) {
+      result = publishPacked(PlexilMsgType_LookupNow, serial, lookup, 0, "",
+                             argsToDeliver.data(), argsToDeliver.size(), dest);
+    }
+    else {
+      // Construct the messages
+      // Leader
+      struct PlexilStringValueMsg leader =
+        { { PlexilMsgType_LookupNow,
+            (uint16_t) argsToDeliver.size(),
+            serial,
+            m_myUID.c_str() },
+          lookup.c_str() };
+
+      result =
+        IPC_publishData(formatMsgName(STRING_VALUE_MSG, dest), (void *) &leader);
+
+      if (result == IPC_OK && !argsToDeliver.empty())
+        // Send trailers, if any 
+        result = sendParameters(argsToDeliver, serial);
+    }
 
     setError(result);
     return result == IPC_OK ? serial : ERROR_SERIAL;
@@ -803,17 +943,24 @@ namespace PLEXIL
   {
     assertTrue_2(m_isStarted, "publishReturnValues called before started");
     uint32_t serial = getSerialNumber();
-    struct PlexilReturnValuesMsg packet =
-      { { PlexilMsgType_ReturnValues,
-          1, // trailing msgs
-          serial,
-          m_myUID.c_str() },
-        request_serial,
-        request_uid.c_str() };
-    IPC_RETURN_TYPE result =
-      IPC_publishData(formatMsgName(RETURN_VALUE_MSG, request_uid), (void *) &packet);
-    if (result == IPC_OK) {
-      result = sendParameters(std::vector<Value>(1, arg), serial, request_uid);
+    IPC_RETURN_TYPE result;
+    if (usePackedFormat(request_uid)) {
+      result = publishPacked(PlexilMsgType_ReturnValues, serial, "", request_serial,
+                             request_uid, &arg, 1, request_uid);
+    }
+    else {
+      struct PlexilReturnValuesMsg packet =
+        { { PlexilMsgType_ReturnValues,
+            1, // trailing msgs
+            serial,
+            m_myUID.c_str() },
+          request_serial,
+          request_uid.c_str() };
+      result =
+        IPC_publishData(formatMsgName(RETURN_VALUE_MSG, request_uid), (void *) &packet);
+      if (result == IPC_OK) {
+        result = sendParameters(std::vector<Value>(1, arg), serial, request_uid);
+      }
     }
     setError(result);
     return result == IPC_OK ? serial : ERROR_SERIAL;
@@ -834,15 +981,22 @@ namespace PLEXIL
     debugMsg("IpcFacade:publishTelemetry",
              ' ' << m_myUID << " sending telemetry message for \"" << destName << "\"");
     uint32_t leaderSerial = getSerialNumber();
-    PlexilStringValueMsg tvMsg =
-      { { (uint16_t) PlexilMsgType_TelemetryValues,
-          (uint16_t) values.size(),
-          leaderSerial,
-          m_myUID.c_str()},
-        destName.c_str()};
-    IPC_RETURN_TYPE status = IPC_publishData(STRING_VALUE_MSG, (void *) &tvMsg);
-    if (status == IPC_OK && !values.empty()) {
-      status = sendParameters(values, leaderSerial);
+    IPC_RETURN_TYPE status;
+    if (usePackedFormat("")) {
+      status = publishPacked(PlexilMsgType_TelemetryValues, leaderSerial, destName, 0, "",
+                             values.data(), values.size(), "");
+    }
+    else {
+      PlexilStringValueMsg tvMsg =
+        { { (uint16_t) PlexilMsgType_TelemetryValues,
+            (uint16_t) values.size(),
+            leaderSerial,
+            m_myUID.c_str()},
+          destName.c_str()};
+      status = IPC_publishData(STRING_VALUE_MSG, (void *) &tvMsg);
+      if (status == IPC_OK && !values.empty()) {
+        status = sendParameters(values, leaderSerial);
+      }
     }
     setError(status);
     return status == IPC_OK ? leaderSerial : ERROR_SERIAL;
@@ -867,6 +1021,200 @@ namespace PLEXIL
     return status == IPC_OK ? serial : ERROR_SERIAL;
   }
 
+  // A directed message may be packed if the destination has announced
+  // it accepts the format. A broadcast may be packed only if every
+  // other subscriber to the leader has announced it.
+  bool IpcFacade::usePackedFormat(std::string const &dest)
+  {
+    if (!m_packedEnabled)
+      return false;
+    std::lock_guard<std::mutex> guard(m_packedPeersMutex);
+    if (dest.empty())
+      return (size_t) m_leaderHandlers <= m_packedPeers.size() + 1;
+    return m_packedPeers.find(dest) != m_packedPeers.end();
+  }
+
+  IPC_RETURN_TYPE IpcFacade::publishPacked(PlexilMsgType leaderType,
+                                           uint32_t serial,
+                                           std::string const &name,
+                                           uint32_t requestSerial,
+                                           std::string const &requester,
+                                           Value const *values,
+                                           size_t nValues,
+                                           std::string const &dest)
+  {
+    size_t dataSize = 0;
+    for (size_t i = 0; i < nValues; ++i) {
+      size_t valSize = values[i].serialSize();
+      if (!valSize) {
+        errorMsg("IpcFacade::publishPacked: Invalid or unimplemented PLEXIL data type "
+                 << values[i].valueType());
+        return IPC_Error;
+      }
+      dataSize += valSize;
+    }
+
+    // Build the shared memory record; the IPC packet shares its buffer
+    PackedRecordHeader const rhdr =
+      { (uint16_t) leaderType,
+        (uint16_t) nValues,
+        serial,
+        requestSerial,
+        (uint32_t) m_myUID.size() + 1,
+        (uint32_t) requester.size() + 1,
+        (uint32_t) name.size() + 1,
+        (uint32_t) dataSize };
+    std::vector<char> record(sizeof(rhdr) + rhdr.senderLength + rhdr.requesterLength
+                             + rhdr.nameLength + dataSize);
+    char *b = record.data();
+    memcpy(b, &rhdr, sizeof(rhdr));
+    b += sizeof(rhdr);
+    memcpy(b, m_myUID.c_str(), rhdr.senderLength);
+    b += rhdr.senderLength;
+    memcpy(b, requester.c_str(), rhdr.requesterLength);
+    b += rhdr.requesterLength;
+    memcpy(b, name.c_str(), rhdr.nameLength);
+    b += rhdr.nameLength;
+    char *data = b;
+    for (size_t i = 0; i < nValues; ++i)
+      b = values[i].serialize(b);
+
+    struct PlexilPackedValuesMsg packet =
+      { { PlexilMsgType_PackedValues,
+          (uint16_t) nValues,
+          serial,
+          m_myUID.c_str() },
+        (uint16_t) leaderType,
+        requestSerial,
+        requester.c_str(),
+        name.c_str(),
+        (uint32_t) dataSize,
+        reinterpret_cast<unsigned char *>(data) };
+
+    // Try shared memory first. Announcements always go through central.
+    bool requestSync = false;
+    if (m_ring && leaderType != PlexilMsgType_uninited) {
+      if (!dest.empty()) {
+        std::shared_ptr<SharedMemoryRing> ring;
+        {
+          std::lock_guard<std::mutex> guard(m_packedPeersMutex);
+          auto it = m_localPeers.find(dest);
+          if (it != m_localPeers.end())
+            ring = it->second;
+        }
+        if (ring && writeToRing(dest, ring.get(), record, requestSync)) {
+          debugMsg("IpcFacade:publishPacked",
+                   ' ' << m_myUID << " sent " << nValues << " values to "
+                   << dest << " through shared memory");
+          return IPC_OK;
+        }
+      }
+      else {
+        // Broadcast through shared memory only if every subscriber,
+        // including this instance, has a ring
+        std::vector<std::pair<std::string, std::shared_ptr<SharedMemoryRing>>> rings;
+        {
+          std::lock_guard<std::mutex> guard(m_packedPeersMutex);
+          if ((size_t) m_leaderHandlers == m_localPeers.size() + 1) {
+            rings.assign(m_localPeers.begin(), m_localPeers.end());
+            rings.push_back(std::make_pair(m_myUID, m_ring));
+          }
+        }
+        if (!rings.empty()) {
+          debugMsg("IpcFacade:publishPacked",
+                   ' ' << m_myUID << " broadcasting " << nValues
+                   << " values through shared memory");
+          IPC_RETURN_TYPE status = IPC_OK;
+          for (auto const &r : rings) {
+            // If the ring is full, send to that peer through central
+            bool sync = false;
+            if (!writeToRing(r.first, r.second.get(), record, sync)) {
+              status = IPC_publishData(formatMsgName(PACKED_VALUES_MSG, r.first),
+                                       (void *) &packet);
+              if (sync)
+                requestRingSync(r.first);
+            }
+          }
+          return status;
+        }
+      }
+    }
+
+    debugMsg("IpcFacade:publishPacked",
+             ' ' << m_myUID << " sending " << nValues << " values in "
+             << dataSize << " bytes, leader type " << leaderType);
+    IPC_RETURN_TYPE status =
+      IPC_publishData(dest.empty() ? PACKED_VALUES_MSG : formatMsgName(PACKED_VALUES_MSG, dest),
+                      (void *) &packet);
+    if (requestSync)
+      requestRingSync(dest);
+    return status;
+  }
+
+  bool IpcFacade::writeToRing(std::string const &uid,
+                              SharedMemoryRing *ring,
+                              std::vector<char> const &record,
+                              bool &requestSync)
+  {
+    std::lock_guard<std::mutex> guard(m_packedPeersMutex);
+    auto it = m_ringFallbackPeers.find(uid);
+    if (it != m_ringFallbackPeers.end()) {
+      switch (it->second) {
+      case RING_FULL:
+        // Records sent through central may still be in transit;
+        // have the peer confirm receipt before using the ring again
+        if (ring->empty()) {
+          it->second = RING_SYNC_PENDING;
+          requestSync = true;
+        }
+        return false;
+
+      case RING_SYNC_PENDING:
+        // This record follows the sync request, so the confirmation won't cover it
+        it->second = RING_SYNC_STALE;
+        return false;
+
+      case RING_SYNC_STALE:
+        return false;
+
+      case RING_SYNCED:
+        debugMsg("IpcFacade:publishPacked",
+                 ' ' << m_myUID << " ring of " << uid << " drained, resuming shared memory");
+        m_ringFallbackPeers.erase(it);
+        break;
+      }
+    }
+    if (ring->write(record.data(), record.size()))
+      return true;
+    debugMsg("IpcFacade:publishPacked",
+             ' ' << m_myUID << " ring of " << uid << " full, falling back to central");
+    m_ringFallbackPeers[uid] = RING_FULL;
+    return false;
+  }
+
+  //! Ask a peer to confirm it has received every message sent
+  //! to it through central.
+  //! @param uid The peer's UID.
+  //! @note The request is an announcement with a request serial and
+  //!       no requester; the peer echoes it back with this instance's
+  //!       UID as the requester. Central delivers messages between
+  //!       two modules in order, so the reply follows them.
+  void IpcFacade::requestRingSync(std::string const &uid)
+  {
+    debugMsg("IpcFacade:requestRingSync", ' ' << m_myUID << " to " << uid);
+    IpcSerialNumber serial = getSerialNumber();
+    publishPacked(PlexilMsgType_uninited, serial, "", serial, "",
+                  nullptr, 0, uid);
+  }
+
+  void IpcFacade::announcePackedFormat(std::string const &dest)
+  {
+    debugMsg("IpcFacade:announcePackedFormat",
+             ' ' << m_myUID << " to " << (dest.empty() ? "all" : dest));
+    publishPacked(PlexilMsgType_uninited, getSerialNumber(), m_endpoint, 0, "",
+                  nullptr, 0, dest);
+  }
+
   /**
    * @brief Helper function for sending a vector of parameters via IPC.
    * @param args The arguments to convert into messages and send
@@ -1118,6 +1466,12 @@ namespace PLEXIL
     if (status != IPC_OK)
       return false;
     status = IPC_defineMsg(formatMsgName(STRING_PAIR_MSG, uid), IPC_VARIABLE_LENGTH, STRING_PAIR_MSG_FORMAT);
+    if (status != IPC_OK)
+      return false;
+    status = IPC_defineMsg(PACKED_VALUES_MSG, IPC_VARIABLE_LENGTH, PACKED_VALUES_MSG_FORMAT);
+    if (status != IPC_OK)
+      return false;
+    status = IPC_defineMsg(formatMsgName(PACKED_VALUES_MSG, uid), IPC_VARIABLE_LENGTH, PACKED_VALUES_MSG_FORMAT);
     condDebugMsg(status == IPC_OK, "IpcFacade:definePlexilIPCMessageTypes", " succeeded");
     return status == IPC_OK;
   }
@@ -1160,6 +1514,44 @@ namespace PLEXIL
     facade->handleMessage(msgData);
   }
 
+  /**
+   * @brief Handler change function as seen by IPC.
+   * @note Called from dispatch thread.
+   */
+  void ipcHandlerChangeHandler(const char *msgName,
+                               int numHandlers,
+                               void *IpcFacade_as_void_ptr)
+  {
+    reinterpret_cast<IpcFacade *>(IpcFacade_as_void_ptr)->handleHandlerChange(msgName, numHandlers);
+  }
+
+  /**
+   * @brief Disconnect function as seen by IPC.
+   * @note Called from dispatch thread.
+   */
+  void ipcDisconnectHandler(const char *moduleName,
+                            void *IpcFacade_as_void_ptr)
+  {
+    reinterpret_cast<IpcFacade *>(IpcFacade_as_void_ptr)->handleDisconnect(moduleName);
+  }
+
+  void IpcFacade::handleHandlerChange(const char *msgName, int numHandlers)
+  {
+    debugMsg("IpcFacade:handleHandlerChange",
+             ' ' << m_myUID << ' ' << msgName << " now has " << numHandlers << " handlers");
+    if (!strcmp(msgName, STRING_VALUE_MSG))
+      m_leaderHandlers = numHandlers;
+  }
+
+  void IpcFacade::handleDisconnect(const char *moduleName)
+  {
+    debugMsg("IpcFacade:handleDisconnect", ' ' << m_myUID << ' ' << moduleName);
+    std::lock_guard<std::mutex> guard(m_packedPeersMutex);
+    m_packedPeers.erase(moduleName);
+    m_localPeers.erase(moduleName);
+    m_ringFallbackPeers.erase(moduleName);
+  }
+
   // Handle a message received from IPC dispatch thread
   void IpcFacade::handleMessage(PlexilMsgBase *msgData)
   {
@@ -1246,6 +1638,12 @@ namespace PLEXIL
       deliverMessages(std::vector<PlexilMsgBase *>(1, msgData));
       break;
 
+      // Complete sequence in one message
+    case PlexilMsgType_PackedValues:
+      debugMsg("IpcFacade:handleMessage", " processing as packed sequence");
+      handlePackedMessage(reinterpret_cast<PlexilPackedValuesMsg *>(msgData));
+      break;
+
     default:
       errorMsg("IpcFacade::handleMessage: Received unimplemented or invalid message type "
                << msgType);
@@ -1318,14 +1716,250 @@ namespace PLEXIL
     }
   }
 
+  //! Unpack a packed sequence and deliver it to the listeners
+  //! registered for its leader type, then free the message data.
+  //! @param msg Pointer to the message.
+  //! @note Called from dispatch thread.
+  void IpcFacade::handlePackedMessage(PlexilPackedValuesMsg *msg)
+  {
+    PlexilMsgBase const &header = msg->header;
+    PlexilMsgType leaderType = (PlexilMsgType) msg->leaderType;
+
+    // Any packed message shows the sender accepts the format
+    if (m_myUID != header.senderUID) {
+      bool isNew;
+      {
+        std::lock_guard<std::mutex> guard(m_packedPeersMutex);
+        isNew = m_packedPeers.insert(header.senderUID).second;
+      }
+      // Introduce ourselves to new peers
+      if (isNew) {
+        debugMsg("IpcFacade:handlePackedMessage",
+                 ' ' << m_myUID << " new peer " << header.senderUID);
+        announcePackedFormat(header.senderUID);
+      }
+
+      // Announcements may offer a shared memory ring
+      if (m_ring && leaderType == PlexilMsgType_uninited && msg->name && *msg->name)
+        connectLocalPeer(header.senderUID, msg->name);
+    }
+
+    if (leaderType == PlexilMsgType_uninited && msg->requestSerial) {
+      if (!msg->requesterUID || !*msg->requesterUID) {
+        // Sync request; everything the sender sent before it has been delivered
+        debugMsg("IpcFacade:handlePackedMessage",
+                 ' ' << m_myUID << " confirming sync to " << header.senderUID);
+        publishPacked(PlexilMsgType_uninited, getSerialNumber(), "",
+                      msg->requestSerial, header.senderUID,
+                      nullptr, 0, header.senderUID);
+      }
+      else if (m_myUID == msg->requesterUID) {
+        // Sync confirmed; the ring may be used again unless more
+        // records went through central after the request
+        std::lock_guard<std::mutex> guard(m_packedPeersMutex);
+        auto it = m_ringFallbackPeers.find(header.senderUID);
+        if (it != m_ringFallbackPeers.end()) {
+          if (it->second == RING_SYNC_PENDING)
+            it->second = RING_SYNCED;
+          else if (it->second == RING_SYNC_STALE)
+            it->second = RING_FULL;
+        }
+      }
+    }
+    else if (m_ring) {
+      // The sender may have fallen back to central after filling our
+      // ring; deliver what it wrote there first
+      waitForRingDelivery();
+    }
+
+    deliverPacked(msg);
+    IPC_freeData(IPC_msgFormatter(PACKED_VALUES_MSG), (void *) msg);
+  }
+
+  //! Deliver a packed sequence to the listeners registered for its
+  //! leader type.
+  //! @param msg Const pointer to the message.
+  //! @note Called from dispatch thread and shared memory thread.
+  void IpcFacade::deliverPacked(PlexilPackedValuesMsg const *msg)
+  {
+    PlexilMsgBase const &header = msg->header;
+    PlexilMsgType leaderType = (PlexilMsgType) msg->leaderType;
+
+    // Decode the values
+    std::vector<Value> values(header.count);
+    char const *b = reinterpret_cast<char const *>(msg->data);
+    char const *end = b + msg->dataSize;
+    bool valid = true;
+    for (size_t i = 0; valid && i < values.size(); ++i) {
+      b = values[i].deserialize(b, end);
+      valid = (b != nullptr);
+    }
+    valid = valid && b == end;
+
+    if (!valid) {
+      warn("IpcFacade " << m_myUID << ": malformed packed message from "
+           << header.senderUID << ", serial " << header.serial << ", ignoring");
+    }
+    else {
+      // Present the values to listeners as a multi-message sequence
+      std::vector<PlexilValueRefMsg> refs(values.size());
+      std::vector<PlexilMsgBase *> msgs;
+      msgs.reserve(values.size() + 1);
+      struct PlexilStringValueMsg nameLeader =
+        { { msg->leaderType, header.count, header.serial, header.senderUID },
+          msg->name };
+      struct PlexilReturnValuesMsg returnLeader =
+        { { msg->leaderType, header.count, header.serial, header.senderUID },
+          msg->requestSerial,
+          msg->requesterUID };
+
+      switch (leaderType) {
+      case PlexilMsgType_Command:
+      case PlexilMsgType_LookupNow:
+      case PlexilMsgType_TelemetryValues:
+        msgs.push_back(reinterpret_cast<PlexilMsgBase *>(&nameLeader));
+        break;
+
+        // Only pay attention to return values directed at us
+      case PlexilMsgType_ReturnValues:
+        if (msg->requesterUID && m_myUID == msg->requesterUID)
+          msgs.push_back(reinterpret_cast<PlexilMsgBase *>(&returnLeader));
+        break;
+
+        // Announcement, nothing to deliver
+      case PlexilMsgType_uninited:
+        break;
+
+      default:
+        errorMsg("IpcFacade::deliverPacked: Received unimplemented or invalid leader type "
+                 << leaderType);
+        break;
+      }
+
+      if (!msgs.empty()) {
+        for (size_t i = 0; i < values.size(); ++i) {
+          refs[i] = { { PlexilMsgType_ValueRef, (uint16_t) i, header.serial, header.senderUID },
+                      &values[i] };
+          msgs.push_back(reinterpret_cast<PlexilMsgBase *>(&refs[i]));
+        }
+        debugMsg("IpcFacade:deliverPacked",
+                 ' ' << m_myUID << " delivering " << msgs.size() << " messages");
+        notifyListeners(msgs);
+      }
+    }
+  }
+
+  //! Attach to the shared memory ring of a peer on this host.
+  //! @param uid The peer's UID.
+  //! @param endpoint The host name and ring name announced by the peer.
+  //! @note Called from dispatch thread.
+  void IpcFacade::connectLocalPeer(std::string const &uid, std::string const &endpoint)
+  {
+#ifdef PLEXIL_IPC_SHARED_MEMORY
+    size_t sep = endpoint.find(' ');
+    if (sep == std::string::npos
+        || endpoint.compare(0, sep, m_endpoint, 0, m_endpoint.find(' ')))
+      return; // malformed, or on another host
+    {
+      std::lock_guard<std::mutex> guard(m_packedPeersMutex);
+      if (m_localPeers.find(uid) != m_localPeers.end())
+        return;
+    }
+    std::shared_ptr<SharedMemoryRing> ring(openSharedMemoryRing(endpoint.substr(sep + 1), uid));
+    if (ring) {
+      debugMsg("IpcFacade:connectLocalPeer",
+               ' ' << m_myUID << " using shared memory for " << uid);
+      std::lock_guard<std::mutex> guard(m_packedPeersMutex);
+      m_localPeers.emplace(uid, ring);
+    }
+#endif
+  }
+
+  //! Read and deliver messages from this instance's shared memory ring.
+  //! @note Runs in its own thread until stop() is called.
+  void IpcFacade::ringDispatch()
+  {
+    debugMsg("IpcFacade:ringDispatch", ' ' << m_myUID << " started");
+    std::vector<char> record;
+    while (!m_stopRingThread) {
+      // Everything before the read position has been delivered
+      {
+        std::lock_guard<std::mutex> guard(m_ringDeliveredMutex);
+        m_ringDelivered = m_ring->readPosition();
+      }
+      m_ringDeliveredCv.notify_all();
+
+      if (!m_ring->read(record, 1000))
+        continue;
+
+      PackedRecordHeader rhdr;
+      if (record.size() < sizeof(rhdr)) {
+        warn("IpcFacade " << m_myUID << ": short shared memory record, ignoring");
+        continue;
+      }
+      memcpy(&rhdr, record.data(), sizeof(rhdr));
+      if (sizeof(rhdr) + rhdr.senderLength + rhdr.requesterLength
+          + rhdr.nameLength + rhdr.dataSize != record.size()
+          || !rhdr.senderLength || !rhdr.requesterLength || !rhdr.nameLength) {
+        warn("IpcFacade " << m_myUID << ": malformed shared memory record, ignoring");
+        continue;
+      }
+
+      char *sender = record.data() + sizeof(rhdr);
+      char *requester = sender + rhdr.senderLength;
+      char *name = requester + rhdr.requesterLength;
+      char *data = name + rhdr.nameLength;
+      // Guard against a misbehaving writer
+      requester[-1] = name[-1] = data[-1] = '\0';
+      PlexilPackedValuesMsg const msg =
+        { { PlexilMsgType_PackedValues,
+            rhdr.count,
+            rhdr.serial,
+            sender },
+          rhdr.leaderType,
+          rhdr.requestSerial,
+          requester,
+          name,
+          rhdr.dataSize,
+          reinterpret_cast<unsigned char *>(data) };
+      deliverPacked(&msg);
+    }
+    debugMsg("IpcFacade:ringDispatch", ' ' << m_myUID << " terminated");
+  }
+
+  //! Wait until every record already in this instance's shared
+  //! memory ring has been delivered.
+  //! @note Called from dispatch thread.
+  void IpcFacade::waitForRingDelivery()
+  {
+    uint64_t const pos = m_ring->writePosition();
+    std::unique_lock<std::mutex> lock(m_ringDeliveredMutex);
+    while (m_ringDelivered < pos && !m_stopDispatchThread && !m_stopRingThread)
+      m_ringDeliveredCv.wait_for(lock, std::chrono::milliseconds(100));
+  }
+
   //! Deliver the given messages to all listeners registered for the leader,
   //! then free the message data.
   //! @param msgs (Const reference to) Vector of message pointers
   //! @note Called from dispatch thread.
   void IpcFacade::deliverMessages(const std::vector<PlexilMsgBase *>& msgs)
+  {
+    notifyListeners(msgs);
+
+    // clean up
+    for (size_t i = 0; i < msgs.size(); i++) {
+      PlexilMsgBase* msg = msgs[i];
+      IPC_freeData(IPC_msgFormatter(msgFormatForType((PlexilMsgType) msg->msgType)), (void *) msg);
+    }
+  }
+
+  //! Deliver the given messages to all listeners registered for the leader.
+  //! @param msgs (Const reference to) Vector of message pointers
+  //! @note Called from dispatch thread.
+  void IpcFacade::notifyListeners(const std::vector<PlexilMsgBase *>& msgs)
   {
     assertTrue_2(!msgs.empty(),
-                 "IpcFacade::deliverMessages: empty message vector");
+                 "IpcFacade::notifyListeners: empty message vector");
 
     {
       debugMsg("IpcFacade:deliverMessage", " locking listeners mutex");
@@ -1344,12 +1978,6 @@ namespace PLEXIL
       }
     }
     debugMsg("IpcFacade:deliverMessage", " unlocked listeners mutex");
-
-    // clean up
-    for (size_t i = 0; i < msgs.size(); i++) {
-      PlexilMsgBase* msg = msgs[i];
-      IPC_freeData(IPC_msgFormatter(msgFormatForType((PlexilMsgType) msg->msgType)), (void *) msg);
-    }
   }
 
 // UUID generation constants
@@ -32,16 +32,23 @@
 
 #include "Value.hh"
 
+#include <atomic>
+#include <condition_variable>
 #include <limits>
 #include <list>
 #include <map>
+#include <memory>
 #include <mutex>
+#include <set>
 #include <string>
 #include <thread>
 #include <vector>
 
 namespace PLEXIL {
 
+  // Forward reference
+  class SharedMemoryRing;
+
   //! Return type from many of the IpcFacade member functions
   using IpcSerialNumber = uint32_t;
 
@@ -104,6 +111,23 @@ namespace PLEXIL {
      */
     void stop();
 
+    //! Allow or forbid use of the packed single-message format.
+    //! @param enable If false, only the multi-message format is sent
+    //!               or accepted.
+    //! @note The packed format is enabled by default. It is only sent
+    //!       to peers which have announced that they accept it.
+    //! @note Must be called before start().
+    void setPackedFormat(bool enable);
+
+    //! Allow or forbid use of shared memory for peers on this host.
+    //! @param enable If true, packed messages to peers on the same
+    //!               host which also allow it are passed through a
+    //!               shared memory ring instead of the central server.
+    //! @note Shared memory is disabled by default. It requires the
+    //!       packed format.
+    //! @note Must be called before start().
+    void setSharedMemory(bool enable);
+
     //! Subscribe this listener for all PLEXIL message types.
     //! @param listener The listener.
     void subscribeAll(IpcMessageListener* listener);
@@ -204,6 +228,17 @@ namespace PLEXIL {
     //! @note Called from dispatch thread.
     void handleMessage(PlexilMsgBase *msg);
 
+    //! Record a change in the number of handlers for a message.
+    //! @param msgName The message name.
+    //! @param numHandlers The current number of handlers.
+    //! @note Called from dispatch thread.
+    void handleHandlerChange(const char *msgName, int numHandlers);
+
+    //! Forget what is known about a peer which has disconnected.
+    //! @param moduleName The peer's UID.
+    //! @note Called from dispatch thread.
+    void handleDisconnect(const char *moduleName);
+
   private:
 
     // Disallow copy, assignment, move
@@ -226,12 +261,91 @@ namespace PLEXIL {
      */
     void cacheMessageTrailer(PlexilMsgBase* msgData);
 
+    //! Unpack a packed sequence and deliver it to the listeners
+    //! registered for its leader type, then free the message data.
+    //! @param msg Pointer to the message.
+    //! @note Called from dispatch thread.
+    void handlePackedMessage(PlexilPackedValuesMsg *msg);
+
+    //! Deliver a packed sequence to the listeners registered for its
+    //! leader type.
+    //! @param msg Const pointer to the message.
+    void deliverPacked(PlexilPackedValuesMsg const *msg);
+
+    //! Attach to the shared memory ring of a peer on this host.
+    //! @param uid The peer's UID.
+    //! @param endpoint The host name and ring name announced by the peer.
+    void connectLocalPeer(std::string const &uid, std::string const &endpoint);
+
+    //! Read and deliver messages from this instance's shared memory ring.
+    //! @note Runs in its own thread.
+    void ringDispatch();
+
+    //! Wait until every record already in this instance's shared
+    //! memory ring has been delivered.
+    //! @note Called from dispatch thread.
+    void waitForRingDelivery();
+
+    //! Deliver the vector of messages to all listeners registered for the leader.
+    //! @param msgs (Const reference to) Vector of message pointers
+    //! @note Called from dispatch thread.
+    void notifyListeners(const std::vector<PlexilMsgBase *> &msgs);
+
     //! Deliver the vector of messages to all listeners registered for the leader,
     //! then free the message data.
     //! @param msgs (Const reference to) Vector of message pointers
     //! @note Called from dispatch thread.
     void deliverMessages(const std::vector<PlexilMsgBase *> &msgs);
 
+    //! Can the packed format be used for messages to this destination?
+    //! @param dest The destination UID; if empty, all subscribers.
+    //! @return True if every recipient accepts the packed format.
+    bool usePackedFormat(std::string const &dest);
+
+    //! Send a complete sequence as one packed message.
+    //! @param leaderType Type of the equivalent leader message.
+    //! @param serial Serial number of the sequence.
+    //! @param name Command or state name; empty for return values.
+    //! @param requestSerial Serial of the request, for return values.
+    //! @param requester UID of the requester, for return values.
+    //! @param values Pointer to the first value.
+    //! @param nValues The number of values.
+    //! @param dest The destination UID; if empty, all subscribers.
+    //! @return The IPC status.
+    IPC_RETURN_TYPE publishPacked(PlexilMsgType leaderType,
+                                  IpcSerialNumber serial,
+                                  std::string const &name,
+                                  IpcSerialNumber requestSerial,
+                                  std::string const &requester,
+                                  Value const *values,
+                                  size_t nValues,
+                                  std::string const &dest);
+
+    //! Write a packed record to a peer's shared memory ring.
+    //! @param uid The peer's UID.
+    //! @param ring The peer's ring.
+    //! @param record The record.
+    //! @param requestSync Set to true if the caller must call
+    //!        requestRingSync() after sending the record through central.
+    //! @return True if written; false if the record must go through central.
+    //! @note Once a record to a peer overflows its ring, later records
+    //!       go through central too until the ring drains and the peer
+    //!       confirms it has received them, so that records are not
+    //!       reordered.
+    bool writeToRing(std::string const &uid,
+                     SharedMemoryRing *ring,
+                     std::vector<char> const &record,
+                     bool &requestSync);
+
+    //! Ask a peer to confirm it has received every message sent
+    //! to it through central.
+    //! @param uid The peer's UID.
+    void requestRingSync(std::string const &uid);
+
+    //! Tell other peers that this instance accepts the packed format.
+    //! @param dest The destination UID; if empty, all subscribers.
+    void announcePackedFormat(std::string const &dest);
+
     /**
      * @brief Helper function for sending a vector of parameters via IPC.
      * @param args The arguments to convert into messages and send
@@ -362,6 +476,50 @@ namespace PLEXIL {
     //* @brief Mutex for registered listener tables.
     std::mutex m_listenersMutex;
 
+    //* @brief UIDs of peers which have announced they accept the packed format.
+    //* @note Shared between threads.
+    std::set<std::string> m_packedPeers;
+
+    //* @brief Shared memory rings of peers on this host, by UID.
+    //* @note Shared between threads.
+    std::map<std::string, std::shared_ptr<SharedMemoryRing>> m_localPeers;
+
+    //! States of a local peer whose ring overflowed.
+    enum RingFallbackState {
+      RING_FULL,         //!< Sending through central until the ring drains
+      RING_SYNC_PENDING, //!< Ring drained, awaiting the peer's confirmation
+      RING_SYNC_STALE,   //!< As above, but more records have gone through central since
+      RING_SYNCED        //!< Peer has received everything; ring may be used again
+    };
+
+    //* @brief Local peers whose rings overflowed, and their states.
+    //* @note Shared between threads.
+    std::map<std::string, RingFallbackState> m_ringFallbackPeers;
+
+    //* @brief Mutex for m_packedPeers, m_localPeers, and m_ringFallbackPeers.
+    std::mutex m_packedPeersMutex;
+
+    //* @brief This instance's shared memory ring, if any.
+    std::shared_ptr<SharedMemoryRing> m_ring;
+
+    //* @brief Host and ring name sent to other peers; empty if no ring.
+    std::string m_endpoint;
+
+    //* @brief The thread reading from m_ring.
+    std::thread m_ringThread;
+
+    //* @brief Stream position of m_ring up to which records have been delivered.
+    uint64_t m_ringDelivered;
+
+    //* @brief Mutex for m_ringDelivered.
+    std::mutex m_ringDeliveredMutex;
+
+    //* @brief Signaled when m_ringDelivered advances.
+    std::condition_variable m_ringDeliveredCv;
+
+    //* @brief Number of handlers subscribed to the broadcast leader message.
+    std::atomic<int> m_leaderHandlers;
+
     //* @brief The message thread
     std::thread m_thread;
 
@@ -380,6 +538,15 @@ namespace PLEXIL {
 
     //* @brief True if the dispatch thread should stop.
     bool m_stopDispatchThread;
+
+    //* @brief True if the shared memory thread should stop.
+    std::atomic<bool> m_stopRingThread;
+
+    //* @brief Is the packed format allowed?
+    bool m_packedEnabled;
+
+    //* @brief Is shared memory allowed?
+    bool m_sharedMemoryEnabled;
   };
 
   /**
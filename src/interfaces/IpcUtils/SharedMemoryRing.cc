@@ -0,0 +1,434 @@
+/* Copyright (c) 2006-2021, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "SharedMemoryRing.hh"
+
+#ifdef PLEXIL_IPC_SHARED_MEMORY
+
+#include "Debug.hh"
+#include "Error.hh"
+
+#include <algorithm>
+#include <atomic>
+
+#if defined(HAVE_CERRNO)
+#include <cerrno>
+#elif defined(HAVE_ERRNO_H)
+#include <errno.h>
+#endif
+
+#if defined(HAVE_CSTRING)
+#include <cstring>
+#elif defined(HAVE_STRING_H)
+#include <string.h>
+#endif
+
+#if defined(HAVE_CTIME)
+#include <ctime>
+#elif defined(HAVE_TIME_H)
+#include <time.h>
+#endif
+
+#ifdef HAVE_DIRENT_H
+#include <dirent.h>
+#endif
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef HAVE_FLOCK
+#include <sys/file.h> // flock()
+#endif
+#include <unistd.h>
+
+namespace PLEXIL
+{
+
+  //! Layout of the start of the shared memory segment.
+  //! The record area follows immediately.
+  struct RingHeader
+  {
+    uint32_t magic;
+    uint32_t capacity;   // size of record area in bytes
+    char ownerUID[128];  // for sanity checking by writers
+    pthread_mutex_t mutex;
+    pthread_cond_t notEmpty;
+    uint64_t head;       // total bytes ever written
+    uint64_t tail;       // total bytes ever read
+    uint32_t closed;
+  };
+
+  static constexpr uint32_t RING_MAGIC = 0x504c5852; // "PLXR"
+
+  // Records are stored as a 32-bit length followed by the data.
+  static constexpr size_t RECORD_OVERHEAD = sizeof(uint32_t);
+
+  //! Lock the ring mutex, recovering it if its holder died.
+  static void lockRing(RingHeader *hdr)
+  {
+    int status = pthread_mutex_lock(&hdr->mutex);
+#ifdef HAVE_PTHREAD_MUTEX_CONSISTENT
+    if (status == EOWNERDEAD) {
+      debugMsg("SharedMemoryRing", " recovering mutex from dead writer");
+      pthread_mutex_consistent(&hdr->mutex);
+    }
+#else
+    (void) status;
+#endif
+  }
+
+  class SharedMemoryRingImpl final : public SharedMemoryRing
+  {
+  public:
+
+    //! @param ownerFd Descriptor holding the owner lock; -1 if not the owner.
+    SharedMemoryRingImpl(std::string const &name,
+                         RingHeader *hdr,
+                         size_t mapSize,
+                         int ownerFd)
+      : m_name(name),
+        m_header(hdr),
+        m_data(reinterpret_cast<char *>(hdr + 1)),
+        m_mapSize(mapSize),
+        m_capacity(hdr->capacity),
+        m_ownerFd(ownerFd)
+    {
+    }
+
+    virtual ~SharedMemoryRingImpl()
+    {
+      if (m_ownerFd >= 0) {
+        close();
+        shm_unlink(m_name.c_str());
+        // Releases the owner lock, now that the name is gone
+        ::close(m_ownerFd);
+      }
+      munmap(m_header, m_mapSize);
+    }
+
+    virtual std::string const &name() const
+    {
+      return m_name;
+    }
+
+    virtual bool write(char const *data, size_t size)
+    {
+      uint32_t len = (uint32_t) size;
+      size_t needed = RECORD_OVERHEAD + size;
+      bool result = false;
+      lockRing(m_header);
+      if (!m_header->closed
+          && needed <= m_capacity - (m_header->head - m_header->tail)) {
+        copyIn(m_header->head, reinterpret_cast<char const *>(&len), RECORD_OVERHEAD);
+        copyIn(m_header->head + RECORD_OVERHEAD, data, size);
+        m_header->head += needed;
+        pthread_cond_signal(&m_header->notEmpty);
+        result = true;
+      }
+      pthread_mutex_unlock(&m_header->mutex);
+      return result;
+    }
+
+    virtual bool read(std::vector<char> &record, unsigned int timeoutMsec)
+    {
+      struct timespec deadline;
+      clock_gettime(CLOCK_REALTIME, &deadline);
+      deadline.tv_sec += timeoutMsec / 1000;
+      deadline.tv_nsec += (timeoutMsec % 1000) * 1000000L;
+      if (deadline.tv_nsec >= 1000000000L) {
+        ++deadline.tv_sec;
+        deadline.tv_nsec -= 1000000000L;
+      }
+
+      bool result = false;
+      lockRing(m_header);
+      while (m_header->head == m_header->tail && !m_header->closed) {
+        int status = pthread_cond_timedwait(&m_header->notEmpty, &m_header->mutex, &deadline);
+#ifdef HAVE_PTHREAD_MUTEX_CONSISTENT
+        if (status == EOWNERDEAD)
+          pthread_mutex_consistent(&m_header->mutex);
+        else
+#endif
+        if (status == ETIMEDOUT)
+          break;
+      }
+      if (m_header->head != m_header->tail) {
+        // Writers share the segment, so check everything before trusting it
+        uint64_t const avail = m_header->head - m_header->tail;
+        uint32_t len = 0;
+        if (avail >= RECORD_OVERHEAD && avail <= m_capacity)
+          copyOut(m_header->tail, reinterpret_cast<char *>(&len), RECORD_OVERHEAD);
+        if (avail < RECORD_OVERHEAD || avail > m_capacity
+            || len > avail - RECORD_OVERHEAD) {
+          warn("SharedMemoryRing " << m_name << ": corrupt ring, discarding "
+               << avail << " bytes");
+          m_header->tail = m_header->head;
+        }
+        else {
+          record.resize(len);
+          copyOut(m_header->tail + RECORD_OVERHEAD, record.data(), len);
+          m_header->tail += RECORD_OVERHEAD + len;
+          result = true;
+        }
+      }
+      pthread_mutex_unlock(&m_header->mutex);
+      return result;
+    }
+
+    virtual bool empty()
+    {
+      lockRing(m_header);
+      bool result = (m_header->head == m_header->tail);
+      pthread_mutex_unlock(&m_header->mutex);
+      return result;
+    }
+
+    virtual uint64_t writePosition()
+    {
+      lockRing(m_header);
+      uint64_t result = m_header->head;
+      pthread_mutex_unlock(&m_header->mutex);
+      return result;
+    }
+
+    virtual uint64_t readPosition()
+    {
+      lockRing(m_header);
+      uint64_t result = m_header->tail;
+      pthread_mutex_unlock(&m_header->mutex);
+      return result;
+    }
+
+    virtual void close()
+    {
+      lockRing(m_header);
+      m_header->closed = 1;
+      pthread_cond_broadcast(&m_header->notEmpty);
+      pthread_mutex_unlock(&m_header->mutex);
+    }
+
+  private:
+
+    // Copy into the record area at the given stream position, wrapping as needed.
+    void copyIn(uint64_t pos, char const *src, size_t n)
+    {
+      size_t offset = pos % m_capacity;
+      size_t first = std::min(n, m_capacity - offset);
+      memcpy(m_data + offset, src, first);
+      memcpy(m_data, src + first, n - first);
+    }
+
+    // Copy out of the record area at the given stream position, wrapping as needed.
+    void copyOut(uint64_t pos, char *dest, size_t n)
+    {
+      size_t offset = pos % m_capacity;
+      size_t first = std::min(n, m_capacity - offset);
+      memcpy(dest, m_data + offset, first);
+      memcpy(dest + first, m_data, n - first);
+    }
+
+    std::string const m_name;
+    RingHeader *m_header;
+    char *m_data;
+    size_t m_mapSize;
+    size_t const m_capacity; // as validated at creation or attach
+    int m_ownerFd;
+  };
+
+  static char const RING_NAME_PREFIX[] = "plexil-ipc-";
+
+#if defined(HAVE_DIRENT_H) && defined(HAVE_FLOCK)
+
+  // A segment with no owner lock and no header may be one whose
+  // creator has not yet taken the lock. Leave it alone until it is
+  // this old.
+  static constexpr time_t UNFINISHED_RING_GRACE_SECS = 60;
+
+  //! Is the segment stale? Its owner holds an exclusive lock on it
+  //! for as long as the ring exists; the kernel drops the lock when
+  //! the owner exits, however it exits. A process ID in the name
+  //! would prove nothing: it may have been reused, or belong to
+  //! another PID namespace sharing this /dev/shm.
+  static bool isStaleRing(std::string const &name)
+  {
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0)
+      return false;
+    bool result = false;
+    if (!flock(fd, LOCK_EX | LOCK_NB)) {
+      struct stat st;
+      if (!fstat(fd, &st)) {
+        if ((size_t) st.st_size >= sizeof(RingHeader)) {
+          void *addr = mmap(nullptr, sizeof(RingHeader), PROT_READ, MAP_SHARED, fd, 0);
+          if (addr != MAP_FAILED) {
+            result = static_cast<RingHeader const *>(addr)->magic == RING_MAGIC;
+            munmap(addr, sizeof(RingHeader));
+          }
+        }
+        if (!result)
+          result = time(nullptr) - st.st_ctime > UNFINISHED_RING_GRACE_SECS;
+      }
+    }
+    ::close(fd); // also releases our lock
+    return result;
+  }
+
+#endif
+
+  //! Unlink segments whose owner no longer holds them, e.g. because
+  //! it crashed before deleting its ring.
+  static void sweepStaleRings()
+  {
+#if defined(HAVE_DIRENT_H) && defined(HAVE_FLOCK)
+    // Where POSIX shared memory objects are visible, e.g. Linux
+    DIR *dir = opendir("/dev/shm");
+    if (!dir)
+      return;
+    size_t const prefixLen = sizeof(RING_NAME_PREFIX) - 1;
+    while (struct dirent *entry = readdir(dir)) {
+      if (strncmp(entry->d_name, RING_NAME_PREFIX, prefixLen))
+        continue;
+      std::string const name = std::string("/") + entry->d_name;
+      if (!isStaleRing(name))
+        continue;
+      debugMsg("SharedMemoryRing", " removing stale segment " << name);
+      shm_unlink(name.c_str());
+    }
+    closedir(dir);
+#endif
+  }
+
+  // Number of names to try before giving up on creating a ring
+  static constexpr unsigned int RING_CREATE_ATTEMPTS = 8;
+
+  SharedMemoryRing *makeSharedMemoryRing(std::string const &ownerUID,
+                                         size_t capacity)
+  {
+    static std::atomic<unsigned int> sl_count(0);
+    if (!sl_count)
+      sweepStaleRings();
+
+    // The name need only be unique; a process in another PID
+    // namespace may be using the same process ID.
+    std::string name;
+    int fd = -1;
+    for (unsigned int i = 0; fd < 0 && i < RING_CREATE_ATTEMPTS; ++i) {
+      name = std::string("/") + RING_NAME_PREFIX + std::to_string(getpid())
+        + '-' + std::to_string(sl_count++);
+      fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+      if (fd < 0 && errno != EEXIST)
+        break;
+    }
+    if (fd < 0) {
+      debugMsg("SharedMemoryRing",
+               " unable to create " << name << ": " << strerror(errno));
+      return nullptr;
+    }
+
+    // Held until the ring is deleted or this process exits
+#ifdef HAVE_FLOCK
+    flock(fd, LOCK_EX);
+#endif
+
+    size_t mapSize = sizeof(RingHeader) + capacity;
+    void *addr = MAP_FAILED;
+    if (!ftruncate(fd, mapSize))
+      addr = mmap(nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+      debugMsg("SharedMemoryRing",
+               " unable to map " << name << ": " << strerror(errno));
+      shm_unlink(name.c_str());
+      ::close(fd);
+      return nullptr;
+    }
+
+    RingHeader *hdr = static_cast<RingHeader *>(addr);
+    hdr->capacity = (uint32_t) capacity;
+    strncpy(hdr->ownerUID, ownerUID.c_str(), sizeof(hdr->ownerUID) - 1);
+    hdr->ownerUID[sizeof(hdr->ownerUID) - 1] = '\0';
+    hdr->head = hdr->tail = 0;
+    hdr->closed = 0;
+
+    pthread_mutexattr_t mattr;
+    pthread_mutexattr_init(&mattr);
+    pthread_mutexattr_setpshared(&mattr, PTHREAD_PROCESS_SHARED);
+#ifdef HAVE_PTHREAD_MUTEX_CONSISTENT
+    pthread_mutexattr_setrobust(&mattr, PTHREAD_MUTEX_ROBUST);
+#endif
+    pthread_mutex_init(&hdr->mutex, &mattr);
+    pthread_mutexattr_destroy(&mattr);
+
+    pthread_condattr_t cattr;
+    pthread_condattr_init(&cattr);
+    pthread_condattr_setpshared(&cattr, PTHREAD_PROCESS_SHARED);
+    pthread_cond_init(&hdr->notEmpty, &cattr);
+    pthread_condattr_destroy(&cattr);
+
+    // Publish only when fully initialized
+    std::atomic_thread_fence(std::memory_order_release);
+    hdr->magic = RING_MAGIC;
+
+    debugMsg("SharedMemoryRing", " created " << name << ", " << capacity << " bytes");
+    return new SharedMemoryRingImpl(name, hdr, mapSize, fd);
+  }
+
+  SharedMemoryRing *openSharedMemoryRing(std::string const &name,
+                                         std::string const &ownerUID)
+  {
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+      debugMsg("SharedMemoryRing",
+               " unable to open " << name << ": " << strerror(errno));
+      return nullptr;
+    }
+
+    void *addr = MAP_FAILED;
+    struct stat st;
+    if (!fstat(fd, &st) && (size_t) st.st_size > sizeof(RingHeader))
+      addr = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+      debugMsg("SharedMemoryRing", " unable to map " << name);
+      return nullptr;
+    }
+
+    RingHeader *hdr = static_cast<RingHeader *>(addr);
+    if (hdr->magic != RING_MAGIC
+        || sizeof(RingHeader) + hdr->capacity != (size_t) st.st_size
+        || strncmp(hdr->ownerUID, ownerUID.c_str(), sizeof(hdr->ownerUID) - 1)) {
+      debugMsg("SharedMemoryRing",
+               ' ' << name << " does not belong to " << ownerUID);
+      munmap(addr, st.st_size);
+      return nullptr;
+    }
+
+    debugMsg("SharedMemoryRing", " opened " << name << " owned by " << ownerUID);
+    return new SharedMemoryRingImpl(name, hdr, st.st_size, -1);
+  }
+
+}
+
+#endif // PLEXIL_IPC_SHARED_MEMORY
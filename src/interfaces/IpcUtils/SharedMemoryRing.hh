@@ -0,0 +1,109 @@
+/* Copyright (c) 2006-2021, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef PLEXIL_SHARED_MEMORY_RING_HH
+#define PLEXIL_SHARED_MEMORY_RING_HH
+
+#include "plexil-stdint.h" // uint64_t; also includes plexil-config.h
+
+#include <string>
+#include <vector>
+
+#if defined(HAVE_SHM_OPEN) && defined(HAVE_PTHREAD_H) && defined(HAVE_SYS_MMAN_H) \
+  && defined(HAVE_SYS_STAT_H) && defined(HAVE_FCNTL_H) && defined(HAVE_UNISTD_H)
+#define PLEXIL_IPC_SHARED_MEMORY 1
+#endif
+
+namespace PLEXIL
+{
+
+  //! @class SharedMemoryRing
+  //! A queue of variable-length records in a POSIX shared memory
+  //! segment. Any number of processes on the same host may write to
+  //! the ring; only its owner reads from it.
+  class SharedMemoryRing
+  {
+  public:
+    virtual ~SharedMemoryRing() = default;
+
+    //! Get the name of the shared memory segment.
+    //! @return Const reference to the name.
+    virtual std::string const &name() const = 0;
+
+    //! Append a record to the ring.
+    //! @param data Pointer to the record.
+    //! @param size Length of the record in bytes.
+    //! @return True if the record was queued; false if there is no
+    //!         room, or the ring has been closed.
+    //! @note Never blocks waiting for room.
+    virtual bool write(char const *data, size_t size) = 0;
+
+    //! Remove the oldest record from the ring.
+    //! @param record Buffer to receive the record.
+    //! @param timeoutMsec Maximum time to wait for a record, in milliseconds.
+    //! @return True if a record was read, false if timed out or closed.
+    virtual bool read(std::vector<char> &record, unsigned int timeoutMsec) = 0;
+
+    //! Has the owner read every record written so far?
+    //! @return True if the ring is empty.
+    virtual bool empty() = 0;
+
+    //! Get the stream position just past the last record written.
+    //! @return The position, in bytes since the ring was created.
+    virtual uint64_t writePosition() = 0;
+
+    //! Get the stream position just past the last record read.
+    //! @return The position, in bytes since the ring was created.
+    virtual uint64_t readPosition() = 0;
+
+    //! Refuse further writes and wake up the reader.
+    virtual void close() = 0;
+  };
+
+  //! Create a ring owned by this process.
+  //! @param ownerUID UID of the owning IpcFacade.
+  //! @param capacity Size of the record area in bytes.
+  //! @return Pointer to the new ring; null if the segment could not
+  //!         be created.
+  //! @note The segment is unlinked when the ring is deleted.
+  //! @note The owning process holds a lock on the segment for the
+  //!       ring's lifetime. Segments left behind by owners which have
+  //!       exited are removed when the first ring is created, where
+  //!       the platform allows them to be listed and locked.
+  extern SharedMemoryRing *makeSharedMemoryRing(std::string const &ownerUID,
+                                                size_t capacity);
+
+  //! Attach to a ring owned by another process on this host.
+  //! @param name Name of the shared memory segment.
+  //! @param ownerUID Expected UID of the owner.
+  //! @return Pointer to the ring; null if the segment does not exist
+  //!         or does not belong to the expected owner.
+  extern SharedMemoryRing *openSharedMemoryRing(std::string const &name,
+                                                std::string const &ownerUID);
+
+}
+
+#endif // PLEXIL_SHARED_MEMORY_RING_HH
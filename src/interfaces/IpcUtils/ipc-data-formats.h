@@ -279,6 +279,33 @@ struct StringPair
 #define STRING_PAIR_MSG "PlexilStringPair"
 #define STRING_PAIR_MSG_FORMAT "{ushort, ushort, uint, string, string, string}"
 
+/*
+ * Packed sequence.
+ * Carries a complete command, LookupNow, telemetry or return value
+ * sequence in a single message. Count is the number of values;
+ * the values are concatenated in PLEXIL Value serial format.
+ * leaderType is the type of the equivalent multi-message leader.
+ * requestSerial and requesterUID are only used for return values,
+ * name is only used for the others.
+ * A packet with leaderType PlexilMsgType_uninited and no values
+ * announces that the sender accepts this format.
+ * Only sent to peers known to accept it; see IpcFacade.
+ */
+
+struct PlexilPackedValuesMsg
+{
+  struct PlexilMsgBase header;
+  uint16_t leaderType;
+  uint32_t requestSerial;
+  const char* requesterUID;
+  const char* name;
+  uint32_t dataSize;
+  unsigned char* data;
+};
+
+#define PACKED_VALUES_MSG "PlexilPackedValues"
+#define PACKED_VALUES_MSG_FORMAT "{ushort, ushort, uint, string, ushort, uint, string, string, int, <ubyte:9>}"
+
 typedef enum {
   PlexilMsgType_uninited=0,
 
@@ -363,6 +390,15 @@ typedef enum {
    * Count indicates position in sequence */
   PlexilMsgType_PairString,
 
+  /* PlexilPackedValuesMsg -
+   * A complete sequence in one message */
+  PlexilMsgType_PackedValues,
+
+  /* Local to IpcFacade, never sent -
+   * Stands in for a value message when a packed sequence
+   * is delivered to listeners */
+  PlexilMsgType_ValueRef,
+
   PlexilMsgType_limit
 }
   PlexilMsgType;
@@ -0,0 +1,422 @@
+/* Copyright (c) 2006-2026, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+//
+// Module test for SharedMemoryRing.
+//
+
+#include "SharedMemoryRing.hh"
+
+#include "DebugMessage.hh"
+#include "Error.hh"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+#ifdef PLEXIL_IPC_SHARED_MEMORY
+#include <fcntl.h>
+#ifdef HAVE_FLOCK
+#include <sys/file.h> // flock()
+#endif
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace PLEXIL;
+
+#ifdef PLEXIL_IPC_SHARED_MEMORY
+
+static char const *const OWNER = "shared-memory-ring-test";
+
+// Small enough that the tests wrap around quickly
+static size_t const CAPACITY = 64;
+
+// Each test record takes 4 length bytes plus this many
+static size_t const RECORD_SIZE = 10;
+
+static bool segmentExists(std::string const &name)
+{
+  int fd = shm_open(name.c_str(), O_RDWR, 0);
+  if (fd < 0)
+    return false;
+  close(fd);
+  return true;
+}
+
+// Maps the whole segment for direct inspection and damage
+class RawSegment
+{
+public:
+  RawSegment(std::string const &name)
+    : addr(nullptr),
+      size(0)
+  {
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    struct stat st;
+    if (fd >= 0 && !fstat(fd, &st)) {
+      void *a = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      if (a != MAP_FAILED) {
+        addr = static_cast<char *>(a);
+        size = st.st_size;
+      }
+    }
+    if (fd >= 0)
+      close(fd);
+  }
+
+  ~RawSegment()
+  {
+    if (addr)
+      munmap(addr, size);
+  }
+
+  // The record area is at the end of the segment
+  char *data() const
+  {
+    return addr + size - CAPACITY;
+  }
+
+  char *addr;
+  size_t size;
+};
+
+static std::string makeRecord(unsigned int n)
+{
+  std::string result(RECORD_SIZE, 'a' + (char) (n % 26));
+  result[0] = (char) n;
+  return result;
+}
+
+static bool writeRecord(SharedMemoryRing &ring, unsigned int n)
+{
+  std::string rec = makeRecord(n);
+  return ring.write(rec.data(), rec.size());
+}
+
+static bool readRecord(SharedMemoryRing &ring, unsigned int n)
+{
+  std::vector<char> rec;
+  if (!ring.read(rec, 0)) {
+    std::cout << "  record " << n << " not read" << std::endl;
+    return false;
+  }
+  if (std::string(rec.data(), rec.size()) != makeRecord(n)) {
+    std::cout << "  record " << n << " read back wrong" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+#if defined(HAVE_DIRENT_H) && defined(HAVE_FLOCK)
+
+// Run in a child process: create a ring, report its name on the
+// pipe, and keep it until the parent closes the other pipe, if any.
+static void ownRing(int namePipe, int holdPipe)
+{
+  std::unique_ptr<SharedMemoryRing> ring(makeSharedMemoryRing(OWNER, CAPACITY));
+  std::string name = ring ? ring->name() : std::string();
+  name += '\n';
+  if (write(namePipe, name.data(), name.size()) < 0)
+    _exit(1);
+  if (holdPipe >= 0) {
+    char c;
+    while (read(holdPipe, &c, 1) > 0)
+      ;
+    ring.reset();
+  }
+  // Otherwise leave the segment behind, as if crashed
+  _exit(0);
+}
+
+// Returns the name of a ring owned by a child process, which is
+// still running if holdPipe is not null.
+static std::string forkOwner(pid_t &pid, int *holdPipe)
+{
+  int names[2], hold[2] = {-1, -1};
+  if (pipe(names) || (holdPipe && pipe(hold)))
+    return std::string();
+  pid = fork();
+  if (!pid) {
+    close(names[0]);
+    if (holdPipe)
+      close(hold[1]);
+    ownRing(names[1], hold[0]);
+  }
+  close(names[1]);
+  if (holdPipe) {
+    close(hold[0]);
+    *holdPipe = hold[1];
+  }
+  std::string result;
+  char c;
+  while (read(names[0], &c, 1) == 1 && c != '\n')
+    result += c;
+  close(names[0]);
+  return result;
+}
+
+// Must run before any other test creates a ring in this process,
+// because the sweep is done when the first one is created.
+static bool testStaleSweep()
+{
+  std::cout << "testStaleSweep" << std::endl;
+
+  // Each child sweeps too, so the dead owner comes last
+  pid_t livePid = 0;
+  int holdPipe = -1;
+  std::string live = forkOwner(livePid, &holdPipe);
+  assertTrue_1(!live.empty());
+
+  pid_t deadPid = 0;
+  std::string dead = forkOwner(deadPid, nullptr);
+  waitpid(deadPid, nullptr, 0);
+  assertTrue_1(!dead.empty());
+  assertTrue_1(segmentExists(live));
+  assertTrue_1(segmentExists(dead));
+
+  // A live owner in another PID namespace may have any process ID
+  // in its segment's name, including that of a dead process here.
+  // It holds the owner lock like any other.
+  std::string const foreign = std::string("/plexil-ipc-") + std::to_string(deadPid) + "-999";
+  int foreignFd = shm_open(foreign.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  assertTrue_1(foreignFd >= 0);
+  assertTrue_1(!flock(foreignFd, LOCK_EX));
+  assertTrue_1(!ftruncate(foreignFd, 4096));
+  {
+    RawSegment raw(foreign);
+    assertTrue_1(raw.addr);
+    uint32_t const magic = 0x504c5852;
+    memcpy(raw.addr, &magic, sizeof(magic));
+  }
+
+  // A segment with no header whose creator may not have locked it yet
+  std::string const unfinished = std::string("/plexil-ipc-0-") + std::to_string(getpid());
+  int fd = shm_open(unfinished.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  assertTrue_1(fd >= 0);
+  close(fd);
+
+  {
+    std::unique_ptr<SharedMemoryRing> ring(makeSharedMemoryRing(OWNER, CAPACITY));
+    assertTrue_1(ring);
+    assertTrue_1(!segmentExists(dead));
+    assertTrue_1(segmentExists(live));
+    assertTrue_1(segmentExists(foreign));
+    assertTrue_1(segmentExists(unfinished));
+  }
+
+  close(holdPipe);
+  waitpid(livePid, nullptr, 0);
+  assertTrue_1(!segmentExists(live));
+  shm_unlink(foreign.c_str());
+  close(foreignFd);
+  shm_unlink(unfinished.c_str());
+  return true;
+}
+
+#endif // defined(HAVE_DIRENT_H) && defined(HAVE_FLOCK)
+
+static bool testWrapAround()
+{
+  std::cout << "testWrapAround" << std::endl;
+  std::unique_ptr<SharedMemoryRing> ring(makeSharedMemoryRing(OWNER, CAPACITY));
+  assertTrue_1(ring);
+  std::unique_ptr<SharedMemoryRing> writer(openSharedMemoryRing(ring->name(), OWNER));
+  assertTrue_1(writer);
+
+  // Records land at every offset, so some split their length and
+  // some their data at the end of the record area
+  size_t const recordLen = sizeof(uint32_t) + RECORD_SIZE;
+  for (unsigned int n = 0; n < 40; ++n) {
+    assertTrue_1(writeRecord(*writer, n));
+    assertTrue_1(writeRecord(*writer, n + 100));
+    assertTrue_1(readRecord(*ring, n));
+    assertTrue_1(readRecord(*ring, n + 100));
+  }
+  assertTrue_1(ring->empty());
+  assertTrue_1(ring->writePosition() == 80 * recordLen);
+  assertTrue_1(ring->readPosition() == ring->writePosition());
+  return true;
+}
+
+static bool testFull()
+{
+  std::cout << "testFull" << std::endl;
+  std::unique_ptr<SharedMemoryRing> ring(makeSharedMemoryRing(OWNER, CAPACITY));
+  assertTrue_1(ring);
+
+  size_t const recordLen = sizeof(uint32_t) + RECORD_SIZE;
+  unsigned int const fits = CAPACITY / recordLen;
+  for (unsigned int n = 0; n < fits; ++n)
+    assertTrue_1(writeRecord(*ring, n));
+  uint64_t const head = ring->writePosition();
+  assertTrue_1(!writeRecord(*ring, fits));
+  assertTrue_1(ring->writePosition() == head);
+
+  // One record too big for the ring, even when empty
+  std::string huge(CAPACITY, 'x');
+  assertTrue_1(!ring->write(huge.data(), huge.size()));
+
+  // Room is made by reading
+  assertTrue_1(readRecord(*ring, 0));
+  assertTrue_1(writeRecord(*ring, fits));
+  for (unsigned int n = 1; n <= fits; ++n)
+    assertTrue_1(readRecord(*ring, n));
+  assertTrue_1(ring->empty());
+  return true;
+}
+
+static bool testCorruptRecord()
+{
+  std::cout << "testCorruptRecord" << std::endl;
+  std::unique_ptr<SharedMemoryRing> ring(makeSharedMemoryRing(OWNER, CAPACITY));
+  assertTrue_1(ring);
+  RawSegment raw(ring->name());
+  assertTrue_1(raw.addr);
+
+  // Length longer than what has been written
+  assertTrue_1(writeRecord(*ring, 1));
+  assertTrue_1(writeRecord(*ring, 2));
+  uint32_t const badLen = RECORD_SIZE + 1000;
+  memcpy(raw.data(), &badLen, sizeof(badLen));
+  std::vector<char> rec;
+  assertTrue_1(!ring->read(rec, 0));
+  assertTrue_1(ring->empty());
+
+  // The ring is usable afterward
+  assertTrue_1(writeRecord(*ring, 3));
+  assertTrue_1(readRecord(*ring, 3));
+  return true;
+}
+
+static bool testCorruptHeader()
+{
+  std::cout << "testCorruptHeader" << std::endl;
+  std::unique_ptr<SharedMemoryRing> ring(makeSharedMemoryRing(OWNER, CAPACITY));
+  assertTrue_1(ring);
+  std::string const name = ring->name();
+
+  assertTrue_1(!openSharedMemoryRing(name, "someone-else"));
+  assertTrue_1(!openSharedMemoryRing("/plexil-ipc-no-such-ring", OWNER));
+  {
+    std::unique_ptr<SharedMemoryRing> writer(openSharedMemoryRing(name, OWNER));
+    assertTrue_1(writer);
+  }
+
+  RawSegment raw(name);
+  assertTrue_1(raw.addr);
+  uint32_t magic;
+  memcpy(&magic, raw.addr, sizeof(magic));
+  uint32_t const bad = ~magic;
+  memcpy(raw.addr, &bad, sizeof(bad));
+  assertTrue_1(!openSharedMemoryRing(name, OWNER));
+  memcpy(raw.addr, &magic, sizeof(magic));
+
+  // Capacity which does not match the segment size
+  uint32_t capacity;
+  memcpy(&capacity, raw.addr + sizeof(uint32_t), sizeof(capacity));
+  assertTrue_1(capacity == CAPACITY);
+  uint32_t const wrong = CAPACITY * 2;
+  memcpy(raw.addr + sizeof(uint32_t), &wrong, sizeof(wrong));
+  assertTrue_1(!openSharedMemoryRing(name, OWNER));
+  memcpy(raw.addr + sizeof(uint32_t), &capacity, sizeof(capacity));
+
+  std::unique_ptr<SharedMemoryRing> writer(openSharedMemoryRing(name, OWNER));
+  assertTrue_1(writer);
+  return true;
+}
+
+static bool testClose()
+{
+  std::cout << "testClose" << std::endl;
+  std::unique_ptr<SharedMemoryRing> ring(makeSharedMemoryRing(OWNER, CAPACITY));
+  assertTrue_1(ring);
+  std::string const name = ring->name();
+  std::unique_ptr<SharedMemoryRing> writer(openSharedMemoryRing(name, OWNER));
+  assertTrue_1(writer);
+
+  // A blocked reader is woken by close
+  typedef std::chrono::steady_clock Clock;
+  bool readResult = true;
+  Clock::duration waited;
+  std::thread reader([&]() -> void {
+                       std::vector<char> rec;
+                       Clock::time_point start = Clock::now();
+                       readResult = ring->read(rec, 30000);
+                       waited = Clock::now() - start;
+                     });
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  writer->close();
+  reader.join();
+  assertTrue_1(!readResult);
+  assertTrue_1(waited < std::chrono::seconds(10));
+
+  // Writes are refused; the owner still removes the segment
+  assertTrue_1(!writeRecord(*writer, 1));
+  assertTrue_1(!writeRecord(*ring, 1));
+  writer.reset();
+  assertTrue_1(segmentExists(name));
+  ring.reset();
+  assertTrue_1(!segmentExists(name));
+  return true;
+}
+
+#endif // PLEXIL_IPC_SHARED_MEMORY
+
+int main()
+{
+  // Read Debug.cfg in current directory, if it exists
+  char debugConfig[] = "Debug.cfg";
+  std::ifstream config(debugConfig);
+  if (config.good()) {
+    PLEXIL::readDebugConfigStream(config);
+    std::cout << "Read debug configuration file " << debugConfig << std::endl;
+  }
+
+#ifdef PLEXIL_IPC_SHARED_MEMORY
+  bool success =
+#if defined(HAVE_DIRENT_H) && defined(HAVE_FLOCK)
+    testStaleSweep() &&
+#endif
+    testWrapAround()
+    && testFull()
+    && testCorruptRecord()
+    && testCorruptHeader()
+    && testClose();
+#else
+  std::cout << "Shared memory rings not supported on this platform" << std::endl;
+  bool success = true;
+#endif
+
+  std::cout << "Shared memory ring test " << (success ? "succeeded" : "failed") << std::endl;
+  return (success ? 0 : 1);
+}
@@ -100,6 +100,25 @@ namespace PLEXIL
              ' ' << this << " Message \"" << pq->m_name << "\" added, value = \"" << param << '"');
   }
 
+  /**
+   * @brief Adds the given message with the given parameters to its queue,
+   *        taking ownership of the parameter value.
+   *        If there is a recipient waiting for the message, it is sent immediately.
+   * @param message The message string to be added
+   * @param params The parameters that are to be sent with the message
+   * @note Called from UdpAdapter::handleUdpMessage().
+   */
+  void MessageQueueMap::addMessage(const std::string& message, Value &&param) {
+    debugMsg("MessageQueueMap:addMessage", ' ' << this << " entered for \"" << message << "\"");
+    PairingQueue* pq = ensureQueue(message);
+    if (!m_allowDuplicateMessages)
+      while (!pq->m_messageQueue.empty())
+        pq->m_messageQueue.pop();
+    pq->m_messageQueue.emplace(std::move(param));
+    updateQueue(pq);
+    debugMsg("MessageQueueMap:addMessage", ' ' << this << " Message \"" << pq->m_name << "\" added");
+  }
+
   /**
    * @brief Sets the flag that determines whether or not incoming messages
    *        with duplicate strings are queued. If true, all incoming messages are
@@ -156,7 +175,7 @@ namespace PLEXIL
     while (!mq.empty() && !rq.empty()) {
       debugMsg("MessageQueueMap:updateQueue", ' ' << queue->m_name << " returning value");
       debugMsg("MessageQueueMap:updateQueue", ' ' << queue->m_name << " returning value");
-      m_execInterface.handleCommandReturn(rq.front(), mq.front());
+      m_execInterface.handleCommandReturn(rq.front(), std::move(mq.front()));
       debugMsg("MessageQueueMap:updateQueue", ' ' << queue->m_name
                << " recipient inactive, ignoring");
       rq.pop();
@@ -76,6 +76,16 @@ namespace PLEXIL
      */
     void addMessage(const std::string& message, const Value& param);
 
+    /**
+     * @brief Adds the given message with the given parameters to its queue,
+     * taking ownership of the parameter value.
+     * If there is a recipient waiting for the message, the value is
+     * handed to it without further copying.
+     * @param message The message string to be added
+     * @param params The parameters that are to be sent with the message
+     */
+    void addMessage(const std::string& message, Value &&param);
+
     /**
      * @brief Sets the flag that determines whether or not incoming messages
      * with duplicate strings are queued. If true, all incoming messages are
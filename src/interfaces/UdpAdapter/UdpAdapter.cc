@@ -34,16 +34,18 @@
 #include "Configuration.hh"
 #include "Debug.hh"
 #include "Error.hh"
+#include "ExecListener.hh"
 #include "InterfaceAdapter.hh"
 #include "InterfaceError.hh"
 #include "MessageQueueMap.hh"
 #include "StateCacheEntry.hh"
 #include "udp-utils.hh"
 #include "UdpEventLoop.hh"
+#include "UdpSendQueue.hh"
 
 #include "pugixml.hpp"
 
-#include <memory> // std::unique_ptr, std::make_unique
+#include <memory> // std::shared_ptr, std::unique_ptr, std::make_unique
 #include <mutex>
 #include <thread>
 
@@ -150,6 +152,29 @@ namespace PLEXIL
     ~UdpMessage() = default;
   };
 
+  //! Sends the datagrams queued by UdpAdapter commands at the end of
+  //! each Exec macro step.
+  class UdpSendFlushListener final : public ExecListener
+  {
+  public:
+    UdpSendFlushListener(std::shared_ptr<UdpSendQueue> queue)
+      : ExecListener(),
+        m_queue(queue)
+    {
+    }
+
+    virtual ~UdpSendFlushListener() = default;
+
+  protected:
+    virtual void implementNotifyStepComplete(unsigned int /* cycleNum */) const override
+    {
+      m_queue->flush();
+    }
+
+  private:
+    std::shared_ptr<UdpSendQueue> m_queue;
+  };
+
   class UdpAdapter : public InterfaceAdapter
   {
   private:
@@ -165,10 +190,12 @@ namespace PLEXIL
     UdpAdapter(AdapterExecInterface &execInterface, AdapterConf *conf)
       : InterfaceAdapter(execInterface, conf),
         m_eventLoop(makeUdpEventLoop()),
+        m_sendQueue(makeUdpSendQueue()),
         m_default_peer("localhost"),
         m_messageQueues(execInterface),
         m_default_local_port(0),
         m_default_peer_port(0),
+        m_batchSends(true),
         m_debug(false)
     {
       debugMsg("UdpAdapter", " constructor");
@@ -206,6 +233,12 @@ namespace PLEXIL
       // Enable debug output if requested
       m_debug = xml.attribute("debug").as_bool();
 
+      // Outbound datagrams issued in one macro step are sent together
+      // at the end of the step, unless disabled
+      m_batchSends = xml.attribute("batch_sends").as_bool(m_batchSends);
+      if (m_batchSends)
+        config->addExecListener(new UdpSendFlushListener(m_sendQueue));
+
       // Parsing the UDP configuration
       m_default_local_port = xml.attribute("default_local_port").as_uint(m_default_local_port);
       // TODO: range check
@@ -241,6 +274,8 @@ namespace PLEXIL
     virtual void stop() override
     {
       debugMsg("UdpAdapter:stop", " called");
+      // Send anything still queued
+      m_sendQueue->flush();
       // Stop the UDP listener thread
       m_eventLoop->stop();
     }
@@ -295,6 +330,25 @@ namespace PLEXIL
         return;
       }
       
+      if (m_batchSends) {
+        // Sent at the end of the macro step; acknowledge the command then
+        bool queued =
+          m_sendQueue->enqueue(msg->second.peer, msg->second.peer_port, udp_buffer, length,
+                               [cmd, intf](bool sent) -> void
+                               {
+                                 debugMsg("UdpAdapter:executeDefaultCommand",
+                                          ' ' << cmd->getName() << (sent ? " sent" : " failed"));
+                                 intf->handleCommandAck(cmd, sent ? COMMAND_SUCCESS : COMMAND_FAILED);
+                                 intf->notifyOfExternalEvent();
+                               });
+        delete[] udp_buffer;
+        if (!queued) {
+          intf->handleCommandAck(cmd, COMMAND_FAILED);
+          intf->notifyOfExternalEvent();
+        }
+        return;
+      }
+
       // Send the buffer to the given host:port
       int status = sendUdpMessage(udp_buffer, msg->second, m_debug);
       debugMsg("UdpAdapter:executeDefaultCommand",
@@ -302,7 +356,7 @@ namespace PLEXIL
       // Clean up some (one hopes)
       delete[] udp_buffer;
       // Do the internal Plexil Boiler Plate (as per example in IpcAdapter.cc)
-      intf->handleCommandAck(cmd, COMMAND_SUCCESS);
+      intf->handleCommandAck(cmd, status < 0 ? COMMAND_FAILED : COMMAND_SUCCESS);
       intf->notifyOfExternalEvent();
     }
 
@@ -849,24 +903,33 @@ namespace PLEXIL
       }
       // (1) addMessage for expected message
       static int counter = 1;     // gensym counter
-      std::ostringstream unique_id;
-      unique_id << msgDef.name << ":msg_parameter:" << counter++;
-      std::string msg_label(unique_id.str());
+      std::string msg_label(msgDef.name);
+      msg_label += ":msg_parameter:";
+      msg_label += std::to_string(counter++);
       debugMsg("UdpAdapter:handleUdpMessage", " adding \"" << msgDef.name << "\" to the command queue");
       const std::string msg_name = formatMessageName(msgDef.name, RECEIVE_COMMAND_COMMAND);
-      m_messageQueues.addMessage(msg_name, msg_label);
+      m_messageQueues.addMessage(msg_name, Value(msg_label));
       // (2) walk the parameters, and for each, call addMessage(label, <value-or-key>), which
       //     (somehow) arranges for executeCommand(GetParameter) to be called, and which in turn
-      //     calls addRecipient and updateQueue
+      //     calls addRecipient and updateQueue.
+      //     Each value is decoded straight from the event loop's receive buffer and
+      //     moved, not copied, on its way to the exec.
+      // Parameter labels are formatMessageName(msg_label, GET_PARAMETER_COMMAND, i);
+      // build the common prefix once.
+      std::string param_label(PARAM_PREFIX);
+      param_label += msg_label;
+      param_label += '_';
+      const size_t param_prefix_len = param_label.size();
       int i = 0;
       int offset = 0;
       for (std::vector<Parameter>::const_iterator param = msgDef.parameters.begin();
            param != msgDef.parameters.end();
            param++, i++) {
-        const std::string param_label = formatMessageName(msg_label, GET_PARAMETER_COMMAND, i);
+        param_label.resize(param_prefix_len);
+        param_label += std::to_string(i);
         int len = param->len;   // number of bytes to read
         int size = param->elements; // size of the array, or 1 for scalars
-        std::string type = param->type; // type to decode
+        std::string const &type = param->type; // type to decode
         if (m_debug) {
           if (size == 1) {
             std::cout << "  handleUdpMessage: decoding " << len << " byte " << type
@@ -905,7 +968,7 @@ namespace PLEXIL
           if (m_debug)
             std::cout << array.toString() << std::endl;
           debugMsg("UdpAdapter:handleUdpMessage", " queueing numeric (integer) array " << array.toString());
-          m_messageQueues.addMessage(param_label, array);
+          m_messageQueues.addMessage(param_label, Value(std::move(array)));
         }
         else if (type.compare("float") == 0) {
           if (len != 4) {
@@ -932,7 +995,7 @@ namespace PLEXIL
           if (m_debug)
             std::cout << array.toString() << std::endl;
           debugMsg("UdpAdapter:handleUdpMessage", " queueing numeric (real) array " << array.toString());
-          m_messageQueues.addMessage(param_label, Value(array));
+          m_messageQueues.addMessage(param_label, Value(std::move(array)));
         }
         else if (type.compare("bool") == 0) {
           int num;
@@ -976,7 +1039,7 @@ namespace PLEXIL
           if (m_debug)
             std::cout << array.toString() << std::endl;
           debugMsg("UdpAdapter:handleUdpMessage", " queueing boolean array " << array.toString());
-          m_messageQueues.addMessage(param_label, Value(array));
+          m_messageQueues.addMessage(param_label, Value(std::move(array)));
         }
         else if (type.compare("string-array") == 0) {
           // XXXX For unknown reasons, OnCommand(... String arg); is unable to receive this (inlike int and float arrays)
@@ -988,7 +1051,7 @@ namespace PLEXIL
           if (m_debug)
             std::cout << array.toString() << std::endl;
           debugMsg("UdpAdapter:handleUdpMessage", " queuing string array " << array.toString());
-          m_messageQueues.addMessage(param_label, Value(array));
+          m_messageQueues.addMessage(param_label, Value(std::move(array)));
         }
         else { // string or die
           if (type.compare("string")) {
@@ -999,7 +1062,7 @@ namespace PLEXIL
           if (m_debug)
             std::cout << str << std::endl;
           debugMsg("UdpAdapter:handleUdpMessage", " queuing string parameter \"" << str << "\"");
-          m_messageQueues.addMessage(param_label, Value(str));
+          m_messageQueues.addMessage(param_label, Value(std::move(str)));
           offset += len;
         }
       }
@@ -1355,6 +1418,7 @@ namespace PLEXIL
 
     std::mutex m_cmdMutex;
     std::unique_ptr<UdpEventLoop> m_eventLoop;
+    std::shared_ptr<UdpSendQueue> m_sendQueue;
     
     // Somewhere to hang the messages, default ports and peers, threads and sockets
     std::string m_default_peer;
@@ -1362,6 +1426,7 @@ namespace PLEXIL
     MessageQueueMap m_messageQueues;
     unsigned int m_default_local_port;
     unsigned int m_default_peer_port;
+    bool m_batchSends; // Defer sends to the end of the macro step
     bool m_debug; // Show debugging output
 
   }; // class UdpAdapter
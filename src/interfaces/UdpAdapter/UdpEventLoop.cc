@@ -57,10 +57,16 @@
 #include <arpa/inet.h>
 #endif
 
-#ifdef HAVE_POLL_H
+#if defined(HAVE_SYS_EPOLL_H)
+#include <sys/epoll.h>
+#elif defined(HAVE_POLL_H)
 #include <poll.h>
 #endif
 
+#ifdef HAVE_SYS_SOCKET_H
+#include <sys/socket.h> // recvmmsg()
+#endif
+
 #ifdef HAVE_UNISTD_H
 #include <unistd.h> // pipe()
 #endif
@@ -68,13 +74,26 @@
 namespace PLEXIL
 {
 
+#ifdef HAVE_RECVMMSG
+  //! Maximum number of datagrams read from a socket by one recvmmsg() call.
+  static constexpr size_t RECEIVE_BATCH_SIZE = 16;
+#else
+  static constexpr size_t RECEIVE_BATCH_SIZE = 1;
+#endif
+
   //! Structure to maintain the state of one listener.
+  //! The receive buffers are allocated once, when the listener is
+  //! constructed, and reused for every datagram.
   struct Listener
   {
     ListenerFunction func;
     size_t maxSize;
     std::unique_ptr<char[]> buffer;
-    std::unique_ptr<struct sockaddr_storage> addrBuf;
+    std::unique_ptr<struct sockaddr_storage[]> addrBuf;
+#ifdef HAVE_RECVMMSG
+    std::unique_ptr<struct iovec[]> iovecs;
+    std::unique_ptr<struct mmsghdr[]> msgs;
+#endif
     socklen_t addrSizeBuf;
     int socketFD;
     in_port_t port;
@@ -83,18 +102,171 @@ namespace PLEXIL
     Listener(int fd, in_port_t p, size_t maxLen, ListenerFunction fn)
       : func(fn),
         maxSize(maxLen),
-        buffer(std::make_unique<char[]>(maxLen)),
-        addrBuf(std::make_unique<struct sockaddr_storage>()),
+        buffer(std::make_unique<char[]>(maxLen * RECEIVE_BATCH_SIZE)),
+        addrBuf(std::make_unique<struct sockaddr_storage[]>(RECEIVE_BATCH_SIZE)),
+#ifdef HAVE_RECVMMSG
+        iovecs(std::make_unique<struct iovec[]>(RECEIVE_BATCH_SIZE)),
+        msgs(std::make_unique<struct mmsghdr[]>(RECEIVE_BATCH_SIZE)),
+#endif
         addrSizeBuf(),
         socketFD(fd),
         port(p),
         active(false)
     {
+#ifdef HAVE_RECVMMSG
+      for (size_t i = 0; i < RECEIVE_BATCH_SIZE; ++i) {
+        iovecs[i].iov_base = buffer.get() + i * maxSize;
+        iovecs[i].iov_len = maxSize;
+        msgs[i].msg_hdr.msg_name = &addrBuf[i];
+        msgs[i].msg_hdr.msg_iov = &iovecs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+      }
+#endif
     }
 
     ~Listener() = default;
   };
 
+  //! A file descriptor reported ready by a ReadySet.
+  struct ReadyEvent
+  {
+    int fd;
+    bool error;
+  };
+
+#if defined(HAVE_SYS_EPOLL_H)
+
+  //! The set of file descriptors watched by the event loop, using epoll.
+  class ReadySet final
+  {
+  public:
+    ReadySet()
+      : m_events(),
+        m_epollFD(epoll_create1(EPOLL_CLOEXEC))
+    {
+      if (m_epollFD < 0)
+        warn("UdpEventLoop: epoll_create1() failed: " << strerror(errno));
+    }
+
+    ~ReadySet()
+    {
+      if (m_epollFD >= 0)
+        close(m_epollFD);
+    }
+
+    bool isValid() const
+    {
+      return m_epollFD >= 0;
+    }
+
+    bool add(int fd)
+    {
+      struct epoll_event ev = {};
+      ev.events = EPOLLIN;
+      ev.data.fd = fd;
+      if (epoll_ctl(m_epollFD, EPOLL_CTL_ADD, fd, &ev)) {
+        warn("UdpEventLoop: epoll_ctl() failed to add FD " << fd << ": "
+             << strerror(errno));
+        return false;
+      }
+      m_events.emplace_back();
+      return true;
+    }
+
+    void remove(int fd)
+    {
+      if (epoll_ctl(m_epollFD, EPOLL_CTL_DEL, fd, nullptr)) {
+        warn("UdpEventLoop: epoll_ctl() failed to remove FD " << fd << ": "
+             << strerror(errno));
+      }
+      else {
+        m_events.pop_back();
+      }
+    }
+
+    //! Wait for one or more file descriptors to become ready.
+    //! @param ready Vector to which the ready descriptors are appended.
+    //! @return True if successful, false on error.
+    bool wait(std::vector<ReadyEvent> &ready)
+    {
+      int nReady = epoll_wait(m_epollFD, m_events.data(), (int) m_events.size(), -1);
+      if (nReady < 0) {
+        if (errno == EINTR)
+          return true;
+        warn("UdpEventLoop: epoll_wait() failed: " << strerror(errno));
+        return false;
+      }
+      for (int i = 0; i < nReady; ++i)
+        ready.push_back({m_events[i].data.fd,
+                         0 != (m_events[i].events & EPOLLERR)});
+      return true;
+    }
+
+  private:
+    std::vector<struct epoll_event> m_events;
+    int m_epollFD;
+  };
+
+#else
+
+  //! The set of file descriptors watched by the event loop, using poll.
+  class ReadySet final
+  {
+  public:
+    ReadySet()
+      : m_pollfds()
+    {
+      m_pollfds.reserve(4);
+    }
+
+    ~ReadySet() = default;
+
+    bool isValid() const
+    {
+      return true;
+    }
+
+    bool add(int fd)
+    {
+      struct pollfd pfd = {fd, POLLIN, 0};
+      m_pollfds.push_back(pfd);
+      return true;
+    }
+
+    void remove(int fd)
+    {
+      std::vector<struct pollfd>::iterator it =
+        std::find_if(m_pollfds.begin(), m_pollfds.end(),
+                     [fd](struct pollfd &pfd) -> bool
+                     { return pfd.fd == fd; });
+      if (it != m_pollfds.end())
+        m_pollfds.erase(it);
+    }
+
+    //! Wait for one or more file descriptors to become ready.
+    //! @param ready Vector to which the ready descriptors are appended.
+    //! @return True if successful, false on error.
+    bool wait(std::vector<ReadyEvent> &ready)
+    {
+      int nReady = poll(m_pollfds.data(), m_pollfds.size(), -1);
+      if (nReady < 0) {
+        if (errno == EINTR)
+          return true;
+        warn("UdpEventLoop: poll() failed: " << strerror(errno));
+        return false;
+      }
+      for (struct pollfd const &pfd : m_pollfds)
+        if (pfd.revents)
+          ready.push_back({pfd.fd, 0 != (pfd.revents & (POLLERR | POLLNVAL))});
+      return true;
+    }
+
+  private:
+    std::vector<struct pollfd> m_pollfds;
+  };
+
+#endif // defined(HAVE_SYS_EPOLL_H)
+
   //! Control operations
   enum ControlOp : uint16_t {
     OP_NO_OP = 0, // invalid
@@ -363,106 +535,49 @@ namespace PLEXIL
     {
       debugMsg("UdpEventLoop:eventLoop", "(" << pipeFD << ")");
 
-      // Allocate a reasonable initial vector.
-      std::vector<struct pollfd> pollfds;
-      pollfds.reserve(4);
-
-      // Set up the control pipe.
-      struct pollfd pfd = {pipeFD, POLLIN, 0};
-      pollfds.push_back(pfd);
+      ReadySet readySet;
+      std::vector<ReadyEvent> ready;
+      ready.reserve(4);
 
       bool stopped = false;
-      bool error = false;
-      do {
-        int nReady = poll(pollfds.data(), pollfds.size(), -1);
-        if (nReady < 0) {
-          warn("UdpEventLoop: poll() failed: " << strerror(errno));
+      bool error = !readySet.isValid() || !readySet.add(pipeFD);
+      while (!stopped && !error) {
+        ready.clear();
+        if (!readySet.wait(ready))
           break;
-        }
-        else if (nReady == 0) {
-          // This would be the timeout case, if we had a timeout
-          debugMsg("UdpEventLoop:eventLoop", " poll() returned 0");
-          continue;
-        }
 
-        // At least 1 FD is ready
-        // pollfds[0] should always represent the control pipe
-        if (pollfds[0].revents) {
-          if (pollfds[0].revents & (POLLERR | POLLNVAL)) {
-            warn("UdpEventLoop: error on control pipe");
-            break;
+        for (ReadyEvent const &event : ready) {
+          if (event.fd == pipeFD) {
+            if (event.error) {
+              warn("UdpEventLoop: error on control pipe");
+              error = true;
+              break;
+            }
+            debugMsg("UdpEventLoop:eventLoop", " control event");
+            if (!handleControlMessage(pipeFD, readySet, stopped))
+              error = true;
+            if (stopped || error)
+              break;
+            continue;
           }
 
-          debugMsg("UdpEventLoop:eventLoop", " control event");
-          // Handle control message or stop request
-          ControlMsg request;
-          ssize_t nbytes = read(pipeFD, &request, sizeof(ControlMsg));
-          if (nbytes < 0) {
-            warn("UdpEventLoop: read() from control pipe failed: " << strerror(errno));
-            error = true;
-            break;
-          }
-          else if (!nbytes) {
-            // EOF on pipe = stop request
-            debugMsg("UdpEventLoop:eventLoop", " stop requested");
-            stopped = true;
-            nReady = 0;
+          // Dispatch the incoming datagram(s)
+          DescriptorMap::const_iterator it = m_descriptors.find(event.fd);
+          if (it == m_descriptors.end()) {
+            // Listener was removed earlier in this batch
+            debugMsg("UdpEventLoop:eventLoop",
+                     " ignoring event on removed FD " << event.fd);
+            continue;
           }
-          else if (nbytes != sizeof(ControlMsg)) {
-            // OOPS
-            warn("UdpEventLoop: control message was wrong size!");
+          if (event.error) {
+            warn("UdpEventLoop: error on FD " << event.fd
+                 << " (port " << it->second->port << ')');
             error = true;
             break;
           }
-          else {
-            switch(request.op) {
-            case OP_ADD:
-              addListener(request.port, pollfds);
-              break;
-
-            case OP_REMOVE:
-              removeListener(request.port, pollfds);
-              break;
-
-            default:
-              warn("UdpEventLoop: invalid control message!");
-              break;
-            }
-
-            // Mark this one off and see if we have more FDs ready
-            --nReady;
-          }
-        }
-        if (nReady) {
-          // Identify FD(s) which became ready
-          // and dispatch the incoming datagrams
-          for (size_t i = 1; i < pollfds.size(); ++i) {
-            if (pollfds[i].revents) {
-              --nReady;
-              int fd = pollfds[i].fd;
-              if (!m_descriptors[fd]) {
-                warn("UdpEventLoop: internal error: no listener for FD " << fd);
-                error = true;
-                break;
-              }
-              if (pollfds[i].revents & (POLLERR | POLLNVAL)) {
-                warn("UdpEventLoop: error on FD " << pollfds[i].fd
-                     << " (port " << m_descriptors[fd]->port << ')');
-                error = true;
-                break;
-              }
-              handleFDReady(fd, m_descriptors[fd]);
-            }
-            if (!nReady)
-              break; // from inner for loop
-          }
-        }
-
-        // Shouldn't be any left over
-        if (nReady) {
-          warn("UdpEventLoop: internal error: failed to handle all ready FDs");
+          handleFDReady(event.fd, it->second);
         }
-      } while (!stopped && !error);
+      }
 
       if (!stopped) {
         warn("UdpEventLoop: shutting down on error");
@@ -479,10 +594,53 @@ namespace PLEXIL
       debugMsg("UdpEventLoop:eventLoop", " exited");
     }
 
+    //! Read one request from the control pipe and act on it.
+    //! @param pipeFD File descriptor of the control pipe.
+    //! @param readySet The event loop's set of watched file descriptors.
+    //! @param stopped Set to true if a stop was requested.
+    //! @return False on error, true otherwise.
+    //! @note Must only be called synchronously from the event loop.
+    bool handleControlMessage(int pipeFD, ReadySet &readySet, bool &stopped)
+    {
+      ControlMsg request;
+      ssize_t nbytes = read(pipeFD, &request, sizeof(ControlMsg));
+      if (nbytes < 0) {
+        warn("UdpEventLoop: read() from control pipe failed: " << strerror(errno));
+        return false;
+      }
+      if (!nbytes) {
+        // EOF on pipe = stop request
+        debugMsg("UdpEventLoop:eventLoop", " stop requested");
+        stopped = true;
+        return true;
+      }
+      if (nbytes != sizeof(ControlMsg)) {
+        // OOPS
+        warn("UdpEventLoop: control message was wrong size!");
+        return false;
+      }
+
+      switch (request.op) {
+      case OP_ADD:
+        addListener(request.port, readySet);
+        break;
+
+      case OP_REMOVE:
+        removeListener(request.port, readySet);
+        break;
+
+      default:
+        warn("UdpEventLoop: invalid control message!");
+        break;
+      }
+      return true;
+    }
+
     //! Add the listener registered for the given port.
     //! @param port The port.
+    //! @param readySet The event loop's set of watched file descriptors.
     //! @note Must only be called synchronously from the event loop.
-    void addListener(in_port_t port, std::vector<struct pollfd> &pollfds)
+    void addListener(in_port_t port, ReadySet &readySet)
     {
       debugMsg("UdpEventLoop:addListener", "(" << port << ")");
 
@@ -499,12 +657,14 @@ namespace PLEXIL
         return;
       }
 
-      // Map the file descriptor to the listener
+      // Add the file descriptor to the watched set
       int fd = l->socketFD;
+      if (!readySet.add(fd)) {
+        m_sem.post(); // complete, though not successful
+        return;
+      }
+      // Map the file descriptor to the listener
       m_descriptors[fd] = l;
-      // and add it to the vector.
-      struct pollfd pfd = {fd, POLLIN, 0};
-      pollfds.push_back(pfd);
       // Mark it active
       l->active = true;
       // Notify foreground
@@ -514,8 +674,9 @@ namespace PLEXIL
 
     //! Remove the listener on the given port.
     //! @param port The port.
+    //! @param readySet The event loop's set of watched file descriptors.
     //! @note Must only be called synchronously from the event loop.
-    void removeListener(in_port_t port, std::vector<struct pollfd> &pollfds)
+    void removeListener(in_port_t port, ReadySet &readySet)
     {
       debugMsg("UdpEventLoop:removeListener", "(" << port << ")");
       Listener *l;
@@ -530,37 +691,57 @@ namespace PLEXIL
       }
 
       int fd = l->socketFD;
-      std::vector<struct pollfd>::iterator it =
-        std::find_if(pollfds.begin(), pollfds.end(),
-                     [fd](struct pollfd &pfd) -> bool
-                     { return pfd.fd == fd; });
-
-      // See if there is a pending error event on the FD before removing it
-      if (it->revents & (POLLERR | POLLNVAL)) {
-        warn("UdpEventLoop::removeListener: ignoring error on FD " << fd);
+      if (l->active) {
+        // Remove the file descriptor from the watched set
+        readySet.remove(fd);
+        // Remove the listener from the descriptor map
+        m_descriptors.erase(fd);
+        // Mark the listener inactive
+        l->active = false;
       }
-
-      // Remove the file descriptor from the pollfd vector
-      pollfds.erase(it);
-      // Remove the listener from the descriptor map
-      m_descriptors.erase(l->socketFD);
-      // Mark the listener inactive
-      l->active = false;
       debugMsg("UdpEventLoop:removeListener",
                " port " << port << " FD " << fd << " succeeded");
       // Notify foreground
       m_sem.post();
     }
 
-    //! Read from the given file descriptor and dispatch the datagram
-    //! to the listener function.
+    //! Read from the given file descriptor and dispatch the
+    //! datagram(s) to the listener function.
     //! @param fd The file descriptor to read from.
     //! @param listener Pointer to the Listener for this port.
     //! @note Must only be called synchronously from the event loop.
     void handleFDReady(int fd, Listener *listener)
     {
-      debugMsg("UdpEventLoop:handleFDReady", " FD " << fd << ", port " << listener->port);
       assertTrue_1(listener);
+      debugMsg("UdpEventLoop:handleFDReady", " FD " << fd << ", port " << listener->port);
+#ifdef HAVE_RECVMMSG
+      // Read as many datagrams as are waiting, up to the size of the
+      // buffer pool.
+      for (size_t i = 0; i < RECEIVE_BATCH_SIZE; ++i)
+        listener->msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+      int nmsgs = recvmmsg(fd, listener->msgs.get(), RECEIVE_BATCH_SIZE,
+                           MSG_DONTWAIT, nullptr);
+      if (nmsgs < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+          warn("UdpEventLoop: recvmmsg() failed on port " << listener->port
+               << ": " << strerror(errno));
+        }
+      }
+      debugMsg("UdpEventLoop:handleFDReady", " received " << nmsgs << " datagrams");
+      for (int i = 0; i < nmsgs; ++i) {
+        struct mmsghdr const &msg = listener->msgs[i];
+        if (msg.msg_hdr.msg_flags & MSG_TRUNC) {
+          warn("UdpEventLoop: datagram truncated to " << listener->maxSize
+               << " bytes on port " << listener->port);
+        }
+        (listener->func)(listener->port,
+                         listener->iovecs[i].iov_base,
+                         (size_t) msg.msg_len,
+                         reinterpret_cast<const struct sockaddr *>(&listener->addrBuf[i]),
+                         msg.msg_hdr.msg_namelen);
+      }
+#else
+      listener->addrSizeBuf = sizeof(struct sockaddr_storage);
       ssize_t nbytes = recvfrom(fd, listener->buffer.get(), listener->maxSize,
                                 0, // flags
                                 reinterpret_cast<struct sockaddr *>(listener->addrBuf.get()),
@@ -576,6 +757,7 @@ namespace PLEXIL
                          reinterpret_cast<const struct sockaddr *>(listener->addrBuf.get()),
                          listener->addrSizeBuf);
       }
+#endif
       debugMsg("UdpEventLoop:handleFDReady", " FD " << fd << " complete");
     }
 
@@ -0,0 +1,250 @@
+// Copyright (c) 2006-2021, Universities Space Research Association (USRA).
+//  All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Universities Space Research Association nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "UdpSendQueue.hh"
+
+#include "Debug.hh"
+#include "Error.hh" // warn()
+#include "udp-utils.hh"
+
+#include <map>
+#include <mutex>
+#include <utility> // std::pair
+#include <vector>
+
+#if defined(HAVE_CERRNO)
+#include <cerrno>
+#elif defined(HAVE_ERRNO_H)
+#include <errno.h>
+#endif
+
+#if defined(HAVE_CSTRING)
+#include <cstring>
+#elif defined(HAVE_STRING_H)
+#include <string.h>
+#endif
+
+#ifdef HAVE_SYS_SOCKET_H
+#include <sys/socket.h> // sendmmsg(), sendto()
+#endif
+
+#ifdef HAVE_UNISTD_H
+#include <unistd.h> // close()
+#endif
+
+namespace PLEXIL
+{
+
+  class UdpSendQueueImpl final : public UdpSendQueue
+  {
+  private:
+    //! One queued outbound datagram.
+    struct Datagram
+    {
+      std::vector<char> data;
+      struct sockaddr_in address;
+      SendCallback callback;
+      bool sent;
+    };
+
+    using PeerKey = std::pair<std::string, in_port_t>;
+    using AddressMap = std::map<PeerKey, struct sockaddr_in>;
+
+    //! Peer host and port -> resolved address
+    AddressMap m_addresses;
+    //! Datagrams waiting to be sent
+    std::vector<Datagram> m_pending;
+#ifdef HAVE_SENDMMSG
+    //! Scratch space for sendmmsg(), reused across calls
+    std::vector<struct mmsghdr> m_msgs;
+    std::vector<struct iovec> m_iovecs;
+#endif
+    //! Serializes access to the queue and the socket
+    std::mutex m_mutex;
+    //! The outbound socket; opened on first use.
+    int m_socket;
+
+  public:
+    UdpSendQueueImpl()
+      : UdpSendQueue(),
+        m_addresses(),
+        m_pending(),
+#ifdef HAVE_SENDMMSG
+        m_msgs(),
+        m_iovecs(),
+#endif
+        m_mutex(),
+        m_socket(-1)
+    {
+    }
+
+    virtual ~UdpSendQueueImpl()
+    {
+      if (!m_pending.empty()) {
+        // Whoever queued these may be gone by now
+        for (Datagram &dgram : m_pending)
+          dgram.callback = SendCallback();
+        flush();
+      }
+      if (m_socket >= 0)
+        close(m_socket);
+    }
+
+    virtual bool enqueue(std::string const &host,
+                         in_port_t port,
+                         const void *buffer,
+                         size_t length,
+                         SendCallback callback) override
+    {
+      std::lock_guard<std::mutex> guard(m_mutex);
+      PeerKey key(host, port);
+      AddressMap::const_iterator it = m_addresses.find(key);
+      if (it == m_addresses.end()) {
+        in_addr_t ip = parse_hostname(host.c_str());
+        if (!ip) {
+          warn("UdpSendQueue: unable to resolve host \"" << host << '"');
+          return false;
+        }
+        struct sockaddr_in addr;
+        init_sockaddr_in(&addr, ip, port);
+        it = m_addresses.emplace(key, addr).first;
+      }
+      const char *start = static_cast<const char *>(buffer);
+      m_pending.push_back({std::vector<char>(start, start + length),
+                           it->second,
+                           std::move(callback),
+                           false});
+      debugMsg("UdpSendQueue:enqueue",
+               ' ' << length << " bytes to " << host << ':' << port
+               << ", " << m_pending.size() << " queued");
+      return true;
+    }
+
+    virtual size_t flush() override
+    {
+      std::vector<Datagram> done;
+      size_t nSent = 0;
+      {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        if (m_pending.empty())
+          return 0;
+
+        if (m_socket < 0)
+          m_socket = socket(AF_INET, SOCK_DGRAM, 0);
+        if (m_socket < 0) {
+          warn("UdpSendQueue: socket() failed: " << strerror(errno)
+               << "; discarding " << m_pending.size() << " datagrams");
+        }
+        else {
+          nSent = sendPending();
+          debugMsg("UdpSendQueue:flush",
+                   " sent " << nSent << " of " << m_pending.size() << " datagrams");
+        }
+        done.swap(m_pending);
+      }
+
+      // Report the outcomes
+      for (Datagram const &dgram : done)
+        if (dgram.callback)
+          dgram.callback(dgram.sent);
+      return nSent;
+    }
+
+  private:
+
+#ifdef HAVE_SENDMMSG
+
+    //! Send the pending datagrams with as few sendmmsg() calls as possible.
+    //! @return The number of datagrams sent.
+    //! @note Caller must hold m_mutex.
+    size_t sendPending()
+    {
+      size_t n = m_pending.size();
+      m_msgs.resize(n);
+      m_iovecs.resize(n);
+      for (size_t i = 0; i < n; ++i) {
+        Datagram &dgram = m_pending[i];
+        m_iovecs[i].iov_base = dgram.data.data();
+        m_iovecs[i].iov_len = dgram.data.size();
+        struct msghdr &hdr = m_msgs[i].msg_hdr;
+        memset(&hdr, 0, sizeof(struct msghdr));
+        hdr.msg_name = &dgram.address;
+        hdr.msg_namelen = sizeof(struct sockaddr_in);
+        hdr.msg_iov = &m_iovecs[i];
+        hdr.msg_iovlen = 1;
+      }
+
+      size_t nSent = 0;
+      size_t next = 0;
+      while (next < n) {
+        int status = sendmmsg(m_socket, &m_msgs[next], n - next, 0);
+        if (status < 0) {
+          if (errno == EINTR)
+            continue;
+          // The first remaining datagram failed; skip it
+          warn("UdpSendQueue: sendmmsg() failed: " << strerror(errno));
+          ++next;
+          continue;
+        }
+        for (int i = 0; i < status; ++i)
+          m_pending[next + i].sent = true;
+        nSent += status;
+        next += status;
+      }
+      return nSent;
+    }
+
+#else
+
+    //! Send the pending datagrams one at a time.
+    //! @return The number of datagrams sent.
+    //! @note Caller must hold m_mutex.
+    size_t sendPending()
+    {
+      size_t nSent = 0;
+      for (Datagram &dgram : m_pending) {
+        if (sendto(m_socket, dgram.data.data(), dgram.data.size(), 0,
+                   reinterpret_cast<const struct sockaddr *>(&dgram.address),
+                   sizeof(struct sockaddr_in)) < 0) {
+          warn("UdpSendQueue: sendto() failed: " << strerror(errno));
+        }
+        else {
+          dgram.sent = true;
+          ++nSent;
+        }
+      }
+      return nSent;
+    }
+
+#endif // HAVE_SENDMMSG
+
+  }; // class UdpSendQueueImpl
+
+  std::unique_ptr<UdpSendQueue> makeUdpSendQueue()
+  {
+    return std::make_unique<UdpSendQueueImpl>();
+  }
+
+} // namespace PLEXIL
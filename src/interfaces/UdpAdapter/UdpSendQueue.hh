@@ -0,0 +1,89 @@
+// Copyright (c) 2006-2021, Universities Space Research Association (USRA).
+//  All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Universities Space Research Association nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+// USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef PLEXIL_UDP_SEND_QUEUE_HH
+#define PLEXIL_UDP_SEND_QUEUE_HH
+
+#include "plexil-config.h"
+
+#include <functional>
+#include <memory> // std::unique_ptr
+#include <string>
+
+#ifdef HAVE_NETINET_IN_H
+#include <netinet/in.h> // in_port_t
+#endif
+
+namespace PLEXIL
+{
+
+  //! @class UdpSendQueue
+  //! Collects outbound datagrams and sends them together on one
+  //! socket, with a single sendmmsg() call where the platform
+  //! supports it.  Peer addresses are resolved once and cached.
+  class UdpSendQueue
+  {
+  public:
+    //! Called by flush() with the outcome of sending one datagram.
+    using SendCallback = std::function<void(bool sent)>;
+
+    virtual ~UdpSendQueue() = default;
+
+    //! Queue a copy of the datagram for sending to the given peer.
+    //! @param host Name of the peer host, suitable for gethostbyname().
+    //! @param port The destination port on the peer host.
+    //! @param buffer Pointer to the datagram.
+    //! @param length Size of the datagram.
+    //! @param callback Function to call once the datagram has been
+    //!        sent or has failed; may be empty.
+    //! @return True if queued, false if the host could not be resolved.
+    //! @note The callback is not called if enqueue() returns false.
+    virtual bool enqueue(std::string const &host,
+                         in_port_t port,
+                         const void *buffer,
+                         size_t length,
+                         SendCallback callback) = 0;
+
+    //! Send all queued datagrams, then call their callbacks.
+    //! @return The number of datagrams successfully sent.
+    //! @note Callbacks are called without any lock held, on the
+    //!       calling thread.
+    virtual size_t flush() = 0;
+
+  protected:
+    UdpSendQueue() = default;
+
+  private:
+    UdpSendQueue(const UdpSendQueue &) = delete;
+    UdpSendQueue(UdpSendQueue &&) = delete;
+    UdpSendQueue &operator=(const UdpSendQueue &) = delete;
+    UdpSendQueue &operator=(UdpSendQueue &&) = delete;
+  };
+
+  std::unique_ptr<UdpSendQueue> makeUdpSendQueue();
+
+} // namespace PLEXIL
+
+#endif // PLEXIL_UDP_SEND_QUEUE_HH
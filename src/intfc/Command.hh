@@ -30,8 +30,12 @@
 #include "State.hh"
 #include "Value.hh"
 
+#include <chrono>
+
 namespace PLEXIL
 {
+  // Forward reference
+  class CommandHandler;
 
   //! @class Command
   //! The API of a Command object as seen from outside the Exec.
@@ -50,6 +54,20 @@ namespace PLEXIL
     // For the benefit of TestExec
     virtual bool isReturnExpected() const = 0;
 
+    // For the Dispatcher's use only.
+    // Returns the handler cached by setCommandHandler() with the same
+    // generation, or null.
+    virtual CommandHandler *getCommandHandler(unsigned int generation) const = 0;
+    // Caches the handler for future calls. The generation identifies
+    // the Dispatcher's handler registrations at the time; a handler
+    // cached under another generation may since have been replaced.
+    // Ignored unless the command name is a constant.
+    virtual void setCommandHandler(CommandHandler *handler, unsigned int generation) = 0;
+    // Returns the time stored by setSendTime() since the command was
+    // last activated, or the clock's epoch if none.
+    virtual std::chrono::steady_clock::time_point getSendTime() const = 0;
+    virtual void setSendTime(std::chrono::steady_clock::time_point t) = 0;
+
   protected:
     Command() = default;
   };
@@ -175,9 +175,13 @@ namespace PLEXIL
       m_argVec(nullptr),
       m_resourceList(nullptr),
       m_resourceValueList(nullptr),
+      m_handler(nullptr),
+      m_handlerGeneration(0),
+      m_sendTime(),
       m_commandHandle(NO_COMMAND_HANDLE),
       m_active(false),
       m_commandFixed(false),
+      m_commandNameIsConstant(false),
       m_commandIsConstant(false),
       m_resourcesFixed(false),
       m_resourcesAreConstant(false),
@@ -237,6 +241,29 @@ namespace PLEXIL
     return m_command.parameters();
   }
 
+  CommandHandler *CommandImpl::getCommandHandler(unsigned int generation) const
+  {
+    return generation == m_handlerGeneration ? m_handler : nullptr;
+  }
+
+  void CommandImpl::setCommandHandler(CommandHandler *handler, unsigned int generation)
+  {
+    if (m_commandNameIsConstant) {
+      m_handler = handler;
+      m_handlerGeneration = generation;
+    }
+  }
+
+  std::chrono::steady_clock::time_point CommandImpl::getSendTime() const
+  {
+    return m_sendTime;
+  }
+
+  void CommandImpl::setSendTime(std::chrono::steady_clock::time_point t)
+  {
+    m_sendTime = t;
+  }
+
   bool CommandImpl::isReturnExpected() const
   {
     return (bool) m_dest;
@@ -328,9 +355,12 @@ namespace PLEXIL
     assertTrue_1(m_active);
     if (m_commandFixed)
       return;
-    std::string const *name;
-    m_nameExpr->getValuePointer(name);
-    m_command.setName(*name);
+    // A constant name need only be copied once
+    if (!m_commandNameIsConstant || m_command.name().empty()) {
+      std::string const *name;
+      m_nameExpr->getValuePointer(name);
+      m_command.setName(*name);
+    }
     if (m_argVec) {
       size_t n = m_argVec->size();
       m_command.setParameterCount(n);
@@ -390,6 +420,7 @@ namespace PLEXIL
     check_error_1(m_nameExpr);
 
     m_commandHandle = NO_COMMAND_HANDLE;
+    m_sendTime = std::chrono::steady_clock::time_point();
     m_ack.activate();
     m_abortComplete.activate();
 
@@ -125,6 +125,12 @@ namespace PLEXIL
     // For the benefit of TestExec
     virtual bool isReturnExpected() const;
 
+    // For the benefit of the Dispatcher
+    virtual CommandHandler *getCommandHandler(unsigned int generation) const;
+    virtual void setCommandHandler(CommandHandler *handler, unsigned int generation);
+    virtual std::chrono::steady_clock::time_point getSendTime() const;
+    virtual void setSendTime(std::chrono::steady_clock::time_point t);
+
     const ResourceValueList &getResourceValues() const;
     CommandHandleValue getCommandHandle() const;
 
@@ -191,6 +197,9 @@ namespace PLEXIL
     ExprVec *m_argVec;
     ResourceList *m_resourceList;
     ResourceValueList *m_resourceValueList;
+    CommandHandler *m_handler; // cached by the Dispatcher
+    unsigned int m_handlerGeneration; // of the Dispatcher's registrations
+    std::chrono::steady_clock::time_point m_sendTime; // set by the Dispatcher
     CommandHandleValue m_commandHandle; // accessed by CommandHandleVariable
     bool m_active;
     bool m_commandFixed, m_commandNameIsConstant, m_commandIsConstant;
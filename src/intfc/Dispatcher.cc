@@ -28,6 +28,6 @@
 namespace PLEXIL
 {
 
-  Dispatcher *g_dispatcher = nullptr;
+  thread_local Dispatcher *g_dispatcher = nullptr;
 
 }
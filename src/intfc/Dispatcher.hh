@@ -109,8 +109,9 @@ namespace PLEXIL
 
   }; // class Dispatcher
 
-  //! Global variable pointing to the Dispatcher instance
-  extern Dispatcher *g_dispatcher;
+  //! Pointer to the Dispatcher instance in use by the calling thread.
+  //! @see g_exec
+  extern thread_local Dispatcher *g_dispatcher;
 
 } // namespace PLEXIL
 
@@ -48,7 +48,8 @@ namespace PLEXIL
     // Reader side
     //
 
-    // Get the head of the queue. If empty, returns nullptr.
+    // Get the next entry. Returns nullptr if the queue is empty, or to
+    // end the current batch early so the Exec can step.
     virtual QueueEntry *get() = 0;
 
     // Flush the queue without examining it.
@@ -491,6 +491,11 @@ namespace PLEXIL
      */
     virtual void setThresholds(CachedValue const *value, Expression const *tolerance) = 0;
 
+    /**
+     * @brief Check whether the thresholds were set from a known value.
+     * @return True if known, false otherwise.
+     */
+    virtual bool isKnown() const = 0;
 
     /**
      * @brief Get the current thresholds.
@@ -574,6 +579,11 @@ namespace PLEXIL
       }
     }
 
+    virtual bool isKnown() const override
+    {
+      return m_wasKnown;
+    }
+
     virtual void getThresholds(NUM &high, NUM &low) const override
     {
       high = m_high;
@@ -721,7 +731,7 @@ namespace PLEXIL
                  ' ' << m_cachedState << ": not active, returning false");
         return false;
       }
-      if (!m_thresholds) {
+      if (!m_thresholds || !m_thresholds->isKnown()) {
         debugMsg("LookupOnChange:getThresholds",
                  ' ' << m_cachedState << ": no thresholds, returning false");
         return false;
@@ -742,7 +752,7 @@ namespace PLEXIL
                  ' ' << m_cachedState << ": not active, returning false");
         return false;
       }
-      if (!m_thresholds) {
+      if (!m_thresholds || !m_thresholds->isKnown()) {
         debugMsg("LookupOnChange:getThresholds",
                  ' ' << m_cachedState << ": no thresholds, returning false");
         return false;
@@ -903,6 +913,7 @@ namespace PLEXIL
                      ' ' << this->m_cachedState
                      << " tolerance changed, updating thresholds");
             m_thresholds->setThresholds(m_cachedValue.get(), m_tolerance);
+            m_entry->updateThresholds(m_cachedState, this);
           }
 
           // Has the (possibly updated) threshold been exceeded?
@@ -915,7 +926,7 @@ namespace PLEXIL
             // Should be only place m_cachedValue is reassigned
             *m_cachedValue = *val;
             m_thresholds->setThresholds(val, m_tolerance);
-            m_entry->updateThresholds(m_cachedState);
+            m_entry->updateThresholds(m_cachedState, this);
             return true;
           }
           debugMsg("LookupOnChange:update",
@@ -932,7 +943,7 @@ namespace PLEXIL
           // worth optimizing?
           m_cachedValue.reset();
           // Tell the cache entry about it
-          m_entry->updateThresholds(m_cachedState);
+          m_entry->updateThresholds(m_cachedState, this);
           return valueChanged; // ??
         }
       }
@@ -950,7 +961,7 @@ namespace PLEXIL
         else
           m_cachedValue.reset(val->clone()); // should be the usual case
         m_thresholds->setThresholds(val, m_tolerance);
-        m_entry->updateThresholds(m_cachedState);
+        m_entry->updateThresholds(m_cachedState, this);
       }
 
       return valueChanged;
@@ -35,7 +35,8 @@
 
 namespace PLEXIL
 {
-  // Forward reference
+  // Forward references
+  class LookupHandler;
   class Value;
 
   //! @class LookupReceiver
@@ -64,6 +65,14 @@ namespace PLEXIL
     virtual void update(Integer const ary[], size_t size) = 0;
     virtual void update(Real const ary[], size_t size) = 0;
     virtual void update(String const ary[], size_t size) = 0;
+
+    // For the Dispatcher's use only.
+    // The handler for the state is resolved on the first lookup and
+    // cached here, because a receiver is bound to exactly one state.
+    // The cached handler is returned only for the generation of the
+    // Dispatcher's handler registrations under which it was cached.
+    virtual LookupHandler *getLookupHandler(unsigned int generation) const = 0;
+    virtual void setLookupHandler(LookupHandler *handler, unsigned int generation) = 0;
   };
 
 }
@@ -35,6 +35,7 @@ namespace PLEXIL
     : next(nullptr),
       command(nullptr),
       value(),
+      enqueued(),
       type(Q_UNINITED)
   {
   }
@@ -46,6 +47,7 @@ namespace PLEXIL
       delete state;
     state = nullptr;
     value.setUnknown();
+    enqueued = std::chrono::steady_clock::time_point();
     type = Q_UNINITED;
   }
 
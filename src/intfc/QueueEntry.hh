@@ -29,6 +29,8 @@
 
 #include "Value.hh"
 
+#include <chrono>
+
 namespace PLEXIL
 {
   // Forward declarations
@@ -67,6 +69,7 @@ namespace PLEXIL
       unsigned int sequence;
     };
     Value value;
+    std::chrono::steady_clock::time_point enqueued; // zero unless timed
     QueueEntryType type;
 
     QueueEntry();
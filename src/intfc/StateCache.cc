@@ -237,10 +237,19 @@ namespace PLEXIL
   const State StateCacheImpl::s_peekAtMessage = State("PeekAtMessage");
   const State StateCacheImpl::s_peekAtMessageSender = State("PeekAtMessageSender");
 
+  thread_local StateCache *g_stateCache = nullptr;
+
   StateCache &StateCache::instance()
   {
+    if (g_stateCache)
+      return *g_stateCache;
     static StateCacheImpl sl_instance;
     return static_cast<StateCache &>(sl_instance);
   }
 
+  StateCache *makeStateCache()
+  {
+    return new StateCacheImpl();
+  }
+
 } // namespace PLEXIL
@@ -45,6 +45,8 @@ namespace PLEXIL
   public:
     virtual ~StateCache() = default;
 
+    //! Return the StateCache bound to the calling thread, or the
+    //! process default instance if none is bound.
     static StateCache &instance();
 
     //!
@@ -132,6 +134,14 @@ namespace PLEXIL
     virtual StateCacheEntry *ensureTimeEntry() = 0;
   };
 
+  //! Pointer to the StateCache instance in use by the calling thread.
+  //! When null, StateCache::instance() returns the process default.
+  extern thread_local StateCache *g_stateCache;
+
+  //! Construct a new, independent StateCache instance.
+  //! @return Pointer to the new instance.
+  extern StateCache *makeStateCache();
+
 } // namespace PLEXIL
 
 #endif // PLEXIL_STATE_CACHE_HH
@@ -36,6 +36,14 @@
 #include "StateCache.hh"
 
 #include <algorithm> // std::find
+#include <iterator>  // std::next
+#include <map>
+
+#if defined(HAVE_CMATH)
+#include <cmath>  // fabs()
+#elif defined(HAVE_MATH_H)
+#include <math.h> // fabs()
+#endif
 
 namespace PLEXIL
 {
@@ -56,7 +64,9 @@ namespace PLEXIL
       : StateCacheEntry(),
         m_value(),
         m_lowThreshold(),
-        m_highThreshold()
+        m_highThreshold(),
+        m_lookupHandler(nullptr),
+        m_lookupHandlerGeneration(0)
     {
     }
 
@@ -78,14 +88,16 @@ namespace PLEXIL
 
     virtual bool hasRegisteredLookups() const
     {
-      return !m_lookups.empty();
+      return !m_lookups.empty() || !m_indexed.empty();
     }
 
     virtual void registerLookup(State const &state, Lookup *lkup)
     {
-      m_lookups.push_back(lkup);
+      if (!indexLookup(lkup))
+        m_lookups.push_back(lkup);
       debugMsg("StateCacheEntry:registerLookup",
-               ' ' << state << " now has " << m_lookups.size() << " lookups");
+               ' ' << state << " now has " << m_lookups.size() + m_indexed.size()
+               << " lookups");
       // Update if stale
       if ((!m_value) || m_value->getTimestamp() < StateCache::instance().getCycleCount()) {
         debugMsg("StateCacheEntry:registerLookup", ' ' << state << " updating stale value");
@@ -97,25 +109,12 @@ namespace PLEXIL
     {
       debugMsg("StateCacheEntry:unregisterLookup", ' ' << state);
 
-      if (m_lookups.empty())
-        return; // can't possibly be registered
-
-      // Somewhat likely to remove last item first, so check for that special case.
-      // TODO: analyze to see if this is true!
-      if (lkup == m_lookups.back())
-        m_lookups.pop_back();
-      else {
-        std::vector<Lookup *>::iterator iter =
-          std::find(m_lookups.begin(), m_lookups.end(), lkup);
-        if (iter != m_lookups.end())
-          m_lookups.erase(iter);
-        else {
-          debugMsg("StateCacheEntry:unregisterLookup", ' ' << state << " lookup not found")
-            return;
-        }
+      if (!unindexLookup(lkup) && !removeUnindexed(lkup)) {
+        debugMsg("StateCacheEntry:unregisterLookup", ' ' << state << " lookup not found");
+        return;
       }
 
-      if (m_lookups.empty()) {
+      if (!hasRegisteredLookups()) {
         debugMsg("StateCacheEntry:unregisterLookup",
                  ' ' << state << " no lookups remaining, unsubscribing");
         if (m_lowThreshold || m_highThreshold) {
@@ -127,45 +126,22 @@ namespace PLEXIL
         // Check whether thresholds should be updated
         debugMsg("StateCacheEntry:unregisterLookup",
                  ' ' << state << " updating thresholds from remaining "
-                 << m_lookups.size() << " lookups");
-        updateThresholds(state);
+                 << m_indexed.size() << " change lookups");
+        refreshThresholds(state);
       }
     }
 
-    virtual void updateThresholds(State const &state)
+    virtual void updateThresholds(State const &state, Lookup *lkup)
     {
-      // Survey lookups to determine if the thresholds
-      // need to be established, changed, or deleted.
-      ValueType vtype = m_value->valueType();
-      bool hasThresholds = false;
-
-      switch (vtype) {
-      case INTEGER_TYPE:
-        hasThresholds = integerUpdateThresholds(state);
-        break;
-
-        // FIXME: support non-Real date/duration types
-      case DATE_TYPE:
-      case DURATION_TYPE:
-
-      case REAL_TYPE: {
-        hasThresholds = realUpdateThresholds(state);
-        break;
-      }
-
-      default:
-        // this is a plan error
-        warn("LookupOnChange: lookup value of type " << valueTypeName(vtype)
-             << " does not allow a tolerance");
-        return;
-      }
-
-      if (!hasThresholds) {
+      // Move the lookup to wherever its current thresholds put it.
+      if (!unindexLookup(lkup) && !removeUnindexed(lkup)) {
         debugMsg("StateCacheEntry:updateThresholds",
-                 ' ' << state << " no change lookups remaining, clearing thresholds");
-        m_lowThreshold.reset();
-        m_highThreshold.reset();
+                 ' ' << state << " lookup not registered, ignoring");
+        return;
       }
+      if (!indexLookup(lkup))
+        m_lookups.push_back(lkup);
+      refreshThresholds(state);
     }
 
     virtual CachedValue const *cachedValue() const
@@ -173,6 +149,17 @@ namespace PLEXIL
       return m_value.get();
     }
 
+    virtual LookupHandler *getLookupHandler(unsigned int generation) const
+    {
+      return generation == m_lookupHandlerGeneration ? m_lookupHandler : nullptr;
+    }
+
+    virtual void setLookupHandler(LookupHandler *handler, unsigned int generation)
+    {
+      m_lookupHandler = handler;
+      m_lookupHandlerGeneration = generation;
+    }
+
     //! Update with the given value and timestamp.
     //! @param val The new value.
     //! @param timestamp The cycle count at the time of update.
@@ -337,12 +324,113 @@ namespace PLEXIL
     // Internal functions
     //
 
+    //! Notify the lookups which may care about the new value.
+    //! Lookups without active thresholds are always notified.
+    //! Change lookups are only notified if the value is unknown,
+    //! or is outside the bounds they last reported.
     void notify() const
     {
-      for (Lookup *lkup : m_lookups)
+      // Snapshot the recipients first, as notified change lookups
+      // will usually move themselves in the index.
+      std::vector<Lookup *> recipients(m_lookups);
+
+      Real val;
+      if (m_indexed.empty()) {
+        // nothing more to do
+      }
+      else if (m_value->getValue(val)) {
+        // Same guard band as LookupOnChange uses on Real thresholds
+        Real epsilon = fabs(val) * 1e-13;
+        Real highLimit = val + epsilon;
+        Real lowLimit = val - epsilon;
+        for (ThresholdIndex::const_iterator it = m_highIndex.begin();
+             it != m_highIndex.end() && it->first <= highLimit;
+             ++it)
+          recipients.push_back(it->second);
+        for (ThresholdIndex::const_reverse_iterator it = m_lowIndex.rbegin();
+             it != m_lowIndex.rend() && it->first >= lowLimit;
+             ++it) {
+          // Skip lookups already collected from the high index
+          if (m_indexed.find(it->second)->second.high->first > highLimit)
+            recipients.push_back(it->second);
+        }
+        debugMsg("StateCacheEntry:notify",
+                 ' ' << recipients.size() - m_lookups.size() << " of "
+                 << m_indexed.size() << " change lookups crossed thresholds");
+      }
+      else {
+        // Unknown or non-numeric, every change lookup must see it
+        for (ThresholdIndex::value_type const &entry : m_highIndex)
+          recipients.push_back(entry.second);
+      }
+
+      for (Lookup *lkup : recipients)
         lkup->valueChanged();
     }
 
+    //! If the lookup reports active thresholds, add it to the
+    //! threshold index and return true. Otherwise return false.
+    bool indexLookup(Lookup *lkup)
+    {
+      if (!m_value)
+        return false;
+
+      Real low, high;
+      switch (m_value->valueType()) {
+      case INTEGER_TYPE: {
+        Integer ilow, ihigh;
+        if (!lkup->getThresholds(ihigh, ilow))
+          return false;
+        low = ilow;
+        high = ihigh;
+        break;
+      }
+
+        // FIXME: support non-Real date/duration types
+      case DATE_TYPE:
+      case DURATION_TYPE:
+
+      case REAL_TYPE:
+        if (!lkup->getThresholds(high, low))
+          return false;
+        break;
+
+      default:
+        return false;
+      }
+
+      IndexEntry &entry = m_indexed[lkup];
+      entry.low = m_lowIndex.insert(ThresholdIndex::value_type(low, lkup));
+      entry.high = m_highIndex.insert(ThresholdIndex::value_type(high, lkup));
+      return true;
+    }
+
+    //! Remove the lookup from the threshold index.
+    //! @return True if it was indexed, false otherwise.
+    bool unindexLookup(Lookup *lkup)
+    {
+      IndexMap::iterator it = m_indexed.find(lkup);
+      if (it == m_indexed.end())
+        return false;
+      m_lowIndex.erase(it->second.low);
+      m_highIndex.erase(it->second.high);
+      m_indexed.erase(it);
+      return true;
+    }
+
+    //! Remove the lookup from the list of unindexed lookups.
+    //! @return True if it was found, false otherwise.
+    bool removeUnindexed(Lookup *lkup)
+    {
+      // Most likely to be the most recently registered, so search from the back.
+      std::vector<Lookup *>::reverse_iterator it =
+        std::find(m_lookups.rbegin(), m_lookups.rend(), lkup);
+      if (it == m_lookups.rend())
+        return false;
+      m_lookups.erase(std::next(it).base());
+      return true;
+    }
+
     //! If there is no cached value or it is a placeholder VoidCachedValue,
     //! construct the appropriate CachedValue instance and return true.
     //! If there is a CachedValue, and it's of a compatible type, return true.
@@ -381,28 +469,30 @@ namespace PLEXIL
       return false;
     }
 
-    bool integerUpdateThresholds(State const &state)
-    {
-      bool hasThresholds = false;
-      Integer ihi, ilo;
-      Integer newihi, newilo;
-      for (Lookup *l : m_lookups) {
-        if (l->getThresholds(newihi, newilo)) {
-          if (hasThresholds) {
-            if (newilo > ilo)
-              ilo = newilo;
-            if (newihi < ihi)
-              ihi = newihi;
-          }
-          else {
-            hasThresholds = true;
-            ilo = newilo;
-            ihi = newihi;
-          }
+    //! Recompute the entry's thresholds from the index, and tell the
+    //! interface about them. The effective thresholds are the tightest
+    //! of all the change lookups' thresholds.
+    void refreshThresholds(State const &state)
+    {
+      if (m_indexed.empty()) {
+        if (m_lowThreshold) {
+          debugMsg("StateCacheEntry:updateThresholds",
+                   ' ' << state << " no change lookups remaining, clearing thresholds");
+          g_dispatcher->clearThresholds(state);
+          m_lowThreshold.reset();
+          m_highThreshold.reset();
         }
+        return;
       }
+
+      Real rlo = m_lowIndex.rbegin()->first;
+      Real rhi = m_highIndex.begin()->first;
       unsigned int timestamp = StateCache::instance().getCycleCount();
-      if (hasThresholds) {
+      ValueType vtype = m_value->valueType();
+      switch (vtype) {
+      case INTEGER_TYPE: {
+        Integer ilo = (Integer) rlo;
+        Integer ihi = (Integer) rhi;
         debugMsg("StateCacheEntry:updateThresholds",
                  ' ' << state << " resetting thresholds " << ilo << ", " << ihi);
         if (!m_lowThreshold) {
@@ -412,38 +502,14 @@ namespace PLEXIL
         m_lowThreshold->update(timestamp, ilo);
         m_highThreshold->update(timestamp, ihi);
         g_dispatcher->setThresholds(state, ihi, ilo);
+        break;
       }
-      else if (m_lowThreshold) {
-        // Had thresholds, but they're no longer in effect
-        m_lowThreshold->setUnknown(timestamp);
-        m_highThreshold->setUnknown(timestamp);
-        g_dispatcher->clearThresholds(state);
-      }
-      return hasThresholds;
-    }
-
-    bool realUpdateThresholds(State const &state)
-    {
-      bool hasThresholds = false;
-      Real rhi, rlo;
-      Real newrhi, newrlo;
-      for (Lookup *l : m_lookups) {
-        if (l->getThresholds(newrhi, newrlo)) {
-          if (hasThresholds) {
-            if (newrlo > rlo)
-              rlo = newrlo;
-            if (newrhi < rhi)
-              rhi = newrhi;
-          }
-          else {
-            hasThresholds = true;
-            rlo = newrlo;
-            rhi = newrhi;
-          }
-        }
-      }
-      unsigned int timestamp = StateCache::instance().getCycleCount();
-      if (hasThresholds) {
+
+        // FIXME: support non-Real date/duration types
+      case DATE_TYPE:
+      case DURATION_TYPE:
+
+      case REAL_TYPE:
         debugMsg("StateCacheEntry:updateThresholds",
                  ' ' << state << " setting thresholds " << rlo << ", " << rhi);
         if (!m_lowThreshold) {
@@ -453,24 +519,41 @@ namespace PLEXIL
         m_lowThreshold->update(timestamp, rlo);
         m_highThreshold->update(timestamp, rhi);
         g_dispatcher->setThresholds(state, rhi, rlo);
+        break;
+
+      default:
+        // this is a plan error
+        warn("LookupOnChange: lookup value of type " << valueTypeName(vtype)
+             << " does not allow a tolerance");
+        break;
       }
-      else if (m_lowThreshold) {
-        // Had thresholds, but they're no longer in effect
-        m_lowThreshold->setUnknown(timestamp);
-        m_highThreshold->setUnknown(timestamp);
-        g_dispatcher->clearThresholds(state);
-      }
-      return hasThresholds;
     }
 
     //
     // Member variables
     //
 
-    std::vector<Lookup *> m_lookups;
+    //! Threshold value -> change lookup.
+    using ThresholdIndex = std::multimap<Real, Lookup *>;
+
+    //! A change lookup's positions in the threshold indices.
+    struct IndexEntry
+    {
+      ThresholdIndex::iterator low;
+      ThresholdIndex::iterator high;
+    };
+
+    using IndexMap = std::map<Lookup *, IndexEntry>;
+
+    std::vector<Lookup *> m_lookups; // lookups without active thresholds
+    ThresholdIndex m_lowIndex;       // change lookups by low threshold
+    ThresholdIndex m_highIndex;      // change lookups by high threshold
+    IndexMap m_indexed;              // change lookups with active thresholds
     CachedValuePtr m_value;
     CachedValuePtr m_lowThreshold;
     CachedValuePtr m_highThreshold;
+    LookupHandler *m_lookupHandler; // cached by the Dispatcher
+    unsigned int m_lookupHandlerGeneration; // of the Dispatcher's registrations
   };
 
   std::unique_ptr<StateCacheEntry> makeStateCacheEntry()
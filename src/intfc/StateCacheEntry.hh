@@ -63,7 +63,12 @@ namespace PLEXIL
     // API to Lookup
     virtual void registerLookup(State const &s, Lookup *l) = 0;
     virtual void unregisterLookup(State const &s, Lookup *l) = 0;
-    virtual void updateThresholds(State const &s) = 0;
+
+    //! Tell the entry that the thresholds of a registered lookup
+    //! have been set, changed, or removed.
+    //! @param s The state.
+    //! @param l The lookup whose thresholds changed.
+    virtual void updateThresholds(State const &s, Lookup *l) = 0;
 
     // Read access to the actual value is through the helper object.
     // Only Lookup and StateCache should use this member function.
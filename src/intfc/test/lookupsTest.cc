@@ -761,6 +761,69 @@ static bool testThresholdUpdate()
   return true;
 }
 
+// Check that change lookups see the state become unknown and known again,
+// even when the new value lies within the old thresholds.
+static bool testThresholdUnknown()
+{
+  StringVariable unknownTest;
+  unknownTest.setInitializer(new StringConstant("unknownTest"), true);
+  RealVariable watchVar;
+  watchVar.setInitializer(new RealConstant(0.0), true);
+  watchVar.activate();
+  theInterface->watch("unknownTest", &watchVar);
+
+  RealVariable tolerance;
+  tolerance.setInitializer(new RealConstant(1.0), true);
+  Real temp, hi, lo;
+
+  LookupPtr l1(dynamic_cast<Lookup *>(makeLookupOnChange(&unknownTest, false, UNKNOWN_TYPE,
+                                                         &tolerance, false, nullptr)));
+  bool l1Notified = false;
+  TrivialListener l1Listener(l1Notified);
+  l1->addListener(&l1Listener);
+
+  // Bump the cycle count
+  StateCache::instance().incrementCycleCount();
+
+  l1->activate();
+  assertTrue_1(l1->getValue(temp));
+  assertTrue_1(temp == 0.0);
+  assertTrue_1(theInterface->getThresholds("unknownTest", hi, lo));
+  assertTrue_1(hi == 1.0);
+  assertTrue_1(lo == -1.0);
+
+  l1Notified = false;
+  watchVar.setUnknown();
+
+  // Bump the cycle count
+  StateCache::instance().incrementCycleCount();
+
+  assertTrue_1(l1Notified);
+  assertTrue_1(!l1->isKnown());
+  // Stale thresholds should no longer be in effect
+  assertTrue_1(!theInterface->getThresholds("unknownTest", hi, lo));
+
+  l1Notified = false;
+  watchVar.setValue(0.5);
+
+  // Bump the cycle count
+  StateCache::instance().incrementCycleCount();
+
+  assertTrue_1(l1Notified);
+  assertTrue_1(l1->getValue(temp));
+  assertTrue_1(temp == 0.5);
+  assertTrue_1(theInterface->getThresholds("unknownTest", hi, lo));
+  assertTrue_1(hi == 1.5);
+  assertTrue_1(lo == -0.5);
+
+  l1->deactivate();
+  l1->removeListener(&l1Listener);
+
+  theInterface->unwatch("unknownTest", &watchVar);
+
+  return true;
+}
+
 bool lookupsTest()
 {
   TestInterface foo;
@@ -770,6 +833,7 @@ bool lookupsTest()
   runTest(testLookupNow);
   runTest(testLookupOnChange);
   runTest(testThresholdUpdate);
+  runTest(testThresholdUnknown);
   g_dispatcher = nullptr;
   return true;
 }
@@ -153,11 +153,14 @@ int main(int argc, char ** /* argv */)
   HAVE_GOOD_STDINT_H)
 
 # POSIX headers
+CHECK_INCLUDE_FILE(dirent.h HAVE_DIRENT_H)
 CHECK_INCLUDE_FILE(dlfcn.h HAVE_DLFCN_H)
 CHECK_INCLUDE_FILE(fcntl.h HAVE_FCNTL_H)
 CHECK_INCLUDE_FILE(pthread.h HAVE_PTHREAD_H)
 CHECK_INCLUDE_FILE(semaphore.h HAVE_SEMAPHORE_H)
 CHECK_INCLUDE_FILE(unistd.h HAVE_UNISTD_H)
+CHECK_INCLUDE_FILE(sys/mman.h HAVE_SYS_MMAN_H)
+CHECK_INCLUDE_FILE(sys/stat.h HAVE_SYS_STAT_H)
 CHECK_INCLUDE_FILE(sys/time.h HAVE_SYS_TIME_H)
 
 # Networking
@@ -166,6 +169,8 @@ CHECK_INCLUDE_FILE(poll.h HAVE_POLL_H)
 CHECK_INCLUDE_FILE(arpa/inet.h HAVE_ARPA_INET_H)
 CHECK_INCLUDE_FILE(netinet/in.h HAVE_NETINET_IN_H)
 CHECK_INCLUDE_FILE(sys/socket.h HAVE_SYS_SOCKET_H)
+CHECK_INCLUDE_FILE(sys/epoll.h HAVE_SYS_EPOLL_H)
+CHECK_INCLUDE_FILE(sys/un.h HAVE_SYS_UN_H)
 
 # glibc backtrace functionality
 CHECK_INCLUDE_FILE(execinfo.h HAVE_EXECINFO_H)
@@ -194,6 +199,7 @@ CHECK_FUNCTION_EXISTS(getitimer HAVE_GETITIMER) # StandAloneSimulator
 CHECK_FUNCTION_EXISTS(gettimeofday HAVE_GETTIMEOFDAY) # various
 CHECK_FUNCTION_EXISTS(localtime_r HAVE_LOCALTIME_R) # utils/test/jni-adapter.cc only
 CHECK_FUNCTION_EXISTS(setitimer HAVE_SETITIMER) # ItimerTimebase, StandAloneSimulator
+CHECK_FUNCTION_EXISTS(sigtimedwait HAVE_SIGTIMEDWAIT) # StandAloneSimulator
 #CHECK_CXX_SYMBOL_EXISTS(timer_create "ctime;time.h" HAVE_TIMER_CREATE)
 
 #
@@ -219,8 +225,19 @@ int main(int argc, char ** /* argv */)
   HAVE_TIMER_CREATE)
 unset(CMAKE_REQUIRED_LIBRARIES)
 
+# Shared memory, used by IpcUtils
+set(CMAKE_REQUIRED_LIBRARIES "rt")
+CHECK_FUNCTION_EXISTS(shm_open HAVE_SHM_OPEN)
+unset(CMAKE_REQUIRED_LIBRARIES)
+set(CMAKE_REQUIRED_LIBRARIES "pthread")
+CHECK_FUNCTION_EXISTS(pthread_mutex_consistent HAVE_PTHREAD_MUTEX_CONSISTENT)
+unset(CMAKE_REQUIRED_LIBRARIES)
+CHECK_FUNCTION_EXISTS(flock HAVE_FLOCK)
+
 # Other POSIX specifics
 CHECK_FUNCTION_EXISTS(gethostbyname HAVE_GETHOSTBYNAME) # UdpAdapter, IPC
+CHECK_FUNCTION_EXISTS(recvmmsg HAVE_RECVMMSG) # UdpAdapter
+CHECK_FUNCTION_EXISTS(sendmmsg HAVE_SENDMMSG) # UdpAdapter
 CHECK_FUNCTION_EXISTS(getpid HAVE_GETPID) # Logging, ExecApplication
 CHECK_FUNCTION_EXISTS(isatty HAVE_ISATTY) # utils/Logging.cc only
 
@@ -30,6 +30,8 @@
 #include "InterfaceManager.hh"
 #include "InterfaceSchema.hh"
 #include "lifecycle-utils.h"
+#include "PlanCheckCache.hh"
+#include "planLibrary.hh"
 #include "PlexilExec.hh"
 #include "ResourceArbiterInterface.hh"
 
@@ -37,10 +39,22 @@
 #include "LuvListener.hh"
 #endif
 
+#if defined(PLEXIL_WITH_THREADS) && !defined(NO_DEBUG_MESSAGE_SUPPORT)
+#define HAVE_DEBUG_CONTROL 1
+#include "DebugControl.hh"
+#include "Notifier.hh"
+#endif
+
 #include "pugixml.hpp"
 
 #include <fstream>
 
+#if defined(HAVE_CSTDLIB)
+#include <cstdlib> // strtoul()
+#elif defined(HAVE_STDLIB_H)
+#include <stdlib.h> // strtoul()
+#endif
+
 #if defined(HAVE_CSTRING)
 #include <cstring>
 #elif defined(HAVE_STRING_H)
@@ -49,6 +63,53 @@
 
 using namespace PLEXIL;
 
+#ifdef HAVE_DEBUG_CONTROL
+
+//! Handles the "stats" debug control command:
+//!   stats on|off|reset   Control counting of change notifications
+//!   stats [<count>]      Report expression statistics
+class StatsCommand final
+{
+public:
+  StatsCommand(ExecApplication *app)
+  {
+    registerDebugControlCommand("stats",
+                                [app](std::string const &arg, std::ostream &reply) -> bool
+                                { return execute(app, arg, reply); });
+  }
+
+  ~StatsCommand()
+  {
+    registerDebugControlCommand("stats", DebugControlCommandFn());
+  }
+
+private:
+  static bool execute(ExecApplication *app, std::string const &arg, std::ostream &reply)
+  {
+    if (arg == "on")
+      Notifier::setNotificationCounting(true);
+    else if (arg == "off")
+      Notifier::setNotificationCounting(false);
+    else if (arg == "reset")
+      Notifier::resetNotificationCounts();
+    else {
+      unsigned long topCount = 10;
+      if (!arg.empty()) {
+        char *end = nullptr;
+        topCount = strtoul(arg.c_str(), &end, 10);
+        if (*end) {
+          reply << "ERROR stats requires on, off, reset, or a count\n";
+          return false;
+        }
+      }
+      app->reportExpressionStatistics(reply, topCount);
+    }
+    return true;
+  }
+};
+
+#endif // HAVE_DEBUG_CONTROL
+
 int main_internal(int argc, char** argv)
 {
   unsigned int const PUGI_PARSE_OPTIONS = pugi::parse_default | pugi::parse_ws_pcdata_single;
@@ -58,14 +119,29 @@ int main_internal(int argc, char** argv)
   std::string resourceFile("resource.data");
   std::vector<std::string> libraryNames;
   std::vector<std::string> libraryPath;
+  std::string recordFile;
+  std::string replayFile;
   std::string
       usage(
           "Usage: universalExec -p <plan>\n\
                     [-l <library_file>]*         (no default)\n\
                     [-L <library_directory>]*    (default .)\n\
+                    [-C <check_cache_directory>] (cache library check results, default none)\n\
                     [-c <interface_config_file>] (default ./interface-config.xml)\n\
                     [-d <debug_config_file>]     (default ./Debug.cfg)\n\
-                    [+d]                         (disable debug messages)\n");
+                    [+d]                         (disable debug messages)\n\
+                    [-B]                         (write debug messages from a background thread)\n\
+                    [-j <threads>]               (condition evaluation threads, default 1)\n\
+                    [-g]                         (group transitions by node type)\n\
+                    [-x]                         (expand library calls when first executed)\n\
+                    [-X]                         (as -x, and release them when reset)\n\
+                    [-record <recording_file>]   (record the inputs to the exec)\n\
+                    [-replay <recording_file>]   (replay recorded inputs instead of using the interfaces)\n");
+
+#ifdef HAVE_DEBUG_CONTROL
+  std::string debugControlPath;
+  usage += "                    [-D <socket_path>]           (accept debug control and stats commands on a local socket)\n";
+#endif
 
 #ifdef HAVE_LUV_LISTENER
   std::string luvHost = LUV_DEFAULT_HOSTNAME;
@@ -77,8 +153,11 @@ int main_internal(int argc, char** argv)
   bool luvRequest = false;
   bool debugConfigSupplied = false;
   bool useDebugConfig = true;
+  bool bufferDebugOutput = false;
   bool resourceFileSupplied = false;
   bool useResourceFile = true;
+  unsigned long evaluationThreads = 1;
+  bool groupTransitions = false;
 
   // if not enough parameters, print usage
   if (argc < 2) {
@@ -96,6 +175,14 @@ int main_internal(int argc, char** argv)
 	  }
       interfaceConfig = std::string(argv[i]);
 	}
+    else if (strcmp(argv[i], "-C") == 0) {
+      if (argc == (++i)) {
+        std::cerr << "Error: Missing argument to the " << argv[i - 1] << " option.\n"
+                  << usage << std::endl;
+        return 2;
+      }
+      setPlanCheckCacheDirectory(argv[i]);
+    }
     else if (strcmp(argv[i], "-d") == 0) {
       if (!useDebugConfig) {
         warn("Both -d and +d options specified.\n"
@@ -125,6 +212,55 @@ int main_internal(int argc, char** argv)
       debugConfig.clear();
       useDebugConfig = false;
     }
+    else if (strcmp(argv[i], "-B") == 0)
+      bufferDebugOutput = true;
+#ifdef HAVE_DEBUG_CONTROL
+    else if (strcmp(argv[i], "-D") == 0) {
+      if (argc == (++i)) {
+        std::cerr << "Error: Missing argument to the " << argv[i - 1] << " option.\n"
+                  << usage << std::endl;
+        return 2;
+      }
+      debugControlPath = argv[i];
+    }
+#endif
+    else if (strcmp(argv[i], "-record") == 0
+             || strcmp(argv[i], "-replay") == 0) {
+      if (argc == (++i)) {
+        std::cerr << "Error: Missing argument to the " << argv[i - 1] << " option.\n"
+                  << usage << std::endl;
+        return 2;
+      }
+      if (strcmp(argv[i - 1], "-record") == 0)
+        recordFile = argv[i];
+      else
+        replayFile = argv[i];
+      if (!recordFile.empty() && !replayFile.empty()) {
+        warn("Both -record and -replay options specified.\n"
+             << usage);
+        return 2;
+      }
+    }
+    else if (strcmp(argv[i], "-j") == 0) {
+      if (argc == (++i)) {
+        std::cerr << "Error: Missing argument to the " << argv[i - 1] << " option.\n"
+                  << usage << std::endl;
+        return 2;
+      }
+      char *end = nullptr;
+      evaluationThreads = strtoul(argv[i], &end, 10);
+      if (*end || !evaluationThreads) {
+        std::cerr << "Error: Invalid thread count '" << argv[i] << "'.\n"
+                  << usage << std::endl;
+        return 2;
+      }
+    }
+    else if (strcmp(argv[i], "-g") == 0)
+      groupTransitions = true;
+    else if (strcmp(argv[i], "-x") == 0)
+      setLibraryExpansionMode(EXPAND_ON_EXECUTE);
+    else if (strcmp(argv[i], "-X") == 0)
+      setLibraryExpansionMode(EXPAND_ON_EXECUTE_AND_RELEASE);
     else if (strcmp(argv[i], "-l") == 0) {
 	  if (argc == (++i)) {
 		std::cerr << "Error: Missing argument to the " << argv[i - 1] << " option.\n" 
@@ -220,6 +356,16 @@ int main_internal(int argc, char** argv)
     if (dbgConfig.good()) 
       readDebugConfigStream(dbgConfig);
   }
+  if (bufferDebugOutput && !startBufferedDebugOutput()) {
+    std::cout << "WARNING: buffered debug output not available; continuing without it"
+              << std::endl;
+  }
+#ifdef HAVE_DEBUG_CONTROL
+  if (!debugControlPath.empty() && !startDebugControlListener(debugControlPath)) {
+    std::cout << "WARNING: unable to accept debug control commands on "
+              << debugControlPath << "; continuing without them" << std::endl;
+  }
+#endif
 
   // get interface configuration file, if provided
   pugi::xml_document configDoc;
@@ -271,6 +417,9 @@ int main_internal(int argc, char** argv)
 
   // construct the application
   std::unique_ptr<PLEXIL::ExecApplication> _app(makeExecApplication());
+#ifdef HAVE_DEBUG_CONTROL
+  StatsCommand statsCommand(_app.get());
+#endif
 
 #ifdef HAVE_LUV_LISTENER
   // Construct interface to the PLEXIL Viewer if requested on the command line
@@ -286,6 +435,24 @@ int main_internal(int argc, char** argv)
   if (useResourceFile) {
     _app->exec()->getArbiter()->readResourceHierarchyFile(resourceFile);
   }
+  if (evaluationThreads > 1
+      && !_app->exec()->setConditionEvaluationThreads(evaluationThreads)) {
+    std::cout << "WARNING: parallel condition evaluation not available; continuing with 1 thread"
+              << std::endl;
+  }
+  _app->exec()->setTransitionBatching(groupTransitions);
+
+  if (!recordFile.empty() && !_app->recordInputs(recordFile)) {
+    std::cout << "ERROR: unable to record to " << recordFile << std::endl;
+    return 1;
+  }
+  if (!replayFile.empty()) {
+    if (!_app->replayInputs(replayFile)) {
+      std::cout << "ERROR: unable to replay " << replayFile << std::endl;
+      return 1;
+    }
+    std::cout << "Replaying inputs from " << replayFile << std::endl;
+  }
 
   if (!_app->initialize(configElt)) {
       std::cout << "ERROR: unable to initialize application"
@@ -351,6 +518,10 @@ int main_internal(int argc, char** argv)
       _app->notifyAndWaitForCompletion();
       // ... then wait for it to finish.
       _app->waitForPlanFinished();
+      if (_app->replayFailed()) {
+        std::cout << "ERROR: replay of " << replayFile << " failed" << std::endl;
+        error = true;
+      }
     }
     // clean up
     _app->stop();
@@ -73,6 +73,15 @@ inline bool readDebugConfigStream(std::istream & /* is */)
   return true;
 }
 
+inline bool startBufferedDebugOutput()
+{
+  return false;
+}
+
+inline void stopBufferedDebugOutput()
+{
+}
+
 }
 
 #else
@@ -106,6 +115,11 @@ inline bool readDebugConfigStream(std::istream & /* is */)
   output to the debug stream returned by DebugMessage::getStream()
   when this debug message is enabled (via, e.g. DebugMessage::enable()
   or DebugMessage::enableAll()).
+  @note When buffered debug output is active, the message is queued
+  for a background thread to write, instead of being written and
+  flushed immediately.
+  @note With threads, each message is written whole, so messages
+  from different threads are not interleaved.
   @see condDebugMsg
   @see debugStmt
   @see condDebugStmt
@@ -129,7 +143,8 @@ inline bool readDebugConfigStream(std::istream & /* is */)
 #define condDebugMsg(cond, marker, data) { \
   static PLEXIL::DebugMessage debug_msg(marker);     \
   if (debug_msg.enabled && (cond)) { \
-    PLEXIL::getDebugOutputStream() << "[" << marker << "]" << data << std::endl; \
+    PLEXIL::beginDebugMessage() << "[" << marker << "]" << data; \
+    PLEXIL::endDebugMessage(); \
   } \
 }
 
@@ -0,0 +1,176 @@
+/* Copyright (c) 2006-2021, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "plexil-config.h"
+
+#include "DebugControl.hh"
+
+#include "DebugMessage.hh"
+#include "Error.hh"
+#include "LocalSocketServer.hh"
+#include "lifecycle-utils.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+
+namespace PLEXIL
+{
+
+  //! Application-defined commands.
+  static std::map<std::string, DebugControlCommandFn> s_commands;
+  static std::mutex s_commandsLock;
+
+  void registerDebugControlCommand(std::string const &verb,
+                                   DebugControlCommandFn fn)
+  {
+    std::lock_guard<std::mutex> guard(s_commandsLock);
+    if (fn)
+      s_commands[verb] = std::move(fn);
+    else
+      s_commands.erase(verb);
+  }
+
+  bool executeDebugControlCommand(std::string const &command, std::ostream &reply)
+  {
+    static char const *sl_whitespace = " \t\r";
+
+    std::string::size_type left = command.find_first_not_of(sl_whitespace);
+    if (left == std::string::npos) {
+      reply << "ERROR empty command\n";
+      return false;
+    }
+    std::string::size_type verbEnd = command.find_first_of(sl_whitespace, left);
+    std::string verb = command.substr(left, verbEnd - left);
+    std::string arg;
+    if (verbEnd != std::string::npos) {
+      std::string::size_type argStart = command.find_first_not_of(sl_whitespace, verbEnd);
+      if (argStart != std::string::npos) {
+        std::string::size_type argEnd = command.find_last_not_of(sl_whitespace);
+        arg = command.substr(argStart, argEnd + 1 - argStart);
+      }
+    }
+
+    if (verb == "enable" || verb == "disable") {
+      if (arg.empty()) {
+        reply << "ERROR " << verb << " requires a pattern\n";
+        return false;
+      }
+      if (verb == "enable")
+        enableMatchingDebugMessages(std::string(arg));
+      else
+        disableMatchingDebugMessages(arg);
+    }
+    else if (verb == "list") {
+      printDebugPatterns(reply);
+    }
+    else if (verb == "buffer") {
+      if (arg == "on") {
+        if (!startBufferedDebugOutput()) {
+          reply << "ERROR buffered output not supported\n";
+          return false;
+        }
+      }
+      else if (arg == "off")
+        stopBufferedDebugOutput();
+      else {
+        reply << "ERROR buffer requires on or off\n";
+        return false;
+      }
+    }
+    else {
+      // Hold the lock across the call, so that a handler can't be
+      // called after it has been unregistered
+      std::lock_guard<std::mutex> guard(s_commandsLock);
+      std::map<std::string, DebugControlCommandFn>::const_iterator it =
+        s_commands.find(verb);
+      if (it == s_commands.end()) {
+        reply << "ERROR unknown command " << verb << '\n';
+        return false;
+      }
+      if (!it->second(arg, reply))
+        return false;
+    }
+    reply << "OK\n";
+    return true;
+  }
+
+  //! Longest command line accepted from a client.
+  static constexpr size_t MAX_COMMAND_LENGTH = 4096;
+
+  // Execute commands from the client until it disconnects, or sends
+  // a line too long to be a command.
+  static void serveDebugControlClient(LocalSocketClient &client)
+  {
+    std::string pending;
+    while (client.read(pending) == LocalSocketClient::READ_OK) {
+      std::string::size_type eol;
+      while ((eol = pending.find('\n')) != std::string::npos) {
+        std::ostringstream reply;
+        executeDebugControlCommand(pending.substr(0, eol), reply);
+        pending.erase(0, eol + 1);
+        if (!client.send(reply.str()))
+          return;
+      }
+      if (pending.size() > MAX_COMMAND_LENGTH) {
+        client.send("ERROR command too long\n");
+        return;
+      }
+    }
+  }
+
+  static std::unique_ptr<LocalSocketServer> s_listener;
+  static std::mutex s_listenerLock;
+
+  bool startDebugControlListener(std::string const &path)
+  {
+    std::lock_guard<std::mutex> guard(s_listenerLock);
+    if (s_listener) {
+      warn("Debug control listener already running");
+      return false;
+    }
+    // Clients are interactive, so have no time limit
+    s_listener.reset(makeLocalSocketServer(path, "Debug control",
+                                           std::chrono::milliseconds::zero(),
+                                           &serveDebugControlClient));
+    if (!s_listener)
+      return false;
+    static bool sl_finalizerAdded = false;
+    if (!sl_finalizerAdded) {
+      plexilAddFinalizer(&stopDebugControlListener);
+      sl_finalizerAdded = true;
+    }
+    return true;
+  }
+
+  void stopDebugControlListener()
+  {
+    std::lock_guard<std::mutex> guard(s_listenerLock);
+    s_listener.reset();
+  }
+
+} // namespace PLEXIL
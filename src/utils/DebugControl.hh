@@ -0,0 +1,84 @@
+/* Copyright (c) 2006-2021, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef PLEXIL_DEBUG_CONTROL_HH
+#define PLEXIL_DEBUG_CONTROL_HH
+
+#include <functional>
+#include <iosfwd>
+#include <string>
+
+namespace PLEXIL
+{
+
+  //
+  // Run time control of debug messages.
+  //
+  // Commands are single lines of text:
+  //   enable <pattern>    Enable messages whose markers contain the pattern
+  //   disable <pattern>   Disable messages whose markers contain the pattern
+  //   list                List the patterns currently in effect
+  //   buffer on|off       Start or stop buffered debug output
+  // plus any commands registered by the application.
+  //
+
+  //! Handler for an application-defined command.
+  //! @param arg The rest of the command line after the verb, trimmed.
+  //! @param reply Stream to which the reply is written.
+  //! @return True if the command was valid, false otherwise.
+  using DebugControlCommandFn =
+    std::function<bool(std::string const &arg, std::ostream &reply)>;
+
+  //! Register a handler for a command verb.
+  //! @param verb The command verb.
+  //! @param fn The handler; an empty function removes the verb.
+  //! @note The handler may be called from the listener thread.
+  //! @note Handlers are called with the command table locked. Once
+  //!       this returns, the handler it replaced is no longer running
+  //!       and won't be called again. Handlers must not call it.
+  extern void registerDebugControlCommand(std::string const &verb,
+                                          DebugControlCommandFn fn);
+
+  //! Execute one debug control command.
+  //! @param command The command line, without its line terminator.
+  //! @param reply Stream to which the reply is written.
+  //! @return True if the command was valid, false otherwise.
+  extern bool executeDebugControlCommand(std::string const &command, std::ostream &reply);
+
+  //! Start a thread accepting debug control commands on a local
+  //! (Unix domain) stream socket at the given path.
+  //! @param path The socket's path in the file system.
+  //! @return True if listening, false otherwise.
+  //! @note A socket left at the path by a listener which has exited
+  //!       is replaced. Fails if anything else is at the path.
+  extern bool startDebugControlListener(std::string const &path);
+
+  //! Stop the listener thread, if running, and remove its socket.
+  extern void stopDebugControlListener();
+
+} // namespace PLEXIL
+
+#endif // PLEXIL_DEBUG_CONTROL_HH
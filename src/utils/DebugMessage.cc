@@ -27,12 +27,22 @@
 #include "DebugMessage.hh"
 
 #include "Error.hh"
+#include "lifecycle-utils.h"
 
 #include "plexil-config.h"
 
+#include <algorithm> // std::remove
 #include <iostream>
+#include <streambuf>
 #include <vector>
 
+#ifdef PLEXIL_WITH_THREADS
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
 #if defined(HAVE_CSTRING)
 #include <cstring> // strstr()
 #elif defined(HAVE_STRING_H)
@@ -51,11 +61,21 @@ namespace PLEXIL
 
   static DebugMessage *allDebugMessages = nullptr;
 
+#ifdef PLEXIL_WITH_THREADS
+  //! Debug messages may be first reached by several threads at once.
+  static std::mutex s_debugMessagesLock;
+#endif
+
   DebugMessage::DebugMessage(char const *mrkr)
     : marker(mrkr),
-      next(allDebugMessages),
-      enabled(matchesPatterns(marker))
+      next(nullptr),
+      enabled(false)
   {
+#ifdef PLEXIL_WITH_THREADS
+    std::lock_guard<std::mutex> guard(s_debugMessagesLock);
+#endif
+    enabled = matchesPatterns(marker);
+    next = allDebugMessages;
     allDebugMessages = this;
   }
 
@@ -127,6 +147,9 @@ namespace PLEXIL
 
   void enableMatchingDebugMessages(std::string &&pattern)
   {
+#ifdef PLEXIL_WITH_THREADS
+    std::lock_guard<std::mutex> guard(s_debugMessagesLock);
+#endif
     // Enable any existing messages that match
     for (DebugMessage *m = allDebugMessages; m != nullptr; m = m->next)
       if (!m->enabled
@@ -137,6 +160,36 @@ namespace PLEXIL
     allDebugPatterns.push_back(std::move(pattern));
   }
 
+  // Messages matching the pattern are disabled even if another pattern
+  // still matches them. Messages constructed later are enabled only if
+  // one of the remaining patterns matches.
+  void disableMatchingDebugMessages(std::string const &pattern)
+  {
+#ifdef PLEXIL_WITH_THREADS
+    std::lock_guard<std::mutex> guard(s_debugMessagesLock);
+#endif
+    for (DebugMessage *m = allDebugMessages; m != nullptr; m = m->next)
+      if (m->enabled
+          && markerMatches(m->marker, pattern))
+        m->enabled = false;
+
+    // Remove patterns which would re-enable them
+    allDebugPatterns.erase(std::remove_if(allDebugPatterns.begin(),
+                                          allDebugPatterns.end(),
+                                          [&pattern](std::string const &pat) -> bool
+                                          { return markerMatches(pat.c_str(), pattern); }),
+                           allDebugPatterns.end());
+  }
+
+  void printDebugPatterns(std::ostream &ostr)
+  {
+#ifdef PLEXIL_WITH_THREADS
+    std::lock_guard<std::mutex> guard(s_debugMessagesLock);
+#endif
+    for (std::string const &pat : allDebugPatterns)
+      ostr << pat << '\n';
+  }
+
   bool readDebugConfigStream(std::istream& istr)
   {
     static const char *sl_whitespace = " \f\n\r\t\v";
@@ -180,4 +233,342 @@ namespace PLEXIL
     return istr.eof();
   }
 
+  //
+  // Buffered output
+  //
+
+  //! Stream buffer which accumulates one message in a string,
+  //! so the string can be handed off without copying.
+  class DebugLineBuffer final : public std::streambuf
+  {
+  public:
+    DebugLineBuffer() = default;
+    ~DebugLineBuffer() = default;
+
+    std::string take()
+    {
+      std::string result(std::move(m_line));
+      m_line.clear();
+      return result;
+    }
+
+    void clear()
+    {
+      m_line.clear();
+    }
+
+  protected:
+    virtual int_type overflow(int_type c) override
+    {
+      if (!traits_type::eq_int_type(c, traits_type::eof()))
+        m_line.push_back(traits_type::to_char_type(c));
+      return traits_type::not_eof(c);
+    }
+
+    virtual std::streamsize xsputn(char const *s, std::streamsize n) override
+    {
+      m_line.append(s, n);
+      return n;
+    }
+
+  private:
+    std::string m_line;
+  };
+
+#ifdef PLEXIL_WITH_THREADS
+
+  //! Serializes writes of whole messages to the debug stream. Debug
+  //! messages may come from any thread, e.g. from node conditions
+  //! evaluated by the worker pool.
+  static std::mutex s_debugOutputLock;
+
+  //! A formatted message waiting to be written.
+  struct DebugRecord
+  {
+    DebugRecord()
+      : next(nullptr),
+        text()
+    {
+    }
+
+    std::atomic<DebugRecord *> next;
+    std::string text;
+  };
+
+  //! Multiple-producer, single-consumer queue of formatted messages.
+  //! Producers never block or take a lock; see D. Vyukov's
+  //! intrusive MPSC node-based queue.
+  class DebugRecordQueue final
+  {
+  public:
+    DebugRecordQueue()
+      : m_stub(),
+        m_head(&m_stub),
+        m_tail(&m_stub)
+    {
+    }
+
+    ~DebugRecordQueue()
+    {
+      while (DebugRecord *rec = pop())
+        delete rec;
+    }
+
+    // Any thread
+    void push(DebugRecord *rec)
+    {
+      rec->next.store(nullptr, std::memory_order_relaxed);
+      DebugRecord *prev = m_head.exchange(rec, std::memory_order_acq_rel);
+      prev->next.store(rec, std::memory_order_release);
+    }
+
+    // Consumer thread only. Returns null if empty (or if a push is in progress).
+    DebugRecord *pop()
+    {
+      DebugRecord *tail = m_tail;
+      DebugRecord *next = tail->next.load(std::memory_order_acquire);
+      if (tail == &m_stub) {
+        if (!next)
+          return nullptr;
+        m_tail = tail = next;
+        next = next->next.load(std::memory_order_acquire);
+      }
+      if (next) {
+        m_tail = next;
+        return tail;
+      }
+      if (tail != m_head.load(std::memory_order_acquire))
+        return nullptr; // push in progress, try again later
+      push(&m_stub);
+      next = tail->next.load(std::memory_order_acquire);
+      if (next) {
+        m_tail = next;
+        return tail;
+      }
+      return nullptr;
+    }
+
+    // Consumer thread only. True if nothing is queued, and no push
+    // is in progress.
+    bool empty() const
+    {
+      return m_tail == &m_stub && m_head.load(std::memory_order_acquire) == &m_stub;
+    }
+
+  private:
+    DebugRecordQueue(DebugRecordQueue const &) = delete;
+    DebugRecordQueue(DebugRecordQueue &&) = delete;
+    DebugRecordQueue &operator=(DebugRecordQueue const &) = delete;
+    DebugRecordQueue &operator=(DebugRecordQueue &&) = delete;
+
+    DebugRecord m_stub;
+    std::atomic<DebugRecord *> m_head; // most recently pushed
+    DebugRecord *m_tail;               // next to pop
+  };
+
+  //! Background thread which writes queued messages.
+  class DebugWriter final
+  {
+  public:
+    DebugWriter()
+      : m_queue(),
+        m_thread(),
+        m_mutex(),
+        m_cv(),
+        m_active(false),
+        m_stop(false)
+    {
+    }
+
+    ~DebugWriter()
+    {
+      stop();
+    }
+
+    bool isActive() const
+    {
+      return m_active.load(std::memory_order_acquire);
+    }
+
+    // Called with s_debugWriterLock held
+    void start()
+    {
+      if (m_thread.joinable())
+        return;
+      m_stop = false;
+      m_thread = std::thread([this]() -> void { run(); });
+      m_active.store(true, std::memory_order_release);
+    }
+
+    // Called with s_debugWriterLock held
+    void stop()
+    {
+      if (!m_thread.joinable())
+        return;
+      m_active.store(false, std::memory_order_release);
+      {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_stop = true;
+      }
+      m_cv.notify_one();
+      m_thread.join();
+      // A message may still be being linked in; wait for it
+      drain();
+      while (!m_queue.empty()) {
+        std::this_thread::yield();
+        drain();
+      }
+    }
+
+    // Any thread
+    void enqueue(std::string &&text)
+    {
+      DebugRecord *rec = new DebugRecord();
+      rec->text = std::move(text);
+      m_queue.push(rec);
+    }
+
+  private:
+    DebugWriter(DebugWriter const &) = delete;
+    DebugWriter(DebugWriter &&) = delete;
+    DebugWriter &operator=(DebugWriter const &) = delete;
+    DebugWriter &operator=(DebugWriter &&) = delete;
+
+    // Interval between writes. Messages are not written one at a time,
+    // and the stream is flushed once per pass.
+    static constexpr std::chrono::milliseconds WRITE_INTERVAL {10};
+
+    void run()
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      while (!m_stop) {
+        m_cv.wait_for(lock, WRITE_INTERVAL);
+        lock.unlock();
+        drain();
+        lock.lock();
+      }
+    }
+
+    void drain()
+    {
+      std::lock_guard<std::mutex> guard(s_debugOutputLock);
+      bool wrote = false;
+      while (DebugRecord *rec = m_queue.pop()) {
+        if (debugStream)
+          *debugStream << rec->text;
+        delete rec;
+        wrote = true;
+      }
+      if (wrote && debugStream)
+        debugStream->flush();
+    }
+
+    DebugRecordQueue m_queue;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::atomic<bool> m_active;
+    bool m_stop;
+  };
+
+  constexpr std::chrono::milliseconds DebugWriter::WRITE_INTERVAL;
+
+  // The writer is never deleted while the process runs, so a thread
+  // which raced with stopBufferedDebugOutput() can still queue its
+  // message safely; it is written when output is next started.
+  static DebugWriter &debugWriter()
+  {
+    static DebugWriter sl_writer;
+    return sl_writer;
+  }
+
+  //! Serializes starting and stopping the writer.
+  static std::mutex s_debugWriterLock;
+
+  bool startBufferedDebugOutput()
+  {
+    std::lock_guard<std::mutex> guard(s_debugWriterLock);
+    static bool sl_finalizerAdded = false;
+    if (!sl_finalizerAdded) {
+      plexilAddFinalizer(&stopBufferedDebugOutput);
+      sl_finalizerAdded = true;
+    }
+    ensureDebugInited();
+    debugWriter().start();
+    return true;
+  }
+
+  void stopBufferedDebugOutput()
+  {
+    std::lock_guard<std::mutex> guard(s_debugWriterLock);
+    debugWriter().stop();
+  }
+
+#else
+
+  bool startBufferedDebugOutput()
+  {
+    return false;
+  }
+
+  void stopBufferedDebugOutput()
+  {
+  }
+
+#endif // PLEXIL_WITH_THREADS
+
+#ifdef PLEXIL_WITH_THREADS
+
+  //! Per-thread message formatting state.
+  struct DebugLineStream
+  {
+    DebugLineStream()
+      : buffer(),
+        stream(&buffer)
+    {
+    }
+
+    DebugLineBuffer buffer;
+    std::ostream stream;
+  };
+
+  static thread_local DebugLineStream s_debugLine;
+
+  // Each message is formatted in the thread's own buffer and then
+  // written whole, so messages from different threads are never
+  // interleaved.
+  std::ostream &beginDebugMessage()
+  {
+    s_debugLine.buffer.clear();
+    return s_debugLine.stream;
+  }
+
+  void endDebugMessage()
+  {
+    s_debugLine.stream << '\n';
+    if (debugWriter().isActive()) {
+      debugWriter().enqueue(s_debugLine.buffer.take());
+      return;
+    }
+    std::string text(s_debugLine.buffer.take());
+    std::lock_guard<std::mutex> guard(s_debugOutputLock);
+    std::ostream &os = getDebugOutputStream();
+    os << text;
+    os.flush();
+  }
+
+#else
+
+  std::ostream &beginDebugMessage()
+  {
+    return getDebugOutputStream();
+  }
+
+  void endDebugMessage()
+  {
+    getDebugOutputStream() << std::endl;
+  }
+
+#endif // PLEXIL_WITH_THREADS
+
 } // namespace PLEXIL
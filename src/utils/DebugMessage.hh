@@ -27,6 +27,7 @@
 #ifndef PLEXIL_DEBUG_MESSAGE_HH
 #define PLEXIL_DEBUG_MESSAGE_HH
 
+#include <atomic>
 #include <iosfwd>
 #include <string>
 
@@ -34,10 +35,12 @@ namespace PLEXIL
 {
   // C++ sucks at information hiding.
   void enableMatchingDebugMessages(std::string &&pattern);
+  void disableMatchingDebugMessages(std::string const &pattern);
 
   struct DebugMessage final 
   {
     friend void enableMatchingDebugMessages(std::string &&);
+    friend void disableMatchingDebugMessages(std::string const &);
 
     /**
      * @brief Construct a DebugMessage.
@@ -63,8 +66,9 @@ namespace PLEXIL
   
     /**
        @brief Whether this instance is 'enabled' or not.
+       @note May be changed by another thread at run time.
     */
-    bool enabled;
+    std::atomic<bool> enabled;
 
   private:
 
@@ -83,6 +87,31 @@ namespace PLEXIL
 
   extern bool readDebugConfigStream(std::istream &is);
 
+  //! Write the patterns currently in effect to the stream, one per line.
+  extern void printDebugPatterns(std::ostream &os);
+
+  //
+  // Buffered output
+  //
+
+  //! Start a background thread which writes debug messages to the
+  //! debug output stream. Until stopped, debug messages are formatted
+  //! into a per-thread buffer and queued, rather than written and
+  //! flushed by the thread which generated them.
+  //! @return True if started, false if not supported.
+  extern bool startBufferedDebugOutput();
+
+  //! Write any queued debug messages and stop the background thread.
+  extern void stopBufferedDebugOutput();
+
+  //! Return the stream to which the next debug message should be written.
+  //! @note Only for use by the debugMsg() and condDebugMsg() macros.
+  extern std::ostream &beginDebugMessage();
+
+  //! Complete the debug message begun by beginDebugMessage().
+  //! @note Only for use by the debugMsg() and condDebugMsg() macros.
+  extern void endDebugMessage();
+
 } // namespace PLEXIL
 
 #endif // PLEXIL_DEBUG_MESSAGE_HH
@@ -0,0 +1,152 @@
+/* Copyright (c) 2006-2021, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "LatencyHistogram.hh"
+
+#include <cmath> // std::ceil()
+#include <limits>
+
+namespace PLEXIL
+{
+
+  LatencyHistogram::LatencyHistogram()
+    : m_count(0),
+      m_sum(0),
+      m_min(std::numeric_limits<uint64_t>::max()),
+      m_max(0)
+  {
+    for (std::atomic<uint64_t> &bucket : m_buckets)
+      bucket.store(0, std::memory_order_relaxed);
+  }
+
+  // Position of the most significant 1 bit; v must be nonzero.
+  static unsigned mostSignificantBit(uint64_t v)
+  {
+#if defined(__GNUC__)
+    return 63 - __builtin_clzll(v);
+#else
+    unsigned result = 0;
+    for (unsigned shift = 32; shift; shift >>= 1) {
+      if (v >> shift) {
+        v >>= shift;
+        result += shift;
+      }
+    }
+    return result;
+#endif
+  }
+
+  size_t LatencyHistogram::bucketIndex(uint64_t usec)
+  {
+    if (usec < EXACT_LIMIT)
+      return (size_t) usec;
+    unsigned msb = mostSignificantBit(usec);
+    if (msb >= MAX_VALUE_BITS)
+      return BUCKET_COUNT - 1;
+    unsigned shift = msb - SUB_BUCKET_BITS;
+    size_t sub = (size_t) (usec >> shift) & (SUB_BUCKET_COUNT - 1);
+    return EXACT_LIMIT + (msb - SUB_BUCKET_BITS - 1) * SUB_BUCKET_COUNT + sub;
+  }
+
+  uint64_t LatencyHistogram::bucketHighestValue(size_t idx)
+  {
+    if (idx < EXACT_LIMIT)
+      return idx;
+    size_t group = (idx - EXACT_LIMIT) / SUB_BUCKET_COUNT;
+    size_t sub = (idx - EXACT_LIMIT) % SUB_BUCKET_COUNT;
+    unsigned shift = (unsigned) group + 1;
+    return ((SUB_BUCKET_COUNT + sub + 1) << shift) - 1;
+  }
+
+  void LatencyHistogram::record(uint64_t usec)
+  {
+    m_buckets[bucketIndex(usec)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(usec, std::memory_order_relaxed);
+    uint64_t oldMin = m_min.load(std::memory_order_relaxed);
+    while (usec < oldMin
+           && !m_min.compare_exchange_weak(oldMin, usec, std::memory_order_relaxed))
+      continue;
+    uint64_t oldMax = m_max.load(std::memory_order_relaxed);
+    while (usec > oldMax
+           && !m_max.compare_exchange_weak(oldMax, usec, std::memory_order_relaxed))
+      continue;
+  }
+
+  void LatencyHistogram::reset()
+  {
+    for (std::atomic<uint64_t> &bucket : m_buckets)
+      bucket.store(0, std::memory_order_relaxed);
+    m_count.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+    m_min.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+  }
+
+  uint64_t LatencyHistogram::count() const
+  {
+    return m_count.load(std::memory_order_relaxed);
+  }
+
+  uint64_t LatencyHistogram::sum() const
+  {
+    return m_sum.load(std::memory_order_relaxed);
+  }
+
+  uint64_t LatencyHistogram::min() const
+  {
+    uint64_t result = m_min.load(std::memory_order_relaxed);
+    return result == std::numeric_limits<uint64_t>::max() ? 0 : result;
+  }
+
+  uint64_t LatencyHistogram::max() const
+  {
+    return m_max.load(std::memory_order_relaxed);
+  }
+
+  uint64_t LatencyHistogram::valueAtQuantile(double q) const
+  {
+    uint64_t total = count();
+    if (!total)
+      return 0;
+    uint64_t maxValue = max();
+    if (q >= 1.0)
+      return maxValue;
+    uint64_t target = (uint64_t) std::ceil(q * total);
+    if (target < 1)
+      target = 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+      seen += m_buckets[i].load(std::memory_order_relaxed);
+      if (seen >= target) {
+        uint64_t result = bucketHighestValue(i);
+        return result < maxValue ? result : maxValue;
+      }
+    }
+    return maxValue;
+  }
+
+} // namespace PLEXIL
@@ -0,0 +1,120 @@
+/* Copyright (c) 2006-2021, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef PLEXIL_LATENCY_HISTOGRAM_HH
+#define PLEXIL_LATENCY_HISTOGRAM_HH
+
+#include "plexil-stdint.h" // uint64_t; also includes plexil-config.h
+
+#include <atomic>
+#include <cstddef> // size_t
+
+namespace PLEXIL
+{
+
+  //! @class LatencyHistogram
+  //! A histogram of latencies in microseconds, in the style of
+  //! HdrHistogram: values below 64 are counted exactly, and larger
+  //! values in buckets no wider than 1/32 of their magnitude, so any
+  //! quantile is reported within about 3% of the true value.
+
+  //! Values may be recorded concurrently from several threads without
+  //! locking. Queries made while values are being recorded may see
+  //! some, but not all, of the concurrent updates.
+  class LatencyHistogram final
+  {
+  public:
+    LatencyHistogram();
+    ~LatencyHistogram() = default;
+
+    //! Record one value.
+    //! @param usec The value, in microseconds.
+    void record(uint64_t usec);
+
+    //! Discard all recorded values.
+    void reset();
+
+    //! @return The number of values recorded.
+    uint64_t count() const;
+
+    //! @return The sum of the values recorded, in microseconds.
+    uint64_t sum() const;
+
+    //! @return The smallest value recorded, in microseconds; 0 if no
+    //!         values have been recorded.
+    uint64_t min() const;
+
+    //! @return The largest value recorded, in microseconds.
+    uint64_t max() const;
+
+    //! Get the value at a given quantile.
+    //! @param q The quantile, from 0 to 1.
+    //! @return The highest value equivalent to the value at that
+    //!         quantile, in microseconds; 0 if no values have been
+    //!         recorded.
+    uint64_t valueAtQuantile(double q) const;
+
+    //! Get the bucket a value is counted in.
+    //! @param usec The value.
+    //! @return The bucket index.
+    static size_t bucketIndex(uint64_t usec);
+
+    //! Get the largest value counted in a bucket.
+    //! @param idx The bucket index.
+    //! @return The value.
+    static uint64_t bucketHighestValue(size_t idx);
+
+  private:
+
+    // Not copyable
+    LatencyHistogram(LatencyHistogram const &) = delete;
+    LatencyHistogram(LatencyHistogram &&) = delete;
+    LatencyHistogram &operator=(LatencyHistogram const &) = delete;
+    LatencyHistogram &operator=(LatencyHistogram &&) = delete;
+
+    //! Bits of a value's magnitude resolved within each power of 2.
+    static constexpr unsigned SUB_BUCKET_BITS = 5;
+    static constexpr size_t SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+
+    //! Values below this are counted exactly.
+    static constexpr uint64_t EXACT_LIMIT = 2 * SUB_BUCKET_COUNT;
+
+    //! Values with more significant bits than this share the last bucket.
+    static constexpr unsigned MAX_VALUE_BITS = 44; // about 200 days
+
+    static constexpr size_t BUCKET_COUNT =
+      EXACT_LIMIT + (MAX_VALUE_BITS - SUB_BUCKET_BITS - 1) * SUB_BUCKET_COUNT;
+
+    std::atomic<uint64_t> m_buckets[BUCKET_COUNT];
+    std::atomic<uint64_t> m_count;
+    std::atomic<uint64_t> m_sum;
+    std::atomic<uint64_t> m_min;
+    std::atomic<uint64_t> m_max;
+  };
+
+} // namespace PLEXIL
+
+#endif // PLEXIL_LATENCY_HISTOGRAM_HH
@@ -0,0 +1,349 @@
+/* Copyright (c) 2006-2026, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "plexil-config.h"
+
+#include "LocalSocketServer.hh"
+
+#include "Debug.hh"
+#include "Error.hh"
+
+#if defined(HAVE_SYS_SOCKET_H) && defined(HAVE_SYS_UN_H) && defined(HAVE_POLL_H) && defined(HAVE_SYS_STAT_H)
+#define PLEXIL_LOCAL_SOCKETS 1
+
+#include <thread>
+
+#if defined(HAVE_CERRNO)
+#include <cerrno>
+#elif defined(HAVE_ERRNO_H)
+#include <errno.h>
+#endif
+
+#if defined(HAVE_CSTRING)
+#include <cstring> // strerror(), strncpy()
+#elif defined(HAVE_STRING_H)
+#include <string.h> // strerror(), strncpy()
+#endif
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace PLEXIL
+{
+
+#ifdef PLEXIL_LOCAL_SOCKETS
+
+  using SteadyClock = std::chrono::steady_clock;
+
+  class LocalSocketClientImpl final : public LocalSocketClient
+  {
+  public:
+    LocalSocketClientImpl(int fd, int stopFd, SteadyClock::time_point deadline)
+      : m_fd(fd),
+        m_stopFd(stopFd),
+        m_deadline(deadline)
+    {
+    }
+
+    virtual ~LocalSocketClientImpl()
+    {
+      close(m_fd);
+    }
+
+    virtual ReadStatus read(std::string &buf) override
+    {
+      pollfd fds[2];
+      fds[0].fd = m_fd;
+      fds[0].events = POLLIN;
+      fds[1].fd = m_stopFd;
+      fds[1].events = POLLIN;
+      while (true) {
+        int timeoutMsec = -1;
+        if (m_deadline != SteadyClock::time_point()) {
+          SteadyClock::duration left = m_deadline - SteadyClock::now();
+          if (left <= SteadyClock::duration::zero())
+            return READ_TIMEOUT;
+          // Round up, so as not to wake before the deadline
+          std::chrono::milliseconds msec =
+            std::chrono::duration_cast<std::chrono::milliseconds>(left);
+          if (msec < left)
+            ++msec;
+          timeoutMsec = (int) msec.count();
+        }
+        int status = poll(fds, 2, timeoutMsec);
+        if (status < 0) {
+          if (errno == EINTR)
+            continue;
+          return READ_END;
+        }
+        if (fds[1].revents)
+          return READ_STOP;
+        if (fds[0].revents)
+          break;
+      }
+
+      char chunk[512];
+      ssize_t n = ::read(m_fd, chunk, sizeof(chunk));
+      if (n <= 0)
+        return READ_END;
+      buf.append(chunk, n);
+      return READ_OK;
+    }
+
+    // A client which has gone away must not raise SIGPIPE in the
+    // host process.
+    virtual bool send(std::string const &text) override
+    {
+#ifdef MSG_NOSIGNAL
+      int const flags = MSG_NOSIGNAL;
+#else
+      int const flags = 0;
+#endif
+      size_t sent = 0;
+      while (sent < text.size()) {
+        ssize_t n = ::send(m_fd, text.data() + sent, text.size() - sent, flags);
+        if (n < 0) {
+          if (errno == EINTR)
+            continue;
+          return false;
+        }
+        sent += n;
+      }
+      return true;
+    }
+
+  private:
+    LocalSocketClientImpl(LocalSocketClientImpl const &) = delete;
+    LocalSocketClientImpl(LocalSocketClientImpl &&) = delete;
+    LocalSocketClientImpl &operator=(LocalSocketClientImpl const &) = delete;
+    LocalSocketClientImpl &operator=(LocalSocketClientImpl &&) = delete;
+
+    int m_fd;
+    int m_stopFd;
+    SteadyClock::time_point m_deadline; //!< Epoch if no deadline
+  };
+
+  class LocalSocketServerImpl final : public LocalSocketServer
+  {
+  public:
+    LocalSocketServerImpl(std::string const &path,
+                          char const *name,
+                          std::chrono::milliseconds clientTimeout,
+                          LocalSocketClientFn fn)
+      : m_path(path),
+        m_name(name),
+        m_clientTimeout(clientTimeout),
+        m_fn(std::move(fn)),
+        m_thread(),
+        m_listenFd(-1)
+    {
+      m_stopPipe[0] = m_stopPipe[1] = -1;
+    }
+
+    virtual ~LocalSocketServerImpl()
+    {
+      if (m_thread.joinable()) {
+        char c = 0;
+        if (write(m_stopPipe[1], &c, 1) < 0) {
+          // nothing more we can do
+        }
+        m_thread.join();
+      }
+      if (m_listenFd >= 0)
+        unlink(m_path.c_str());
+      closeAll();
+    }
+
+    virtual std::string const &path() const override
+    {
+      return m_path;
+    }
+
+    bool start()
+    {
+      sockaddr_un addr;
+      if (m_path.size() >= sizeof(addr.sun_path)) {
+        warn(m_name << " socket path " << m_path << " is too long");
+        return false;
+      }
+      memset(&addr, 0, sizeof(addr));
+      addr.sun_family = AF_UNIX;
+      strncpy(addr.sun_path, m_path.c_str(), sizeof(addr.sun_path) - 1);
+
+      if (pipe(m_stopPipe) != 0) {
+        warn(m_name << ": pipe failed: " << strerror(errno));
+        return false;
+      }
+      if (!removeStaleSocket(addr)) {
+        closeAll();
+        return false;
+      }
+      m_listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+      if (m_listenFd < 0) {
+        warn(m_name << ": socket failed: " << strerror(errno));
+        closeAll();
+        return false;
+      }
+      if (bind(m_listenFd, (sockaddr *) &addr, sizeof(addr)) != 0
+          || listen(m_listenFd, 4) != 0) {
+        warn(m_name << ": unable to listen on " << m_path << ": " << strerror(errno));
+        closeAll();
+        return false;
+      }
+      m_thread = std::thread([this]() -> void { run(); });
+      debugMsg("LocalSocketServer", ' ' << m_name << " listening on " << m_path);
+      return true;
+    }
+
+  private:
+    LocalSocketServerImpl(LocalSocketServerImpl const &) = delete;
+    LocalSocketServerImpl(LocalSocketServerImpl &&) = delete;
+    LocalSocketServerImpl &operator=(LocalSocketServerImpl const &) = delete;
+    LocalSocketServerImpl &operator=(LocalSocketServerImpl &&) = delete;
+
+    void closeAll()
+    {
+      if (m_listenFd >= 0)
+        close(m_listenFd);
+      m_listenFd = -1;
+      for (int &fd : m_stopPipe) {
+        if (fd >= 0)
+          close(fd);
+        fd = -1;
+      }
+    }
+
+    // Remove a socket left behind at the path by a server which has
+    // exited. Anything else at the path is left alone.
+    // Returns true if nothing is now at the path.
+    bool removeStaleSocket(sockaddr_un const &addr)
+    {
+      struct stat st;
+      if (lstat(m_path.c_str(), &st) != 0) {
+        if (errno == ENOENT)
+          return true;
+        warn(m_name << ": unable to check " << m_path << ": " << strerror(errno));
+        return false;
+      }
+      if (!S_ISSOCK(st.st_mode)) {
+        warn(m_name << ": " << m_path << " exists and is not a socket");
+        return false;
+      }
+      // Don't take over a socket that is still being listened on
+      int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+      if (probe >= 0) {
+        bool live = connect(probe, (sockaddr const *) &addr, sizeof(addr)) == 0;
+        close(probe);
+        if (live) {
+          warn(m_name << ": " << m_path << " is in use by another server");
+          return false;
+        }
+      }
+      if (unlink(m_path.c_str()) != 0 && errno != ENOENT) {
+        warn(m_name << ": unable to remove " << m_path << ": " << strerror(errno));
+        return false;
+      }
+      return true;
+    }
+
+    // Wait until a client connects or stop is requested.
+    // Returns true if a client is waiting.
+    bool waitForClient()
+    {
+      pollfd fds[2];
+      fds[0].fd = m_listenFd;
+      fds[0].events = POLLIN;
+      fds[1].fd = m_stopPipe[0];
+      fds[1].events = POLLIN;
+      while (true) {
+        int status = poll(fds, 2, -1);
+        if (status < 0) {
+          if (errno == EINTR)
+            continue;
+          return false;
+        }
+        if (fds[1].revents)
+          return false;
+        if (fds[0].revents)
+          return true;
+      }
+    }
+
+    void run()
+    {
+      while (waitForClient()) {
+        int fd = accept(m_listenFd, nullptr, nullptr);
+        if (fd < 0)
+          continue;
+        SteadyClock::time_point deadline;
+        if (m_clientTimeout.count() > 0)
+          deadline = SteadyClock::now() + m_clientTimeout;
+        LocalSocketClientImpl client(fd, m_stopPipe[0], deadline);
+        m_fn(client);
+      }
+    }
+
+    std::string m_path;
+    std::string m_name;
+    std::chrono::milliseconds m_clientTimeout;
+    LocalSocketClientFn m_fn;
+    std::thread m_thread;
+    int m_listenFd;
+    int m_stopPipe[2];
+  };
+
+  LocalSocketServer *makeLocalSocketServer(std::string const &path,
+                                           char const *name,
+                                           std::chrono::milliseconds clientTimeout,
+                                           LocalSocketClientFn fn)
+  {
+    LocalSocketServerImpl *result =
+      new LocalSocketServerImpl(path, name, clientTimeout, std::move(fn));
+    if (!result->start()) {
+      delete result;
+      return nullptr;
+    }
+    return result;
+  }
+
+#else
+
+  LocalSocketServer *makeLocalSocketServer(std::string const &path,
+                                           char const *name,
+                                           std::chrono::milliseconds /* clientTimeout */,
+                                           LocalSocketClientFn /* fn */)
+  {
+    warn(name << " socket " << path << " not supported on this platform");
+    return nullptr;
+  }
+
+#endif // PLEXIL_LOCAL_SOCKETS
+
+} // namespace PLEXIL
@@ -0,0 +1,97 @@
+/* Copyright (c) 2006-2026, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef PLEXIL_LOCAL_SOCKET_SERVER_HH
+#define PLEXIL_LOCAL_SOCKET_SERVER_HH
+
+#include <chrono>
+#include <functional>
+#include <string>
+
+namespace PLEXIL
+{
+
+  //! @class LocalSocketClient
+  //! One client connection to a LocalSocketServer.
+  class LocalSocketClient
+  {
+  public:
+    virtual ~LocalSocketClient() = default;
+
+    //! Status of a read.
+    enum ReadStatus {
+      READ_OK = 0,  //!< Data was appended
+      READ_END,     //!< The client closed the connection, or an error occurred
+      READ_TIMEOUT, //!< The client's deadline has passed
+      READ_STOP     //!< The server is being stopped
+    };
+
+    //! Wait for data from the client and append it to the buffer.
+    //! @param buf The buffer.
+    //! @return The status.
+    virtual ReadStatus read(std::string &buf) = 0;
+
+    //! Send the whole of the text to the client.
+    //! @param text The text.
+    //! @return True if sent, false if the client has gone away.
+    virtual bool send(std::string const &text) = 0;
+  };
+
+  //! Function called in the server thread for each client connection.
+  //! The connection is closed when it returns.
+  using LocalSocketClientFn = std::function<void(LocalSocketClient &client)>;
+
+  //! @class LocalSocketServer
+  //! Accepts connections on a local (Unix domain) stream socket in its
+  //! own thread, and serves them one at a time.
+  //! Deleting the server stops the thread and removes the socket.
+  class LocalSocketServer
+  {
+  public:
+    virtual ~LocalSocketServer() = default;
+
+    //! @return The socket's path in the file system.
+    virtual std::string const &path() const = 0;
+  };
+
+  //! Construct a server and start listening.
+  //! @param path The socket's path in the file system.
+  //! @param name Name of the service, for messages.
+  //! @param clientTimeout Total time allowed to each client, from
+  //!        connection to the end of its reads; zero for no limit.
+  //! @param fn The function called for each client.
+  //! @return Pointer to the server; nullptr if unable to listen.
+  //! @note A socket left at the path by a server which has exited
+  //!       is replaced. Fails if anything else is at the path.
+  extern LocalSocketServer *
+  makeLocalSocketServer(std::string const &path,
+                        char const *name,
+                        std::chrono::milliseconds clientTimeout,
+                        LocalSocketClientFn fn);
+
+} // namespace PLEXIL
+
+#endif // PLEXIL_LOCAL_SOCKET_SERVER_HH
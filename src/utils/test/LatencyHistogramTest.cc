@@ -0,0 +1,106 @@
+/* Copyright (c) 2006-2020, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "LatencyHistogram.hh"
+#include "TestSupport.hh"
+
+using namespace PLEXIL;
+
+static bool testBuckets()
+{
+  // Small values are exact
+  for (uint64_t v = 0; v < 64; ++v) {
+    assertTrue_1(LatencyHistogram::bucketIndex(v) == v);
+    assertTrue_1(LatencyHistogram::bucketHighestValue(v) == v);
+  }
+
+  // Every value lies within its bucket, and buckets are narrow
+  uint64_t v = 64;
+  size_t prevIdx = 63;
+  while (v < (((uint64_t) 1) << 43)) {
+    size_t idx = LatencyHistogram::bucketIndex(v);
+    assertTrue_1(idx >= prevIdx);
+    uint64_t highest = LatencyHistogram::bucketHighestValue(idx);
+    assertTrue_1(highest >= v);
+    assertTrue_1(highest - v <= v / 32);
+    if (idx > 0)
+      assertTrue_1(LatencyHistogram::bucketHighestValue(idx - 1) < v);
+    prevIdx = idx;
+    v += v / 7 + 1;
+  }
+
+  // Adjacent buckets leave no gaps
+  for (size_t i = 64; i < 1000; ++i)
+    assertTrue_1(LatencyHistogram::bucketIndex(LatencyHistogram::bucketHighestValue(i) + 1)
+                 == i + 1);
+
+  return true;
+}
+
+static bool testQuantiles()
+{
+  LatencyHistogram h;
+  assertTrue_1(h.count() == 0);
+  assertTrue_1(h.min() == 0);
+  assertTrue_1(h.valueAtQuantile(0.5) == 0);
+
+  for (uint64_t v = 1; v <= 1000; ++v)
+    h.record(v);
+  assertTrue_1(h.count() == 1000);
+  assertTrue_1(h.sum() == 500500);
+  assertTrue_1(h.min() == 1);
+  assertTrue_1(h.max() == 1000);
+
+  uint64_t median = h.valueAtQuantile(0.5);
+  assertTrue_1(median >= 500 && median <= 500 + 500 / 32);
+  uint64_t p99 = h.valueAtQuantile(0.99);
+  assertTrue_1(p99 >= 990 && p99 <= 1000);
+  assertTrue_1(h.valueAtQuantile(1.0) == 1000);
+  assertTrue_1(h.valueAtQuantile(0.0) == 1);
+
+  // One outlier shows up only in the tail
+  h.record(5000000);
+  assertTrue_1(h.valueAtQuantile(0.5) == median);
+  assertTrue_1(h.valueAtQuantile(0.999) <= 1000 + 1000 / 32);
+  assertTrue_1(h.valueAtQuantile(1.0) == 5000000);
+
+  h.reset();
+  assertTrue_1(h.count() == 0);
+  assertTrue_1(h.sum() == 0);
+  assertTrue_1(h.min() == 0);
+  assertTrue_1(h.max() == 0);
+  assertTrue_1(h.valueAtQuantile(0.99) == 0);
+
+  return true;
+}
+
+bool LatencyHistogramTest()
+{
+  runTest(testBuckets);
+  runTest(testQuantiles);
+
+  return true;
+}
@@ -55,6 +55,13 @@
 #include "timespec-utils.hh"
 #include "timeval-utils.hh"
 
+#if defined(PLEXIL_WITH_THREADS) && !defined(NO_DEBUG_MESSAGE_SUPPORT)
+#include "DebugControl.hh"
+
+#include <thread>
+#include <vector>
+#endif
+
 #include <iomanip>
 #include <iostream>
 #include <fstream>
@@ -94,6 +101,7 @@
 
 // Tests not in this source file
 
+extern bool LatencyHistogramTest();
 extern bool LinkedQueueTest();
 extern bool SimpleMapTest();
 extern bool SimpleSetTest();
@@ -206,11 +214,28 @@ private:
   }
 };
 
+#if defined(PLEXIL_WITH_THREADS) && !defined(NO_DEBUG_MESSAGE_SUPPORT)
+// Written a character at a time, so messages written without
+// synchronization are likely to be interleaved
+struct CharByChar
+{
+  std::string const &text;
+};
+
+static std::ostream &operator<<(std::ostream &os, CharByChar const &c)
+{
+  for (char ch : c.text)
+    os.put(ch);
+  return os;
+}
+#endif
+
 class DebugTest {
 public:
   static bool test() {
     runTest(testDebugError);
     runTest(testDebugFiles);
+    runTest(testRuntimeControl);
     return true;
   }
 private:
@@ -235,6 +260,78 @@ private:
     return(true);
   }
 
+  static bool testRuntimeControl() {
+#if !defined(NO_DEBUG_MESSAGE_SUPPORT)
+    std::ostringstream debugOutput;
+    setDebugOutputStream(debugOutput);
+
+    debugMsg("runtimeControl", " one");
+    enableMatchingDebugMessages("runtimeControl");
+    debugMsg("runtimeControl", " two");
+    disableMatchingDebugMessages("runtimeControl");
+    debugMsg("runtimeControl", " three");
+    assertTrue_1(debugOutput.str() == "[runtimeControl] two\n");
+
+#ifdef PLEXIL_WITH_THREADS
+    // Messages from several threads at once are written whole
+    debugOutput.str("");
+    enableMatchingDebugMessages("runtimeControl");
+    std::string const padding(200, 'x');
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 4; ++t)
+      writers.emplace_back([t, &padding]() -> void {
+          for (int i = 0; i < 250; ++i)
+            debugMsg("runtimeControl",
+                     ' ' << t << ' ' << CharByChar {padding} << ' ' << i);
+        });
+    for (std::thread &w : writers)
+      w.join();
+    disableMatchingDebugMessages("runtimeControl");
+    std::istringstream lines(debugOutput.str());
+    std::string line;
+    int next[4] = {0, 0, 0, 0};
+    while (std::getline(lines, line)) {
+      std::istringstream fields(line);
+      std::string marker, pad;
+      int t = -1, i = -1;
+      fields >> marker >> t >> pad >> i;
+      assertTrue_1(marker == "[runtimeControl]");
+      assertTrue_1(t >= 0 && t < 4);
+      assertTrue_1(pad == padding);
+      assertTrue_1(i == next[t]++);
+      assertTrue_1(fields.eof());
+    }
+    for (int t = 0; t < 4; ++t)
+      assertTrue_1(next[t] == 250);
+
+    // Messages are written by the background thread
+    debugOutput.str("");
+    assertTrue_1(startBufferedDebugOutput());
+    std::ostringstream reply;
+    assertTrue_1(executeDebugControlCommand("enable runtimeControl", reply));
+    assertTrue_1(reply.str() == "OK\n");
+    for (int i = 0; i < 100; ++i)
+      debugMsg("runtimeControl", ' ' << i);
+    reply.str("");
+    assertTrue_1(executeDebugControlCommand("  disable   runtimeControl ", reply));
+    assertTrue_1(reply.str() == "OK\n");
+    debugMsg("runtimeControl", " not written");
+    stopBufferedDebugOutput();
+    std::ostringstream expected;
+    for (int i = 0; i < 100; ++i)
+      expected << "[runtimeControl] " << i << '\n';
+    assertTrue_1(debugOutput.str() == expected.str());
+
+    reply.str("");
+    assertTrue_1(!executeDebugControlCommand("frobnicate", reply));
+    assertTrue_1(reply.str().compare(0, 5, "ERROR") == 0);
+#endif
+
+    setDebugOutputStream(std::cerr);
+#endif
+    return true;
+  }
+
   static void runDebugTest(int cfgNum) {
 #if !defined(PLEXIL_UNSAFE) && !defined(NO_DEBUG_MESSAGE_SUPPORT)
     std::stringstream cfgName;
@@ -506,6 +603,7 @@ void UtilModuleTests::runTests(std::string /* path */)
   runTestSuite(SimpleSetTest);
   runTestSuite(LinkedQueueTest);
   runTestSuite(bitsetUtilsTest);
+  runTestSuite(LatencyHistogramTest);
 
   // Do cleanup
   plexilRunFinalizers();
@@ -132,6 +132,7 @@ namespace PLEXIL {
     PARENT_FAILED,
     EXITED,
     PARENT_EXITED,
+    LIBRARY_EXPANSION_FAILED,
     FAILURE_TYPE_MAX
   };
 
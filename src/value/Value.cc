@@ -308,6 +308,41 @@ namespace PLEXIL
   {
   }
 
+  Value::Value(String &&val)
+    : stringValue(new String(std::move(val))),
+      m_type(STRING_TYPE),
+      m_known(true)
+  {
+  }
+
+  Value::Value(BooleanArray &&val)
+    : arrayValue(new BooleanArray(std::move(val))),
+      m_type(BOOLEAN_ARRAY_TYPE),
+      m_known(true)
+  {
+  }
+
+  Value::Value(IntegerArray &&val)
+    : arrayValue(new IntegerArray(std::move(val))),
+      m_type(INTEGER_ARRAY_TYPE),
+      m_known(true)
+  {
+  }
+
+  Value::Value(RealArray &&val)
+    : arrayValue(new RealArray(std::move(val))),
+      m_type(REAL_ARRAY_TYPE),
+      m_known(true)
+  {
+  }
+
+  Value::Value(StringArray &&val)
+    : arrayValue(new StringArray(std::move(val))),
+      m_type(STRING_ARRAY_TYPE),
+      m_known(true)
+  {
+  }
+
   Value::Value(std::vector<Value> const &vals)
     : arrayValue(), // we can be sure result is an array
       m_type(UNKNOWN_TYPE),
@@ -1285,6 +1320,96 @@ namespace PLEXIL
     }
   }
 
+  // Read the 3 byte size which follows a type code.
+  static size_t readSerialLength(char const *buf)
+  {
+    size_t siz = ((size_t) (unsigned char) buf[1]) << 8;
+    siz = (siz + (size_t) (unsigned char) buf[2]) << 8;
+    return siz + (size_t) (unsigned char) buf[3];
+  }
+
+  // Size of the serial representation beginning at buf, reading nothing
+  // at or after end.  Returns 0 if the representation is invalid or
+  // extends past end.
+  static size_t boundedSerialSize(char const *buf, char const *end)
+  {
+    if (buf >= end)
+      return 0;
+    size_t const avail = end - buf;
+    size_t result = 0;
+    switch ((ValueType) *buf) {
+    case UNKNOWN_TYPE:
+      result = 1;
+      break;
+
+    case BOOLEAN_TYPE:
+    case COMMAND_HANDLE_TYPE:
+      result = 2;
+      break;
+
+    case INTEGER_TYPE:
+      result = 5;
+      break;
+
+    case REAL_TYPE:
+      result = 9;
+      break;
+
+    case STRING_TYPE:
+      if (avail < 4)
+        return 0;
+      result = 4 + readSerialLength(buf);
+      break;
+
+    case BOOLEAN_ARRAY_TYPE:
+    case INTEGER_ARRAY_TYPE:
+    case REAL_ARRAY_TYPE:
+    case STRING_ARRAY_TYPE: {
+      if (avail < 4)
+        return 0;
+      size_t const n = readSerialLength(buf);
+      size_t const bits = (n + 7) / 8;
+      switch ((ValueType) *buf) {
+      case BOOLEAN_ARRAY_TYPE:
+        result = 4 + 2 * bits;
+        break;
+
+      case INTEGER_ARRAY_TYPE:
+        result = 4 + bits + 4 * n;
+        break;
+
+      case REAL_ARRAY_TYPE:
+        result = 4 + bits + 8 * n;
+        break;
+
+      default: // STRING_ARRAY_TYPE
+        // Each element has its own 3 byte length
+        result = 4 + bits;
+        for (size_t i = 0; i < n; ++i) {
+          if (avail < result + 3)
+            return 0;
+          result += 3 + readSerialLength(buf + result - 1);
+        }
+        break;
+      }
+      break;
+    }
+
+    default: // invalid
+      return 0;
+    }
+    return result <= avail ? result : 0;
+  }
+
+  char const *Value::deserialize(char const *buf, char const *end)
+  {
+    size_t const siz = boundedSerialSize(buf, end);
+    if (!siz)
+      return nullptr;
+    char const *result = deserialize(buf);
+    return result == buf + siz ? result : nullptr;
+  }
+
   size_t Value::serialSize() const
   {
     if (!isKnown())
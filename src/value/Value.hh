@@ -74,6 +74,13 @@ namespace PLEXIL
     Value(RealArray const &val);
     Value(StringArray const &val);
 
+    // Take ownership of the contents of a temporary.
+    Value(String &&val);
+    Value(BooleanArray &&val);
+    Value(IntegerArray &&val);
+    Value(RealArray &&val);
+    Value(StringArray &&val);
+
     Value(uint8_t enumVal, ValueType typ); // Typed UNKNOWN
 
     // Constructs the appropriate array type.
@@ -132,6 +139,9 @@ namespace PLEXIL
 
     char *serialize(char *b) const; 
     char const *deserialize(char const *b);
+    //! As above, but reject a representation which is malformed or
+    //! extends past end, without reading at or beyond end.
+    char const *deserialize(char const *b, char const *end);
     size_t serialSize() const; 
 
   private:
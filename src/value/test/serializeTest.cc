@@ -2088,10 +2088,67 @@ static bool testValueSerDes()
   return true;
 }
 
+// Bounded deserialization must reject every truncation of a valid
+// representation without reading past the end.
+static bool testBoundedValueSerDes()
+{
+  StringArray sa(5);
+  for (size_t i = 0; i < sa.size(); ++i)
+    sa.setElement(i, String(i * 3, 'x'));
+  IntegerArray ia(200); // size byte > 127
+  for (size_t i = 0; i < ia.size(); ++i)
+    ia.setElement(i, (Integer) i);
+
+  Value const values[] =
+    {Value(),
+     Value(true),
+     Value((Integer) 42),
+     Value(3.5),
+     Value(String("bounded")),
+     Value(BooleanArray(9, true)),
+     Value(ia),
+     Value(RealArray(3, 1.5)),
+     Value(sa)};
+
+  for (Value const &v : values) {
+    size_t const siz = v.serialSize();
+    assertTrueMsg(siz && siz <= BUFSIZE, "bad serial size for " << v);
+    char *end = v.serialize(buffer);
+    assertTrueMsg(end == buffer + siz, "serialize failed for " << v);
+
+    Value result;
+    char const *cbufptr = result.deserialize(buffer, buffer + siz);
+    assertTrueMsg(cbufptr == buffer + siz, "bounded deserialize failed for " << v);
+    assertTrueMsg(result == v, "bounded deserialize got " << result << ", expected " << v);
+
+    for (size_t len = 0; len < siz; ++len)
+      assertTrueMsg(!result.deserialize(buffer, buffer + len),
+                    "bounded deserialize accepted " << len << " of "
+                    << siz << " bytes of " << v);
+  }
+
+  // Corrupt string length
+  Value const str(String("abc"));
+  size_t const siz = str.serialSize();
+  str.serialize(buffer);
+  buffer[1] = (char) 0x7F;
+  Value result;
+  assertTrueMsg(!result.deserialize(buffer, buffer + siz),
+                "bounded deserialize accepted a corrupt string length");
+
+  // Invalid type code
+  buffer[0] = (char) STATE_TYPE;
+  assertTrueMsg(!result.deserialize(buffer, buffer + siz),
+                "bounded deserialize accepted an invalid type code");
+
+  return true;
+}
+
 bool serializeTest()
 {
   runTest(testBasicSerDes);
   runTest(testArraySerDes);
   runTest(testValueSerDes);
+  runTest(testBoundedValueSerDes);
   return true;
 }  
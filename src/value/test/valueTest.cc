@@ -563,6 +563,44 @@ static bool testMoveConstructors()
     }
   }
 
+  // Construction from temporaries takes ownership of the contents
+  {
+    String str("long enough to defeat the small string optimization");
+    String const *tempstr = nullptr;
+    Value strv(std::move(str));
+    assertTrue_1(strv.isKnown());
+    assertTrue_1(STRING_TYPE == strv.valueType());
+    assertTrue_1(strv.getValuePointer(tempstr));
+    assertTrue_1(*tempstr == "long enough to defeat the small string optimization");
+
+    IntegerArray ia(3);
+    ia.setElement(0, (Integer) 1);
+    ia.setElement(2, (Integer) 3);
+    IntegerArray const *tempiap = nullptr;
+    Value iav(std::move(ia));
+    assertTrue_1(iav.isKnown());
+    assertTrue_1(INTEGER_ARRAY_TYPE == iav.valueType());
+    assertTrue_1(iav.getValuePointer(tempiap));
+    assertTrue_1(tempiap->size() == 3);
+    Integer tempi;
+    assertTrue_1(tempiap->getElement(0, tempi));
+    assertTrue_1(tempi == 1);
+    assertTrue_1(!tempiap->elementKnown(1));
+    assertTrue_1(tempiap->getElement(2, tempi));
+    assertTrue_1(tempi == 3);
+
+    std::vector<String> sv(2);
+    sv[0] = String("yo ");
+    sv[1] = String("mama");
+    StringArray sa(sv);
+    StringArray const *tempsap = nullptr;
+    Value sav(std::move(sa));
+    assertTrue_1(sav.isKnown());
+    assertTrue_1(STRING_ARRAY_TYPE == sav.valueType());
+    assertTrue_1(sav.getValuePointer(tempsap));
+    assertTrue_1(*tempsap == StringArray(sv));
+  }
+
   return true;
 }
 
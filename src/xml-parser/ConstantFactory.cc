@@ -345,6 +345,7 @@ namespace PLEXIL
     case PARENT_FAILED:
     case EXITED:
     case PARENT_EXITED:
+    case LIBRARY_EXPANSION_FAILED:
       return FAILURE_TYPE; // is OK
 
     default:
@@ -380,6 +381,9 @@ namespace PLEXIL
     case PARENT_EXITED:
       return PARENT_EXITED_CONSTANT();
 
+    case LIBRARY_EXPANSION_FAILED:
+      return LIBRARY_EXPANSION_FAILED_CONSTANT();
+
     default:
       reportParserExceptionWithLocation(expr,
                                         "createExpression: Invalid FailureTypeValue");
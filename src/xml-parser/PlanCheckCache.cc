@@ -0,0 +1,305 @@
+/* Copyright (c) 2006-2021, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "plexil-config.h"
+
+#include "PlanCheckCache.hh"
+
+#include "Debug.hh"
+#include "parsePlan.hh"
+#include "SymbolTable.hh"
+
+#include "pugixml.hpp"
+
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#if defined(HAVE_CSTDIO)
+#include <cstdio>
+#elif defined(HAVE_STDIO_H)
+#include <stdio.h>
+#endif
+
+#if defined(HAVE_CSTRING)
+#include <cstring> // memcpy()
+#elif defined(HAVE_STRING_H)
+#include <string.h> // memcpy()
+#endif
+
+#ifdef HAVE_UNISTD_H
+#include <unistd.h> // getpid()
+#endif
+
+#ifdef HAVE_DLFCN_H
+#include <dlfcn.h> // dladdr()
+#endif
+
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+
+namespace PLEXIL
+{
+
+  static std::string s_cacheDirectory;
+
+  //
+  // SHA-256 (FIPS 180-4)
+  //
+
+  static uint32_t const SHA256_K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+  };
+
+  static inline uint32_t rotr(uint32_t x, unsigned int n)
+  {
+    return (x >> n) | (x << (32 - n));
+  }
+
+  static void sha256Block(uint32_t state[8], unsigned char const *block)
+  {
+    uint32_t w[64];
+    for (size_t i = 0; i < 16; ++i)
+      w[i] = ((uint32_t) block[4 * i] << 24)
+        | ((uint32_t) block[4 * i + 1] << 16)
+        | ((uint32_t) block[4 * i + 2] << 8)
+        | (uint32_t) block[4 * i + 3];
+    for (size_t i = 16; i < 64; ++i) {
+      uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+      uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+      w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (size_t i = 0; i < 64; ++i) {
+      uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25))
+        + ((e & f) ^ (~e & g)) + SHA256_K[i] + w[i];
+      uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22))
+        + ((a & b) ^ (a & c) ^ (b & c));
+      h = g;
+      g = f;
+      f = e;
+      e = d + t1;
+      d = c;
+      c = b;
+      b = a;
+      a = t1 + t2;
+    }
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+  }
+
+  void makePlanContentKey(void const *data, size_t length,
+                          PlanContentKey &key)
+  {
+    uint32_t state[8] = {
+      0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+      0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+    unsigned char const *p = static_cast<unsigned char const *>(data);
+    size_t left = length;
+    for (; left >= 64; left -= 64, p += 64)
+      sha256Block(state, p);
+
+    // Padding: a 1 bit, zeros, then the length in bits
+    unsigned char tail[128] = {0};
+    memcpy(tail, p, left);
+    tail[left] = 0x80;
+    size_t tailLength = (left < 56) ? 64 : 128;
+    uint64_t bits = (uint64_t) length * 8;
+    for (size_t i = 0; i < 8; ++i)
+      tail[tailLength - 1 - i] = (unsigned char) (bits >> (8 * i));
+    sha256Block(state, tail);
+    if (tailLength == 128)
+      sha256Block(state, tail + 64);
+
+    for (size_t i = 0; i < 8; ++i)
+      for (size_t j = 0; j < 4; ++j)
+        key.digest[4 * i + j] = (uint8_t) (state[i] >> (24 - 8 * j));
+    key.length = length;
+  }
+
+  static std::string digestString(PlanContentKey const &key)
+  {
+    std::ostringstream s;
+    s << std::hex << std::setfill('0');
+    for (uint8_t b : key.digest)
+      s << std::setw(2) << (unsigned int) b;
+    return s.str();
+  }
+
+  void setPlanCheckCacheDirectory(std::string const &dirname)
+  {
+    s_cacheDirectory = dirname;
+    debugMsg("PlanCheckCache", " directory set to \"" << dirname << '"');
+  }
+
+  std::string const &getPlanCheckCacheDirectory()
+  {
+    return s_cacheDirectory;
+  }
+
+  // The first line of each cache file.  It identifies everything
+  // the check result depends on other than the plan itself, so that
+  // entries made by a different checker are ignored.
+  static std::string makeCacheFormatId()
+  {
+    std::ostringstream inputs;
+    inputs << (unsigned int) TYPE_MAX << ' ' << PUGIXML_VERSION << ' ' << PUGI_PARSE_OPTIONS;
+
+    // The image containing the checker, i.e. this library or the
+    // executable it is linked into
+    bool haveImage = false;
+#if defined(HAVE_DLFCN_H) && defined(HAVE_SYS_STAT_H)
+    Dl_info info;
+    struct stat st;
+    if (dladdr(reinterpret_cast<void *>(&makeCacheFormatId), &info)
+        && info.dli_fname
+        && !stat(info.dli_fname, &st)) {
+      inputs << ' ' << info.dli_fname
+             << ' ' << st.st_size
+             << ' ' << st.st_mtime;
+      haveImage = true;
+    }
+#endif
+    if (!haveImage)
+      inputs << ' ' << __DATE__ << ' ' << __TIME__;
+
+    std::string const inputStr = inputs.str();
+    PlanContentKey id;
+    makePlanContentKey(inputStr.data(), inputStr.size(), id);
+    std::string const result = "PLEXIL-CHECK " + digestString(id).substr(0, 16);
+    debugMsg("PlanCheckCache", " format ID " << result
+             << " from " << inputStr);
+    return result;
+  }
+
+  static std::string const &cacheFormatId()
+  {
+    static std::string const sl_formatId = makeCacheFormatId();
+    return sl_formatId;
+  }
+
+  static std::string cacheFileName(PlanContentKey const &key)
+  {
+    std::ostringstream s;
+    s << s_cacheDirectory << '/'
+      << digestString(key).substr(0, 16) << '-' << key.length << ".chk";
+    return s.str();
+  }
+
+  SymbolTable *findCheckedPlan(PlanContentKey const &key)
+  {
+    if (s_cacheDirectory.empty() || !key.length)
+      return nullptr;
+
+    std::string const fname = cacheFileName(key);
+    std::ifstream s(fname.c_str());
+    if (!s)
+      return nullptr;
+
+    // The file name carries only part of the digest, so compare all of it
+    std::string header, digest;
+    uint64_t length = 0;
+    if (!std::getline(s, header) || header != cacheFormatId()
+        || !(s >> digest >> length)
+        || digest != digestString(key) || length != key.length) {
+      debugMsg("PlanCheckCache", " ignoring stale entry " << fname);
+      return nullptr;
+    }
+
+    // A bad entry is a miss; the plan is checked as if it were absent
+    SymbolTable *result = nullptr;
+    try {
+      result = readSymbolTable(s);
+    }
+    catch (...) {
+      result = nullptr;
+    }
+    debugMsg("PlanCheckCache",
+             (result ? " hit " : " malformed entry ") << fname);
+    return result;
+  }
+
+  void storeCheckedPlan(PlanContentKey const &key,
+                        SymbolTable const *symtab)
+  {
+    if (s_cacheDirectory.empty() || !key.length || !symtab)
+      return;
+
+    // Write to a unique temporary name, then rename into place,
+    // so concurrent readers never see a partial entry.
+    static std::atomic<unsigned int> s_serial(0);
+    std::string const fname = cacheFileName(key);
+    std::ostringstream tempName;
+    tempName << fname << ".tmp";
+#ifdef HAVE_UNISTD_H
+    tempName << '.' << getpid();
+#endif
+    tempName << '.' << s_serial++;
+    std::string const tname = tempName.str();
+
+    {
+      std::ofstream s(tname.c_str());
+      if (!s) {
+        debugMsg("PlanCheckCache", " unable to create " << tname);
+        return;
+      }
+      s << cacheFormatId() << '\n'
+        << digestString(key) << ' ' << key.length << '\n';
+      symtab->write(s);
+      if (!s) {
+        s.close();
+        remove(tname.c_str());
+        debugMsg("PlanCheckCache", " error writing " << tname);
+        return;
+      }
+    }
+    if (rename(tname.c_str(), fname.c_str())) {
+      remove(tname.c_str());
+      debugMsg("PlanCheckCache", " unable to rename " << tname);
+      return;
+    }
+    debugMsg("PlanCheckCache", " stored " << fname);
+  }
+
+} // namespace PLEXIL
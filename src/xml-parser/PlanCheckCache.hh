@@ -0,0 +1,100 @@
+/* Copyright (c) 2006-2021, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef PLEXIL_PLAN_CHECK_CACHE_HH
+#define PLEXIL_PLAN_CHECK_CACHE_HH
+
+#include "plexil-stdint.h"
+
+#include <string>
+
+namespace PLEXIL
+{
+  class SymbolTable;
+
+  //
+  // Persistent cache of plan check results
+  //
+  // Checking a plan or library yields a symbol table, and depends only
+  // on the content of the XML file.  When a cache directory is set, the
+  // symbol table of each successfully checked file is saved there, keyed
+  // by a digest of the file content, and later loads of the same content
+  // skip the check.
+  //
+
+  //! Length of a content digest in bytes.
+  constexpr size_t PLAN_DIGEST_LENGTH = 32;
+
+  //! Identifies the content of an XML file by its SHA-256 digest.
+  //! A length of 0 means the content is unknown.
+  struct PlanContentKey
+  {
+    uint64_t length;
+    uint8_t digest[PLAN_DIGEST_LENGTH];
+  };
+
+  /**
+   * @brief Compute the content key of a buffer.
+   * @param data The file contents.
+   * @param length The length in bytes.
+   * @param key The key to set.
+   */
+  extern void makePlanContentKey(void const *data, size_t length,
+                                 PlanContentKey &key);
+
+  /**
+   * @brief Set the directory in which to cache check results.
+   * @param dirname Name of an existing directory; empty disables the cache.
+   * @note Should be called before any plans or libraries are loaded.
+   */
+  extern void setPlanCheckCacheDirectory(std::string const &dirname);
+
+  /**
+   * @brief Get the cache directory.
+   * @return The directory name; empty if the cache is disabled.
+   */
+  extern std::string const &getPlanCheckCacheDirectory();
+
+  /**
+   * @brief Look for a cached check result.
+   * @param key The content key.
+   * @return A new symbol table if found; nullptr otherwise.
+   * @note An entry which cannot be read is treated as absent.
+   */
+  extern SymbolTable *findCheckedPlan(PlanContentKey const &key);
+
+  /**
+   * @brief Save the result of a successful check.
+   * @param key The content key.
+   * @param symtab The symbol table produced by the check.
+   * @note Failure to write the cache is not an error.
+   */
+  extern void storeCheckedPlan(PlanContentKey const &key,
+                               SymbolTable const *symtab);
+
+} // namespace PLEXIL
+
+#endif // PLEXIL_PLAN_CHECK_CACHE_HH
@@ -29,6 +29,10 @@
 
 #include "Debug.hh"
 
+#include <istream>
+#include <iterator> // std::istreambuf_iterator
+#include <ostream>
+#include <sstream>
 #include <stack>
 
 namespace PLEXIL
@@ -348,6 +352,165 @@ namespace PLEXIL
       return it->second;
     }
 
+    //
+    // Serialization
+    //
+    // One symbol per line:
+    //  <kind> <name length> <name> <kind-specific fields>
+    // Commands and lookups carry the return type, the any-parameters flag,
+    // and the parameter types.  Library nodes carry their interface
+    // variables as (name, type, in-out flag).
+    //
+
+    void write(std::ostream &s) const
+    {
+      writeSymbols(s, 'C', m_commandMap);
+      writeSymbols(s, 'L', m_lookupMap);
+      for (SymbolMap::value_type const &entry : m_mutexMap) {
+        s << 'M' << ' ';
+        writeName(s, entry.first);
+        s << '\n';
+      }
+      for (LibraryMap::value_type const &entry : m_libraryMap) {
+        LibraryNodeSymbol const *lib = entry.second;
+        s << 'N' << ' ';
+        writeName(s, entry.first);
+        s << ' ' << lib->m_paramTypeMap.size();
+        for (std::map<std::string, ValueType>::value_type const &param : lib->m_paramTypeMap) {
+          s << ' ';
+          writeName(s, param.first);
+          s << ' ' << (unsigned int) param.second
+            << ' ' << (lib->m_paramInOutMap.find(param.first)->second ? 1 : 0);
+        }
+        s << '\n';
+      }
+      s << 'E' << '\n';
+    }
+
+    // Every length and count is checked against the size of the input,
+    // so that a corrupt entry cannot cause a huge allocation or loop.
+    bool read(std::istream &s, size_t size)
+    {
+      char kind;
+      std::string name;
+      while (s >> kind) {
+        switch (kind) {
+        case 'C':
+        case 'L': {
+          if (!readName(s, size, name))
+            return false;
+          Symbol *sym = (kind == 'C') ? addCommand(name.c_str()) : addLookup(name.c_str());
+          ValueType returnType;
+          unsigned int anyParams;
+          size_t nParams;
+          if (!sym || !readType(s, returnType) || !(s >> anyParams >> nParams)
+              || !countFits(s, size, nParams))
+            return false;
+          sym->setReturnType(returnType);
+          if (anyParams)
+            sym->setAnyParameters();
+          for (size_t i = 0; i < nParams; ++i) {
+            ValueType paramType;
+            if (!readType(s, paramType))
+              return false;
+            sym->addParameterType(paramType);
+          }
+          break;
+        }
+
+        case 'M':
+          if (!readName(s, size, name) || !addMutex(name.c_str()))
+            return false;
+          break;
+
+        case 'N': {
+          size_t nParams;
+          if (!readName(s, size, name) || !(s >> nParams)
+              || !countFits(s, size, nParams))
+            return false;
+          LibraryNodeSymbol *lib = addLibraryNode(name.c_str());
+          if (!lib)
+            return false;
+          for (size_t i = 0; i < nParams; ++i) {
+            ValueType paramType;
+            unsigned int inOut;
+            if (!readName(s, size, name) || !readType(s, paramType) || !(s >> inOut))
+              return false;
+            lib->addParameter(name.c_str(), paramType, inOut != 0);
+          }
+          break;
+        }
+
+        case 'E':
+          return true;
+
+        default:
+          return false;
+        }
+      }
+      return false; // no end marker
+    }
+
+  private:
+
+    static void writeName(std::ostream &s, std::string const &name)
+    {
+      s << name.size() << ' ' << name;
+    }
+
+    // Bytes between the read position and the end of the input
+    static size_t bytesLeft(std::istream &s, size_t size)
+    {
+      std::streamoff pos = s.tellg();
+      if (pos < 0 || (size_t) pos > size)
+        return 0;
+      return size - (size_t) pos;
+    }
+
+    // Each item in a list takes at least two bytes: a space and a digit
+    static bool countFits(std::istream &s, size_t size, size_t count)
+    {
+      return count <= bytesLeft(s, size) / 2;
+    }
+
+    static bool readName(std::istream &s, size_t size, std::string &name)
+    {
+      size_t len;
+      if (!(s >> len) || s.get() != ' ' || len > bytesLeft(s, size))
+        return false;
+      name.resize(len);
+      return len == 0 || s.read(&name[0], len);
+    }
+
+    // Reject codes which are not members of the ValueType enumeration.
+    static bool readType(std::istream &s, ValueType &type)
+    {
+      unsigned int code;
+      if (!(s >> code) || code >= TYPE_MAX)
+        return false;
+      type = (ValueType) code;
+      return type == UNKNOWN_TYPE
+        || isScalarType(type)
+        || isArrayType(type)
+        || type == STATE_TYPE
+        || isInternalType(type);
+    }
+
+    static void writeSymbols(std::ostream &s, char kind, SymbolMap const &map)
+    {
+      for (SymbolMap::value_type const &entry : map) {
+        Symbol const *sym = entry.second;
+        s << kind << ' ';
+        writeName(s, entry.first);
+        s << ' ' << (unsigned int) sym->m_returnType
+          << ' ' << (sym->m_anyParams ? 1 : 0)
+          << ' ' << sym->m_paramTypes.size();
+        for (uint8_t t : sym->m_paramTypes)
+          s << ' ' << (unsigned int) t;
+        s << '\n';
+      }
+    }
+
   };
 
   SymbolTable *makeSymbolTable()
@@ -355,9 +518,25 @@ namespace PLEXIL
     return new SymbolTableImpl();
   }
 
-  static std::stack<SymbolTable *> s_symtabStack;
+  SymbolTable *readSymbolTable(std::istream &s)
+  {
+    // Take the rest of the stream, so its size is known
+    std::string const contents((std::istreambuf_iterator<char>(s)),
+                               std::istreambuf_iterator<char>());
+    std::istringstream in(contents);
+    SymbolTableImpl *result = new SymbolTableImpl();
+    if (!result->read(in, contents.size())) {
+      delete result;
+      return nullptr;
+    }
+    return result;
+  }
+
+  // The symbol table stack is per thread, so that several plans or
+  // libraries may be checked concurrently.
+  static thread_local std::stack<SymbolTable *> s_symtabStack;
 
-  static SymbolTable *s_symbolTable = nullptr;
+  static thread_local SymbolTable *s_symbolTable = nullptr;
 
   void pushSymbolTable(SymbolTable *s)
   {
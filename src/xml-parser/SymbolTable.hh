@@ -30,6 +30,7 @@
 #include "plexil-stdint.h"
 #include "ValueType.hh"
 
+#include <iosfwd>
 #include <map>
 #include <string>
 #include <vector>
@@ -76,6 +77,7 @@ namespace PLEXIL
     bool anyParameters() const;
 
   private:
+    friend class SymbolTableImpl;
 
     std::string m_name;
     std::vector<uint8_t> m_paramTypes;
@@ -106,6 +108,7 @@ namespace PLEXIL
     ValueType parameterValueType(char const *pname);
 
   private:
+    friend class SymbolTableImpl;
 
     std::string m_name;
     std::map<std::string, bool> m_paramInOutMap;
@@ -130,6 +133,9 @@ namespace PLEXIL
     virtual Symbol const *getMutex(char const *name) = 0;
     virtual LibraryNodeSymbol const *getLibraryNode(char const *name) = 0;
 
+    //! Write the contents of this table in the form read by readSymbolTable().
+    virtual void write(std::ostream &s) const = 0;
+
   protected: 
     SymbolTable()
     {
@@ -146,6 +152,11 @@ namespace PLEXIL
 
   extern SymbolTable *makeSymbolTable();
 
+  //! Construct a symbol table from the output of SymbolTable::write().
+  //! Reads to the end of the stream.
+  //! @return The new table; nullptr if the input is malformed.
+  extern SymbolTable *readSymbolTable(std::istream &s);
+
   // Set the current symbol table, saving the old value to restore later.
   extern void pushSymbolTable(SymbolTable *s);
 
@@ -26,7 +26,10 @@
 
 #include "createExpression.hh"
 #include "Debug.hh"
+#include "Error.hh"
+#include "Expression.hh"
 #include "LibraryCallNode.hh"
+#include "NodeVariableMap.hh"
 #include "parseNode.hh"
 #include "parsePlan.hh"
 #include "parser-utils.hh"
@@ -49,6 +52,18 @@ using pugi::node_pcdata;
 namespace PLEXIL
 {
 
+  static LibraryExpansionMode s_expansionMode = EXPAND_AT_LOAD;
+
+  void setLibraryExpansionMode(LibraryExpansionMode mode)
+  {
+    s_expansionMode = mode;
+  }
+
+  LibraryExpansionMode getLibraryExpansionMode()
+  {
+    return s_expansionMode;
+  }
+
   //
   // First pass
   //
@@ -124,6 +139,67 @@ namespace PLEXIL
     node->allocateAliasMap(estimateAliasSpace(callXml));
   }
 
+  //
+  // Deferred expansion
+  //
+
+  // Holds on to the library version current when the call was parsed,
+  // even if the library is later replaced.
+  class DeferredLibraryCall : public LibraryCallExpander
+  {
+  public:
+    DeferredLibraryCall(LibraryPtr const &l)
+      : m_library(l)
+    {
+    }
+
+    virtual ~DeferredLibraryCall() = default;
+
+    virtual bool expand(LibraryCallNode *caller) override
+    {
+      xml_node const plan = m_library->doc->document_element();
+      try {
+        NodeImpl *callee = constructPlan(plan, m_library->symtab, caller);
+        caller->addChild(callee);
+        pushSymbolTable(m_library->symtab);
+        try {
+          finalizeNode(callee, plan.child(NODE_TAG));
+        }
+        catch (...) {
+          popSymbolTable();
+          throw;
+        }
+        popSymbolTable();
+      }
+      catch (ParserException const &exc) {
+        warn("Error expanding LibraryNodeCall node "
+             << caller->getNodeId() << ":\n" << exc.what());
+        return false;
+      }
+      return true;
+    }
+
+  private:
+    LibraryPtr m_library;
+  };
+
+  // The call node's own conditions, variables, and aliases can refer
+  // to the called node by name, which requires it to exist when they are
+  // constructed.  Be conservative and expand such calls at load time.
+  static bool mayReferenceCallee(xml_node const callXml)
+  {
+    xml_node const calleeIdXml = callXml.first_child();
+    char const *calleeName = calleeIdXml.child_value();
+    xml_node const nodeXml = callXml.parent().parent();
+    xml_node const ownIdXml = nodeXml.child(NODEID_TAG);
+    return nodeXml.find_node([&](xml_node n) -> bool
+                             {
+                               return n != calleeIdXml && n != ownIdXml
+                                 && (testTag(NODEID_TAG, n) || testTag(NODEREF_TAG, n))
+                                 && !strcmp(calleeName, n.child_value());
+                             });
+  }
+
   void constructLibraryCall(LibraryCallNode *node, xml_node const callXml)
   {
     assertTrue_1(node);
@@ -131,13 +207,22 @@ namespace PLEXIL
 
     allocateAliases(node, callXml);
 
-    Library const *l = getLibraryNode(callXml.first_child().child_value());
+    LibraryPtr l = getLibraryNode(callXml.first_child().child_value());
     checkParserExceptionWithLocation(l,
                                      callXml,
                                      "Library node "
                                      << callXml.first_child().child_value()
                                      << " not found while expanding LibraryNodeCall node "
                                      << node->getNodeId());
+
+    if (s_expansionMode != EXPAND_AT_LOAD && !mayReferenceCallee(callXml)) {
+      debugMsg("constructLibraryCall",
+               " deferring expansion of " << callXml.first_child().child_value());
+      node->setExpander(new DeferredLibraryCall(l),
+                        s_expansionMode == EXPAND_ON_EXECUTE_AND_RELEASE);
+      return;
+    }
+
     // Construct call
     // Template was checked before it was added to library
     node->addChild(constructPlan(l->doc->document_element(), l->symtab, node));
@@ -161,6 +246,45 @@ namespace PLEXIL
   }
 
   // Second pass
+  // Check the aliases against the called node's interface,
+  // as linking its interface variables would if it were expanded now.
+  static void checkDeferredInterface(LibraryCallNode *node, xml_node const calleeXml)
+  {
+    NodeVariableMap const *aliases = node->getChildVariableMap();
+    for (xml_node const ifaceXml : calleeXml.child(INTERFACE_TAG).children()) {
+      bool isInOut = testTag(INOUT_TAG, ifaceXml);
+      for (xml_node const decl : ifaceXml.children()) {
+        char const *name = decl.child_value(NAME_TAG);
+        Expression *exp = aliases ? aliases->findVariable(name) : nullptr;
+        if (!exp) {
+          checkParserExceptionWithLocation(decl.child(INITIALVAL_TAG),
+                                           decl,
+                                           "Node " << calleeXml.child_value(NODEID_TAG)
+                                           << ": " << (isInOut ? "InOut" : "In")
+                                           << " interface variable \"" << name
+                                           << "\" not found and no default InitialValue provided");
+          continue;
+        }
+        ValueType typ = parseValueType(decl.child_value(TYPE_TAG));
+        if (testTag(DECL_ARRAY_TAG, decl))
+          typ = arrayType(typ);
+        checkParserExceptionWithLocation(typ == exp->valueType(),
+                                         decl,
+                                         "Node " << calleeXml.child_value(NODEID_TAG)
+                                         << ", " << (isInOut ? "InOut" : "In")
+                                         << " interface variable \"" << name
+                                         << "\":\n Declared type is " << valueTypeName(typ)
+                                         << ", but expression of type "
+                                         << valueTypeName(exp->valueType()) << " was provided");
+        checkParserExceptionWithLocation(!isInOut || exp->isAssignable(),
+                                         decl,
+                                         "Node " << calleeXml.child_value(NODEID_TAG)
+                                         << ": InOut interface variable \"" << name
+                                         << "\" is read-only");
+      }
+    }
+  }
+
   void finalizeLibraryCall(LibraryCallNode *node, xml_node const callXml)
   {
     assertTrue_1(node);
@@ -168,11 +292,17 @@ namespace PLEXIL
 
     finalizeAliases(node, callXml);
 
-    Library const *l = getLibraryNode(callXml.first_child().child_value());
+    LibraryPtr l = getLibraryNode(callXml.first_child().child_value());
     assertTrue_2(l,
                  "finalizeLibraryCall: Internal error: can't find library");
     xml_node const calleeXml = l->doc->document_element().child(NODE_TAG);
 
+    if (!node->isExpanded()) {
+      // Expansion deferred until execution
+      checkDeferredInterface(node, calleeXml);
+      return;
+    }
+
     // should never happen, but...
     assertTrue_2(!node->getChildren().empty(),
                  "finalizeLibraryCall: Internal error: LibraryNodeCall node missing called node");
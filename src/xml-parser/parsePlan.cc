@@ -24,17 +24,39 @@
 * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include "plexil-config.h"
+
 #include "Debug.hh"
 #include "NodeImpl.hh"
 #include "parseGlobalDeclarations.hh"
 #include "parseNode.hh"
+#include "parsePlan.hh"
 #include "parser-utils.hh"
 #include "ParserException.hh"
+#include "PlanCheckCache.hh"
 #include "PlexilSchema.hh"
 #include "SymbolTable.hh"
 
 #include "pugixml.hpp"
 
+#include <sstream>
+
+#if defined(HAVE_SYS_STAT_H) && defined(HAVE_FCNTL_H) && defined(HAVE_UNISTD_H)
+#define PLEXIL_READ_XML_FILES 1
+#if defined(HAVE_CERRNO)
+#include <cerrno>
+#elif defined(HAVE_ERRNO_H)
+#include <errno.h>
+#endif
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(HAVE_SYS_MMAN_H)
+#define PLEXIL_MAP_XML_FILES 1
+#include <sys/mman.h>
+#endif
+#endif
+
 using pugi::xml_document;
 using pugi::xml_node;
 using pugi::xml_parse_result;
@@ -64,6 +86,107 @@ namespace PLEXIL
     return doc;
   }
 
+#ifdef PLEXIL_READ_XML_FILES
+
+  static void checkXmlParseResult(xml_document *doc,
+                                  xml_parse_result const &parseResult,
+                                  std::string const &filename)
+  {
+    if (parseResult.status != pugi::status_ok) {
+      delete doc;
+      checkParserException(false,
+                           "Error reading XML file " << filename
+                           << ": " << parseResult.description());
+    }
+  }
+
+  xml_document *readXmlFile(std::string const &filename,
+                            PlanContentKey *key)
+  {
+    debugMsg("readXmlFile", ' ' << filename);
+    if (key)
+      key->length = 0;
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+      if (errno == ENOENT)
+        return nullptr;
+      return loadXmlFile(filename); // let it report the error
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) || !S_ISREG(st.st_mode) || !st.st_size) {
+      close(fd);
+      return loadXmlFile(filename);
+    }
+
+    size_t length = (size_t) st.st_size;
+
+#ifdef PLEXIL_MAP_XML_FILES
+    // Parse straight from the page cache. load_buffer() copies the
+    // text into storage owned by the document, which the in-place
+    // parse needs anyway, so the mapping is only held while parsing.
+    void *addr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr != MAP_FAILED) {
+      close(fd);
+      if (key)
+        makePlanContentKey(addr, length, *key);
+      xml_document *doc = new xml_document;
+      xml_parse_result parseResult = doc->load_buffer(addr, length, PUGI_PARSE_OPTIONS);
+      munmap(addr, length);
+      checkXmlParseResult(doc, parseResult, filename);
+      return doc;
+    }
+    debugMsg("readXmlFile", " unable to map " << filename << ", reading it");
+#endif
+
+    // The document takes ownership of the buffer, so it must come
+    // from pugixml's allocator.  Nothing refers to the file once
+    // it has been read.
+    char *buffer =
+      static_cast<char *>((*pugi::get_memory_allocation_function())(length));
+    if (!buffer) {
+      close(fd);
+      return loadXmlFile(filename);
+    }
+    size_t nread = 0;
+    while (nread < length) {
+      ssize_t n = read(fd, buffer + nread, length - nread);
+      if (n < 0 && errno == EINTR)
+        continue;
+      if (n <= 0)
+        break; // error, or file truncated while reading
+      nread += (size_t) n;
+    }
+    close(fd);
+    if (nread < length) {
+      (*pugi::get_memory_deallocation_function())(buffer);
+      debugMsg("readXmlFile", " short read, reloading " << filename);
+      return loadXmlFile(filename);
+    }
+
+    // Must precede parsing, which modifies the buffer
+    if (key)
+      makePlanContentKey(buffer, length, *key);
+
+    xml_document *doc = new xml_document;
+    xml_parse_result parseResult =
+      doc->load_buffer_inplace_own(buffer, length, PUGI_PARSE_OPTIONS);
+    checkXmlParseResult(doc, parseResult, filename); // deleting doc frees the buffer
+    return doc;
+  }
+
+#else
+
+  xml_document *readXmlFile(std::string const &filename,
+                            PlanContentKey *key)
+  {
+    if (key)
+      key->length = 0;
+    return loadXmlFile(filename);
+  }
+
+#endif // PLEXIL_READ_XML_FILES
+
   // First pass: surface check of XML
   SymbolTable *checkPlan(xml_node const xml)
   {
@@ -99,6 +222,16 @@ namespace PLEXIL
     return result;
   }
 
+  SymbolTable *checkPlan(xml_node const xml, PlanContentKey const &key)
+  {
+    SymbolTable *result = findCheckedPlan(key);
+    if (result)
+      return result;
+    result = checkPlan(xml);
+    storeCheckedPlan(key, result);
+    return result;
+  }
+
   NodeImpl *constructPlan(xml_node const xml, SymbolTable *symtab, NodeImpl *parent)
   {
     xml_node const root = xml.child(NODE_TAG);
@@ -128,10 +261,23 @@ namespace PLEXIL
   }
 
   NodeImpl *parsePlan(xml_node const xml)
+  {
+    // The source file is not known here, so key on the serialized plan
+    PlanContentKey key = {};
+    if (!getPlanCheckCacheDirectory().empty()) {
+      std::ostringstream s;
+      xml.print(s, "", pugi::format_raw);
+      std::string const content = s.str();
+      makePlanContentKey(content.data(), content.size(), key);
+    }
+    return parsePlan(xml, key);
+  }
+
+  NodeImpl *parsePlan(xml_node const xml, PlanContentKey const &key)
   {
     debugMsg("parsePlan", "entered");
     // Perform surface checks & log global symbols
-    SymbolTable *symtab = checkPlan(xml);
+    SymbolTable *symtab = checkPlan(xml, key);
     NodeImpl *result = nullptr;
     result = constructPlan(xml, symtab, nullptr); // can throw ParserException
     pushSymbolTable(symtab);
@@ -40,19 +40,51 @@ namespace PLEXIL
 {
   class NodeImpl;
   class SymbolTable;
+  struct PlanContentKey;
 
   extern unsigned int const PUGI_PARSE_OPTIONS;
 
   extern pugi::xml_document *loadXmlFile(std::string const &filename);
 
+  /**
+   * @brief Load an XML file through a read-only mapping of it, or by
+   *        reading it into a buffer where it cannot be mapped.
+   * @param filename The file name.
+   * @param key If not null, set to the content key of the file;
+   *        its length is 0 if the file was read by loadXmlFile().
+   * @return The document; nullptr if the file was not found.
+   * @note The mapping is released before returning; the document
+   *       does not refer to the file once loaded.
+   * @note Falls back to loadXmlFile() where POSIX I/O is not available.
+   */
+  extern pugi::xml_document *readXmlFile(std::string const &filename,
+                                         PlanContentKey *key = nullptr);
+
   extern SymbolTable *checkPlan(pugi::xml_node const xml);
 
+  /**
+   * As above, but use the plan check cache if the content is known.
+   */
+  extern SymbolTable *checkPlan(pugi::xml_node const xml,
+                                PlanContentKey const &key);
+
   /**
    * Constructs but does not finalize the node (for library calls).
    */
   extern NodeImpl *constructPlan(pugi::xml_node const xml, SymbolTable *symtab, NodeImpl *parent);
 
+  /**
+   * @brief Check and construct a plan.
+   * @note Uses the plan check cache, if enabled, keyed on the
+   *       serialized XML.
+   */
   extern NodeImpl *parsePlan(pugi::xml_node const xml);
+
+  /**
+   * As above, but keyed on the content of the file the plan was read from.
+   */
+  extern NodeImpl *parsePlan(pugi::xml_node const xml,
+                             PlanContentKey const &key);
 }
 
 #endif // PLEXIL_NEW_XML_PARSER
@@ -24,18 +24,28 @@
 * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include "plexil-config.h"
+
 #include "planLibrary.hh"
 
 #include "lifecycle-utils.h"
-#include "map-utils.hh"
 #include "parsePlan.hh"
 #include "ParserException.hh"
+#include "PlanCheckCache.hh"
 #include "PlexilSchema.hh"
-#include "SimpleMap.hh"
 #include "SymbolTable.hh"
 
 #include "pugixml.hpp"
 
+#include <map>
+
+#ifdef PLEXIL_WITH_THREADS
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#endif
+
 using pugi::xml_document;
 using pugi::xml_node;
 using std::string;
@@ -50,10 +60,22 @@ namespace PLEXIL
   // List of library directories to search
   static vector<string> s_librarySearchPaths;
 
-  // Place to store library nodes and their global contexts
-  typedef SimpleMap<string, Library> LibraryMap;
+  // Place to store library nodes and their global contexts.
+  // Replacing a library swaps the pointer; readers holding the old
+  // version keep it alive until they let go of it.
+  typedef std::map<string, LibraryPtr, std::less<> > LibraryMap;
   static LibraryMap s_libraryMap;
 
+#ifdef PLEXIL_WITH_THREADS
+  // Guards the library map and the search path.
+  // Never held while a plan is being checked, as checking a library
+  // may load other libraries.
+  static std::mutex s_libraryMutex;
+#define LIBRARY_GUARD std::lock_guard<std::mutex> guard(s_libraryMutex)
+#else
+#define LIBRARY_GUARD
+#endif
+
   vector<string> const &getLibraryPaths()
   {
     return s_librarySearchPaths;
@@ -61,45 +83,61 @@ namespace PLEXIL
 
   void appendLibraryPath(string const &dirname)
   {
+    LIBRARY_GUARD;
     s_librarySearchPaths.push_back(dirname);
   }
 
   void prependLibraryPath(string const &dirname)
   {
+    LIBRARY_GUARD;
     s_librarySearchPaths.insert(s_librarySearchPaths.begin(), dirname);
   }
 
   void setLibraryPaths(std::vector<std::string> const &paths)
   {
+    LIBRARY_GUARD;
     s_librarySearchPaths = paths;
   }
 
+  Library::~Library()
+  {
+    delete doc;
+    delete symtab;
+  }
+
   // Call at exit
   static void cleanLibraryMap()
   {
-    for (LibraryMap::iterator it = s_libraryMap.begin(); it != s_libraryMap.end(); ++it) {
-      Library &l = it->second;
-      delete l.doc;
-      l.doc = nullptr;
-      delete l.symtab;
-      l.symtab = nullptr;
+    LibraryMap temp;
+    {
+      LIBRARY_GUARD;
+      temp.swap(s_libraryMap);
     }
-    s_libraryMap.clear();
+    // Libraries are deleted here, outside the lock,
+    // unless someone else still holds them
   }
 
   // Internal function
-  static xml_document *loadLibraryFile(string const &filename)
+  static xml_document *loadLibraryFile(string const &filename,
+                                       PlanContentKey *key)
   {
     // Check current working directory first
-    xml_document *result = loadXmlFile(filename);
+    xml_document *result = readXmlFile(filename, key);
     if (result)
       return result;
 
+    // Copy the path, so another thread can modify it while we search
+    vector<string> paths;
+    {
+      LIBRARY_GUARD;
+      paths = s_librarySearchPaths;
+    }
+
     // Find the first occurrence of the library in this path
-    vector<string>::const_iterator it = s_librarySearchPaths.begin();
-    while (!result && it != s_librarySearchPaths.end()) {
+    vector<string>::const_iterator it = paths.begin();
+    while (!result && it != paths.end()) {
       string candidateFile = *it + "/" + filename;
-      result = loadXmlFile(candidateFile);
+      result = readXmlFile(candidateFile, key);
       if (result)
         return result;
       ++it;
@@ -107,68 +145,46 @@ namespace PLEXIL
     return nullptr;
   }
 
-  // name could be node name, file name w/ or w/o directory, w/ w/o .plx
-  Library const *loadLibraryNode(char const *name)
-  {
-    string nodeName = name;
-    string fname = name;
-    size_t pos = fname.rfind(".plx");
-    if (pos == string::npos)
-      fname += ".plx";
-    else
-      nodeName = nodeName.substr(0, pos);
-    pos = nodeName.find_last_of("/\\");
-    if (pos != string::npos)
-      nodeName = nodeName.substr(++pos);
-
-    xml_document *doc = loadLibraryFile(fname);
-    if (!doc)
-      return nullptr;
-    
-    // Check whether document actually contains the named plan
-    char const *nodeId = doc->document_element().child(NODE_TAG).child_value(NODEID_TAG);
-    if (nodeName != nodeId) {
-      warn("Unable to load library node \"" << nodeName
-           << "\": file " << fname << " does not contain " << nodeId);
-      delete doc;
-      return nullptr;
-    }
-
-    return loadLibraryDocument(doc);
-  }
-
   // Internal fn
-  static Library *findLibraryNode(char const *name)
+  // Caller must hold the library mutex
+  static LibraryPtr findLibraryNode(char const *name)
   {
-    LibraryMap::iterator it = s_libraryMap.find<char const *, CStringComparator>(name);
+    LibraryMap::iterator it = s_libraryMap.find(name);
     if (it != s_libraryMap.end())
-      return &it->second;
+      return it->second;
     else
-      return nullptr;
+      return LibraryPtr();
   }
 
-  Library const *loadLibraryDocument(xml_document *doc)
+  // Internal function
+  static LibraryPtr addLibrary(xml_document *doc,
+                               PlanContentKey const &key,
+                               bool replace)
   {
     // Check if already loaded
     xml_node const plan = doc->document_element();
     char const *nodeId = plan.child(NODE_TAG).child_value(NODEID_TAG);
-    Library *l = findLibraryNode(nodeId);
-
-    if (l && plan == l->doc->document_element()) {
-      // Same plan, no need to go any further
-      delete doc;
-      return l;
+    {
+      LIBRARY_GUARD;
+      LibraryPtr l = findLibraryNode(nodeId);
+      if (l && (!replace || plan == l->doc->document_element())) {
+        // Same plan, or caller is content with the existing version
+        delete doc;
+        return l;
+      }
     }
 
+    // Check the plan without holding the lock,
+    // as it may need to load other libraries.
     SymbolTable *symtab = nullptr;
     try {
-      symtab = checkPlan(plan);
+      symtab = checkPlan(plan, key);
     }
     catch (ParserException const &exc) {
-      delete doc;
       warn("Unable to load library node \"" << nodeId << "\": "
            << exc.what());
-      return nullptr;
+      delete doc;
+      return LibraryPtr();
     }
     catch (...) {
       delete doc;
@@ -176,13 +192,16 @@ namespace PLEXIL
     }
 
     // Success!
-    if (l) {
+    LibraryPtr result = std::make_shared<Library const>(doc, symtab);
+    LibraryPtr previous; // if replaced, released outside the lock
+    LIBRARY_GUARD;
+    LibraryPtr &entry = s_libraryMap[nodeId];
+    if (entry) {
+      if (!replace)
+        // Another thread loaded it while we were checking
+        return entry; // result deletes the new version
       // Replace previous version
-      delete l->doc;
-      delete l->symtab;
-      l->doc = doc;
-      l->symtab = symtab;
-      return l;
+      previous.swap(entry);
     }
     else {
       // If this is first library added, set up the cleanup function
@@ -191,28 +210,122 @@ namespace PLEXIL
         plexilAddFinalizer(&cleanLibraryMap);
         sl_inited = true;
       }
-      
-      std::string nodeStr = nodeId;
-      s_libraryMap[nodeStr] = Library(doc, symtab);
-      return &s_libraryMap[nodeStr];
     }
+    entry = result;
+    return result;
+  }
+
+  // Internal function
+  // name could be node name, file name w/ or w/o directory, w/ w/o .plx
+  static LibraryPtr loadLibraryNodeImpl(char const *name, bool replace)
+  {
+    string nodeName = name;
+    string fname = name;
+    size_t pos = fname.rfind(".plx");
+    if (pos == string::npos)
+      fname += ".plx";
+    else
+      nodeName = nodeName.substr(0, pos);
+    pos = nodeName.find_last_of("/\\");
+    if (pos != string::npos)
+      nodeName = nodeName.substr(++pos);
+
+    PlanContentKey key = {};
+    xml_document *doc =
+      loadLibraryFile(fname,
+                      getPlanCheckCacheDirectory().empty() ? nullptr : &key);
+    if (!doc)
+      return LibraryPtr();
+    
+    // Check whether document actually contains the named plan
+    char const *nodeId = doc->document_element().child(NODE_TAG).child_value(NODEID_TAG);
+    if (nodeName != nodeId) {
+      warn("Unable to load library node \"" << nodeName
+           << "\": file " << fname << " does not contain " << nodeId);
+      delete doc;
+      return LibraryPtr();
+    }
+
+    return addLibrary(doc, key, replace);
+  }
+
+  LibraryPtr loadLibraryNode(char const *name)
+  {
+    return loadLibraryNodeImpl(name, true);
+  }
+
+  LibraryPtr loadLibraryDocument(xml_document *doc, bool replace)
+  {
+    PlanContentKey const noKey = {};
+    return addLibrary(doc, noKey, replace);
   }
 
   bool isLibraryLoaded(char const *name)
   {
-    LibraryMap::iterator it = s_libraryMap.find<char const *, CStringComparator>(name);
-    return it != s_libraryMap.end();
+    LIBRARY_GUARD;
+    return s_libraryMap.find(name) != s_libraryMap.end();
   }
 
-  Library const *getLibraryNode(char const *name, bool loadIfNotFound)
+  LibraryPtr getLibraryNode(char const *name, bool loadIfNotFound)
   {
-    LibraryMap::iterator it = s_libraryMap.find<char const *, CStringComparator>(name);
-    if (it != s_libraryMap.end())
-      return &it->second;
-    else if (loadIfNotFound)
-      return loadLibraryNode(name);
+    {
+      LIBRARY_GUARD;
+      LibraryMap::iterator it = s_libraryMap.find(name);
+      if (it != s_libraryMap.end())
+        return it->second;
+    }
+    if (loadIfNotFound)
+      return loadLibraryNodeImpl(name, false);
     else
-      return nullptr;
+      return LibraryPtr();
+  }
+
+  bool loadLibraryNodes(vector<string> const &names, size_t nThreads)
+  {
+    size_t const n = names.size();
+#ifdef PLEXIL_WITH_THREADS
+    if (nThreads > n)
+      nThreads = n;
+    if (nThreads > 1) {
+      std::atomic<size_t> next(0);
+      std::atomic<bool> ok(true);
+      std::exception_ptr firstError;
+      std::mutex errorMutex;
+
+      auto worker = [&]() {
+        size_t i;
+        while ((i = next++) < n) {
+          try {
+            if (!getLibraryNode(names[i].c_str(), true))
+              ok = false;
+          }
+          catch (...) {
+            std::lock_guard<std::mutex> g(errorMutex);
+            if (!firstError)
+              firstError = std::current_exception();
+            ok = false;
+          }
+        }
+      };
+
+      vector<std::thread> threads;
+      threads.reserve(nThreads - 1);
+      for (size_t t = 1; t < nThreads; ++t)
+        threads.emplace_back(worker);
+      worker();
+      for (std::thread &t : threads)
+        t.join();
+
+      if (firstError)
+        std::rethrow_exception(firstError);
+      return ok;
+    }
+#endif
+    bool result = true;
+    for (size_t i = 0; i < n; ++i)
+      if (!getLibraryNode(names[i].c_str(), true))
+        result = false;
+    return result;
   }
 
 } // namespace PLEXIL
@@ -27,6 +27,7 @@
 #ifndef PLEXIL_PLAN_LIBRARY_HH
 #define PLEXIL_PLAN_LIBRARY_HH
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -41,21 +42,35 @@ namespace PLEXIL
 
   // A Library consists of a pre-checked XML document
   // and the symbol table generated by the check.
+  // A Library owns both, and is never modified once published.
   struct Library {
     pugi::xml_document *doc;
     SymbolTable *symtab;
 
-    Library()
-      : doc(nullptr), symtab(nullptr)
-    {}
     Library(pugi::xml_document *d, SymbolTable *s)
       : doc(d), symtab(s)
     {}
+    ~Library();
+
+  private:
+    Library(Library const &) = delete;
+    Library(Library &&) = delete;
+    Library &operator=(Library const &) = delete;
+    Library &operator=(Library &&) = delete;
   };
 
+  using LibraryPtr = std::shared_ptr<Library const>;
+
+  //
+  // The library registry may be used from several threads at once.
+  // Replacing a library publishes a new Library; holders of the
+  // previous version keep it alive until they release it.
+  //
+
   /**
    * @brief Get the current library search path.
    * @return The path.
+   * @note Not safe to call while another thread is modifying the path.
    */
   extern std::vector<std::string> const & getLibraryPaths();
   
@@ -88,26 +103,68 @@ namespace PLEXIL
    * @brief Return the named Library, if found.
    * @param name The name of the library sought.
    * @param loadIfNotFound When true, attempt to load the named library from a file.
-   * @return Pointer to the Library descriptor; nullptr if not found.
+   * @return Shared pointer to the Library; null if not found.
    */
-  extern Library const *getLibraryNode(char const *name,
-                                       bool loadIfNotFound = true);
+  extern LibraryPtr getLibraryNode(char const *name,
+                                   bool loadIfNotFound = true);
 
   /**
    * @brief Load the requested library node from a file,
    *        using the current library path.
+   *        Library files are read into a buffer and parsed in place where possible.
    * @param nodeName Name of the library to load.
-   * @return Pointer to the requested Library, or nullptr.
+   * @return Shared pointer to the requested Library; null if not loaded.
    */
-  extern Library const *loadLibraryNode(char const *nodeName);
+  extern LibraryPtr loadLibraryNode(char const *nodeName);
 
   /**
    * @brief Load the library node definition contained in the given XML document.
    * @param Pointer to the XML document.
-   * @return The Library if successful, nullptr otherwise.
+   * @param replace If true, replace any existing library of the same name;
+   *                if false, return the existing library instead.
+   * @return The Library if successful, null otherwise.
    * @note Ownership of the document is transferred in this call.
    */
-  extern Library const *loadLibraryDocument(pugi::xml_document *doc);
+  extern LibraryPtr loadLibraryDocument(pugi::xml_document *doc,
+                                        bool replace = true);
+
+  //
+  // Library call expansion
+  //
+
+  enum LibraryExpansionMode {
+    EXPAND_AT_LOAD = 0,           //!< Construct called nodes with the plan (default)
+    EXPAND_ON_EXECUTE,            //!< Construct a called node when its caller first executes
+    EXPAND_ON_EXECUTE_AND_RELEASE //!< As above, and delete it when the caller is reset
+  };
+
+  /**
+   * @brief Choose when LibraryNodeCall nodes construct their called nodes.
+   * @param mode The mode.
+   * @note Applies to plans and libraries parsed after the call.
+   * @note A call whose own conditions, variables, or aliases refer to
+   *       the called node is always expanded at load.
+   */
+  extern void setLibraryExpansionMode(LibraryExpansionMode mode);
+
+  /**
+   * @brief Get the library call expansion mode.
+   * @return The mode.
+   */
+  extern LibraryExpansionMode getLibraryExpansionMode();
+
+  /**
+   * @brief Ensure that all the named libraries are loaded,
+   *        using up to the given number of threads.
+   * @param names Names of the libraries to load.
+   * @param nThreads Maximum number of threads to use.
+   * @return true if all libraries were found and loaded, false otherwise.
+   * @note Libraries which are already loaded are not reloaded.
+   * @note If loading any library throws an exception, the first such
+   *       exception is rethrown after all threads have finished.
+   */
+  extern bool loadLibraryNodes(std::vector<std::string> const &names,
+                               size_t nThreads);
 
 } // namespace PLEXIL
 
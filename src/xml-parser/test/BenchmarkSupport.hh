@@ -0,0 +1,101 @@
+/* Copyright (c) 2006-2021, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef PLEXIL_BENCHMARK_SUPPORT_HH
+#define PLEXIL_BENCHMARK_SUPPORT_HH
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#if defined(HAVE_CSTDDEF)
+#include <cstddef> // size_t
+#elif defined(HAVE_STDDEF_H)
+#include <stddef.h> // size_t
+#endif
+
+//
+// Minimal timing harness for the core-benchmark executable.
+//
+
+//! Global benchmark parameters, set from the command line.
+struct BenchmarkOptions
+{
+  size_t iterations;   //!< Base iteration count for microbenchmarks.
+  size_t planWidth;    //!< Children per list node in synthetic plans.
+  size_t planDepth;    //!< Levels of list nodes in synthetic plans.
+  size_t threads;      //!< Condition evaluation threads for exec benchmarks.
+  bool groupTransitions; //!< Group exec benchmark transitions by node type.
+  std::string filter;  //!< If not empty, run only benchmarks whose name contains this.
+};
+
+extern BenchmarkOptions g_benchmarkOptions;
+
+//! Sink for computed results, so the optimizer can't discard the work.
+extern volatile size_t g_benchmarkSink;
+
+//! Returns true if the named benchmark was selected on the command line.
+inline bool benchmarkSelected(std::string const &name)
+{
+  return g_benchmarkOptions.filter.empty()
+    || name.find(g_benchmarkOptions.filter) != std::string::npos;
+}
+
+//! Print one line of benchmark results.
+inline void reportBenchmark(std::string const &name,
+                            size_t iterations,
+                            std::chrono::steady_clock::duration elapsed)
+{
+  double nsec =
+    std::chrono::duration_cast<std::chrono::duration<double, std::nano> >(elapsed).count();
+  double perOp = iterations ? nsec / iterations : 0.0;
+  double opsPerSec = nsec > 0.0 ? iterations * 1.0e9 / nsec : 0.0;
+  std::cout << std::left << std::setw(52) << name << std::right
+            << std::setw(12) << iterations << " iter "
+            << std::fixed << std::setprecision(1)
+            << std::setw(12) << perOp << " ns/op "
+            << std::setprecision(0)
+            << std::setw(14) << opsPerSec << " op/s"
+            << std::defaultfloat << std::endl;
+}
+
+//! Time 'iterations' calls to fn(i) and report the result.
+//! @param name Display name of the benchmark.
+//! @param iterations Number of times to call fn.
+//! @param fn Callable taking a size_t loop index.
+template <typename F>
+void runBenchmark(std::string const &name, size_t iterations, F fn)
+{
+  if (!benchmarkSelected(name))
+    return;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; ++i)
+    fn(i);
+  reportBenchmark(name, iterations, std::chrono::steady_clock::now() - start);
+}
+
+#endif // PLEXIL_BENCHMARK_SUPPORT_HH
@@ -0,0 +1,155 @@
+/* Copyright (c) 2006-2021, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+//
+// Microbenchmarks for the expression, interface, and exec core
+//
+
+#include "plexil-config.h"
+
+#include "BenchmarkSupport.hh"
+#include "DebugMessage.hh"
+#include "Error.hh"
+#include "ParserException.hh"
+#include "lifecycle-utils.h"
+
+#include <fstream>
+
+#if defined(HAVE_CSTDLIB)
+#include <cstdlib>
+#elif defined(HAVE_STDLIB_H)
+#include <stdlib.h>
+#endif
+
+#if defined(HAVE_CSTRING)
+#include <cstring>
+#elif defined(HAVE_STRING_H)
+#include <string.h>
+#endif
+
+BenchmarkOptions g_benchmarkOptions = {1000000, 10, 3, 1, false, std::string()};
+
+volatile size_t g_benchmarkSink = 0;
+
+// Declarations of benchmark suites
+extern void exprBenchmarks();
+extern void valueBenchmarks();
+extern void intfcBenchmarks();
+extern void queueBenchmarks();
+extern void execBenchmarks();
+
+static void usage()
+{
+  std::cout << "Usage: core-benchmark [options]\n"
+            << " Options:\n"
+            << "  -h               Display this message and exit\n"
+            << "  -d <debug file>  Use debug-file as debug message config (default Debug.cfg)\n"
+            << "  -n <number>      Base iteration count for microbenchmarks (default 1000000)\n"
+            << "  -w <number>      Children per list node in synthetic plans (default 10)\n"
+            << "  -D <number>      Depth of list nodes in synthetic plans (default 3)\n"
+            << "  -j <number>      Condition evaluation threads for exec benchmarks (default 1)\n"
+            << "  -g               Group exec benchmark transitions by node type\n"
+            << "  -f <string>      Run only benchmarks whose names contain <string>\n"
+            << std::endl;
+}
+
+static bool parseCount(char const *arg, size_t &result)
+{
+  long n = atol(arg);
+  if (n <= 0)
+    return false;
+  result = (size_t) n;
+  return true;
+}
+
+int main(int argc, char *argv[])
+{
+  std::string debugConfig("Debug.cfg");
+
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "-h")) {
+      usage();
+      return 0;
+    }
+    if (!strcmp(argv[i], "-g")) {
+      g_benchmarkOptions.groupTransitions = true;
+      continue;
+    }
+    if (i + 1 >= argc) {
+      std::cerr << "Missing value for option " << argv[i] << std::endl;
+      usage();
+      return 1;
+    }
+    bool ok = true;
+    if (!strcmp(argv[i], "-d"))
+      debugConfig = argv[++i];
+    else if (!strcmp(argv[i], "-n"))
+      ok = parseCount(argv[++i], g_benchmarkOptions.iterations);
+    else if (!strcmp(argv[i], "-w"))
+      ok = parseCount(argv[++i], g_benchmarkOptions.planWidth);
+    else if (!strcmp(argv[i], "-D"))
+      ok = parseCount(argv[++i], g_benchmarkOptions.planDepth);
+    else if (!strcmp(argv[i], "-j"))
+      ok = parseCount(argv[++i], g_benchmarkOptions.threads);
+    else if (!strcmp(argv[i], "-f"))
+      g_benchmarkOptions.filter = argv[++i];
+    else {
+      std::cerr << "Unknown option " << argv[i] << std::endl;
+      usage();
+      return 1;
+    }
+    if (!ok) {
+      std::cerr << "Option " << argv[i - 1] << " value out of range or invalid" << std::endl;
+      usage();
+      return 1;
+    }
+  }
+
+  std::ifstream config(debugConfig.c_str());
+  if (config.good())
+    PLEXIL::readDebugConfigStream(config);
+
+  try {
+    PLEXIL::Error::doThrowExceptions();
+
+    exprBenchmarks();
+    valueBenchmarks();
+    queueBenchmarks();
+    intfcBenchmarks();
+    execBenchmarks();
+  }
+  catch (PLEXIL::ParserException const &e) {
+    std::cerr << "Aborting benchmark due to parser exception:\n" << e.what() << std::endl;
+    return 1;
+  }
+  catch (PLEXIL::Error const &e) {
+    std::cerr << "Aborting benchmark due to error:\n" << e << std::endl;
+    return 1;
+  }
+
+  plexilRunFinalizers();
+  return 0;
+}
@@ -0,0 +1,183 @@
+/* Copyright (c) 2006-2021, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+//
+// Benchmarks for PlexilExec::step() on synthetic plans
+//
+
+#include "BenchmarkSupport.hh"
+#include "Dispatcher.hh"
+#include "Error.hh"
+#include "NodeImpl.hh"
+#include "PlexilExec.hh"
+#include "parsePlan.hh"
+
+#include "pugixml.hpp"
+
+using namespace PLEXIL;
+
+namespace
+{
+
+  //
+  // Dispatcher which ignores everything.
+  // The synthetic plans contain no commands, lookups, or updates.
+  //
+
+  class NullDispatcher final : public Dispatcher
+  {
+  public:
+    NullDispatcher() = default;
+    virtual ~NullDispatcher() = default;
+
+    virtual void lookupNow(State const & /* state */,
+                           LookupReceiver * /* receiver */) override {}
+    virtual void setThresholds(const State & /* state */,
+                               Real /* hi */, Real /* lo */) override {}
+    virtual void setThresholds(const State & /* state */,
+                               Integer /* hi */, Integer /* lo */) override {}
+    virtual void clearThresholds(const State & /* state */) override {}
+    virtual void executeCommand(Command * /* cmd */) override {}
+    virtual void reportCommandArbitrationFailure(Command * /* cmd */) override {}
+    virtual void invokeAbort(Command * /* cmd */) override {}
+    virtual void executeUpdate(Update * /* update */) override {}
+  };
+
+  //
+  // Synthetic plan construction
+  //
+
+  void addIntegerDeclaration(pugi::xml_node node, char const *name)
+  {
+    pugi::xml_node decl =
+      node.append_child("VariableDeclarations").append_child("DeclareVariable");
+    decl.append_child("Name").append_child(pugi::node_pcdata).set_value(name);
+    decl.append_child("Type").append_child(pugi::node_pcdata).set_value("Integer");
+    decl.append_child("InitialValue").append_child("IntegerValue")
+      .append_child(pugi::node_pcdata).set_value("0");
+  }
+
+  // Leaf node: Assignment node incrementing its own local variable.
+  void addAssignmentNode(pugi::xml_node parent, std::string const &id)
+  {
+    pugi::xml_node node = parent.append_child("Node");
+    node.append_attribute("NodeType").set_value("Assignment");
+    node.append_child("NodeId").append_child(pugi::node_pcdata).set_value(id.c_str());
+    addIntegerDeclaration(node, "x");
+    pugi::xml_node assn = node.append_child("NodeBody").append_child("Assignment");
+    assn.append_child("IntegerVariable").append_child(pugi::node_pcdata).set_value("x");
+    pugi::xml_node add = assn.append_child("NumericRHS").append_child("ADD");
+    add.append_child("IntegerVariable").append_child(pugi::node_pcdata).set_value("x");
+    add.append_child("IntegerValue").append_child(pugi::node_pcdata).set_value("1");
+  }
+
+  // Interior node: NodeList with 'width' children, 'depth' levels deep.
+  void addListNode(pugi::xml_node parent, std::string const &id,
+                   size_t width, size_t depth)
+  {
+    if (!depth) {
+      addAssignmentNode(parent, id);
+      return;
+    }
+    pugi::xml_node node = parent.append_child("Node");
+    node.append_attribute("NodeType").set_value("NodeList");
+    node.append_child("NodeId").append_child(pugi::node_pcdata).set_value(id.c_str());
+    pugi::xml_node list = node.append_child("NodeBody").append_child("NodeList");
+    for (size_t i = 0; i < width; ++i)
+      addListNode(list, id + '_' + std::to_string(i), width, depth - 1);
+  }
+
+  size_t planNodeCount(size_t width, size_t depth)
+  {
+    size_t result = 1;
+    size_t levelCount = 1;
+    for (size_t i = 0; i < depth; ++i) {
+      levelCount *= width;
+      result += levelCount;
+    }
+    return result;
+  }
+
+  void execStepBenchmark(size_t width, size_t depth, size_t threads, bool group)
+  {
+    std::string suffix = " " + std::to_string(width) + 'x' + std::to_string(depth)
+      + " (" + std::to_string(planNodeCount(width, depth)) + " nodes)";
+    if (threads > 1)
+      suffix += " -j" + std::to_string(threads);
+    if (group)
+      suffix += " -g";
+    if (!benchmarkSelected("parsePlan" + suffix)
+        && !benchmarkSelected("PlexilExec::step" + suffix))
+      return;
+
+    pugi::xml_document doc;
+    addListNode(doc.append_child("PlexilPlan"), "Root", width, depth);
+
+    NullDispatcher dispatcher;
+    g_dispatcher = &dispatcher;
+    g_exec = makePlexilExec();
+    g_exec->setDispatcher(&dispatcher);
+    assertTrueMsg(g_exec->setConditionEvaluationThreads(threads),
+                  "execStepBenchmark: parallel condition evaluation not available");
+    g_exec->setTransitionBatching(group);
+
+    size_t const runs = 10;
+    size_t macroSteps = 0;
+    std::chrono::steady_clock::duration loadTime(0), stepTime(0);
+    double now = 0.0;
+    for (size_t i = 0; i < runs; ++i) {
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      NodeImpl *root = parsePlan(doc.document_element());
+      g_exec->addPlan(root);
+      std::chrono::steady_clock::time_point ready = std::chrono::steady_clock::now();
+      loadTime += ready - start;
+
+      do {
+        g_exec->step(now += 1.0);
+        ++macroSteps;
+      } while (g_exec->needsStep());
+      stepTime += std::chrono::steady_clock::now() - ready;
+
+      assertTrueMsg(g_exec->allPlansFinished(),
+                    "execStepBenchmark: plan did not finish");
+      g_exec->deleteFinishedPlans();
+    }
+
+    reportBenchmark("parsePlan" + suffix, runs, loadTime);
+    reportBenchmark("PlexilExec::step" + suffix, macroSteps, stepTime);
+
+    delete g_exec;
+    g_exec = nullptr;
+    g_dispatcher = nullptr;
+  }
+
+} // anonymous namespace
+
+void execBenchmarks()
+{
+  execStepBenchmark(g_benchmarkOptions.planWidth, g_benchmarkOptions.planDepth,
+                    g_benchmarkOptions.threads, g_benchmarkOptions.groupTransitions);
+}
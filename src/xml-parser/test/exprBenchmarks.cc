@@ -0,0 +1,183 @@
+/* Copyright (c) 2006-2021, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+//
+// Benchmarks for the expression notification graph and operator evaluation
+//
+
+#include "ArithmeticOperators.hh"
+#include "BenchmarkSupport.hh"
+#include "Comparisons.hh"
+#include "ExpressionListener.hh"
+#include "Function.hh"
+#include "UserVariable.hh"
+
+#include <memory>
+#include <vector>
+
+using namespace PLEXIL;
+
+namespace
+{
+
+  class CountingListener final : public ExpressionListener
+  {
+  public:
+    CountingListener() = default;
+    ~CountingListener() = default;
+
+    virtual void notifyChanged() override
+    {
+      ++count;
+    }
+
+    size_t count = 0;
+  };
+
+  void publishChangeBenchmark(size_t fanout)
+  {
+    IntegerVariable var;
+    std::vector<std::unique_ptr<CountingListener> > listeners;
+    listeners.reserve(fanout);
+    for (size_t i = 0; i < fanout; ++i) {
+      listeners.emplace_back(new CountingListener());
+      var.addListener(listeners.back().get());
+    }
+    var.activate();
+
+    runBenchmark("Notifier::publishChange fanout " + std::to_string(fanout),
+                 g_benchmarkOptions.iterations,
+                 [&var] (size_t) { var.publishChange(); });
+
+    size_t total = 0;
+    for (std::unique_ptr<CountingListener> const &l : listeners) {
+      total += l->count;
+      var.removeListener(l.get());
+    }
+    g_benchmarkSink = total;
+    var.deactivate();
+  }
+
+  //
+  // Evaluate a binary function of two variables, changing one
+  // argument each iteration so nothing can be hoisted out of the loop.
+  //
+
+  template <typename ARG, typename RESULT>
+  void binaryOperatorBenchmark(char const *typeName,
+                               Operator const *op,
+                               ARG a0,
+                               ARG b0)
+  {
+    UserVariable<ARG> a(a0);
+    UserVariable<ARG> b(b0);
+    std::unique_ptr<Function> fn(makeFunction(op, 2));
+    fn->setArgument(0, &a, false);
+    fn->setArgument(1, &b, false);
+    fn->activate();
+
+    RESULT result;
+    size_t known = 0;
+    runBenchmark(op->getName() + '<' + typeName + '>',
+                 g_benchmarkOptions.iterations,
+                 [&] (size_t i)
+                 {
+                   a.setValue((ARG) (a0 + (ARG) (i & 0xF)));
+                   if (fn->getValue(result))
+                     ++known;
+                 });
+    g_benchmarkSink = known;
+    fn->deactivate();
+  }
+
+  template <typename ARG>
+  void unaryOperatorBenchmark(char const *typeName,
+                              Operator const *op,
+                              ARG a0)
+  {
+    UserVariable<ARG> a(a0);
+    std::unique_ptr<Function> fn(makeFunction(op, 1));
+    fn->setArgument(0, &a, false);
+    fn->activate();
+
+    ARG result;
+    size_t known = 0;
+    runBenchmark(op->getName() + '<' + typeName + '>',
+                 g_benchmarkOptions.iterations,
+                 [&] (size_t i)
+                 {
+                   a.setValue((ARG) (a0 + (ARG) (i & 0xF)));
+                   if (fn->getValue(result))
+                     ++known;
+                 });
+    g_benchmarkSink = known;
+    fn->deactivate();
+  }
+
+  template <typename NUM>
+  void arithmeticBenchmarks(char const *typeName)
+  {
+    NUM const a0 = (NUM) 37;
+    NUM const b0 = (NUM) 5;
+    binaryOperatorBenchmark<NUM, NUM>(typeName, Addition<NUM>::instance(), a0, b0);
+    binaryOperatorBenchmark<NUM, NUM>(typeName, Subtraction<NUM>::instance(), a0, b0);
+    binaryOperatorBenchmark<NUM, NUM>(typeName, Multiplication<NUM>::instance(), a0, b0);
+    binaryOperatorBenchmark<NUM, NUM>(typeName, Division<NUM>::instance(), a0, b0);
+    binaryOperatorBenchmark<NUM, NUM>(typeName, Modulo<NUM>::instance(), a0, b0);
+    binaryOperatorBenchmark<NUM, NUM>(typeName, Minimum<NUM>::instance(), a0, b0);
+    binaryOperatorBenchmark<NUM, NUM>(typeName, Maximum<NUM>::instance(), a0, b0);
+    unaryOperatorBenchmark<NUM>(typeName, AbsoluteValue<NUM>::instance(), (NUM) -a0);
+  }
+
+  template <typename NUM>
+  void comparisonBenchmarks(char const *typeName)
+  {
+    NUM const a0 = (NUM) 37;
+    NUM const b0 = (NUM) 42;
+    binaryOperatorBenchmark<NUM, Boolean>(typeName, Equal::instance(), a0, b0);
+    binaryOperatorBenchmark<NUM, Boolean>(typeName, NotEqual::instance(), a0, b0);
+    binaryOperatorBenchmark<NUM, Boolean>(typeName, GreaterThan<NUM>::instance(), a0, b0);
+    binaryOperatorBenchmark<NUM, Boolean>(typeName, GreaterEqual<NUM>::instance(), a0, b0);
+    binaryOperatorBenchmark<NUM, Boolean>(typeName, LessThan<NUM>::instance(), a0, b0);
+    binaryOperatorBenchmark<NUM, Boolean>(typeName, LessEqual<NUM>::instance(), a0, b0);
+  }
+
+} // anonymous namespace
+
+void exprBenchmarks()
+{
+  publishChangeBenchmark(1);
+  publishChangeBenchmark(8);
+  publishChangeBenchmark(64);
+  publishChangeBenchmark(512);
+
+  arithmeticBenchmarks<Integer>("Integer");
+  arithmeticBenchmarks<Real>("Real");
+  unaryOperatorBenchmark<Real>("Real", SquareRoot<Real>::instance(), 37.0);
+
+  comparisonBenchmarks<Integer>("Integer");
+  comparisonBenchmarks<Real>("Real");
+}
@@ -0,0 +1,71 @@
+/* Copyright (c) 2006-2021, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+//
+// Benchmarks for the StateCache
+//
+
+#include "BenchmarkSupport.hh"
+#include "State.hh"
+#include "StateCache.hh"
+
+#include <vector>
+
+using namespace PLEXIL;
+
+namespace
+{
+
+  // Measures the cost of finding the cache entry and updating its value,
+  // as a function of the number of distinct states in the cache.
+  void lookupReturnBenchmark(size_t nStates)
+  {
+    std::vector<State> states;
+    states.reserve(nStates);
+    for (size_t i = 0; i < nStates; ++i)
+      states.emplace_back(State("BenchmarkState", Value((Integer) i)));
+
+    StateCache &cache = StateCache::instance();
+    // Populate the cache outside the timed loop
+    for (State const &s : states)
+      cache.lookupReturn(s, Value((Integer) 0));
+
+    runBenchmark("StateCache::lookupReturn " + std::to_string(nStates) + " states",
+                 g_benchmarkOptions.iterations,
+                 [&cache, &states, nStates] (size_t i)
+                 {
+                   cache.lookupReturn(states[i % nStates], Value((Integer) i));
+                 });
+  }
+
+} // anonymous namespace
+
+void intfcBenchmarks()
+{
+  lookupReturnBenchmark(1);
+  lookupReturnBenchmark(100);
+  lookupReturnBenchmark(10000);
+}
@@ -24,6 +24,8 @@
 * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include "plexil-config.h"
+
 #include "ArrayImpl.hh"
 #include "Assignable.hh"
 #include "Assignment.hh"
@@ -34,6 +36,7 @@
 #include "parseNode.hh"
 #include "ParserException.hh"
 #include "planLibrary.hh"
+#include "SymbolTable.hh"
 #include "TestSupport.hh"
 #include "Update.hh"
 #include "UpdateNode.hh"
@@ -42,6 +45,13 @@
 
 #include "pugixml.hpp"
 
+#ifdef PLEXIL_WITH_THREADS
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#endif
+
 using namespace PLEXIL;
 
 using pugi::xml_attribute;
@@ -1874,6 +1884,98 @@ static bool libraryCallNodeXmlParserTest()
   return true;
 }
 
+#ifdef PLEXIL_WITH_THREADS
+
+static size_t const N_CONCURRENT_LIBS = 4;
+static size_t const N_CONCURRENT_THREADS = 4;
+static size_t const N_CONCURRENT_ITERATIONS = 25;
+
+// Each thread loads the same set of libraries and expands calls to them,
+// using its own symbol table.
+static bool concurrentLibraryCallWorker(size_t threadIdx)
+{
+  SymbolTable *symtab = makeSymbolTable();
+  pushSymbolTable(symtab);
+
+  bool result = true;
+  for (size_t iter = 0; iter < N_CONCURRENT_ITERATIONS && result; ++iter) {
+    std::string libName = "concLib" + std::to_string((threadIdx + iter) % N_CONCURRENT_LIBS);
+
+    // Offer a library definition; only the first one loaded should be kept
+    xml_document *libDoc = new xml_document;
+    makeNode(libDoc->append_child("PlexilPlan"), libName.c_str(), "Empty");
+    LibraryPtr lib = loadLibraryDocument(libDoc, false);
+    if (!lib || !lib->doc || !lib->symtab) {
+      result = false;
+      break;
+    }
+
+    xml_document callDoc;
+    std::string callName = libName + "Caller";
+    xml_node callXml = makeNode(callDoc, callName.c_str(), "LibraryNodeCall");
+    makePcdataElement(callXml.append_child("NodeBody").append_child("LibraryNodeCall"),
+                      "NodeId", libName.c_str());
+    NodeImpl *call = nullptr;
+    try {
+      checkNode(callXml);
+      call = constructNode(callXml, nullptr);
+      finalizeNode(call, callXml);
+      result = call->getType() == NodeType_LibraryNodeCall
+        && call->getChildren().size() == 1
+        && call->getChildren().front()->getNodeId() == libName;
+    }
+    catch (ParserException const &) {
+      result = false;
+    }
+    delete call;
+  }
+
+  popSymbolTable();
+  delete symtab;
+  return result;
+}
+
+static bool concurrentLibraryCallXmlParserTest()
+{
+  std::atomic<size_t> failures(0);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < N_CONCURRENT_THREADS; ++i)
+    threads.emplace_back([i, &failures]() {
+                           if (!concurrentLibraryCallWorker(i))
+                             ++failures;
+                         });
+  for (std::thread &t : threads)
+    t.join();
+  assertTrue_1(failures == 0);
+
+  for (size_t i = 0; i < N_CONCURRENT_LIBS; ++i)
+    assertTrue_1(isLibraryLoaded(("concLib" + std::to_string(i)).c_str()));
+
+  // Libraries already present are not reloaded
+  std::vector<std::string> names;
+  for (size_t i = 0; i < N_CONCURRENT_LIBS; ++i)
+    names.push_back("concLib" + std::to_string(i));
+  LibraryPtr before = getLibraryNode("concLib0", false);
+  assertTrue_1(loadLibraryNodes(names, N_CONCURRENT_THREADS));
+  assertTrue_1(getLibraryNode("concLib0", false) == before);
+
+  // Replacing a library publishes a new version;
+  // the old one lives only as long as someone holds it
+  std::weak_ptr<Library const> old(before);
+  xml_document *replacement = new xml_document;
+  makeNode(replacement->append_child("PlexilPlan"), "concLib0", "Empty");
+  LibraryPtr after = loadLibraryDocument(replacement, true);
+  assertTrue_1(after && after != before);
+  assertTrue_1(getLibraryNode("concLib0", false) == after);
+  assertTrue_1(before->doc && before->symtab);
+  before.reset();
+  assertTrue_1(old.expired());
+
+  return true;
+}
+
+#endif // PLEXIL_WITH_THREADS
+
 bool nodeXmlParserTest()
 {
   doc = new xml_document();
@@ -1884,6 +1986,9 @@ bool nodeXmlParserTest()
   runTest(commandNodeXmlParserTest);
   runTest(updateNodeXmlParserTest);
   runTest(libraryCallNodeXmlParserTest);
+#ifdef PLEXIL_WITH_THREADS
+  runTest(concurrentLibraryCallXmlParserTest);
+#endif
 
   delete doc;
   doc = nullptr;
@@ -0,0 +1,301 @@
+/* Copyright (c) 2006-2026, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+//
+// Module test for the plan check cache and symbol table serialization.
+//
+
+#include "PlanCheckCache.hh"
+#include "SymbolTable.hh"
+
+#include "DebugMessage.hh"
+#include "Error.hh"
+
+#include <cstdio> // std::remove()
+#include <cstdlib> // mkdtemp()
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+
+#include <unistd.h> // rmdir()
+
+using namespace PLEXIL;
+
+static std::string toHex(PlanContentKey const &key)
+{
+  std::ostringstream s;
+  s << std::hex << std::setfill('0');
+  for (uint8_t b : key.digest)
+    s << std::setw(2) << (unsigned int) b;
+  return s.str();
+}
+
+static std::string digestOf(std::string const &text)
+{
+  PlanContentKey key;
+  makePlanContentKey(text.data(), text.size(), key);
+  assertTrue_1(key.length == text.size());
+  return toHex(key);
+}
+
+static bool testDigest()
+{
+  std::cout << "testDigest" << std::endl;
+  // FIPS 180-4 examples, and lengths either side of the padding boundary
+  assertTrue_1(digestOf("")
+               == "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+  assertTrue_1(digestOf("abc")
+               == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+  assertTrue_1(digestOf("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq")
+               == "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+  assertTrue_1(digestOf(std::string(1000000, 'a'))
+               == "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+  assertTrue_1(digestOf(std::string(55, 'x')) != digestOf(std::string(56, 'x')));
+  return true;
+}
+
+static SymbolTable *makeTestTable()
+{
+  SymbolTable *symtab = makeSymbolTable();
+  Symbol *cmd = symtab->addCommand("move");
+  cmd->setReturnType(BOOLEAN_TYPE);
+  cmd->addParameterType(REAL_TYPE);
+  cmd->addParameterType(STRING_ARRAY_TYPE);
+  cmd->setAnyParameters();
+  Symbol *lkup = symtab->addLookup("with space");
+  lkup->setReturnType(INTEGER_TYPE);
+  symtab->addLookup("");
+  symtab->addMutex("m1");
+  LibraryNodeSymbol *lib = symtab->addLibraryNode("Lib");
+  lib->addParameter("in", INTEGER_TYPE, false);
+  lib->addParameter("inOut", STRING_TYPE, true);
+  return symtab;
+}
+
+static std::string writeTable(SymbolTable const *symtab)
+{
+  std::ostringstream s;
+  symtab->write(s);
+  return s.str();
+}
+
+// Returns true if the text is rejected, without throwing
+static bool rejected(std::string const &text)
+{
+  std::istringstream s(text);
+  std::unique_ptr<SymbolTable> symtab(readSymbolTable(s));
+  return !symtab;
+}
+
+static bool testRoundTrip()
+{
+  std::cout << "testRoundTrip" << std::endl;
+  std::unique_ptr<SymbolTable> orig(makeTestTable());
+  std::string const text = writeTable(orig.get());
+
+  std::istringstream s(text);
+  std::unique_ptr<SymbolTable> copy(readSymbolTable(s));
+  assertTrue_1(copy);
+  Symbol const *cmd = copy->getCommand("move");
+  assertTrue_1(cmd);
+  assertTrue_1(cmd->returnType() == BOOLEAN_TYPE);
+  assertTrue_1(cmd->parameterCount() == 2);
+  assertTrue_1(cmd->parameterType(0) == REAL_TYPE);
+  assertTrue_1(cmd->parameterType(1) == STRING_ARRAY_TYPE);
+  assertTrue_1(cmd->anyParameters());
+  Symbol const *lkup = copy->getLookup("with space");
+  assertTrue_1(lkup);
+  assertTrue_1(lkup->returnType() == INTEGER_TYPE);
+  assertTrue_1(lkup->parameterCount() == 0);
+  assertTrue_1(!lkup->anyParameters());
+  assertTrue_1(copy->getLookup(""));
+  assertTrue_1(!copy->getCommand("with space"));
+  assertTrue_1(copy->getMutex("m1"));
+  LibraryNodeSymbol *lib = const_cast<LibraryNodeSymbol *>(copy->getLibraryNode("Lib"));
+  assertTrue_1(lib);
+  assertTrue_1(lib->isParameterDeclared("in"));
+  assertTrue_1(lib->parameterValueType("in") == INTEGER_TYPE);
+  assertTrue_1(!lib->isParameterInOut("in"));
+  assertTrue_1(lib->parameterValueType("inOut") == STRING_TYPE);
+  assertTrue_1(lib->isParameterInOut("inOut"));
+  assertTrue_1(!lib->isParameterDeclared("out"));
+
+  // Writing the copy gives the same text
+  assertTrue_1(writeTable(copy.get()) == text);
+
+  // An empty table
+  std::unique_ptr<SymbolTable> empty(makeSymbolTable());
+  std::istringstream e(writeTable(empty.get()));
+  std::unique_ptr<SymbolTable> emptyCopy(readSymbolTable(e));
+  assertTrue_1(emptyCopy);
+  assertTrue_1(!emptyCopy->getCommand("move"));
+  return true;
+}
+
+static bool testMalformed()
+{
+  std::cout << "testMalformed" << std::endl;
+  std::unique_ptr<SymbolTable> orig(makeTestTable());
+  std::string const text = writeTable(orig.get());
+
+  // Every truncation short of the end marker
+  size_t const end = text.rfind('E');
+  for (size_t len = 0; len <= end; ++len) {
+    if (!rejected(text.substr(0, len))) {
+      std::cout << "  table truncated to " << len << " bytes was not rejected" << std::endl;
+      return false;
+    }
+  }
+
+  // Lengths and counts larger than the input
+  assertTrue_1(rejected("C 4000000000 x 0 0 0\nE\n"));
+  assertTrue_1(rejected("C 20 x 0 0 0\nE\n"));
+  assertTrue_1(rejected("M 18446744073709551615 m\nE\n"));
+  assertTrue_1(rejected("L 1 x 0 0 4000000000 0 0\nE\n"));
+  assertTrue_1(rejected("N 3 Lib 18446744073709551615 1 x 0 0\nE\n"));
+
+  // Bad types, duplicates, and unknown kinds
+  assertTrue_1(rejected("C 1 x 9999 0 0\nE\n"));
+  assertTrue_1(rejected("M 1 x\nM 1 x\nE\n"));
+  assertTrue_1(rejected("Q 1 x\nE\n"));
+  assertTrue_1(!rejected("M 1 x\nE\n"));
+  return true;
+}
+
+static bool testCache(std::string const &dir)
+{
+  std::cout << "testCache" << std::endl;
+  setPlanCheckCacheDirectory(dir);
+
+  std::string const plan("<PlexilPlan><Node/></PlexilPlan>");
+  PlanContentKey key;
+  makePlanContentKey(plan.data(), plan.size(), key);
+  std::ostringstream fname;
+  fname << dir << '/' << toHex(key).substr(0, 16) << '-' << key.length << ".chk";
+  std::string const entry = fname.str();
+
+  // Nothing stored yet; unknown content is never looked up
+  assertTrue_1(!findCheckedPlan(key));
+  PlanContentKey unknown = {};
+  assertTrue_1(!findCheckedPlan(unknown));
+
+  std::unique_ptr<SymbolTable> orig(makeTestTable());
+  storeCheckedPlan(key, orig.get());
+  {
+    std::unique_ptr<SymbolTable> hit(findCheckedPlan(key));
+    assertTrue_1(hit);
+    assertTrue_1(writeTable(hit.get()) == writeTable(orig.get()));
+  }
+
+  // Different content of the same length
+  std::string other(plan);
+  other[1] = 'Q';
+  PlanContentKey otherKey;
+  makePlanContentKey(other.data(), other.size(), otherKey);
+  assertTrue_1(!findCheckedPlan(otherKey));
+
+  std::string contents;
+  {
+    std::ifstream in(entry.c_str());
+    assertTrue_1(in);
+    contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+  size_t const line1 = contents.find('\n');
+  size_t const line2 = contents.find('\n', line1 + 1);
+  assertTrue_1(line2 != std::string::npos);
+
+  // An entry whose full digest differs, under the same file name
+  {
+    std::string bad(contents);
+    char &c = bad[line1 + 20];
+    c = (c == '0') ? '1' : '0';
+    std::ofstream out(entry.c_str(), std::ios::out | std::ios::trunc);
+    out << bad;
+  }
+  assertTrue_1(!findCheckedPlan(key));
+
+  // A corrupt symbol table is a miss, not an error
+  {
+    std::ofstream out(entry.c_str(), std::ios::out | std::ios::trunc);
+    out << contents.substr(0, line2 + 1) << "C 4000000000 x\n";
+  }
+  assertTrue_1(!findCheckedPlan(key));
+
+  // An entry made by a different checker
+  {
+    std::ofstream out(entry.c_str(), std::ios::out | std::ios::trunc);
+    out << "PLEXIL-CHECK 0000000000000000" << contents.substr(line1);
+  }
+  assertTrue_1(!findCheckedPlan(key));
+
+  // Storing again replaces the entry
+  storeCheckedPlan(key, orig.get());
+  {
+    std::unique_ptr<SymbolTable> hit(findCheckedPlan(key));
+    assertTrue_1(hit);
+  }
+
+  // No directory, no cache
+  setPlanCheckCacheDirectory("");
+  assertTrue_1(!findCheckedPlan(key));
+  std::remove(entry.c_str());
+  return true;
+}
+
+int main()
+{
+  // Read Debug.cfg in current directory, if it exists
+  char debugConfig[] = "Debug.cfg";
+  std::ifstream config(debugConfig);
+  if (config.good()) {
+    PLEXIL::readDebugConfigStream(config);
+    std::cout << "Read debug configuration file " << debugConfig << std::endl;
+  }
+
+  char dirTemplate[] = "/tmp/plan-check-cache-test-XXXXXX";
+  if (!mkdtemp(dirTemplate)) {
+    std::cout << "Unable to create cache directory" << std::endl;
+    return 1;
+  }
+
+  bool success = false;
+  try {
+    success = testDigest()
+      && testRoundTrip()
+      && testMalformed()
+      && testCache(dirTemplate);
+  }
+  catch (std::exception const &exc) {
+    std::cout << "Unexpected exception: " << exc.what() << std::endl;
+    success = false;
+  }
+
+  rmdir(dirTemplate);
+  std::cout << "Plan check cache test " << (success ? "succeeded" : "failed") << std::endl;
+  return (success ? 0 : 1);
+}
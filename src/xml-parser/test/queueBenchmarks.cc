@@ -0,0 +1,137 @@
+/* Copyright (c) 2006-2021, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+//
+// Benchmarks for LinkedQueue and PriorityQueue
+//
+
+#include "BenchmarkSupport.hh"
+#include "LinkedQueue.hh"
+
+#include <vector>
+
+using namespace PLEXIL;
+
+namespace
+{
+
+  struct QueueItem
+  {
+    QueueItem(int p = 0)
+      : nxt(nullptr),
+        priority(p)
+    {
+    }
+
+    QueueItem *next() const
+    {
+      return nxt;
+    }
+
+    QueueItem **nextPtr()
+    {
+      return &nxt;
+    }
+
+    QueueItem *nxt;
+    int priority;
+  };
+
+  struct QueueItemCompare
+  {
+    bool operator()(QueueItem const &a, QueueItem const &b) const
+    {
+      return a.priority < b.priority;
+    }
+  };
+
+  void linkedQueueBenchmark(size_t queueLength)
+  {
+    std::vector<QueueItem> items(queueLength);
+    LinkedQueue<QueueItem> q;
+    size_t const rounds = g_benchmarkOptions.iterations / queueLength + 1;
+
+    // One iteration = one push plus one pop
+    runBenchmark("LinkedQueue push/pop length " + std::to_string(queueLength),
+                 rounds * queueLength,
+                 [&items, &q, queueLength] (size_t i)
+                 {
+                   size_t idx = i % queueLength;
+                   if (idx == 0)
+                     // Drain the queue
+                     while (!q.empty())
+                       q.pop();
+                   q.push(&items[idx]);
+                 });
+    q.clear();
+
+    // Removal from the middle is a linear search
+    for (QueueItem &item : items)
+      q.push(&item);
+    runBenchmark("LinkedQueue remove/push length " + std::to_string(queueLength),
+                 g_benchmarkOptions.iterations / 16 + 1,
+                 [&items, &q, queueLength] (size_t i)
+                 {
+                   QueueItem *item = &items[(i * 7919) % queueLength];
+                   q.remove(item);
+                   q.push(item);
+                 });
+    q.clear();
+  }
+
+  void priorityQueueBenchmark(size_t queueLength, int priorityLevels)
+  {
+    std::vector<QueueItem> items;
+    items.reserve(queueLength);
+    for (size_t i = 0; i < queueLength; ++i)
+      items.emplace_back((int) ((i * 7919) % priorityLevels));
+    PriorityQueue<QueueItem, QueueItemCompare> q;
+
+    // One iteration = one insert, plus the pops to drain it periodically
+    runBenchmark("PriorityQueue insert/pop length " + std::to_string(queueLength)
+                 + " levels " + std::to_string(priorityLevels),
+                 g_benchmarkOptions.iterations / 16 + 1,
+                 [&items, &q, queueLength] (size_t i)
+                 {
+                   size_t idx = i % queueLength;
+                   if (idx == 0)
+                     while (!q.empty())
+                       q.pop();
+                   q.insert(&items[idx]);
+                 });
+    q.clear();
+  }
+
+} // anonymous namespace
+
+void queueBenchmarks()
+{
+  linkedQueueBenchmark(16);
+  linkedQueueBenchmark(1024);
+  priorityQueueBenchmark(16, 4);
+  priorityQueueBenchmark(1024, 4);
+  priorityQueueBenchmark(1024, 256);
+}
@@ -0,0 +1,92 @@
+/* Copyright (c) 2006-2021, Universities Space Research Association (USRA).
+*  All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*     * Neither the name of the Universities Space Research Association nor the
+*       names of its contributors may be used to endorse or promote products
+*       derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY USRA ``AS IS'' AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL USRA BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+* TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+//
+// Benchmarks for Value copy, assignment, and serialization
+//
+
+#include "ArrayImpl.hh"
+#include "BenchmarkSupport.hh"
+#include "Value.hh"
+
+#include <vector>
+
+using namespace PLEXIL;
+
+namespace
+{
+
+  void valueBenchmark(std::string const &label, Value const &val)
+  {
+    size_t const n = g_benchmarkOptions.iterations;
+
+    runBenchmark("Value copy " + label, n,
+                 [&val] (size_t)
+                 {
+                   Value copy(val);
+                   g_benchmarkSink = copy.isKnown();
+                 });
+
+    Value dest;
+    runBenchmark("Value assign " + label, n,
+                 [&val, &dest] (size_t)
+                 {
+                   dest = val;
+                   g_benchmarkSink = dest.isKnown();
+                 });
+
+    std::vector<char> buffer(val.serialSize());
+    runBenchmark("Value serialize " + label, n,
+                 [&val, &buffer] (size_t)
+                 {
+                   char *end = val.serialize(buffer.data());
+                   g_benchmarkSink = end - buffer.data();
+                 });
+
+    Value result;
+    runBenchmark("Value deserialize " + label, n,
+                 [&result, &buffer] (size_t)
+                 {
+                   char const *end = result.deserialize(buffer.data());
+                   g_benchmarkSink = end - buffer.data();
+                 });
+  }
+
+} // anonymous namespace
+
+void valueBenchmarks()
+{
+  size_t const arraySize = 1024;
+
+  valueBenchmark("Boolean", Value(true));
+  valueBenchmark("Integer", Value((Integer) 42));
+  valueBenchmark("Real", Value(3.14159));
+  valueBenchmark("String", Value("The quick brown fox jumps over the lazy dog"));
+  valueBenchmark("IntegerArray[1024]", Value(IntegerArray(arraySize, 42)));
+  valueBenchmark("RealArray[1024]", Value(RealArray(arraySize, 3.14159)));
+  valueBenchmark("StringArray[1024]",
+                 Value(StringArray(arraySize, String("telemetry"))));
+}
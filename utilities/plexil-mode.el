@@ -330,6 +330,7 @@
     ;; Node failure values
     "EXITED"
     "INVARIANT_CONDITION_FAILED"
+    "LIBRARY_EXPANSION_FAILED"
     "PARENT_EXITED"
     "PARENT_FAILED"
     "POST_CONDITION_FAILED"
@@ -299,7 +299,8 @@ public class PlexilSchema
         INVARIANT_CONDITION_FAILED,
         PARENT_FAILED,
         EXITED,
-        PARENT_EXITED;
+        PARENT_EXITED,
+        LIBRARY_EXPANSION_FAILED;
     }
 
     // NodeRef directions